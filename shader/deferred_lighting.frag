@@ -3,11 +3,10 @@
 
 #include "pbr.h"
 
-layout(input_attachment_index = 0, set = 0, binding = 0) uniform subpassInput normal_texture_sampler;
-layout(input_attachment_index = 1, set = 0, binding = 1) uniform subpassInput base_color_texture_sampler;
-layout(input_attachment_index = 2, set = 0, binding = 2) uniform subpassInput emissive_color_texture_sampler;
-layout(input_attachment_index = 3, set = 0, binding = 3) uniform subpassInput metallic_roughness_occlusion_texture_sampler;
-layout(input_attachment_index = 4, set = 0, binding = 4) uniform subpassInput depth_stencil_texture_sampler;
+layout(input_attachment_index = 0, set = 0, binding = 0) uniform subpassInput normal_roughness_texture_sampler;
+layout(input_attachment_index = 1, set = 0, binding = 1) uniform subpassInput base_color_metallic_texture_sampler;
+layout(input_attachment_index = 2, set = 0, binding = 2) uniform subpassInput emissive_occlusion_texture_sampler;
+layout(input_attachment_index = 3, set = 0, binding = 3) uniform subpassInput depth_stencil_texture_sampler;
 
 layout(location = 0) in vec2 f_tex_coord;
 layout(location = 0) out vec4 o_color;
@@ -20,15 +19,17 @@ void main()
     vec4 world_position = lighting_ubo.inv_camera_view_proj * ndc_pos;
     MaterialInfo mat_info;
 	mat_info.position = world_position.xyz / world_position.w;
-	mat_info.normal = subpassLoad(normal_texture_sampler).xyz;
+	vec4 normal_roughness = subpassLoad(normal_roughness_texture_sampler);
+	mat_info.normal = oct_decode(normal_roughness.xy * 2.0 - 1.0);
 	
-	// pbr material properties
-	mat_info.base_color = subpassLoad(base_color_texture_sampler);
-	mat_info.emissive_color = subpassLoad(emissive_color_texture_sampler);
-	vec3 metallic_roughness_occlusion = subpassLoad(metallic_roughness_occlusion_texture_sampler).xyz;
-	mat_info.metallic = metallic_roughness_occlusion.x;
-	mat_info.roughness = metallic_roughness_occlusion.y;
-	mat_info.occlusion = metallic_roughness_occlusion.z;
+	// pbr material properties, deferred meshes are opaque
+	vec4 base_color_metallic = subpassLoad(base_color_metallic_texture_sampler);
+	vec4 emissive_occlusion = subpassLoad(emissive_occlusion_texture_sampler);
+	mat_info.base_color = vec4(base_color_metallic.rgb, 1.0);
+	mat_info.emissive_color = vec4(emissive_occlusion.rgb, 1.0);
+	mat_info.metallic = base_color_metallic.a;
+	mat_info.roughness = normal_roughness.z;
+	mat_info.occlusion = emissive_occlusion.a;
 
 	o_color = calc_pbr(mat_info);
 }
\ No newline at end of file
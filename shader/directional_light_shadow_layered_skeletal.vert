@@ -0,0 +1,37 @@
+#version 450
+#extension GL_GOOGLE_include_directive : enable
+#extension GL_ARB_shader_viewport_layer_array : enable
+
+#include "host_device.h"
+
+layout(push_constant) uniform PCO
+{
+	TransformPCO transform_pco;
+	layout(offset = 192) uint layer_indices;
+} pco;
+
+layout(set = 0, binding = 0) readonly buffer _BonePaletteSSBO { BoneTransform bone_transforms[]; };
+layout(binding = 1) uniform _ShadowCascadeUBO { ShadowCascadeUBO shadow_cascade_ubo; };
+
+#include "skinning.h"
+
+layout(location = 0) in vec3 position;
+layout(location = 1) in vec2 tex_coord;
+layout(location = 3) in uvec4 bones;
+layout(location = 4) in vec4 weights;
+
+layout(location = 0) out vec2 g_tex_coord;
+
+void main()
+{
+	mat4 blend_bone_matrix = calc_skinning_matrix(bones, weights);
+
+	// each instance renders to one visible cascade, cascade indices are packed in 4 bits each
+	uint cascade = (pco.layer_indices >> (4 * gl_InstanceIndex)) & 0xF;
+	vec4 world_position = pco.transform_pco.m * blend_bone_matrix * vec4(position, 1.0);
+
+	g_tex_coord = tex_coord;
+
+	gl_Layer = int(cascade);
+	gl_Position = shadow_cascade_ubo.cascade_view_projs[cascade] * world_position;
+}
\ No newline at end of file
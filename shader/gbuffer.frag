@@ -3,18 +3,24 @@
 
 #include "material.h"
 
-layout(location = 0) out vec4 o_normal;
-layout(location = 1) out vec4 o_base_color;
-layout(location = 2) out vec4 o_emissive_color;
-layout(location = 3) out vec4 o_metallic_roughness_occlusion;
+// emissive and occlusion are written to the color attachment, which composition overwrites with the lit color
+layout(location = 0) out vec4 o_emissive_occlusion;
+layout(location = 1) out vec4 o_normal_roughness;
+layout(location = 2) out vec4 o_base_color_metallic;
+layout(location = 3) out vec2 o_velocity;
+
+layout(location = 3) in vec4 f_clip_position;
+layout(location = 4) in vec4 f_prev_clip_position;
 
 void main()
 {
 	MaterialInfo mat_info = calc_material_info();
 
 	// gbuffers
-	o_normal = vec4(mat_info.normal, 0.0);
-	o_base_color = mat_info.base_color;
-	o_emissive_color = mat_info.emissive_color;
-	o_metallic_roughness_occlusion.xyz = vec3(mat_info.metallic, mat_info.roughness, mat_info.occlusion);
+	o_emissive_occlusion = vec4(mat_info.emissive_color.rgb, mat_info.occlusion);
+	o_normal_roughness = vec4(oct_encode(normalize(mat_info.normal)) * 0.5 + 0.5, mat_info.roughness, 0.0);
+	o_base_color_metallic = vec4(mat_info.base_color.rgb, mat_info.metallic);
+
+	// screen uv motion since the previous frame, both positions share the current jitter so it cancels out
+	o_velocity = (f_clip_position.xy / f_clip_position.w - f_prev_clip_position.xy / f_prev_clip_position.w) * 0.5;
 }
\ No newline at end of file
@@ -5,26 +5,62 @@
 #define TWO_PI (PI * 2.0)
 #define HALF_PI (PI * 0.5)
 
-#define INVALID_BONE -1
-#define MAX_BONE_NUM 128
 #define BONE_NUM_PER_VERTEX 4
 
+// bone palettes are skinned with dual quaternions instead of matrices, which halves their bandwidth but ignores bone scales,
+// set by the BAMBOO_DUAL_QUATERNION_SKINNING cmake option for both c++ and shaders
+#ifndef DUAL_QUATERNION_SKINNING
+#define DUAL_QUATERNION_SKINNING 0
+#endif
+
 #define STD_GAMMA 2.2
 #define DIELECTRIC_F0 0.04
 #define TONEMAP_EXPOSURE 4.5
 #define EPSILON 0.001
 
-#define MAX_POINT_LIGHT_NUM 8
-#define MAX_SPOT_LIGHT_NUM 8
+#define MAX_POINT_LIGHT_NUM 256
+#define MAX_SPOT_LIGHT_NUM 256
+#define MAX_SHADOW_POINT_LIGHT_NUM 8
+#define MAX_SHADOW_SPOT_LIGHT_NUM 32
+#define LIGHT_CLUSTER_DIM_X 16
+#define LIGHT_CLUSTER_DIM_Y 9
+#define LIGHT_CLUSTER_DIM_Z 24
+#define LIGHT_CLUSTER_NUM (LIGHT_CLUSTER_DIM_X * LIGHT_CLUSTER_DIM_Y * LIGHT_CLUSTER_DIM_Z)
+#define MAX_LIGHT_INDEX_NUM (LIGHT_CLUSTER_NUM * 32)
 #define SHADOW_CASCADE_NUM 4
 #define SHADOW_FACE_NUM 6
 #define MIN_SHADOW_ALPHA 0.001
 #define MIN_OUTLINE_ALPHA 0.001
 #define DIRECTIONAL_LIGHT_SHADOW_BIAS 0.002
-#define SPOT_LIGHT_SHADOW_BIAS 0.001
+#define LOCAL_LIGHT_SHADOW_BIAS 0.001
 #define PCF_DELTA_SCALE 0.75
 #define PCF_SAMPLE_RANGE 1
 
+// mesh vertex buffers with half float uvs and octahedral normals, quantized when uploaded so assets don't depend on it,
+// set by the BAMBOO_QUANTIZED_VERTEX cmake option for both c++ and shaders
+#ifndef QUANTIZED_VERTEX
+#define QUANTIZED_VERTEX 0
+#endif
+
+// vertex sizes in 32 bit words, skinning compute shader reads skeletal vertices and writes static ones,
+// skeletal vertices pack their 16 bit bone indices in 2 words
+#if QUANTIZED_VERTEX
+#define STATIC_VERTEX_WORD_NUM 5
+#define SKELETAL_VERTEX_WORD_NUM 11
+#else
+#define STATIC_VERTEX_WORD_NUM 8
+#define SKELETAL_VERTEX_WORD_NUM 14
+#endif
+#define SKINNING_GROUP_SIZE 64
+
+// meshlet sizes of mesh shader friendly clusters, which are culled by compute shader before indirect draws
+#define MESHLET_MAX_VERTEX_NUM 64
+#define MESHLET_MAX_TRIANGLE_NUM 124
+#define MESHLET_CULL_GROUP_SIZE 64
+
+// velocity attachment clear value, marks pixels without motion vectors
+#define BACKGROUND_VELOCITY 1024.0
+
 #define OUTLINE_THICKNESS 2
 #define DEBUG_SHADER_DEPTH_MULTIPLIER 0.02
 
@@ -38,6 +74,33 @@ bool is_nearly_zero(float v)
 {
     return abs(v) < EPSILON;
 }
+
+// inverse transpose of the upper 3x3 matrix up to a scale, i.e. its cofactor matrix with the sign of determinant
+mat3 calc_normal_matrix(mat4 m)
+{
+    mat3 nm = mat3(cross(m[1].xyz, m[2].xyz), cross(m[2].xyz, m[0].xyz), cross(m[0].xyz, m[1].xyz));
+    return determinant(mat3(m)) < 0.0 ? -nm : nm;
+}
+
+// project the normal onto an octahedron, and unfold its lower half onto the corners, in [-1, 1]
+vec2 oct_encode(vec3 n)
+{
+    vec2 e = n.xy / (abs(n.x) + abs(n.y) + abs(n.z));
+    if (n.z < 0.0)
+    {
+        e = (1.0 - abs(e.yx)) * vec2(e.x >= 0.0 ? 1.0 : -1.0, e.y >= 0.0 ? 1.0 : -1.0);
+    }
+    return e;
+}
+
+vec3 oct_decode(vec2 e)
+{
+    vec3 n = vec3(e.xy, 1.0 - abs(e.x) - abs(e.y));
+    float t = max(-n.z, 0.0);
+    n.x += n.x >= 0.0 ? -t : t;
+    n.y += n.y >= 0.0 ? -t : t;
+    return normalize(n);
+}
 #endif
 
 #endif
\ No newline at end of file
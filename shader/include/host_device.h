@@ -14,16 +14,23 @@ using uint = unsigned int;
 
 #include "constants.h"
 
-struct BoneUBO
+// skinning transform of a bone in a bone palette ssbo, a unit dual quaternion
+// with its real and dual parts in x, y, z, w order if DUAL_QUATERNION_SKINNING
+struct BoneTransform
 {
-	mat4 bone_matrices[MAX_BONE_NUM];
+#if DUAL_QUATERNION_SKINNING
+	vec4 real;
+	vec4 dual;
+#else
+	mat4 matrix;
+#endif
 };
 
 struct TransformPCO
 {
     mat4 m;
-    mat4 nm;
     mat4 mvp;
+    mat4 prev_mvp; // model view projection of the previous frame, for motion vectors
 };
 
 struct MaterialPCO
@@ -65,7 +72,7 @@ struct PointLight
     float radius;
 	float linear_attenuation;
 	float quadratic_attenuation;
-    int cast_shadow;
+    int shadow_index; // -1 if the light has no shadow
 };
 
 struct SpotLight
@@ -73,6 +80,7 @@ struct SpotLight
     PointLight _pl;
     vec3 direction; float padding0;
     mat4 view_proj;
+    vec4 shadow_atlas_rect; // uv offset(xy) and scale(zw) of the light's shadow atlas tile
 };
 
 struct LightingUBO
@@ -81,24 +89,48 @@ struct LightingUBO
     vec3 camera_pos;
     float exposure;
     mat4 camera_view;
+    mat4 camera_view_proj;
     mat4 inv_camera_view_proj;
 
-    // lights
+    // lights, point and spot lights are stored in LightSSBO
     SkyLight sky_light;
     DirectionalLight directional_light;
-    PointLight point_lights[MAX_POINT_LIGHT_NUM];
-    SpotLight spot_lights[MAX_SPOT_LIGHT_NUM];
 
     int has_sky_light;
     int has_directional_light;
     int point_light_num;
     int spot_light_num;
 
+    // light clusters are sliced exponentially in view depth: slice = log(depth) * scale - bias
+    float cluster_z_scale;
+    float cluster_z_bias;
+    float padding0;
+    float padding1;
+
     // debug
     vec3 camera_dir;
     int shader_debug_option;
 };
 
+struct PointLightShadow
+{
+    mat4 face_view_projs[SHADOW_FACE_NUM]; // cube faces in +x, -x, +y, -y, +z, -z order
+    vec4 face_atlas_rects[SHADOW_FACE_NUM]; // uv offset(xy) and scale(zw) of each face's shadow atlas tile
+};
+
+struct LightSSBO
+{
+    PointLight point_lights[MAX_POINT_LIGHT_NUM];
+    SpotLight spot_lights[MAX_SPOT_LIGHT_NUM];
+    PointLightShadow point_light_shadows[MAX_SHADOW_POINT_LIGHT_NUM];
+};
+
+struct LightCluster
+{
+    uint light_offset; // first light index of the cluster in the light index list
+    uint light_counts; // point light count in low 16 bits, spot light count in high 16 bits
+};
+
 struct MaterialInfo
 {
     vec3 position;
@@ -115,9 +147,39 @@ struct ShadowCascadeUBO
     mat4 cascade_view_projs[SHADOW_CASCADE_NUM];
 };
 
-struct ShadowCubeUBO
+struct MeshletData
+{
+    vec4 sphere; // object space center(xyz) and radius(w)
+    vec4 cone_apex;
+    vec4 cone_axis_cutoff; // backfacing if the view direction to the apex is within the cutoff of the axis
+    uint first_index; // absolute in the index buffer, ready for indirect draws
+    uint index_count;
+    int vertex_offset;
+    uint padding0;
+};
+
+struct MeshletCullPCO
+{
+    vec4 frustum_planes[6]; // object space, scaled so their distances compare with object space radii
+    vec4 camera_pos; // object space, cone culling is enabled if w is 1
+    uint meshlet_offset;
+    uint meshlet_count;
+    uint draw_offset; // first indirect command of the sub mesh
+    uint count_index; // draw count of the sub mesh in the count buffer
+};
+
+struct SkinningPCO
+{
+    uint vertex_count;
+};
+
+struct TemporalUpsamplePCO
 {
-    mat4 face_view_projs[SHADOW_FACE_NUM];
+    mat4 reprojection; // current to previous clip space, for pixels without motion vectors
+    vec4 render_size; // render resolution(xy) and reciprocal of input texture size(zw)
+    vec2 jitter; // projection jitter in uv
+    float history_weight;
+    int reset_history;
 };
 
 #endif
\ No newline at end of file
@@ -11,12 +11,19 @@ layout(set = 0, binding = 7) uniform sampler2D brdf_lut_texture_sampler;
 
 // shadow textures
 layout(set = 0, binding = 8) uniform sampler2DArray directional_light_shadow_texture_sampler;
-layout(set = 0, binding = 9) uniform samplerCube point_light_shadow_texture_samplers[MAX_POINT_LIGHT_NUM];
-layout(set = 0, binding = 10) uniform sampler2D spot_light_shadow_texture_samplers[MAX_SPOT_LIGHT_NUM];
+layout(set = 0, binding = 10) uniform sampler2D local_light_shadow_atlas_sampler;
 
 // lighting ubo
 layout(set = 0, binding = 11) uniform _LightingUBO { LightingUBO lighting_ubo; };
 
+// point/spot lights and their cluster assignment
+layout(set = 0, binding = 12) readonly buffer _LightSSBO { LightSSBO light_ssbo; };
+layout(set = 0, binding = 13) readonly buffer _LightClusterSSBO
+{
+	LightCluster light_clusters[LIGHT_CLUSTER_NUM];
+	uint light_indices[];
+};
+
 struct PBRInfo
 {
 	float NdotL;                  // cos angle between normal and light direction
@@ -150,6 +157,36 @@ float filterPCF(vec4 shadow_coord, uint cascade_index)
 	return shadow / count;
 }
 
+// shadow of a spot light frustum or a point light cube face, sampled from its atlas tile,
+// clamped inside the tile so filtering doesn't fetch neighbour tiles
+float sampleLocalLightShadow(mat4 view_proj, vec4 atlas_rect, vec3 position)
+{
+	vec4 shadow_coord = (k_shadow_bias_mat * view_proj) * vec4(position, 1.0);
+	shadow_coord = shadow_coord / shadow_coord.w;
+	if (shadow_coord.z <= 0.0 || shadow_coord.z >= 1.0)
+	{
+		return 1.0;
+	}
+
+	vec2 half_texel = 0.5 / vec2(textureSize(local_light_shadow_atlas_sampler, 0));
+	vec2 atlas_uv = clamp(atlas_rect.xy + shadow_coord.xy * atlas_rect.zw, atlas_rect.xy + half_texel, atlas_rect.xy + atlas_rect.zw - half_texel);
+	float depth = texture(local_light_shadow_atlas_sampler, atlas_uv).r;
+	return depth < shadow_coord.z - LOCAL_LIGHT_SHADOW_BIAS ? 0.0 : 1.0;
+}
+
+// index of the light cluster containing the world position, must match RenderSystem::assignLightClusters
+uint calc_light_cluster_index(vec3 position)
+{
+	vec4 clip_pos = lighting_ubo.camera_view_proj * vec4(position, 1.0);
+	vec2 uv = clip_pos.xy / clip_pos.w * 0.5 + 0.5;
+	ivec2 tile = clamp(ivec2(uv * vec2(LIGHT_CLUSTER_DIM_X, LIGHT_CLUSTER_DIM_Y)), ivec2(0), ivec2(LIGHT_CLUSTER_DIM_X - 1, LIGHT_CLUSTER_DIM_Y - 1));
+
+	float depth = max(-(lighting_ubo.camera_view * vec4(position, 1.0)).z, EPSILON);
+	int slice = clamp(int(floor(log(depth) * lighting_ubo.cluster_z_scale - lighting_ubo.cluster_z_bias)), 0, LIGHT_CLUSTER_DIM_Z - 1);
+
+	return uint(tile.x + tile.y * LIGHT_CLUSTER_DIM_X + slice * LIGHT_CLUSTER_DIM_X * LIGHT_CLUSTER_DIM_Y);
+}
+
 bool is_debug_lit() { return lighting_ubo.shader_debug_option == 0; }
 bool is_debug_unlit() { return lighting_ubo.shader_debug_option == 1; }
 bool is_debug_wireframe() { return lighting_ubo.shader_debug_option == 2; }
@@ -267,10 +304,15 @@ vec4 calc_pbr(MaterialInfo mat_info)
 		light_color += getLightContribution(pbr_info, n, v, -directional_light.direction, directional_light.color) * shadow;
 	}
 
+	// only shade the point/spot lights assigned to this fragment's cluster
+	LightCluster light_cluster = light_clusters[calc_light_cluster_index(mat_info.position)];
+	uint point_light_count = light_cluster.light_counts & 0xFFFFu;
+	uint spot_light_count = light_cluster.light_counts >> 16;
+
 	// point lights
-	for (int i = 0; i < lighting_ubo.point_light_num; ++i)
+	for (uint i = 0; i < point_light_count; ++i)
 	{
-		PointLight point_light = lighting_ubo.point_lights[i];
+		PointLight point_light = light_ssbo.point_lights[light_indices[light_cluster.light_offset + i]];
 		
 		float distance = distance(point_light.position, mat_info.position);
 		if (distance < point_light.radius)
@@ -281,14 +323,15 @@ vec4 calc_pbr(MaterialInfo mat_info)
 			vec3 l = normalize(point_light.position - mat_info.position);
 
 			float shadow = 1.0;
-			if (bool(point_light.cast_shadow))
+			if (point_light.shadow_index >= 0)
 			{
+				// the cube face is selected by the major axis of the light to fragment vector, in +x, -x, +y, -y, +z, -z order
 				vec3 sample_vector = mat_info.position - point_light.position;
-				float depth = texture(point_light_shadow_texture_samplers[i], sample_vector).x;
-				if (length(sample_vector) > depth)
-				{
-					shadow = 0.0;
-				}
+				vec3 abs_vector = abs(sample_vector);
+				uint axis = abs_vector.x >= max(abs_vector.y, abs_vector.z) ? 0u : (abs_vector.y >= abs_vector.z ? 1u : 2u);
+				uint face = axis * 2u + (sample_vector[axis] < 0.0 ? 1u : 0u);
+				shadow = sampleLocalLightShadow(light_ssbo.point_light_shadows[point_light.shadow_index].face_view_projs[face], 
+					light_ssbo.point_light_shadows[point_light.shadow_index].face_atlas_rects[face], mat_info.position);
 			}
 
 			light_color += getLightContribution(pbr_info, n, v, l, c) * shadow;
@@ -296,9 +339,9 @@ vec4 calc_pbr(MaterialInfo mat_info)
 	}
 
 	// spot lights
-	for (int i = 0; i < lighting_ubo.spot_light_num; ++i)
+	for (uint i = 0; i < spot_light_count; ++i)
 	{
-		SpotLight spot_light = lighting_ubo.spot_lights[i];
+		SpotLight spot_light = light_ssbo.spot_lights[light_indices[light_cluster.light_offset + point_light_count + i]];
 		PointLight point_light = spot_light._pl;
 
 		float distance = distance(point_light.position, mat_info.position);
@@ -314,19 +357,9 @@ vec4 calc_pbr(MaterialInfo mat_info)
 			vec3 l = normalize(point_light.position - mat_info.position);
 
 			float shadow = 1.0;
-			if (bool(point_light.cast_shadow))
+			if (point_light.shadow_index >= 0)
 			{
-				vec4 shadow_coord = (k_shadow_bias_mat * spot_light.view_proj) * vec4(mat_info.position, 1.0);
-				shadow_coord = shadow_coord / shadow_coord.w;
-
-				if (shadow_coord.z > 0.0 && shadow_coord.z < 1.0) 
-				{
-					float depth = texture(spot_light_shadow_texture_samplers[i], shadow_coord.xy).r;
-					if (depth < shadow_coord.z - SPOT_LIGHT_SHADOW_BIAS) 
-					{
-						shadow = 0.0;
-					}
-				}
+				shadow = sampleLocalLightShadow(spot_light.view_proj, spot_light.shadow_atlas_rect, mat_info.position);
 			}
 
 			light_color += getLightContribution(pbr_info, n, v, l, c) * shadow;
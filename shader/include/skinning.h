@@ -0,0 +1,43 @@
+#ifndef SKINNING
+#define SKINNING
+
+#include "host_device.h"
+
+// blended skinning matrix of a vertex, the bone_transforms palette must be declared before the include
+mat4 calc_skinning_matrix(uvec4 bones, vec4 weights)
+{
+#if DUAL_QUATERNION_SKINNING
+	// blend on the hemisphere of the first bone's rotation, and normalize the blend to a rigid transform
+	vec4 first_real = bone_transforms[bones[0]].real;
+	vec4 real = vec4(0.0);
+	vec4 dual = vec4(0.0);
+	for (int i = 0; i < BONE_NUM_PER_VERTEX; ++i)
+	{
+		BoneTransform bone_transform = bone_transforms[bones[i]];
+		float weight = dot(bone_transform.real, first_real) < 0.0 ? -weights[i] : weights[i];
+		real += bone_transform.real * weight;
+		dual += bone_transform.dual * weight;
+	}
+	float inv_length = 1.0 / length(real);
+	real *= inv_length;
+	dual *= inv_length;
+
+	// rotation of the real part, and translation 2 * dual * conjugate(real)
+	float x = real.x, y = real.y, z = real.z, w = real.w;
+	vec3 translation = 2.0 * (w * dual.xyz - dual.w * real.xyz + cross(real.xyz, dual.xyz));
+	return mat4(
+		vec4(1.0 - 2.0 * (y * y + z * z), 2.0 * (x * y + w * z), 2.0 * (x * z - w * y), 0.0),
+		vec4(2.0 * (x * y - w * z), 1.0 - 2.0 * (x * x + z * z), 2.0 * (y * z + w * x), 0.0),
+		vec4(2.0 * (x * z + w * y), 2.0 * (y * z - w * x), 1.0 - 2.0 * (x * x + y * y), 0.0),
+		vec4(translation, 1.0));
+#else
+	mat4 blend_bone_matrix = mat4(0.0);
+	for (int i = 0; i < BONE_NUM_PER_VERTEX; ++i)
+	{
+		blend_bone_matrix += bone_transforms[bones[i]].matrix * weights[i];
+	}
+	return blend_bone_matrix;
+#endif
+}
+
+#endif
\ No newline at end of file
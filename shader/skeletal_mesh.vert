@@ -3,33 +3,43 @@
 
 #include "host_device.h"
 
-layout(set = 0, binding = 0) uniform _BoneUBO { BoneUBO bone_ubo; };
+layout(set = 0, binding = 0) readonly buffer _BonePaletteSSBO { BoneTransform bone_transforms[]; };
 layout(push_constant) uniform _TransformPCO { TransformPCO transform_pco; };
 
+#include "skinning.h"
+
 layout(location = 0) in vec3 position;
 layout(location = 1) in vec2 tex_coord;
+#if QUANTIZED_VERTEX
+layout(location = 2) in vec2 oct_normal;
+#else
 layout(location = 2) in vec3 normal;
-layout(location = 3) in ivec4 bones;
+#endif
+layout(location = 3) in uvec4 bones;
 layout(location = 4) in vec4 weights;
 
 layout(location = 0) out vec3 f_position;
 layout(location = 1) out vec2 f_tex_coord;
 layout(location = 2) out vec3 f_normal;
+layout(location = 3) out vec4 f_clip_position;
+layout(location = 4) out vec4 f_prev_clip_position;
 
 void main()
 {
-	mat4 blend_bone_matrix = mat4(0.0);
-	for (int i = 0; i < BONE_NUM_PER_VERTEX; ++i)
-	{
-		blend_bone_matrix += bone_ubo.bone_matrices[bones[i]] * weights[i];
-	}
+#if QUANTIZED_VERTEX
+	vec3 normal = oct_decode(oct_normal);
+#endif
+
+	mat4 blend_bone_matrix = calc_skinning_matrix(bones, weights);
 
 	vec4 local_position = blend_bone_matrix * vec4(position, 1.0);
 	vec3 local_normal = mat3(blend_bone_matrix) * normal;
 	
 	f_position = (transform_pco.m * local_position).xyz;
 	f_tex_coord = tex_coord;
-	f_normal = normalize(mat3(transform_pco.nm) * local_normal);
+	f_normal = normalize(calc_normal_matrix(transform_pco.m) * local_normal);
 
 	gl_Position = transform_pco.mvp * local_position;
+	f_clip_position = gl_Position;
+	f_prev_clip_position = transform_pco.prev_mvp * local_position;
 }
\ No newline at end of file
@@ -0,0 +1,37 @@
+#version 450
+#extension GL_GOOGLE_include_directive : enable
+
+#include "host_device.h"
+
+layout(push_constant) uniform _TransformPCO { TransformPCO transform_pco; };
+
+layout(location = 0) in vec3 position;
+layout(location = 1) in vec2 tex_coord;
+#if QUANTIZED_VERTEX
+layout(location = 2) in vec2 oct_normal;
+#else
+layout(location = 2) in vec3 normal;
+#endif
+// position of the previous frame, differs from position for compute skinned meshes
+layout(location = 3) in vec3 prev_position;
+
+layout(location = 0) out vec3 f_position;
+layout(location = 1) out vec2 f_tex_coord;
+layout(location = 2) out vec3 f_normal;
+layout(location = 3) out vec4 f_clip_position;
+layout(location = 4) out vec4 f_prev_clip_position;
+
+void main()
+{	
+#if QUANTIZED_VERTEX
+	vec3 normal = oct_decode(oct_normal);
+#endif
+
+	f_position = (transform_pco.m * vec4(position, 1.0)).xyz;
+	f_tex_coord = tex_coord;
+	f_normal = normalize(calc_normal_matrix(transform_pco.m) * normal);
+
+	gl_Position = transform_pco.mvp * vec4(position, 1.0);
+	f_clip_position = gl_Position;
+	f_prev_clip_position = transform_pco.prev_mvp * vec4(prev_position, 1.0);
+}
\ No newline at end of file
@@ -0,0 +1,58 @@
+#version 450
+#extension GL_GOOGLE_include_directive : enable
+
+#include "host_device.h"
+
+layout(location = 0) in vec2 f_tex_coord;
+layout(location = 0) out vec4 o_color;
+
+layout(set = 0, binding = 0) uniform sampler2D color_texture_sampler;
+layout(set = 0, binding = 1) uniform sampler2D velocity_texture_sampler;
+layout(set = 0, binding = 2) uniform sampler2D history_texture_sampler;
+
+layout(push_constant) uniform _TemporalUpsamplePCO { TemporalUpsamplePCO temporal_upsample_pco; };
+
+void main()
+{
+	// position of the output pixel in the jittered render region of input textures
+	vec2 render_size = temporal_upsample_pco.render_size.xy;
+	vec2 render_pos = clamp((f_tex_coord + temporal_upsample_pco.jitter) * render_size, vec2(0.5), render_size - 0.5);
+	ivec2 render_coord = ivec2(render_pos);
+	ivec2 max_coord = ivec2(render_size) - 1;
+
+	// current color and the color bounds of its neighborhood
+	vec4 color = textureLod(color_texture_sampler, render_pos * temporal_upsample_pco.render_size.zw, 0.0);
+	vec4 min_color = color;
+	vec4 max_color = color;
+	for (int y = -1; y <= 1; ++y)
+	{
+		for (int x = -1; x <= 1; ++x)
+		{
+			vec4 neighbor_color = texelFetch(color_texture_sampler, clamp(render_coord + ivec2(x, y), ivec2(0), max_coord), 0);
+			min_color = min(min_color, neighbor_color);
+			max_color = max(max_color, neighbor_color);
+		}
+	}
+
+	o_color = color;
+	if (bool(temporal_upsample_pco.reset_history))
+	{
+		return;
+	}
+
+	// pixels without motion vectors are reprojected at the far plane
+	vec2 velocity = texelFetch(velocity_texture_sampler, render_coord, 0).xy;
+	if (velocity.x >= BACKGROUND_VELOCITY)
+	{
+		vec4 prev_clip_pos = temporal_upsample_pco.reprojection * vec4(f_tex_coord * 2.0 - 1.0, 1.0, 1.0);
+		velocity = f_tex_coord - (prev_clip_pos.xy / prev_clip_pos.w * 0.5 + 0.5);
+	}
+
+	// history which was out of screen is rejected, the rest is clamped to the neighborhood to reject disocclusions
+	vec2 history_uv = f_tex_coord - velocity;
+	if (all(greaterThanEqual(history_uv, vec2(0.0))) && all(lessThanEqual(history_uv, vec2(1.0))))
+	{
+		vec4 history_color = clamp(textureLod(history_texture_sampler, history_uv, 0.0), min_color, max_color);
+		o_color = mix(color, history_color, temporal_upsample_pco.history_weight);
+	}
+}
\ No newline at end of file
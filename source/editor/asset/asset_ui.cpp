@@ -348,6 +348,19 @@ namespace Bamboo
 					static bool combine_meshes = true;
 					ImGui::Checkbox("combine meshes", &combine_meshes);
 
+					static bool generate_lods = true;
+					ImGui::Checkbox("generate lods", &generate_lods);
+
+					static bool optimize_meshes = true;
+					ImGui::Checkbox("optimize meshes", &optimize_meshes);
+
+					static bool build_meshlets = false;
+					ImGui::Checkbox("build meshlets", &build_meshlets);
+
+					ImGui::SeparatorText("Animation");
+					static bool compress_animations = true;
+					ImGui::Checkbox("compress animations", &compress_animations);
+
 					ImGui::SeparatorText("Material");
 					static bool contains_occlusion_channel = true;
 					ImGui::Checkbox("contain occlusion channel", &contains_occlusion_channel);
@@ -359,7 +372,7 @@ namespace Bamboo
 						StopWatch stop_watch;
 						stop_watch.start();
 
-						as->importGltf(import_file, import_folder, { combine_meshes, force_static_mesh, contains_occlusion_channel });
+						as->importGltf(import_file, import_folder, { combine_meshes, force_static_mesh, generate_lods, optimize_meshes, build_meshlets, compress_animations, contains_occlusion_channel });
 						LOG_INFO("import gltf {} to {}, elapsed time: {}ms", import_file, import_folder, stop_watch.stopMs());
 						iter = m_imported_files.erase(iter);
 					}
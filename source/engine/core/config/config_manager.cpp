@@ -23,6 +23,21 @@ namespace Bamboo
 		return m_config_node["window"]["fullscreen"].as<bool>();
 	}
 
+	int ConfigManager::getFramesInFlight()
+	{
+		return m_config_node["render"]["frames_in_flight"].as<int>();
+	}
+
+	bool ConfigManager::isLowLatencyMode()
+	{
+		return m_config_node["render"]["low_latency_mode"].as<bool>();
+	}
+
+	int ConfigManager::getMemoryBudgetMB()
+	{
+		return m_config_node["render"]["memory_budget_mb"].as<int>();
+	}
+
 	std::string ConfigManager::getDefaultWorldUrl()
 	{
 		return m_config_node["default_world_url"].as<std::string>();
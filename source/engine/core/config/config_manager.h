@@ -15,6 +15,10 @@ namespace Bamboo
 		int getWindowHeight();
 		bool isFullscreen();
 
+		int getFramesInFlight();
+		bool isLowLatencyMode();
+		int getMemoryBudgetMB();
+
 		std::string getDefaultWorldUrl();
 		std::string getEditorLayout();
 		bool getSaveLayout();
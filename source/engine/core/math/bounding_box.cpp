@@ -59,4 +59,25 @@ namespace Bamboo
 		return (m_max - m_min) * 0.5f;
 	}
 
+	bool BoundingBox::isOutsideFrustum(const glm::mat4& view_proj) const
+	{
+		// bit per clip plane: left, right, bottom, top, near, far
+		uint32_t outside_planes = 0x3f;
+		for (uint32_t i = 0; i < 8; ++i)
+		{
+			glm::vec4 corner((i & 1) ? m_max.x : m_min.x, (i & 2) ? m_max.y : m_min.y, (i & 4) ? m_max.z : m_min.z, 1.0f);
+			glm::vec4 clip_pos = view_proj * corner;
+
+			uint32_t corner_outside_planes = 0;
+			corner_outside_planes |= clip_pos.x < -clip_pos.w ? 1 << 0 : 0;
+			corner_outside_planes |= clip_pos.x > clip_pos.w ? 1 << 1 : 0;
+			corner_outside_planes |= clip_pos.y < -clip_pos.w ? 1 << 2 : 0;
+			corner_outside_planes |= clip_pos.y > clip_pos.w ? 1 << 3 : 0;
+			corner_outside_planes |= clip_pos.z < 0.0f ? 1 << 4 : 0;
+			corner_outside_planes |= clip_pos.z > clip_pos.w ? 1 << 5 : 0;
+			outside_planes &= corner_outside_planes;
+		}
+		return outside_planes != 0;
+	}
+
 }
\ No newline at end of file
@@ -18,6 +18,9 @@ namespace Bamboo
 		glm::vec3 center() const;
 		glm::vec3 extent() const;
 
+		// conservative, true only if all corners are outside of the same clip plane of a [0, 1] depth view projection
+		bool isOutsideFrustum(const glm::mat4& view_proj) const;
+
 	private:
 		friend class cereal::access;
 		template<class Archive>
@@ -30,6 +30,19 @@ namespace Bamboo
 		return mapRangeValueUnclamped(val, from_min, from_max, to_min, to_max);
 	}
 
+	float MathUtil::halton(uint32_t index, uint32_t base)
+	{
+		float result = 0.0f;
+		float fraction = 1.0f;
+		while (index > 0)
+		{
+			fraction /= base;
+			result += fraction * (index % base);
+			index /= base;
+		}
+		return result;
+	}
+
 	bool MathUtil::randomBool()
 	{
 		return Random::get<bool>();
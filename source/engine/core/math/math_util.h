@@ -12,6 +12,9 @@ namespace Bamboo
 		static float mapRangeValueUnclamped(float val, float from_min, float from_max, float to_min, float to_max);
 		static float mapRangeValueClamped(float val, float from_min, float from_max, float to_min, float to_max);
 
+		// low discrepancy sequence in [0, 1), index starts from 1
+		static float halton(uint32_t index, uint32_t base);
+
 		static bool randomBool();
 		static int randomInteger(int min, int max);
 		static float randomFloat();
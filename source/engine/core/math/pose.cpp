@@ -0,0 +1,217 @@
+#include "pose.h"
+#include "simd.h"
+
+namespace Bamboo
+{
+
+	void Pose::resize(size_t bone_count)
+	{
+		m_bone_count = bone_count;
+		size_t padded_size = (bone_count + k_simd_max_width - 1) / k_simd_max_width * k_simd_max_width;
+		for (int c = 0; c < ComponentNum; ++c)
+		{
+			bool is_one = c == RotationW || c >= ScaleX;
+			m_components[c].resize(padded_size, is_one ? 1.0f : 0.0f);
+		}
+	}
+
+	void Pose::setTransform(size_t index, const QTransform& transform)
+	{
+		setTranslation(index, transform.m_position);
+		setRotation(index, transform.m_rotation);
+		setScale(index, transform.m_scale);
+	}
+
+	void Pose::setTranslation(size_t index, const glm::vec3& translation)
+	{
+		m_components[TranslationX][index] = translation.x;
+		m_components[TranslationY][index] = translation.y;
+		m_components[TranslationZ][index] = translation.z;
+	}
+
+	void Pose::setRotation(size_t index, const glm::quat& rotation)
+	{
+		m_components[RotationX][index] = rotation.x;
+		m_components[RotationY][index] = rotation.y;
+		m_components[RotationZ][index] = rotation.z;
+		m_components[RotationW][index] = rotation.w;
+	}
+
+	void Pose::setScale(size_t index, const glm::vec3& scale)
+	{
+		m_components[ScaleX][index] = scale.x;
+		m_components[ScaleY][index] = scale.y;
+		m_components[ScaleZ][index] = scale.z;
+	}
+
+	QTransform Pose::getTransform(size_t index) const
+	{
+		QTransform transform;
+		transform.m_position = glm::vec3(m_components[TranslationX][index], m_components[TranslationY][index], m_components[TranslationZ][index]);
+		transform.m_rotation = glm::quat(m_components[RotationW][index],
+			m_components[RotationX][index], m_components[RotationY][index], m_components[RotationZ][index]);
+		transform.m_scale = glm::vec3(m_components[ScaleX][index], m_components[ScaleY][index], m_components[ScaleZ][index]);
+		return transform;
+	}
+
+	// interpolates a block of simd width bones, all inputs are loaded before storing so out can alias a or b
+	static void interpolateBlock(std::array<float*, Pose::ComponentNum>& out,
+		const std::array<const float*, Pose::ComponentNum>& a, const std::array<const float*, Pose::ComponentNum>& b,
+		size_t i, SimdFloat translation_t, SimdFloat rotation_t, SimdFloat scale_t)
+	{
+		for (int c = Pose::TranslationX; c <= Pose::TranslationZ; ++c)
+		{
+			simdStore(out[c] + i, simdLerp(simdLoad(a[c] + i), simdLoad(b[c] + i), translation_t));
+		}
+
+		// flip b onto the hemisphere of a, so rotations take the shortest arc
+		SimdFloat ar[4], br[4];
+		SimdFloat dot = simdSet(0.0f);
+		for (int c = 0; c < 4; ++c)
+		{
+			ar[c] = simdLoad(a[Pose::RotationX + c] + i);
+			br[c] = simdLoad(b[Pose::RotationX + c] + i);
+			dot = dot + ar[c] * br[c];
+		}
+		SimdFloat sign = simdSign(dot);
+
+		SimdFloat r[4];
+		SimdFloat length2 = simdSet(0.0f);
+		for (int c = 0; c < 4; ++c)
+		{
+			r[c] = simdLerp(ar[c], br[c] * sign, rotation_t);
+			length2 = length2 + r[c] * r[c];
+		}
+		SimdFloat inv_length = simdInvSqrt(length2);
+		for (int c = 0; c < 4; ++c)
+		{
+			simdStore(out[Pose::RotationX + c] + i, r[c] * inv_length);
+		}
+
+		for (int c = Pose::ScaleX; c <= Pose::ScaleZ; ++c)
+		{
+			simdStore(out[c] + i, simdLerp(simdLoad(a[c] + i), simdLoad(b[c] + i), scale_t));
+		}
+	}
+
+	// hamilton product of quaternions in x, y, z, w order
+	static void quatMul(const SimdFloat a[4], const SimdFloat b[4], SimdFloat out[4])
+	{
+		out[0] = a[3] * b[0] + a[0] * b[3] + a[1] * b[2] - a[2] * b[1];
+		out[1] = a[3] * b[1] - a[0] * b[2] + a[1] * b[3] + a[2] * b[0];
+		out[2] = a[3] * b[2] + a[0] * b[1] - a[1] * b[0] + a[2] * b[3];
+		out[3] = a[3] * b[3] - a[0] * b[0] - a[1] * b[1] - a[2] * b[2];
+	}
+
+	static void getComponents(Pose& pose, std::array<float*, Pose::ComponentNum>& components)
+	{
+		for (int c = 0; c < Pose::ComponentNum; ++c)
+		{
+			components[c] = pose.component(static_cast<Pose::EComponent>(c));
+		}
+	}
+
+	static void getComponents(const Pose& pose, std::array<const float*, Pose::ComponentNum>& components)
+	{
+		for (int c = 0; c < Pose::ComponentNum; ++c)
+		{
+			components[c] = pose.component(static_cast<Pose::EComponent>(c));
+		}
+	}
+
+	void Pose::interpolate(Pose& out, const Pose& a, const Pose& b,
+		const float* translation_ts, const float* rotation_ts, const float* scale_ts)
+	{
+		out.resize(a.size());
+		std::array<float*, ComponentNum> out_components;
+		std::array<const float*, ComponentNum> a_components, b_components;
+		getComponents(out, out_components);
+		getComponents(a, a_components);
+		getComponents(b, b_components);
+
+		for (size_t i = 0; i < out.paddedSize(); i += SimdFloat::k_width)
+		{
+			interpolateBlock(out_components, a_components, b_components, i,
+				simdLoad(translation_ts + i), simdLoad(rotation_ts + i), simdLoad(scale_ts + i));
+		}
+	}
+
+	void Pose::blend(Pose& out, const Pose& a, const Pose& b, float weight)
+	{
+		out.resize(a.size());
+		std::array<float*, ComponentNum> out_components;
+		std::array<const float*, ComponentNum> a_components, b_components;
+		getComponents(out, out_components);
+		getComponents(a, a_components);
+		getComponents(b, b_components);
+
+		SimdFloat t = simdSet(weight);
+		for (size_t i = 0; i < out.paddedSize(); i += SimdFloat::k_width)
+		{
+			interpolateBlock(out_components, a_components, b_components, i, t, t, t);
+		}
+	}
+
+	void Pose::addAdditive(Pose& out, const Pose& base, const Pose& additive, const Pose& reference, float weight)
+	{
+		out.resize(base.size());
+		std::array<float*, ComponentNum> out_components;
+		std::array<const float*, ComponentNum> base_components, additive_components, reference_components;
+		getComponents(out, out_components);
+		getComponents(base, base_components);
+		getComponents(additive, additive_components);
+		getComponents(reference, reference_components);
+
+		SimdFloat w = simdSet(weight);
+		for (size_t i = 0; i < out.paddedSize(); i += SimdFloat::k_width)
+		{
+			// all inputs are loaded before storing so out can alias base
+			SimdFloat base_rotation[4], additive_rotation[4], inv_reference_rotation[4];
+			for (int c = 0; c < 4; ++c)
+			{
+				base_rotation[c] = simdLoad(base_components[RotationX + c] + i);
+				additive_rotation[c] = simdLoad(additive_components[RotationX + c] + i);
+				inv_reference_rotation[c] = simdLoad(reference_components[RotationX + c] + i);
+			}
+			for (int c = 0; c < 3; ++c)
+			{
+				inv_reference_rotation[c] = simdSet(0.0f) - inv_reference_rotation[c];
+			}
+
+			for (int c = TranslationX; c <= TranslationZ; ++c)
+			{
+				simdStore(out_components[c] + i, simdLoad(base_components[c] + i) +
+					(simdLoad(additive_components[c] + i) - simdLoad(reference_components[c] + i)) * w);
+			}
+			for (int c = ScaleX; c <= ScaleZ; ++c)
+			{
+				simdStore(out_components[c] + i, simdLoad(base_components[c] + i) +
+					(simdLoad(additive_components[c] + i) - simdLoad(reference_components[c] + i)) * w);
+			}
+
+			// delta rotation, normalized lerp from identity by weight on the hemisphere of identity
+			SimdFloat delta[4];
+			quatMul(additive_rotation, inv_reference_rotation, delta);
+			SimdFloat sign = simdSign(delta[3]);
+			SimdFloat length2 = simdSet(0.0f);
+			for (int c = 0; c < 4; ++c)
+			{
+				delta[c] = simdLerp(simdSet(c == 3 ? 1.0f : 0.0f), delta[c] * sign, w);
+				length2 = length2 + delta[c] * delta[c];
+			}
+			SimdFloat inv_length = simdInvSqrt(length2);
+			for (int c = 0; c < 4; ++c)
+			{
+				delta[c] = delta[c] * inv_length;
+			}
+
+			SimdFloat rotation[4];
+			quatMul(delta, base_rotation, rotation);
+			for (int c = 0; c < 4; ++c)
+			{
+				simdStore(out_components[RotationX + c] + i, rotation[c]);
+			}
+		}
+	}
+
+}
\ No newline at end of file
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "transform.h"
+
+#include <array>
+#include <vector>
+
+namespace Bamboo
+{
+	// local transforms of a skeleton's bones as structure of arrays: every component of translations,
+	// rotations and scales is a separate float array, padded so that simd kernels need no tail loops
+	class Pose
+	{
+	public:
+		enum EComponent
+		{
+			TranslationX, TranslationY, TranslationZ,
+			RotationX, RotationY, RotationZ, RotationW,
+			ScaleX, ScaleY, ScaleZ,
+			ComponentNum
+		};
+
+		// padding bones hold identity transforms, per bone arrays passed to kernels must have the padded size
+		void resize(size_t bone_count);
+		size_t size() const { return m_bone_count; }
+		size_t paddedSize() const { return m_components[0].size(); }
+
+		float* component(EComponent c) { return m_components[c].data(); }
+		const float* component(EComponent c) const { return m_components[c].data(); }
+
+		void setTransform(size_t index, const QTransform& transform);
+		void setTranslation(size_t index, const glm::vec3& translation);
+		void setRotation(size_t index, const glm::quat& rotation);
+		void setScale(size_t index, const glm::vec3& scale);
+		QTransform getTransform(size_t index) const;
+
+		// per bone linear interpolation of translations and scales, and normalized lerp of rotations along the shortest arc,
+		// with separate interpolation factors of each bone's translation, rotation and scale
+		static void interpolate(Pose& out, const Pose& a, const Pose& b,
+			const float* translation_ts, const float* rotation_ts, const float* scale_ts);
+
+		// crossfade from a to b by weight
+		static void blend(Pose& out, const Pose& a, const Pose& b, float weight);
+
+		// apply the difference of additive from reference onto base by weight: translations and scales add their weighted differences,
+		// rotations are premultiplied by the delta rotation scaled along the shortest arc
+		static void addAdditive(Pose& out, const Pose& base, const Pose& additive, const Pose& reference, float weight);
+
+	private:
+		size_t m_bone_count = 0;
+		std::array<std::vector<float>, ComponentNum> m_components;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,157 @@
+#pragma once
+
+#include <cstddef>
+#include <cmath>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#define BAMBOO_SIMD_AVX
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define BAMBOO_SIMD_SSE
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+#include <arm_neon.h>
+#define BAMBOO_SIMD_NEON
+#endif
+
+namespace Bamboo
+{
+	// the widest float vector the target is compiled for: avx, sse or neon, otherwise a scalar fallback,
+	// kernels written with it process SimdFloat::k_width floats per instruction
+	struct SimdFloat
+	{
+#if defined(BAMBOO_SIMD_AVX)
+		static constexpr size_t k_width = 8;
+		__m256 v;
+#elif defined(BAMBOO_SIMD_SSE)
+		static constexpr size_t k_width = 4;
+		__m128 v;
+#elif defined(BAMBOO_SIMD_NEON)
+		static constexpr size_t k_width = 4;
+		float32x4_t v;
+#else
+		static constexpr size_t k_width = 1;
+		float v;
+#endif
+	};
+
+	// arrays processed by simd kernels are padded to a multiple of the widest vector of all targets
+	const size_t k_simd_max_width = 8;
+
+	inline SimdFloat simdLoad(const float* p)
+	{
+#if defined(BAMBOO_SIMD_AVX)
+		return { _mm256_loadu_ps(p) };
+#elif defined(BAMBOO_SIMD_SSE)
+		return { _mm_loadu_ps(p) };
+#elif defined(BAMBOO_SIMD_NEON)
+		return { vld1q_f32(p) };
+#else
+		return { *p };
+#endif
+	}
+
+	inline void simdStore(float* p, SimdFloat a)
+	{
+#if defined(BAMBOO_SIMD_AVX)
+		_mm256_storeu_ps(p, a.v);
+#elif defined(BAMBOO_SIMD_SSE)
+		_mm_storeu_ps(p, a.v);
+#elif defined(BAMBOO_SIMD_NEON)
+		vst1q_f32(p, a.v);
+#else
+		*p = a.v;
+#endif
+	}
+
+	inline SimdFloat simdSet(float f)
+	{
+#if defined(BAMBOO_SIMD_AVX)
+		return { _mm256_set1_ps(f) };
+#elif defined(BAMBOO_SIMD_SSE)
+		return { _mm_set1_ps(f) };
+#elif defined(BAMBOO_SIMD_NEON)
+		return { vdupq_n_f32(f) };
+#else
+		return { f };
+#endif
+	}
+
+	inline SimdFloat operator+(SimdFloat a, SimdFloat b)
+	{
+#if defined(BAMBOO_SIMD_AVX)
+		return { _mm256_add_ps(a.v, b.v) };
+#elif defined(BAMBOO_SIMD_SSE)
+		return { _mm_add_ps(a.v, b.v) };
+#elif defined(BAMBOO_SIMD_NEON)
+		return { vaddq_f32(a.v, b.v) };
+#else
+		return { a.v + b.v };
+#endif
+	}
+
+	inline SimdFloat operator-(SimdFloat a, SimdFloat b)
+	{
+#if defined(BAMBOO_SIMD_AVX)
+		return { _mm256_sub_ps(a.v, b.v) };
+#elif defined(BAMBOO_SIMD_SSE)
+		return { _mm_sub_ps(a.v, b.v) };
+#elif defined(BAMBOO_SIMD_NEON)
+		return { vsubq_f32(a.v, b.v) };
+#else
+		return { a.v - b.v };
+#endif
+	}
+
+	inline SimdFloat operator*(SimdFloat a, SimdFloat b)
+	{
+#if defined(BAMBOO_SIMD_AVX)
+		return { _mm256_mul_ps(a.v, b.v) };
+#elif defined(BAMBOO_SIMD_SSE)
+		return { _mm_mul_ps(a.v, b.v) };
+#elif defined(BAMBOO_SIMD_NEON)
+		return { vmulq_f32(a.v, b.v) };
+#else
+		return { a.v * b.v };
+#endif
+	}
+
+	// a + (b - a) * t
+	inline SimdFloat simdLerp(SimdFloat a, SimdFloat b, SimdFloat t)
+	{
+		return a + (b - a) * t;
+	}
+
+	// 1 or -1 by the sign bit of a
+	inline SimdFloat simdSign(SimdFloat a)
+	{
+#if defined(BAMBOO_SIMD_AVX)
+		return { _mm256_or_ps(_mm256_and_ps(a.v, _mm256_set1_ps(-0.0f)), _mm256_set1_ps(1.0f)) };
+#elif defined(BAMBOO_SIMD_SSE)
+		return { _mm_or_ps(_mm_and_ps(a.v, _mm_set1_ps(-0.0f)), _mm_set1_ps(1.0f)) };
+#elif defined(BAMBOO_SIMD_NEON)
+		uint32x4_t sign_bits = vandq_u32(vreinterpretq_u32_f32(a.v), vdupq_n_u32(0x80000000u));
+		return { vreinterpretq_f32_u32(vorrq_u32(sign_bits, vreinterpretq_u32_f32(vdupq_n_f32(1.0f)))) };
+#else
+		return { a.v < 0.0f ? -1.0f : 1.0f };
+#endif
+	}
+
+	// 1 / sqrt(a), a must be positive
+	inline SimdFloat simdInvSqrt(SimdFloat a)
+	{
+#if defined(BAMBOO_SIMD_AVX)
+		return { _mm256_div_ps(_mm256_set1_ps(1.0f), _mm256_sqrt_ps(a.v)) };
+#elif defined(BAMBOO_SIMD_SSE)
+		return { _mm_div_ps(_mm_set1_ps(1.0f), _mm_sqrt_ps(a.v)) };
+#elif defined(BAMBOO_SIMD_NEON)
+		// estimate refined by two newton raphson steps
+		float32x4_t e = vrsqrteq_f32(a.v);
+		e = vmulq_f32(e, vrsqrtsq_f32(vmulq_f32(a.v, e), e));
+		e = vmulq_f32(e, vrsqrtsq_f32(vmulq_f32(a.v, e), e));
+		return { e };
+#else
+		return { 1.0f / std::sqrt(a.v) };
+#endif
+	}
+}
\ No newline at end of file
@@ -0,0 +1,186 @@
+#include "descriptor_set_cache.h"
+#include "vulkan_rhi.h"
+
+#include <algorithm>
+
+namespace Bamboo
+{
+
+	void DescriptorSetCache::init(const std::vector<VkDescriptorPoolSize>& pool_sizes, uint32_t max_sets)
+	{
+		VkDescriptorPoolCreateInfo pool_ci{};
+		pool_ci.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+		pool_ci.flags = VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT;
+		pool_ci.maxSets = max_sets;
+		pool_ci.poolSizeCount = static_cast<uint32_t>(pool_sizes.size());
+		pool_ci.pPoolSizes = pool_sizes.data();
+
+		VkResult result = vkCreateDescriptorPool(VulkanRHI::get().getDevice(), &pool_ci, nullptr, &m_descriptor_pool);
+		CHECK_VULKAN_RESULT(result, "create descriptor set cache pool");
+
+		m_max_sets = max_sets;
+		m_allocated_set_count = 0;
+		m_released_handle_index = VulkanRHI::get().getReleasedDescriptorHandleEnd();
+	}
+
+	void DescriptorSetCache::destroy()
+	{
+		if (m_descriptor_pool)
+		{
+			vkDestroyDescriptorPool(VulkanRHI::get().getDevice(), m_descriptor_pool, nullptr);
+			m_descriptor_pool = VK_NULL_HANDLE;
+		}
+		m_desc_sets.clear();
+		m_retired_desc_sets.clear();
+		m_allocated_set_count = 0;
+	}
+
+	VkDescriptorSet DescriptorSetCache::getDescriptorSet(VkDescriptorSetLayout desc_set_layout, const std::vector<VkWriteDescriptorSet>& desc_writes)
+	{
+		releaseDestroyedHandles();
+
+		uint64_t frame_index = VulkanRHI::get().getFrameIndex();
+		buildKey(desc_set_layout, desc_writes);
+		auto iter = m_desc_sets.find(m_key);
+		if (iter != m_desc_sets.end())
+		{
+			iter->second.last_used_frame = frame_index;
+			return iter->second.desc_set;
+		}
+
+		// allocate and update a new descriptor set
+		tick();
+		ASSERT(m_allocated_set_count < m_max_sets, "descriptor set cache is full");
+
+		VkDescriptorSetAllocateInfo desc_set_ai{};
+		desc_set_ai.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+		desc_set_ai.descriptorPool = m_descriptor_pool;
+		desc_set_ai.descriptorSetCount = 1;
+		desc_set_ai.pSetLayouts = &desc_set_layout;
+
+		VkDescriptorSet desc_set;
+		VkResult result = vkAllocateDescriptorSets(VulkanRHI::get().getDevice(), &desc_set_ai, &desc_set);
+		CHECK_VULKAN_RESULT(result, "allocate cached descriptor set");
+		m_allocated_set_count++;
+
+		std::vector<VkWriteDescriptorSet> set_desc_writes = desc_writes;
+		for (VkWriteDescriptorSet& desc_write : set_desc_writes)
+		{
+			desc_write.dstSet = desc_set;
+		}
+		vkUpdateDescriptorSets(VulkanRHI::get().getDevice(), static_cast<uint32_t>(set_desc_writes.size()), set_desc_writes.data(), 0, nullptr);
+
+		m_desc_sets[m_key] = { desc_set, frame_index };
+		return desc_set;
+	}
+
+	void DescriptorSetCache::tick()
+	{
+		uint64_t frame_index = VulkanRHI::get().getFrameIndex();
+		uint64_t flight_count = VulkanRHI::get().getFlightCount();
+
+		// retire sets which haven't been used recently
+		for (auto iter = m_desc_sets.begin(); iter != m_desc_sets.end();)
+		{
+			if (iter->second.last_used_frame + flight_count < frame_index)
+			{
+				m_retired_desc_sets.push_back({ iter->second.last_used_frame, iter->second.desc_set });
+				iter = m_desc_sets.erase(iter);
+			}
+			else
+			{
+				++iter;
+			}
+		}
+
+		// free retired sets once no frame in flight references them
+		for (auto iter = m_retired_desc_sets.begin(); iter != m_retired_desc_sets.end();)
+		{
+			if (iter->first + flight_count < frame_index)
+			{
+				vkFreeDescriptorSets(VulkanRHI::get().getDevice(), m_descriptor_pool, 1, &iter->second);
+				m_allocated_set_count--;
+				iter = m_retired_desc_sets.erase(iter);
+			}
+			else
+			{
+				++iter;
+			}
+		}
+	}
+
+	void DescriptorSetCache::clear()
+	{
+		for (const auto& iter : m_desc_sets)
+		{
+			m_retired_desc_sets.push_back({ iter.second.last_used_frame, iter.second.desc_set });
+		}
+		m_desc_sets.clear();
+	}
+
+	void DescriptorSetCache::releaseDestroyedHandles()
+	{
+		VulkanRHI& vulkan_rhi = VulkanRHI::get();
+		uint64_t released_handle_end = vulkan_rhi.getReleasedDescriptorHandleEnd();
+		if (m_released_handle_index < vulkan_rhi.getReleasedDescriptorHandleBegin())
+		{
+			// the handles destroyed since the last call were trimmed already
+			clear();
+		}
+		else
+		{
+			for (uint64_t i = m_released_handle_index; i < released_handle_end; ++i)
+			{
+				uint64_t handle = vulkan_rhi.getReleasedDescriptorHandle(i);
+				for (auto iter = m_desc_sets.begin(); iter != m_desc_sets.end();)
+				{
+					if (std::find(iter->first.begin(), iter->first.end(), handle) != iter->first.end())
+					{
+						m_retired_desc_sets.push_back({ iter->second.last_used_frame, iter->second.desc_set });
+						iter = m_desc_sets.erase(iter);
+					}
+					else
+					{
+						++iter;
+					}
+				}
+			}
+		}
+		m_released_handle_index = released_handle_end;
+	}
+
+	void DescriptorSetCache::buildKey(VkDescriptorSetLayout desc_set_layout, const std::vector<VkWriteDescriptorSet>& desc_writes)
+	{
+		// the key vector is reused between lookups, so hits don't allocate
+		m_key.clear();
+		auto combine = [this](uint64_t value)
+		{
+			m_key.push_back(value);
+		};
+
+		combine((uint64_t)desc_set_layout);
+		for (const VkWriteDescriptorSet& desc_write : desc_writes)
+		{
+			combine(desc_write.dstBinding);
+			combine(desc_write.dstArrayElement);
+			combine(desc_write.descriptorType);
+			combine(desc_write.descriptorCount);
+			for (uint32_t i = 0; i < desc_write.descriptorCount; ++i)
+			{
+				if (desc_write.pImageInfo)
+				{
+					combine((uint64_t)desc_write.pImageInfo[i].sampler);
+					combine((uint64_t)desc_write.pImageInfo[i].imageView);
+					combine(desc_write.pImageInfo[i].imageLayout);
+				}
+				if (desc_write.pBufferInfo)
+				{
+					combine((uint64_t)desc_write.pBufferInfo[i].buffer);
+					combine(desc_write.pBufferInfo[i].offset);
+					combine(desc_write.pBufferInfo[i].range);
+				}
+			}
+		}
+	}
+
+}
\ No newline at end of file
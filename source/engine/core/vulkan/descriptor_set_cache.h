@@ -0,0 +1,52 @@
+#pragma once
+
+#include "vulkan_util.h"
+
+#include <vector>
+#include <map>
+
+namespace Bamboo
+{
+	// descriptor sets cached by their binding contents, for bindings which rarely change between frames,
+	// the layouts used with this cache must not be push descriptor layouts
+	class DescriptorSetCache
+	{
+	public:
+		void init(const std::vector<VkDescriptorPoolSize>& pool_sizes, uint32_t max_sets);
+		void destroy();
+
+		// get the descriptor set matching the writes, allocate and update it on cache miss
+		VkDescriptorSet getDescriptorSet(VkDescriptorSetLayout desc_set_layout, const std::vector<VkWriteDescriptorSet>& desc_writes);
+
+		// release sets which aren't used by any frame in flight, should be called once per frame
+		void tick();
+
+		// drop all cached sets, e.g. after the attachments they reference are recreated
+		void clear();
+
+	private:
+		struct CachedDescriptorSet
+		{
+			VkDescriptorSet desc_set;
+			uint64_t last_used_frame;
+		};
+
+		// flatten the layout and every written descriptor into m_key
+		void buildKey(VkDescriptorSetLayout desc_set_layout, const std::vector<VkWriteDescriptorSet>& desc_writes);
+
+		// retire the sets referencing resources destroyed since the last call, their handles may be reused
+		void releaseDestroyedHandles();
+
+		VkDescriptorPool m_descriptor_pool = VK_NULL_HANDLE;
+		uint32_t m_max_sets = 0;
+		uint32_t m_allocated_set_count = 0;
+		uint64_t m_released_handle_index = 0;
+
+		// keyed by the full binding contents rather than a hash of them, so that colliding writes can't share a set
+		std::map<std::vector<uint64_t>, CachedDescriptorSet> m_desc_sets;
+		std::vector<uint64_t> m_key;
+
+		// sets waiting for frames in flight to complete before being freed
+		std::vector<std::pair<uint64_t, VkDescriptorSet>> m_retired_desc_sets;
+	};
+}
\ No newline at end of file
@@ -1,5 +1,6 @@
 #include "vulkan_rhi.h"
 #include "engine/core/event/event_system.h"
+#include "engine/core/config/config_manager.h"
 #include "engine/function/render/window_system.h"
 
 #include <array>
@@ -11,6 +12,14 @@ namespace Bamboo
 {
 	void VulkanRHI::init()
 	{
+		// frames in flight: 1 for lowest latency, 3 for highest throughput
+		m_flight_count = static_cast<uint32_t>(std::clamp(g_engine.configManager()->getFramesInFlight(), 1, MAX_FRAMES_IN_FLIGHT));
+		m_low_latency_mode = g_engine.configManager()->isLowLatencyMode();
+
+		// memory budget: 0 means using the budget reported by driver
+		m_memory_budget_limit = static_cast<VkDeviceSize>(std::max(g_engine.configManager()->getMemoryBudgetMB(), 0)) * 1024 * 1024;
+		m_memory_usages.fill(0);
+
 		createInstance();
 #if ENABLE_VALIDATION_LAYER
 		createDebugging();
@@ -28,11 +37,17 @@ namespace Bamboo
 		createCommandPools();
 		createCommandBuffers();
 		createSynchronizationPrimitives();
+		createTimestampQueryPool();
 	}
 
 	void VulkanRHI::render()
 	{
 		waitFrame();
+		if (!acquireFrame())
+		{
+			// the frame is skipped, this flight stays waited and acquires again next frame
+			return;
+		}
 		recordFrame();
 		submitFrame();
 		presentFrame();
@@ -48,14 +63,21 @@ namespace Bamboo
 		{
 			vkDestroySemaphore(m_device, render_finished_semaphore, nullptr);
 		}
-		for (VkFence flight_fence : m_flight_fences)
+		for (VkSemaphore compute_finished_semaphore : m_compute_finished_semaphores)
+		{
+			vkDestroySemaphore(m_device, compute_finished_semaphore, nullptr);
+		}
+		vkDestroySemaphore(m_device, m_timeline_semaphore, nullptr);
+		if (m_timestamp_query_pool != VK_NULL_HANDLE)
 		{
-			vkDestroyFence(m_device, flight_fence, nullptr);
+			vkDestroyQueryPool(m_device, m_timestamp_query_pool, nullptr);
 		}
 
 		destroySwapchainObjects();
 		vkDestroyCommandPool(m_device, m_instant_command_pool, nullptr);
 		vkDestroyCommandPool(m_device, m_command_pool, nullptr);
+		vkDestroyCommandPool(m_device, m_instant_compute_command_pool, nullptr);
+		vkDestroyCommandPool(m_device, m_compute_command_pool, nullptr);
 
 		vkDestroySwapchainKHR(m_device, m_swapchain, nullptr);
 
@@ -178,6 +200,18 @@ namespace Bamboo
 		vkGetPhysicalDeviceFeatures(m_physical_device, &m_physical_device_features);
 		ASSERT(m_physical_device_features.textureCompressionBC, "doesn't support bc block texture compression");
 		ASSERT(isFormatSupported(VK_FORMAT_BC7_UNORM_BLOCK) && isFormatSupported(VK_FORMAT_BC7_SRGB_BLOCK), "doesn't support bc block formats");
+
+		m_physical_device_vulkan13_features = {};
+		m_physical_device_vulkan13_features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES;
+		m_physical_device_vulkan12_features = {};
+		m_physical_device_vulkan12_features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+		m_physical_device_vulkan12_features.pNext = &m_physical_device_vulkan13_features;
+		VkPhysicalDeviceFeatures2 physical_device_features2{};
+		physical_device_features2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+		physical_device_features2.pNext = &m_physical_device_vulkan12_features;
+		vkGetPhysicalDeviceFeatures2(m_physical_device, &physical_device_features2);
+		ASSERT(m_physical_device_vulkan12_features.timelineSemaphore, "doesn't support timeline semaphore");
+		ASSERT(m_physical_device_vulkan13_features.dynamicRendering, "doesn't support dynamic rendering");
 	}
 
 	void VulkanRHI::createLogicDevice()
@@ -189,6 +223,7 @@ namespace Bamboo
 
 		VkDeviceCreateInfo device_ci{};
 		device_ci.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+		device_ci.pNext = &m_required_device_vulkan12_features;
 		device_ci.queueCreateInfoCount = static_cast<uint32_t>(queue_cis.size());
 		device_ci.pQueueCreateInfos = queue_cis.data();
 		device_ci.pEnabledFeatures = &m_required_device_features;
@@ -208,6 +243,8 @@ namespace Bamboo
 	{
 		vkGetDeviceQueue(m_device, m_queue_family_indices.graphics, 0, &m_graphics_queue);
 		vkGetDeviceQueue(m_device, m_queue_family_indices.transfer, 0, &m_transfer_queue);
+		vkGetDeviceQueue(m_device, m_queue_family_indices.compute, 0, &m_compute_queue);
+		LOG_INFO("async compute: {}", isAsyncCompute() ? "dedicated compute queue family" : "shared with graphics queue family");
 	}
 
 	void VulkanRHI::createVmaAllocator()
@@ -218,6 +255,10 @@ namespace Bamboo
 		vma_alloc_ci.physicalDevice = m_physical_device;
 		vma_alloc_ci.device = m_device;
 		vma_alloc_ci.flags |= VMA_ALLOCATOR_CREATE_KHR_DEDICATED_ALLOCATION_BIT;
+		if (m_is_memory_budget_supported)
+		{
+			vma_alloc_ci.flags |= VMA_ALLOCATOR_CREATE_EXT_MEMORY_BUDGET_BIT;
+		}
 
 		VkResult result = vmaCreateAllocator(&vma_alloc_ci, &m_allocator);
 		CHECK_VULKAN_RESULT(result, "create vma allocator");
@@ -326,11 +367,19 @@ namespace Bamboo
 
 		command_pool_ci.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
 		vkCreateCommandPool(m_device, &command_pool_ci, nullptr, &m_instant_command_pool);
+
+		// compute command pools
+		command_pool_ci.queueFamilyIndex = m_queue_family_indices.compute;
+		command_pool_ci.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+		vkCreateCommandPool(m_device, &command_pool_ci, nullptr, &m_compute_command_pool);
+
+		command_pool_ci.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+		vkCreateCommandPool(m_device, &command_pool_ci, nullptr, &m_instant_compute_command_pool);
 	}
 
 	void VulkanRHI::createCommandBuffers()
 	{
-		m_command_buffers.resize(MAX_FRAMES_IN_FLIGHT);
+		m_command_buffers.resize(m_flight_count);
 
 		VkCommandBufferAllocateInfo command_buffer_ai{};
 		command_buffer_ai.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
@@ -338,52 +387,109 @@ namespace Bamboo
 		command_buffer_ai.commandPool = m_command_pool;
 		command_buffer_ai.commandBufferCount = static_cast<uint32_t>(m_command_buffers.size());
 
-		for (int i = 0; i < MAX_FRAMES_IN_FLIGHT; ++i)
-		{
-			VkCommandBuffer command_buffer;
-			vkAllocateCommandBuffers(m_device, &command_buffer_ai, m_command_buffers.data());
-		}
+		vkAllocateCommandBuffers(m_device, &command_buffer_ai, m_command_buffers.data());
+
+		m_compute_command_buffers.resize(m_flight_count);
+		command_buffer_ai.commandPool = m_compute_command_pool;
+		command_buffer_ai.commandBufferCount = static_cast<uint32_t>(m_compute_command_buffers.size());
+		vkAllocateCommandBuffers(m_device, &command_buffer_ai, m_compute_command_buffers.data());
 	}
 
 	void VulkanRHI::createSynchronizationPrimitives()
 	{
 		m_flight_index = 0;
+		m_frame_index = 0;
+		m_is_frame_waited = false;
+		m_is_compute_recorded = false;
 
-		// semaphore: GPU-GPU
-		m_image_avaliable_semaphores.resize(MAX_FRAMES_IN_FLIGHT);
-		m_render_finished_semaphores.resize(MAX_FRAMES_IN_FLIGHT);
-
-		// fence: CPU-GPU
-		m_flight_fences.resize(MAX_FRAMES_IN_FLIGHT);
+		// binary semaphore: GPU-GPU
+		m_image_avaliable_semaphores.resize(m_flight_count);
+		m_render_finished_semaphores.resize(m_flight_count);
+		m_compute_finished_semaphores.resize(m_flight_count);
 
 		VkSemaphoreCreateInfo semaphore_ci{};
 		semaphore_ci.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
 
-		VkFenceCreateInfo fence_ci{};
-		fence_ci.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
-		fence_ci.flags = VK_FENCE_CREATE_SIGNALED_BIT;
-
-		for (uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; ++i)
+		for (uint32_t i = 0; i < m_flight_count; ++i)
 		{
 			vkCreateSemaphore(m_device, &semaphore_ci, nullptr, &m_image_avaliable_semaphores[i]);
 			vkCreateSemaphore(m_device, &semaphore_ci, nullptr, &m_render_finished_semaphores[i]);
-			vkCreateFence(m_device, &fence_ci, nullptr, &m_flight_fences[i]);
+			vkCreateSemaphore(m_device, &semaphore_ci, nullptr, &m_compute_finished_semaphores[i]);
 		}
+
+		// timeline semaphore: CPU-GPU
+		m_flight_timeline_values.assign(m_flight_count, 0);
+
+		VkSemaphoreTypeCreateInfo semaphore_type_ci{};
+		semaphore_type_ci.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+		semaphore_type_ci.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+		semaphore_type_ci.initialValue = 0;
+		semaphore_ci.pNext = &semaphore_type_ci;
+
+		VkResult result = vkCreateSemaphore(m_device, &semaphore_ci, nullptr, &m_timeline_semaphore);
+		CHECK_VULKAN_RESULT(result, "create timeline semaphore");
+	}
+
+	void VulkanRHI::createTimestampQueryPool()
+	{
+		m_timestamp_valids.assign(m_flight_count, false);
+		if (m_queue_family_propertiess[m_queue_family_indices.graphics].timestampValidBits == 0 ||
+			m_physical_device_properties.limits.timestampPeriod <= 0.0f)
+		{
+			LOG_WARNING("timestamp queries aren't supported by graphics queue, gpu frame time is unavailable");
+			return;
+		}
+
+		// a begin and an end timestamp of each flight
+		VkQueryPoolCreateInfo query_pool_ci{};
+		query_pool_ci.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+		query_pool_ci.queryType = VK_QUERY_TYPE_TIMESTAMP;
+		query_pool_ci.queryCount = m_flight_count * 2;
+		VkResult result = vkCreateQueryPool(m_device, &query_pool_ci, nullptr, &m_timestamp_query_pool);
+		CHECK_VULKAN_RESULT(result, "create timestamp query pool");
 	}
 
 	void VulkanRHI::waitFrame()
 	{
-		// wait sumbitted command buffer finished
-		vkWaitForFences(m_device, 1, &m_flight_fences[m_flight_index], VK_TRUE, UINT64_MAX);
+		if (m_is_frame_waited)
+		{
+			return;
+		}
 
-		// get free swapchain image
+		// wait the last command buffer submitted by this flight finished
+		VkSemaphoreWaitInfo semaphore_wi{};
+		semaphore_wi.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+		semaphore_wi.semaphoreCount = 1;
+		semaphore_wi.pSemaphores = &m_timeline_semaphore;
+		semaphore_wi.pValues = &m_flight_timeline_values[m_flight_index];
+		vkWaitSemaphores(m_device, &semaphore_wi, UINT64_MAX);
+		m_is_frame_waited = true;
+
+		// the flight's timestamps are available once its submission finished
+		if (m_timestamp_valids[m_flight_index])
+		{
+			std::array<uint64_t, 2> timestamps;
+			VkResult result = vkGetQueryPoolResults(m_device, m_timestamp_query_pool, m_flight_index * 2, 2,
+				sizeof(timestamps), timestamps.data(), sizeof(uint64_t), VK_QUERY_RESULT_64_BIT);
+			if (result == VK_SUCCESS && timestamps[1] >= timestamps[0])
+			{
+				m_gpu_frame_time = (timestamps[1] - timestamps[0]) * m_physical_device_properties.limits.timestampPeriod * 1e-6f;
+			}
+			m_timestamp_valids[m_flight_index] = false;
+		}
+	}
+
+	bool VulkanRHI::acquireFrame()
+	{
+		// get free swapchain image, the image available semaphore isn't signaled if the swapchain is out of date
 		VkResult result = vkAcquireNextImageKHR(m_device, m_swapchain, UINT64_MAX, m_image_avaliable_semaphores[m_flight_index], VK_NULL_HANDLE, &m_image_index);
 		if (result == VK_ERROR_OUT_OF_DATE_KHR)
 		{
 			recreateSwapchain();
-			return;
+			return false;
 		}
 		ASSERT(result == VK_SUCCESS || result == VK_SUBOPTIMAL_KHR, "failed to acquire swapchain image!");
+		return true;
 	}
 
 	void VulkanRHI::recordFrame()
@@ -395,27 +501,160 @@ namespace Bamboo
 		command_buffer_bi.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
 		vkBeginCommandBuffer(command_buffer, &command_buffer_bi);
 
+		// the begin timestamp is written at the stage which waits for the swapchain image, so vsync waits aren't timed
+		bool is_timed = m_timestamp_query_pool != VK_NULL_HANDLE;
+		if (is_timed)
+		{
+			vkCmdResetQueryPool(command_buffer, m_timestamp_query_pool, m_flight_index * 2, 2);
+			vkCmdWriteTimestamp(command_buffer, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, m_timestamp_query_pool, m_flight_index * 2);
+		}
+
 		// record all render passes
 		g_engine.eventSystem()->syncDispatch(std::make_shared<RenderRecordFrameEvent>());
 
+		if (is_timed)
+		{
+			vkCmdWriteTimestamp(command_buffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, m_timestamp_query_pool, m_flight_index * 2 + 1);
+			m_timestamp_valids[m_flight_index] = true;
+		}
+
 		vkEndCommandBuffer(command_buffer);
 	}
 
+	VkCommandBuffer VulkanRHI::getComputeCommandBuffer()
+	{
+		VkCommandBuffer command_buffer = m_compute_command_buffers[m_flight_index];
+		if (!m_is_compute_recorded)
+		{
+			vkResetCommandBuffer(command_buffer, 0);
+
+			VkCommandBufferBeginInfo command_buffer_bi{};
+			command_buffer_bi.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+			command_buffer_bi.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+			vkBeginCommandBuffer(command_buffer, &command_buffer_bi);
+
+			m_is_compute_recorded = true;
+		}
+		return command_buffer;
+	}
+
+	void VulkanRHI::trackAllocation(VmaAllocation allocation, EMemoryCategory category)
+	{
+		VmaAllocationInfo allocation_info;
+		vmaGetAllocationInfo(m_allocator, allocation, &allocation_info);
+
+		m_tracked_allocations[allocation] = std::make_pair(category, allocation_info.size);
+		m_memory_usages[static_cast<size_t>(category)] += allocation_info.size;
+	}
+
+	EMemoryCategory VulkanRHI::untrackAllocation(VmaAllocation allocation)
+	{
+		EMemoryCategory category = EMemoryCategory::Buffer;
+		auto iter = m_tracked_allocations.find(allocation);
+		if (iter != m_tracked_allocations.end())
+		{
+			category = iter->second.first;
+			m_memory_usages[static_cast<size_t>(category)] -= iter->second.second;
+			m_tracked_allocations.erase(iter);
+		}
+		return category;
+	}
+
+	void VulkanRHI::releaseDescriptorHandle(uint64_t handle)
+	{
+		// caches which fall behind the trimmed handles drop all their sets instead
+		const size_t k_max_released_handle_num = 4096;
+		if (m_released_descriptor_handles.size() == k_max_released_handle_num)
+		{
+			m_released_descriptor_handles.pop_front();
+			m_released_descriptor_handle_begin++;
+		}
+		m_released_descriptor_handles.push_back(handle);
+	}
+
+	void VulkanRHI::getMemoryBudget(VkDeviceSize& usage, VkDeviceSize& budget)
+	{
+		const VkPhysicalDeviceMemoryProperties* p_memory_properties = nullptr;
+		vmaGetMemoryProperties(m_allocator, &p_memory_properties);
+		std::vector<VmaBudget> heap_budgets(p_memory_properties->memoryHeapCount);
+		vmaGetHeapBudgets(m_allocator, heap_budgets.data());
+
+		// only device local heaps are taken into account
+		usage = 0;
+		budget = 0;
+		for (uint32_t i = 0; i < p_memory_properties->memoryHeapCount; ++i)
+		{
+			if (p_memory_properties->memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT)
+			{
+				usage += heap_budgets[i].usage;
+				budget += heap_budgets[i].budget;
+			}
+		}
+
+		if (m_memory_budget_limit > 0)
+		{
+			budget = std::min(budget, m_memory_budget_limit);
+		}
+	}
+
+	bool VulkanRHI::isOverMemoryBudget()
+	{
+		// keep some headroom for transient allocations like staging buffers
+		const float k_budget_ratio = 0.9f;
+
+		VkDeviceSize usage, budget;
+		getMemoryBudget(usage, budget);
+		return usage > static_cast<VkDeviceSize>(budget * k_budget_ratio);
+	}
+
 	void VulkanRHI::submitFrame()
 	{
+		std::vector<VkSemaphore> wait_semaphores = { m_image_avaliable_semaphores[m_flight_index] };
+		std::vector<VkPipelineStageFlags> wait_stages = { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT };
+
+		// submit async compute commands first, graphics commands wait on them from the vertex input stage
+		if (m_is_compute_recorded)
+		{
+			VkCommandBuffer compute_command_buffer = m_compute_command_buffers[m_flight_index];
+			vkEndCommandBuffer(compute_command_buffer);
+
+			VkSubmitInfo compute_submit_info{};
+			compute_submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+			compute_submit_info.commandBufferCount = 1;
+			compute_submit_info.pCommandBuffers = &compute_command_buffer;
+			compute_submit_info.signalSemaphoreCount = 1;
+			compute_submit_info.pSignalSemaphores = &m_compute_finished_semaphores[m_flight_index];
+
+			VkResult result = vkQueueSubmit(m_compute_queue, 1, &compute_submit_info, VK_NULL_HANDLE);
+			CHECK_VULKAN_RESULT(result, "submit compute queue");
+
+			wait_semaphores.push_back(m_compute_finished_semaphores[m_flight_index]);
+			wait_stages.push_back(VK_PIPELINE_STAGE_VERTEX_INPUT_BIT);
+			m_is_compute_recorded = false;
+		}
+
 		VkSubmitInfo submit_info{};
 		submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-		submit_info.waitSemaphoreCount = 1;
-		submit_info.pWaitSemaphores = &m_image_avaliable_semaphores[m_flight_index];
-		VkPipelineStageFlags wait_stages[] = { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT };
-		submit_info.pWaitDstStageMask = wait_stages;
+		submit_info.waitSemaphoreCount = static_cast<uint32_t>(wait_semaphores.size());
+		submit_info.pWaitSemaphores = wait_semaphores.data();
+		submit_info.pWaitDstStageMask = wait_stages.data();
 		submit_info.commandBufferCount = 1;
 		submit_info.pCommandBuffers = &m_command_buffers[m_flight_index];
-		submit_info.signalSemaphoreCount = 1;
-		submit_info.pSignalSemaphores = &m_render_finished_semaphores[m_flight_index];
 
-		vkResetFences(m_device, 1, &m_flight_fences[m_flight_index]);
-		VkResult result = vkQueueSubmit(m_graphics_queue, 1, &submit_info, m_flight_fences[m_flight_index]);
+		// signal the binary semaphore for presentation and the timeline semaphore for frame pacing
+		m_flight_timeline_values[m_flight_index] = ++m_frame_index;
+		std::array<VkSemaphore, 2> signal_semaphores = { m_render_finished_semaphores[m_flight_index], m_timeline_semaphore };
+		std::array<uint64_t, 2> signal_values = { 0, m_frame_index };
+		submit_info.signalSemaphoreCount = static_cast<uint32_t>(signal_semaphores.size());
+		submit_info.pSignalSemaphores = signal_semaphores.data();
+
+		VkTimelineSemaphoreSubmitInfo timeline_semaphore_si{};
+		timeline_semaphore_si.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+		timeline_semaphore_si.signalSemaphoreValueCount = static_cast<uint32_t>(signal_values.size());
+		timeline_semaphore_si.pSignalSemaphoreValues = signal_values.data();
+		submit_info.pNext = &timeline_semaphore_si;
+
+		VkResult result = vkQueueSubmit(m_graphics_queue, 1, &submit_info, VK_NULL_HANDLE);
 		CHECK_VULKAN_RESULT(result, "submit queue");
 	}
 
@@ -439,7 +678,8 @@ namespace Bamboo
 			CHECK_VULKAN_RESULT(result, "present swapchain image");
 		}
 
-		m_flight_index = (m_flight_index + 1) % MAX_FRAMES_IN_FLIGHT;
+		m_flight_index = (m_flight_index + 1) % m_flight_count;
+		m_is_frame_waited = false;
 	}
 
 	std::vector<const char*> VulkanRHI::getRequiredInstanceExtensions()
@@ -540,6 +780,14 @@ namespace Bamboo
 			}
 		}
 
+		// add optional device extensions
+		m_is_memory_budget_supported = std::find(supported_device_extensions.begin(), supported_device_extensions.end(),
+			VK_EXT_MEMORY_BUDGET_EXTENSION_NAME) != supported_device_extensions.end();
+		if (m_is_memory_budget_supported)
+		{
+			required_device_extensions.push_back(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+		}
+
 		return required_device_extensions;
 	}
 
@@ -567,6 +815,23 @@ namespace Bamboo
 			required_device_features.fillModeNonSolid = VK_TRUE;
 		}
 
+		if (m_physical_device_features.multiDrawIndirect)
+		{
+			required_device_features.multiDrawIndirect = VK_TRUE;
+		}
+
+		// vulkan 1.2/1.3 features are chained to device create info
+		m_required_device_vulkan12_features = {};
+		m_required_device_vulkan12_features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+		m_required_device_vulkan12_features.timelineSemaphore = VK_TRUE;
+		m_required_device_vulkan12_features.shaderOutputLayer = m_physical_device_vulkan12_features.shaderOutputLayer;
+		m_required_device_vulkan12_features.drawIndirectCount = m_physical_device_vulkan12_features.drawIndirectCount;
+		m_required_device_vulkan12_features.pNext = &m_required_device_vulkan13_features;
+
+		m_required_device_vulkan13_features = {};
+		m_required_device_vulkan13_features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES;
+		m_required_device_vulkan13_features.dynamicRendering = VK_TRUE;
+
 		return required_device_features;
 	}
 
@@ -6,6 +6,8 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <array>
+#include <deque>
 
 namespace Bamboo
 {
@@ -18,25 +20,69 @@ namespace Bamboo
 
 		void waitDeviceIdle() { vkDeviceWaitIdle(m_device); }
 
+		// wait until the current flight's previous submission finished, only waits once per frame
+		void waitFrame();
+
 		VkInstance getInstance() { return m_instance; }
 		VkPhysicalDevice getPhysicalDevice() { return m_physical_device; }
 		VkPhysicalDeviceProperties getPhysicalDeviceProperties() { return m_physical_device_properties; }
 		VkFormat getColorFormat() { return m_surface_format.format; }
 		VkFormat getDepthFormat() { return m_depth_format; }
+
+		// the first candidate which can be rendered to, the last candidate should be one that every device supports
+		VkFormat getColorAttachmentFormat(const std::vector<VkFormat>& candidates) {
+			return getProperImageFormat(candidates, VK_IMAGE_TILING_OPTIMAL, VK_FORMAT_FEATURE_COLOR_ATTACHMENT_BIT);
+		}
 		VkDevice getDevice() { return m_device; }
 		uint32_t getGraphicsQueueFamily() { return m_queue_family_indices.graphics; }
 		VkQueue getGraphicsQueue() { return m_graphics_queue; }
 		VkQueue getTransferQueue() { return m_transfer_queue; }
+		uint32_t getComputeQueueFamily() { return m_queue_family_indices.compute; }
+		VkQueue getComputeQueue() { return m_compute_queue; }
+		bool isAsyncCompute() { return m_queue_family_indices.compute != m_queue_family_indices.graphics; }
+
+		// vertex shaders can write gl_Layer, so layered targets can be rendered with instancing instead of geometry shaders
+		bool isShaderOutputLayerSupported() { return m_physical_device_vulkan12_features.shaderOutputLayer; }
+
+		// gpu culled draws are recorded with indirect draw counts written by compute shaders
+		bool isDrawIndirectCountSupported() { return m_physical_device_vulkan12_features.drawIndirectCount && m_physical_device_features.multiDrawIndirect; }
+
+		// gpu time of the last finished frame's graphics commands in milliseconds, 0 if timestamps aren't supported
+		float getGPUFrameTime() { return m_gpu_frame_time; }
 		VmaAllocator getAllocator() { return m_allocator; }
 		uint32_t getSwapchainImageCount() { return m_swapchain_image_count; }
 		const std::vector<VkImageView>& getSwapchainImageViews() { return m_swapchain_image_views; }
 		const VkExtent2D& getSwapchainImageSize() { return m_extent; }
 		uint32_t getImageIndex() { return m_image_index; }
 		uint32_t getFlightIndex() { return m_flight_index; }
+		uint32_t getFlightCount() { return m_flight_count; }
+		uint64_t getFrameIndex() { return m_frame_index; }
+		bool isLowLatencyMode() { return m_low_latency_mode; }
 		VkCommandPool getInstantCommandPool() { return m_instant_command_pool; }
+		VkCommandPool getInstantComputeCommandPool() { return m_instant_compute_command_pool; }
 		VkCommandBuffer getCommandBuffer() { return m_command_buffers[m_flight_index]; }
+
+		// async compute command buffer of current flight, it's submitted before the graphics command buffer,
+		// which waits on it at the vertex input stage, so it may only produce vertex data independent of this frame's graphics results
+		VkCommandBuffer getComputeCommandBuffer();
 		PFN_vkCmdPushDescriptorSetKHR getVkCmdPushDescriptorSetKHR() { return m_vk_cmd_push_desc_set_func; }
 
+		// gpu memory tracking, every vma allocation made by VulkanUtil is registered with its category
+		void trackAllocation(VmaAllocation allocation, EMemoryCategory category);
+		EMemoryCategory untrackAllocation(VmaAllocation allocation);
+		VkDeviceSize getMemoryUsage(EMemoryCategory category) { return m_memory_usages[static_cast<size_t>(category)]; }
+
+		// device local heaps usage and budget, from VK_EXT_memory_budget if supported, otherwise estimated by vma
+		void getMemoryBudget(VkDeviceSize& usage, VkDeviceSize& budget);
+		bool isOverMemoryBudget();
+
+		// handles of destroyed resources which can be referenced by descriptors, in destruction order,
+		// cached descriptor sets referencing them are invalid, indices keep counting up as old handles are trimmed
+		void releaseDescriptorHandle(uint64_t handle);
+		uint64_t getReleasedDescriptorHandleBegin() { return m_released_descriptor_handle_begin; }
+		uint64_t getReleasedDescriptorHandleEnd() { return m_released_descriptor_handle_begin + m_released_descriptor_handles.size(); }
+		uint64_t getReleasedDescriptorHandle(uint64_t index) { return m_released_descriptor_handles[index - m_released_descriptor_handle_begin]; }
+
 		static VulkanRHI& get()
 		{
 			static VulkanRHI vulkan_rhi;
@@ -75,8 +121,9 @@ namespace Bamboo
 		void createCommandPools();
 		void createCommandBuffers();
 		void createSynchronizationPrimitives();
+		void createTimestampQueryPool();
 
-		void waitFrame();
+		bool acquireFrame();
 		void recordFrame();
 		void submitFrame();
 		void presentFrame();
@@ -108,13 +155,18 @@ namespace Bamboo
 		VkPhysicalDevice m_physical_device;
 		VkPhysicalDeviceProperties m_physical_device_properties;
 		VkPhysicalDeviceFeatures m_physical_device_features;
+		VkPhysicalDeviceVulkan12Features m_physical_device_vulkan12_features;
+		VkPhysicalDeviceVulkan13Features m_physical_device_vulkan13_features;
 		VkDevice m_device;
 		VkQueue m_graphics_queue;
 		VkQueue m_transfer_queue;
+		VkQueue m_compute_queue;
 		VkSurfaceKHR m_surface;
 		VmaAllocator m_allocator;
 		VkCommandPool m_command_pool;
 		VkCommandPool m_instant_command_pool;
+		VkCommandPool m_compute_command_pool;
+		VkCommandPool m_instant_compute_command_pool;
 		VkSwapchainKHR m_swapchain;
 
 		// debug functions
@@ -127,6 +179,8 @@ namespace Bamboo
 		std::vector<const char*> m_required_instance_layers;
 		std::vector<const char*> m_required_device_extensions;
 		VkPhysicalDeviceFeatures m_required_device_features;
+		VkPhysicalDeviceVulkan12Features m_required_device_vulkan12_features;
+		VkPhysicalDeviceVulkan13Features m_required_device_vulkan13_features;
 
 		// queue families
 		QueueFamilyIndices m_queue_family_indices;
@@ -142,13 +196,38 @@ namespace Bamboo
 		std::vector<VkImageView> m_swapchain_image_views;
 
 		// synchronization primitives
+		uint32_t m_flight_count;
 		uint32_t m_flight_index;
 		uint32_t m_image_index;
+		uint64_t m_frame_index;
+		bool m_low_latency_mode;
+		bool m_is_frame_waited;
 		std::vector<VkSemaphore> m_image_avaliable_semaphores;
 		std::vector<VkSemaphore> m_render_finished_semaphores;
-		std::vector<VkFence> m_flight_fences;
 		std::vector<VkCommandBuffer> m_command_buffers;
 
+		// async compute: begun lazily, graphics submission waits on its semaphore
+		bool m_is_compute_recorded;
+		std::vector<VkSemaphore> m_compute_finished_semaphores;
+		std::vector<VkCommandBuffer> m_compute_command_buffers;
+
+		// timeline semaphore: CPU-GPU, each flight records the timeline value its last submission signals
+		VkSemaphore m_timeline_semaphore;
+		std::vector<uint64_t> m_flight_timeline_values;
+
+		// gpu frame timing: each flight writes timestamps at the begin and end of its graphics commands
+		VkQueryPool m_timestamp_query_pool = VK_NULL_HANDLE;
+		std::vector<bool> m_timestamp_valids;
+		float m_gpu_frame_time = 0.0f;
+
+		// gpu memory budget
+		bool m_is_memory_budget_supported;
+		VkDeviceSize m_memory_budget_limit;
+		std::map<VmaAllocation, std::pair<EMemoryCategory, VkDeviceSize>> m_tracked_allocations;
+		std::array<VkDeviceSize, static_cast<size_t>(EMemoryCategory::Count)> m_memory_usages;
+		std::deque<uint64_t> m_released_descriptor_handles;
+		uint64_t m_released_descriptor_handle_begin = 0;
+
 		// additional device extension functions
 		PFN_vkCmdPushDescriptorSetKHR m_vk_cmd_push_desc_set_func;
 	};
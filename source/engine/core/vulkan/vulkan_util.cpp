@@ -61,6 +61,12 @@ namespace Bamboo
 	{
 		if (buffer != VK_NULL_HANDLE)
 		{
+			// vertex/index and staging buffers are never referenced by descriptors
+			EMemoryCategory category = VulkanRHI::get().untrackAllocation(allocation);
+			if (category != EMemoryCategory::Mesh && category != EMemoryCategory::Staging)
+			{
+				VulkanRHI::get().releaseDescriptorHandle((uint64_t)buffer);
+			}
 			vmaDestroyBuffer(VulkanRHI::get().getAllocator(), buffer, allocation);
 		}
 	}
@@ -69,6 +75,7 @@ namespace Bamboo
 	{
 		if (image != VK_NULL_HANDLE)
 		{
+			VulkanRHI::get().untrackAllocation(allocation);
 			vmaDestroyImage(VulkanRHI::get().getAllocator(), image, allocation);
 		}
 	}
@@ -77,6 +84,7 @@ namespace Bamboo
 	{
 		if (view != VK_NULL_HANDLE)
 		{
+			VulkanRHI::get().releaseDescriptorHandle((uint64_t)view);
 			vkDestroyImageView(VulkanRHI::get().getDevice(), view, nullptr);
 		}
 
@@ -87,21 +95,23 @@ namespace Bamboo
 	{
 		if (sampler != VK_NULL_HANDLE)
 		{
+			VulkanRHI::get().releaseDescriptorHandle((uint64_t)sampler);
 			vkDestroySampler(VulkanRHI::get().getDevice(), sampler, nullptr);
 		}
 		if (view != VK_NULL_HANDLE)
 		{
+			VulkanRHI::get().releaseDescriptorHandle((uint64_t)view);
 			vkDestroyImageView(VulkanRHI::get().getDevice(), view, nullptr);
 		}
 		vma_image.destroy();
 	}
 
-	VkCommandBuffer VulkanUtil::beginInstantCommands()
+	VkCommandBuffer VulkanUtil::beginInstantCommands(bool is_compute)
 	{
 		VkCommandBufferAllocateInfo command_buffer_ai{};
 		command_buffer_ai.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
 		command_buffer_ai.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-		command_buffer_ai.commandPool = VulkanRHI::get().getInstantCommandPool();
+		command_buffer_ai.commandPool = is_compute ? VulkanRHI::get().getInstantComputeCommandPool() : VulkanRHI::get().getInstantCommandPool();
 		command_buffer_ai.commandBufferCount = 1;
 
 		VkCommandBuffer command_buffer;
@@ -116,7 +126,7 @@ namespace Bamboo
 		return command_buffer;
 	}
 
-	void VulkanUtil::endInstantCommands(VkCommandBuffer command_buffer)
+	void VulkanUtil::endInstantCommands(VkCommandBuffer command_buffer, bool is_compute)
 	{
 		vkEndCommandBuffer(command_buffer);
 
@@ -132,16 +142,18 @@ namespace Bamboo
 		VkFence fence;
 		vkCreateFence(VulkanRHI::get().getDevice(), &fence_ci, nullptr, &fence);
 
-		VkQueue queue = VulkanRHI::get().getGraphicsQueue();
+		VkQueue queue = is_compute ? VulkanRHI::get().getComputeQueue() : VulkanRHI::get().getGraphicsQueue();
 		vkQueueSubmit(queue, 1, &submit_info, fence);
 
 		vkWaitForFences(VulkanRHI::get().getDevice(), 1, &fence, VK_TRUE, UINT64_MAX);
 		vkDestroyFence(VulkanRHI::get().getDevice(), fence, nullptr);
 
-		vkFreeCommandBuffers(VulkanRHI::get().getDevice(), VulkanRHI::get().getInstantCommandPool(), 1, &command_buffer);
+		VkCommandPool command_pool = is_compute ? VulkanRHI::get().getInstantComputeCommandPool() : VulkanRHI::get().getInstantCommandPool();
+		vkFreeCommandBuffers(VulkanRHI::get().getDevice(), command_pool, 1, &command_buffer);
 	}
 
-	void VulkanUtil::createBuffer(VkDeviceSize size, VkBufferUsageFlags buffer_usage, VmaMemoryUsage memory_usage, VmaBuffer& buffer)
+	void VulkanUtil::createBuffer(VkDeviceSize size, VkBufferUsageFlags buffer_usage, VmaMemoryUsage memory_usage, VmaBuffer& buffer, 
+		bool is_readback, bool is_compute_shared)
 	{
 		VkBufferCreateInfo buffer_ci{};
 		buffer_ci.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
@@ -150,15 +162,38 @@ namespace Bamboo
 		buffer_ci.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
 		buffer_ci.flags = 0;
 
+		// buffers read by both graphics and async compute queues are shared concurrently, instead of transferring their ownership every frame
+		std::array<uint32_t, 2> queue_families = { VulkanRHI::get().getGraphicsQueueFamily(), VulkanRHI::get().getComputeQueueFamily() };
+		if (is_compute_shared && VulkanRHI::get().isAsyncCompute())
+		{
+			buffer_ci.sharingMode = VK_SHARING_MODE_CONCURRENT;
+			buffer_ci.queueFamilyIndexCount = static_cast<uint32_t>(queue_families.size());
+			buffer_ci.pQueueFamilyIndices = queue_families.data();
+		}
+
 		VmaAllocationCreateInfo vma_alloc_ci{};
 		vma_alloc_ci.usage = memory_usage;
 		if (memory_usage == VMA_MEMORY_USAGE_AUTO_PREFER_HOST)
 		{
-			vma_alloc_ci.flags = VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT | VMA_ALLOCATION_CREATE_MAPPED_BIT;
+			vma_alloc_ci.flags = (is_readback ? VMA_ALLOCATION_CREATE_HOST_ACCESS_RANDOM_BIT : VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT) |
+				VMA_ALLOCATION_CREATE_MAPPED_BIT;
 		}
 		
 		buffer.size = size;
 		vmaCreateBuffer(VulkanRHI::get().getAllocator(), &buffer_ci, &vma_alloc_ci, &buffer.buffer, &buffer.allocation, nullptr);
+
+		// classify buffer memory by its usage
+		EMemoryCategory category = EMemoryCategory::Buffer;
+		if (buffer_usage & (VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT))
+		{
+			category = EMemoryCategory::Mesh;
+		}
+		else if (!(buffer_usage & (VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT)) &&
+			(buffer_usage & (VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT)))
+		{
+			category = EMemoryCategory::Staging;
+		}
+		VulkanRHI::get().trackAllocation(buffer.allocation, category);
 	}
 
 	void VulkanUtil::copyBuffer(VkBuffer src_buffer, VkBuffer dst_buffer, VkDeviceSize size)
@@ -172,11 +207,11 @@ namespace Bamboo
 		endInstantCommands(command_buffer);
 	}
 
-	void VulkanUtil::updateBuffer(VmaBuffer& buffer, void* data, size_t size)
+	void VulkanUtil::updateBuffer(VmaBuffer& buffer, void* data, size_t size, size_t offset)
 	{
 		void* mapped_data;
 		vmaMapMemory(VulkanRHI::get().getAllocator(), buffer.allocation, &mapped_data);
-		memcpy(mapped_data, data, size);
+		memcpy((uint8_t*)mapped_data + offset, data, size);
 		vmaUnmapMemory(VulkanRHI::get().getAllocator(), buffer.allocation);
 	}
 
@@ -250,7 +285,7 @@ namespace Bamboo
 			copyBufferToImage(staging_buffer.buffer, image, width, height);
 
 			// clear staging buffer
-			vmaDestroyBuffer(VulkanRHI::get().getAllocator(), staging_buffer.buffer, staging_buffer.allocation);
+			staging_buffer.destroy();
 
 			// generate image mipmaps, and transition image to READ_ONLY_OPT state for shader reading
 			createImageMipmaps(image, width, height, mip_levels);
@@ -302,6 +337,12 @@ namespace Bamboo
 
 		VkResult result = vmaCreateImage(VulkanRHI::get().getAllocator(), &image_ci, &vma_alloc_ci, &image.image, &image.allocation, nullptr);
 		CHECK_VULKAN_RESULT(result, "vma create image");
+
+		// classify image memory by its usage
+		const VkImageUsageFlags render_target_usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | 
+			VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT | VK_IMAGE_USAGE_STORAGE_BIT;
+		VulkanRHI::get().trackAllocation(image.allocation, 
+			(image_usage & render_target_usage) ? EMemoryCategory::RenderTarget : EMemoryCategory::Texture);
 	}
 
 	VkImageView VulkanUtil::createImageView(VkImage image, VkFormat format, VkImageAspectFlags aspect_flags, uint32_t mip_levels, uint32_t layers)
@@ -352,7 +393,7 @@ namespace Bamboo
 		return sampler;
 	}
 
-	void VulkanUtil::createVertexBuffer(uint32_t buffer_size, void* vertex_data, VmaBuffer& vertex_buffer)
+	void VulkanUtil::createVertexBuffer(uint32_t buffer_size, void* vertex_data, VmaBuffer& vertex_buffer, VkBufferUsageFlags extra_usage)
 	{
 		VmaBuffer staging_buffer;
 		createBuffer(buffer_size, 
@@ -363,19 +404,22 @@ namespace Bamboo
 		// copy vertex staging_buffer_data to staging buffer
 		updateBuffer(staging_buffer, vertex_data, static_cast<size_t>(buffer_size));
 
+		// vertex buffers read as storage buffers are skinned on the compute queue
 		createBuffer(buffer_size,
-			VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+			VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | extra_usage,
 			VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE,
-			vertex_buffer);
+			vertex_buffer, false, (extra_usage & VK_BUFFER_USAGE_STORAGE_BUFFER_BIT) != 0);
 
 		copyBuffer(staging_buffer.buffer, vertex_buffer.buffer, buffer_size);
 
-		vmaDestroyBuffer(VulkanRHI::get().getAllocator(), staging_buffer.buffer, staging_buffer.allocation);
+		staging_buffer.destroy();
 	}
 
-	void VulkanUtil::createIndexBuffer(const std::vector<uint32_t>& indices, VmaBuffer& index_buffer)
+	void VulkanUtil::createIndexBuffer(const std::vector<uint32_t>& indices, VmaBuffer& index_buffer, const std::vector<uint16_t>& indices16)
 	{
-		VkDeviceSize buffer_size = sizeof(indices[0]) * indices.size();
+		VkDeviceSize indices32_size = sizeof(uint32_t) * indices.size();
+		VkDeviceSize indices16_size = sizeof(uint16_t) * indices16.size();
+		VkDeviceSize buffer_size = indices32_size + indices16_size;
 
 		VmaBuffer staging_buffer;
 		createBuffer(buffer_size,
@@ -383,8 +427,15 @@ namespace Bamboo
 			VMA_MEMORY_USAGE_AUTO_PREFER_HOST,
 			staging_buffer);
 
-		// copy index data to staging buffer
-		updateBuffer(staging_buffer, (void*)indices.data(), static_cast<size_t>(buffer_size));
+		// copy index data to staging buffer, 16 bit indices are packed after the 32 bit ones
+		if (indices32_size > 0)
+		{
+			updateBuffer(staging_buffer, (void*)indices.data(), static_cast<size_t>(indices32_size));
+		}
+		if (indices16_size > 0)
+		{
+			updateBuffer(staging_buffer, (void*)indices16.data(), static_cast<size_t>(indices16_size), static_cast<size_t>(indices32_size));
+		}
 
 		createBuffer(buffer_size,
 			VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT,
@@ -393,7 +444,26 @@ namespace Bamboo
 
 		copyBuffer(staging_buffer.buffer, index_buffer.buffer, buffer_size);
 
-		vmaDestroyBuffer(VulkanRHI::get().getAllocator(), staging_buffer.buffer, staging_buffer.allocation);
+		staging_buffer.destroy();
+	}
+
+	void VulkanUtil::createStorageBuffer(uint32_t buffer_size, void* data, VmaBuffer& storage_buffer)
+	{
+		VmaBuffer staging_buffer;
+		createBuffer(buffer_size,
+			VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+			VMA_MEMORY_USAGE_AUTO_PREFER_HOST,
+			staging_buffer);
+		updateBuffer(staging_buffer, data, static_cast<size_t>(buffer_size));
+
+		createBuffer(buffer_size,
+			VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+			VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE,
+			storage_buffer);
+
+		copyBuffer(staging_buffer.buffer, storage_buffer.buffer, buffer_size);
+
+		staging_buffer.destroy();
 	}
 
 	VkAccessFlags accessFlagsForImageLayout(VkImageLayout layout)
@@ -480,6 +550,59 @@ namespace Bamboo
 		endInstantCommands(command_buffer);
 	}
 
+	void VulkanUtil::cmdImageBarrier(VkCommandBuffer command_buffer, VkImage image, VkImageAspectFlags aspect_flags, uint32_t layers,
+		VkImageLayout old_layout, VkImageLayout new_layout, VkPipelineStageFlags src_stage, VkAccessFlags src_access,
+		VkPipelineStageFlags dst_stage, VkAccessFlags dst_access)
+	{
+		VkImageMemoryBarrier barrier{};
+		barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+		barrier.oldLayout = old_layout;
+		barrier.newLayout = new_layout;
+		barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barrier.image = image;
+		barrier.srcAccessMask = src_access;
+		barrier.dstAccessMask = dst_access;
+
+		barrier.subresourceRange.aspectMask = aspect_flags;
+		barrier.subresourceRange.baseMipLevel = 0;
+		barrier.subresourceRange.levelCount = 1;
+		barrier.subresourceRange.baseArrayLayer = 0;
+		barrier.subresourceRange.layerCount = layers;
+
+		vkCmdPipelineBarrier(command_buffer, src_stage, dst_stage, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+	}
+
+	void VulkanUtil::cmdCopyImage(VkCommandBuffer command_buffer, VkImage src_image, VkImage dst_image, VkImageAspectFlags aspect_flags,
+		uint32_t width, uint32_t height, uint32_t layers)
+	{
+		VkImageCopy image_copy{};
+		image_copy.srcSubresource.aspectMask = aspect_flags;
+		image_copy.srcSubresource.mipLevel = 0;
+		image_copy.srcSubresource.baseArrayLayer = 0;
+		image_copy.srcSubresource.layerCount = layers;
+		image_copy.dstSubresource = image_copy.srcSubresource;
+		image_copy.extent = { width, height, 1 };
+
+		vkCmdCopyImage(command_buffer, src_image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, dst_image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &image_copy);
+	}
+
+	void VulkanUtil::cmdCopyImageRegion(VkCommandBuffer command_buffer, VkImage src_image, VkImage dst_image, VkImageAspectFlags aspect_flags,
+		uint32_t x, uint32_t y, uint32_t width, uint32_t height)
+	{
+		VkImageCopy image_copy{};
+		image_copy.srcSubresource.aspectMask = aspect_flags;
+		image_copy.srcSubresource.mipLevel = 0;
+		image_copy.srcSubresource.baseArrayLayer = 0;
+		image_copy.srcSubresource.layerCount = 1;
+		image_copy.srcOffset = { (int32_t)x, (int32_t)y, 0 };
+		image_copy.dstSubresource = image_copy.srcSubresource;
+		image_copy.dstOffset = image_copy.srcOffset;
+		image_copy.extent = { width, height, 1 };
+
+		vkCmdCopyImage(command_buffer, src_image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, dst_image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &image_copy);
+	}
+
 	void VulkanUtil::copyBufferToImage(VkBuffer buffer, VkImage image, uint32_t width, uint32_t height)
 	{
 		VkCommandBuffer command_buffer = beginInstantCommands();
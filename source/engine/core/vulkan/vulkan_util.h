@@ -4,7 +4,8 @@
 #include <vulkan/vulkan.h>
 #include <vma/vk_mem_alloc.h>
 
-#define MAX_FRAMES_IN_FLIGHT 2
+// upper bound of frames in flight, the actual count is configured at runtime
+#define MAX_FRAMES_IN_FLIGHT 3
 
 namespace Bamboo
 {
@@ -21,6 +22,12 @@ namespace Bamboo
         LOG_FATAL("failed to {}, error: {}", msg, vkErrorString(result)); \
     }
 
+	// gpu memory categories for budget tracking
+	enum class EMemoryCategory
+	{
+		Texture, Mesh, RenderTarget, Staging, Buffer, Count
+	};
+
 	// VMA Buffer
 	struct VmaBuffer
 	{
@@ -67,13 +74,15 @@ namespace Bamboo
 	class VulkanUtil
 	{
 	public:
-		// begin and end instant transient commandbuffer
-		static VkCommandBuffer beginInstantCommands();
-		static void endInstantCommands(VkCommandBuffer command_buffer);
+		// begin and end instant transient commandbuffer, on the graphics queue or the compute queue
+		static VkCommandBuffer beginInstantCommands(bool is_compute = false);
+		static void endInstantCommands(VkCommandBuffer command_buffer, bool is_compute = false);
 
-		static void createBuffer(VkDeviceSize size, VkBufferUsageFlags buffer_usage, VmaMemoryUsage memory_usage, VmaBuffer& buffer);
+		// host visible buffers are write combined for uploads, readback buffers are cached for cpu reads instead
+		static void createBuffer(VkDeviceSize size, VkBufferUsageFlags buffer_usage, VmaMemoryUsage memory_usage, VmaBuffer& buffer, 
+			bool is_readback = false, bool is_compute_shared = false);
 		static void copyBuffer(VkBuffer src_buffer, VkBuffer dst_buffer, VkDeviceSize size);
-		static void updateBuffer(VmaBuffer& buffer, void* data, size_t size);
+		static void updateBuffer(VmaBuffer& buffer, void* data, size_t size, size_t offset = 0);
 
 		static VmaImageViewSampler loadImageViewSampler(const std::string& filename,
 			uint32_t mip_levels = 1, uint32_t layers = 1, VkFormat format = VK_FORMAT_R8G8B8A8_SRGB, 
@@ -92,9 +101,20 @@ namespace Bamboo
 		static VkSampler createSampler(VkFilter min_filter, VkFilter mag_filter, uint32_t mip_levels,
 			VkSamplerAddressMode address_mode_u, VkSamplerAddressMode address_mode_v, VkSamplerAddressMode address_mode_w);
 
-		static void createVertexBuffer(uint32_t buffer_size, void* vertex_data, VmaBuffer& vertex_buffer);
-		static void createIndexBuffer(const std::vector<uint32_t>& indices, VmaBuffer& index_buffer);
-
+		static void createVertexBuffer(uint32_t buffer_size, void* vertex_data, VmaBuffer& vertex_buffer, VkBufferUsageFlags extra_usage = 0);
+		static void createIndexBuffer(const std::vector<uint32_t>& indices, VmaBuffer& index_buffer, const std::vector<uint16_t>& indices16 = {});
+		static void createStorageBuffer(uint32_t buffer_size, void* data, VmaBuffer& storage_buffer);
+
+		// record an image memory barrier into a frame command buffer, e.g. for attachments of dynamic rendering passes
+		static void cmdImageBarrier(VkCommandBuffer command_buffer, VkImage image, VkImageAspectFlags aspect_flags, uint32_t layers,
+			VkImageLayout old_layout, VkImageLayout new_layout, VkPipelineStageFlags src_stage, VkAccessFlags src_access,
+			VkPipelineStageFlags dst_stage, VkAccessFlags dst_access);
+		// record a whole image copy of the first mip level, src must be in TRANSFER_SRC and dst in TRANSFER_DST layout
+		static void cmdCopyImage(VkCommandBuffer command_buffer, VkImage src_image, VkImage dst_image, VkImageAspectFlags aspect_flags,
+			uint32_t width, uint32_t height, uint32_t layers);
+		// record a copy of the same 2d region of both images' first mip level and layer, e.g. a tile of an atlas
+		static void cmdCopyImageRegion(VkCommandBuffer command_buffer, VkImage src_image, VkImage dst_image, VkImageAspectFlags aspect_flags,
+			uint32_t x, uint32_t y, uint32_t width, uint32_t height);
 		static void transitionImageLayout(VkImage image, VkImageLayout old_layout, VkImageLayout new_layout, 
 			VkFormat format = VK_FORMAT_B8G8R8A8_SRGB, uint32_t mip_levels = 1, uint32_t layers = 1);
 		static void copyBufferToImage(VkBuffer buffer, VkImage image, uint32_t width, uint32_t height);
@@ -2,8 +2,10 @@
 #include "engine/core/base/macro.h"
 #include "engine/platform/timer/timer.h"
 #include "engine/core/event/event_system.h"
+#include "engine/core/vulkan/vulkan_rhi.h"
 #include "engine/function/render/window_system.h"
 #include "engine/function/render/render_system.h"
+#include "engine/function/animation/animation_system.h"
 #include "engine/function/framework/world/world_manager.h"
 
 namespace Bamboo
@@ -27,6 +29,15 @@ namespace Bamboo
 
     bool Engine::tick(float delta_time)
     {
+        // in low latency mode, wait for the gpu frame slot before sampling input and simulating,
+        // so that the recorded frame reflects the latest input
+        bool is_low_latency = VulkanRHI::get().isLowLatencyMode();
+        if (is_low_latency)
+        {
+            VulkanRHI::get().waitFrame();
+            g_engine.windowSystem()->pollEvents();
+        }
+
         logicTick(delta_time);
         renderTick(delta_time);
 
@@ -34,7 +45,10 @@ namespace Bamboo
 		calcFPS(delta_time);
 
         g_engine.setDeltaTime(delta_time);
-        g_engine.windowSystem()->pollEvents();
+        if (!is_low_latency)
+        {
+            g_engine.windowSystem()->pollEvents();
+        }
         g_engine.windowSystem()->setTitle(std::string(APP_NAME) + " - " + std::to_string(getFPS()) + " FPS");
 
         return !g_engine.windowSystem()->shouldClose();
@@ -55,6 +69,7 @@ namespace Bamboo
     {
         g_engine.eventSystem()->tick();
         g_engine.worldManager()->tick(delta_time);
+        g_engine.animationSystem()->tick(delta_time);
 		g_engine.timerManager()->tick(delta_time);
 	}
 
@@ -0,0 +1,426 @@
+#include "animation_graph.h"
+#include "engine/core/base/macro.h"
+
+#include <algorithm>
+
+namespace Bamboo
+{
+
+	void PosePool::init(size_t bone_count, size_t pose_num)
+	{
+		m_poses.resize(pose_num);
+		for (Pose& pose : m_poses)
+		{
+			pose.resize(bone_count);
+		}
+		m_used_num = 0;
+	}
+
+	Pose& PosePool::acquire()
+	{
+		ASSERT(m_used_num < m_poses.size(), "pose pool is exhausted, its graph isn't bound");
+		return m_poses[m_used_num++];
+	}
+
+	void PosePool::release()
+	{
+		m_used_num--;
+	}
+
+	void AnimationClipNode::bind(const Skeleton& skeleton)
+	{
+		m_channel_bone_indices.resize(m_animation->m_channels.size());
+		m_leaf_channels.resize(m_animation->m_channels.size());
+		for (size_t c = 0; c < m_animation->m_channels.size(); ++c)
+		{
+			uint16_t bone_index = skeleton.getBoneIndex(m_animation->m_channels[c].m_bone_name);
+			m_channel_bone_indices[c] = bone_index;
+			m_leaf_channels[c] = bone_index != INVALID_BONE_INDEX && skeleton.m_bones[bone_index].m_children.empty();
+		}
+		m_key_cursors.assign(m_animation->m_channels.size(), 0);
+
+		// bones without channels keep their bind pose
+		size_t bone_count = skeleton.m_bones.size();
+		for (Pose& key_pose : m_key_poses)
+		{
+			key_pose.resize(bone_count);
+			for (size_t i = 0; i < bone_count; ++i)
+			{
+				key_pose.setTransform(i, skeleton.m_bones[i].m_local_bind_pose_transform);
+			}
+		}
+		m_translation_ts.assign(m_key_poses[0].paddedSize(), 0.0f);
+		m_rotation_ts.assign(m_key_poses[0].paddedSize(), 0.0f);
+		m_scale_ts.assign(m_key_poses[0].paddedSize(), 0.0f);
+	}
+
+	float AnimationClipNode::getDuration(const std::vector<float>& parameters) const
+	{
+		return m_animation->m_duration;
+	}
+
+	void AnimationClipNode::evaluate(AnimationGraphContext& context, float phase, Pose& out)
+	{
+		// gather the bracketing keys of each channel, then interpolate all bones at once
+		float time = m_animation->m_start_time + phase * m_animation->m_duration;
+		for (size_t c = 0; c < m_animation->m_channels.size(); ++c)
+		{
+			uint16_t bone_index = m_channel_bone_indices[c];
+			if (bone_index == INVALID_BONE_INDEX || (context.skip_leaf_bones && m_leaf_channels[c]))
+			{
+				// skip invalid channel
+				continue;
+			}
+
+			const auto& channel = m_animation->m_channels[c];
+
+			const auto& sampler = m_animation->m_samplers[channel.m_sampler_index];
+			if (sampler.getKeyCount() == 0)
+			{
+				continue;
+			}
+
+			// times out of the sampler's range hold its first or last key
+			size_t i = sampler.findKey(time, m_key_cursors[c]);
+			size_t j = std::min(i + 1, sampler.getKeyCount() - 1);
+			float interval = sampler.m_times[j] - sampler.m_times[i];
+			float t = interval > 0.0f ? std::clamp((time - sampler.m_times[i]) / interval, 0.0f, 1.0f) : 0.0f;
+			switch (channel.m_path_type)
+			{
+			case AnimationChannel::EPathType::Translation:
+			{
+				m_key_poses[0].setTranslation(bone_index, sampler.getValue(i));
+				m_key_poses[1].setTranslation(bone_index, sampler.getValue(j));
+				m_translation_ts[bone_index] = t;
+			}
+				break;
+			case AnimationChannel::EPathType::Rotation:
+			{
+				glm::vec4 q0 = sampler.getValue(i);
+				glm::vec4 q1 = sampler.getValue(j);
+				m_key_poses[0].setRotation(bone_index, glm::make_quat(glm::value_ptr(q0)));
+				m_key_poses[1].setRotation(bone_index, glm::make_quat(glm::value_ptr(q1)));
+				m_rotation_ts[bone_index] = t;
+			}
+				break;
+			case AnimationChannel::EPathType::Scale:
+			{
+				m_key_poses[0].setScale(bone_index, sampler.getValue(i));
+				m_key_poses[1].setScale(bone_index, sampler.getValue(j));
+				m_scale_ts[bone_index] = t;
+			}
+				break;
+			default:
+			{
+				LOG_FATAL("Unknown animation channel path type {}", channel.m_path_type);
+			}
+				break;
+			}
+		}
+
+		Pose::interpolate(out, m_key_poses[0], m_key_poses[1], m_translation_ts.data(), m_rotation_ts.data(), m_scale_ts.data());
+	}
+
+	AnimationBlendNode::AnimationBlendNode(uint32_t parameter_index, const std::vector<std::pair<float, AnimationGraphNode*>>& children) :
+		m_parameter_index(parameter_index), m_children(children)
+	{
+		ASSERT(!m_children.empty(), "blend node has no children");
+		std::sort(m_children.begin(), m_children.end(),
+			[](const auto& a, const auto& b) { return a.first < b.first; });
+	}
+
+	float AnimationBlendNode::getDuration(const std::vector<float>& parameters) const
+	{
+		size_t i, j;
+		float weight;
+		findChildren(parameters, i, j, weight);
+		return glm::mix(m_children[i].second->getDuration(parameters), m_children[j].second->getDuration(parameters), weight);
+	}
+
+	void AnimationBlendNode::evaluate(AnimationGraphContext& context, float phase, Pose& out)
+	{
+		size_t i, j;
+		float weight;
+		findChildren(context.parameters, i, j, weight);
+		if (i == j || weight <= 0.0f)
+		{
+			m_children[i].second->evaluate(context, phase, out);
+			return;
+		}
+		if (weight >= 1.0f)
+		{
+			m_children[j].second->evaluate(context, phase, out);
+			return;
+		}
+
+		m_children[i].second->evaluate(context, phase, out);
+		Pose& pose = context.pose_pool.acquire();
+		m_children[j].second->evaluate(context, phase, pose);
+		Pose::blend(out, out, pose, weight);
+		context.pose_pool.release();
+	}
+
+	uint32_t AnimationBlendNode::getTempPoseNum() const
+	{
+		uint32_t temp_pose_num = 0;
+		for (const auto& child : m_children)
+		{
+			temp_pose_num = std::max(temp_pose_num, child.second->getTempPoseNum());
+		}
+		return temp_pose_num + 1;
+	}
+
+	void AnimationBlendNode::findChildren(const std::vector<float>& parameters, size_t& i, size_t& j, float& weight) const
+	{
+		// parameters out of the thresholds' range clamp to the first or last child
+		float value = parameters[m_parameter_index];
+		auto iter = std::upper_bound(m_children.begin(), m_children.end(), value,
+			[](float value, const auto& child) { return value < child.first; });
+		j = std::min(static_cast<size_t>(iter - m_children.begin()), m_children.size() - 1);
+		i = j > 0 ? j - 1 : 0;
+		float interval = m_children[j].first - m_children[i].first;
+		weight = interval > 0.0f ? std::clamp((value - m_children[i].first) / interval, 0.0f, 1.0f) : 0.0f;
+	}
+
+	uint32_t AnimationGraph::addParameter(const std::string& name, float value)
+	{
+		auto iter = m_parameter_indices.find(name);
+		if (iter != m_parameter_indices.end())
+		{
+			m_parameters[iter->second] = value;
+			return iter->second;
+		}
+
+		uint32_t index = static_cast<uint32_t>(m_parameters.size());
+		m_parameter_indices[name] = index;
+		m_parameters.push_back(value);
+		return index;
+	}
+
+	void AnimationGraph::setParameter(const std::string& name, float value)
+	{
+		auto iter = m_parameter_indices.find(name);
+		if (iter == m_parameter_indices.end())
+		{
+			LOG_WARNING("animation graph has no parameter {}", name);
+			return;
+		}
+		m_parameters[iter->second] = value;
+	}
+
+	float AnimationGraph::getParameter(const std::string& name) const
+	{
+		auto iter = m_parameter_indices.find(name);
+		return iter != m_parameter_indices.end() ? m_parameters[iter->second] : 0.0f;
+	}
+
+	AnimationGraphNode* AnimationGraph::addClipNode(const std::shared_ptr<Animation>& animation)
+	{
+		m_nodes.push_back(std::make_unique<AnimationClipNode>(animation));
+		m_is_bound = false;
+		return m_nodes.back().get();
+	}
+
+	AnimationGraphNode* AnimationGraph::addBlendNode(const std::string& parameter, const std::vector<std::pair<float, AnimationGraphNode*>>& children)
+	{
+		m_nodes.push_back(std::make_unique<AnimationBlendNode>(addParameter(parameter, getParameter(parameter)), children));
+		m_is_bound = false;
+		return m_nodes.back().get();
+	}
+
+	uint32_t AnimationGraph::addState(const std::string& name, AnimationGraphNode* node, bool loop, float speed)
+	{
+		m_states.push_back({ name, node, loop, speed });
+		m_is_bound = false;
+
+		// the first state plays by default
+		uint32_t index = static_cast<uint32_t>(m_states.size() - 1);
+		if (m_current_state == INVALID_ANIMATION_STATE_INDEX)
+		{
+			m_current_state = index;
+		}
+		return index;
+	}
+
+	uint32_t AnimationGraph::getStateIndex(const std::string& name) const
+	{
+		for (size_t i = 0; i < m_states.size(); ++i)
+		{
+			if (m_states[i].name == name)
+			{
+				return static_cast<uint32_t>(i);
+			}
+		}
+		return INVALID_ANIMATION_STATE_INDEX;
+	}
+
+	void AnimationGraph::play(uint32_t state, float crossfade_duration)
+	{
+		if (state >= m_states.size())
+		{
+			LOG_WARNING("animation graph has no state {}", state);
+			return;
+		}
+
+		if (state == m_current_state)
+		{
+			return;
+		}
+
+		if (crossfade_duration > 0.0f && m_current_state != INVALID_ANIMATION_STATE_INDEX)
+		{
+			m_fading_state = m_current_state;
+			m_crossfade_time = 0.0f;
+			m_crossfade_duration = crossfade_duration;
+		}
+		else
+		{
+			m_fading_state = INVALID_ANIMATION_STATE_INDEX;
+		}
+		m_current_state = state;
+		m_states[state].phase = 0.0f;
+	}
+
+	void AnimationGraph::play(const std::string& state, float crossfade_duration)
+	{
+		play(getStateIndex(state), crossfade_duration);
+	}
+
+	uint32_t AnimationGraph::addLayer(AnimationGraphNode* node, float weight, bool is_additive, bool loop, float speed)
+	{
+		Layer layer;
+		layer.node = node;
+		layer.weight = weight;
+		layer.is_additive = is_additive;
+		layer.loop = loop;
+		layer.speed = speed;
+		m_layers.push_back(std::move(layer));
+		m_is_bound = false;
+		return static_cast<uint32_t>(m_layers.size() - 1);
+	}
+
+	void AnimationGraph::setLayerWeight(uint32_t layer, float weight)
+	{
+		m_layers[layer].weight = std::clamp(weight, 0.0f, 1.0f);
+	}
+
+	void AnimationGraph::bind(const Skeleton& skeleton)
+	{
+		for (auto& node : m_nodes)
+		{
+			node->bind(skeleton);
+		}
+
+		// a crossfade holds the fading state's pose while evaluating the current one, a layer holds its pose while applying it
+		uint32_t pose_num = 0;
+		for (const State& state : m_states)
+		{
+			pose_num = std::max(pose_num, state.node->getTempPoseNum() + 1);
+		}
+		for (const Layer& layer : m_layers)
+		{
+			pose_num = std::max(pose_num, layer.node->getTempPoseNum() + 1);
+		}
+		m_pose_pool.init(skeleton.m_bones.size(), pose_num);
+
+		// additive layers are relative to their first frame
+		AnimationGraphContext context{ m_pose_pool, m_parameters, false };
+		for (Layer& layer : m_layers)
+		{
+			if (layer.is_additive)
+			{
+				layer.reference_pose.resize(skeleton.m_bones.size());
+				layer.node->evaluate(context, 0.0f, layer.reference_pose);
+			}
+		}
+
+		m_is_bound = true;
+	}
+
+	float AnimationGraph::advancePhase(float phase, AnimationGraphNode* node, bool loop, float speed, float delta_time) const
+	{
+		float duration = node->getDuration(m_parameters);
+		if (duration <= 0.0f)
+		{
+			return 0.0f;
+		}
+
+		phase += delta_time * speed / duration;
+		return loop ? phase - std::floor(phase) : std::min(phase, 1.0f);
+	}
+
+	void AnimationGraph::advance(float delta_time)
+	{
+		if (m_current_state != INVALID_ANIMATION_STATE_INDEX)
+		{
+			State& state = m_states[m_current_state];
+			state.phase = advancePhase(state.phase, state.node, state.loop, state.speed, delta_time);
+		}
+
+		if (m_fading_state != INVALID_ANIMATION_STATE_INDEX)
+		{
+			State& state = m_states[m_fading_state];
+			state.phase = advancePhase(state.phase, state.node, state.loop, state.speed, delta_time);
+
+			m_crossfade_time += delta_time;
+			if (m_crossfade_time >= m_crossfade_duration)
+			{
+				m_fading_state = INVALID_ANIMATION_STATE_INDEX;
+			}
+		}
+
+		for (Layer& layer : m_layers)
+		{
+			if (layer.weight > 0.0f)
+			{
+				layer.phase = advancePhase(layer.phase, layer.node, layer.loop, layer.speed, delta_time);
+			}
+		}
+	}
+
+	void AnimationGraph::evaluate(Pose& out, bool skip_leaf_bones)
+	{
+		if (m_current_state == INVALID_ANIMATION_STATE_INDEX)
+		{
+			return;
+		}
+
+		// only the playing states, and layers with weights, are evaluated
+		AnimationGraphContext context{ m_pose_pool, m_parameters, skip_leaf_bones };
+		State& state = m_states[m_current_state];
+		if (m_fading_state != INVALID_ANIMATION_STATE_INDEX)
+		{
+			State& fading_state = m_states[m_fading_state];
+			Pose& fading_pose = m_pose_pool.acquire();
+			fading_state.node->evaluate(context, fading_state.phase, fading_pose);
+			state.node->evaluate(context, state.phase, out);
+			Pose::blend(out, fading_pose, out, m_crossfade_time / m_crossfade_duration);
+			m_pose_pool.release();
+		}
+		else
+		{
+			state.node->evaluate(context, state.phase, out);
+		}
+
+		for (Layer& layer : m_layers)
+		{
+			if (layer.weight <= 0.0f)
+			{
+				continue;
+			}
+
+			Pose& layer_pose = m_pose_pool.acquire();
+			layer.node->evaluate(context, layer.phase, layer_pose);
+			if (layer.is_additive)
+			{
+				Pose::addAdditive(out, out, layer_pose, layer.reference_pose, layer.weight);
+			}
+			else
+			{
+				Pose::blend(out, out, layer_pose, layer.weight);
+			}
+			m_pose_pool.release();
+		}
+	}
+
+}
\ No newline at end of file
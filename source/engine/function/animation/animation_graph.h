@@ -0,0 +1,171 @@
+#pragma once
+
+#include "engine/core/math/pose.h"
+#include "engine/resource/asset/skeleton.h"
+#include "engine/resource/asset/animation.h"
+
+#include <map>
+#include <memory>
+
+#define INVALID_ANIMATION_STATE_INDEX UINT32_MAX
+
+namespace Bamboo
+{
+	// poses allocated for a skeleton when a graph is bound, acquired and released in stack order while evaluating the graph,
+	// so that evaluation doesn't allocate
+	class PosePool
+	{
+	public:
+		void init(size_t bone_count, size_t pose_num);
+		Pose& acquire();
+		void release();
+
+	private:
+		std::vector<Pose> m_poses;
+		size_t m_used_num = 0;
+	};
+
+	struct AnimationGraphContext
+	{
+		PosePool& pose_pool;
+		const std::vector<float>& parameters;
+
+		// leaf bones keep the transforms of their last sampled keys
+		bool skip_leaf_bones;
+	};
+
+	// nodes are evaluated at a normalized phase, so that the children of blend nodes stay in step whatever their durations
+	class AnimationGraphNode
+	{
+	public:
+		virtual ~AnimationGraphNode() = default;
+
+		// resolve channels against the skeleton and allocate sampling buffers, children are bound by their graph
+		virtual void bind(const Skeleton& skeleton) {}
+
+		// duration of a cycle with current parameters, in seconds
+		virtual float getDuration(const std::vector<float>& parameters) const = 0;
+
+		// write the pose at phase in [0, 1] to out, only the children with nonzero weights are evaluated
+		virtual void evaluate(AnimationGraphContext& context, float phase, Pose& out) = 0;
+
+		// pool poses held by the subtree while it's evaluated
+		virtual uint32_t getTempPoseNum() const { return 0; }
+	};
+
+	class AnimationClipNode : public AnimationGraphNode
+	{
+	public:
+		AnimationClipNode(const std::shared_ptr<Animation>& animation) : m_animation(animation) {}
+
+		virtual void bind(const Skeleton& skeleton) override;
+		virtual float getDuration(const std::vector<float>& parameters) const override;
+		virtual void evaluate(AnimationGraphContext& context, float phase, Pose& out) override;
+
+	private:
+		std::shared_ptr<Animation> m_animation;
+
+		// the bone index, cached key index and whether it animates a leaf bone of each channel
+		std::vector<uint16_t> m_channel_bone_indices;
+		std::vector<size_t> m_key_cursors;
+		std::vector<bool> m_leaf_channels;
+
+		// the keys bracketing the sampled time and their interpolation factors of each bone
+		std::array<Pose, 2> m_key_poses;
+		std::vector<float> m_translation_ts;
+		std::vector<float> m_rotation_ts;
+		std::vector<float> m_scale_ts;
+	};
+
+	// 1d blend tree, crossfades between the two children whose thresholds bracket the parameter
+	class AnimationBlendNode : public AnimationGraphNode
+	{
+	public:
+		AnimationBlendNode(uint32_t parameter_index, const std::vector<std::pair<float, AnimationGraphNode*>>& children);
+
+		virtual float getDuration(const std::vector<float>& parameters) const override;
+		virtual void evaluate(AnimationGraphContext& context, float phase, Pose& out) override;
+		virtual uint32_t getTempPoseNum() const override;
+
+	private:
+		void findChildren(const std::vector<float>& parameters, size_t& i, size_t& j, float& weight) const;
+
+		uint32_t m_parameter_index;
+
+		// sorted by thresholds
+		std::vector<std::pair<float, AnimationGraphNode*>> m_children;
+	};
+
+	// a state machine over the graph's nodes with crossfaded transitions, and layers applied over the playing state in order.
+	// a graph keeps playback state, so it belongs to one animator
+	class AnimationGraph
+	{
+	public:
+		uint32_t addParameter(const std::string& name, float value = 0.0f);
+		void setParameter(const std::string& name, float value);
+		float getParameter(const std::string& name) const;
+
+		// nodes are owned by the graph
+		AnimationGraphNode* addClipNode(const std::shared_ptr<Animation>& animation);
+		AnimationGraphNode* addBlendNode(const std::string& parameter, const std::vector<std::pair<float, AnimationGraphNode*>>& children);
+
+		uint32_t addState(const std::string& name, AnimationGraphNode* node, bool loop = true, float speed = 1.0f);
+		uint32_t getStateIndex(const std::string& name) const;
+		uint32_t getCurrentState() const { return m_current_state; }
+
+		// start a state from its beginning, crossfading from the current one, playing the current state again does nothing.
+		// switching during a crossfade drops the state fading out
+		void play(uint32_t state, float crossfade_duration = 0.0f);
+		void play(const std::string& state, float crossfade_duration = 0.0f);
+
+		// override layers blend over the states by weight, additive layers add their difference from their first frame
+		uint32_t addLayer(AnimationGraphNode* node, float weight, bool is_additive, bool loop = true, float speed = 1.0f);
+		void setLayerWeight(uint32_t layer, float weight);
+
+		// must be bound again after nodes, states or layers are added
+		void bind(const Skeleton& skeleton);
+		bool isBound() const { return m_is_bound; }
+
+		// advance the playing states, layers and crossfade, doesn't sample
+		void advance(float delta_time);
+		void evaluate(Pose& out, bool skip_leaf_bones);
+
+	private:
+		struct State
+		{
+			std::string name;
+			AnimationGraphNode* node;
+			bool loop;
+			float speed;
+			float phase = 0.0f;
+		};
+
+		struct Layer
+		{
+			AnimationGraphNode* node;
+			float weight;
+			bool is_additive;
+			bool loop;
+			float speed;
+			float phase = 0.0f;
+			Pose reference_pose;
+		};
+
+		float advancePhase(float phase, AnimationGraphNode* node, bool loop, float speed, float delta_time) const;
+
+		std::vector<std::unique_ptr<AnimationGraphNode>> m_nodes;
+		std::map<std::string, uint32_t> m_parameter_indices;
+		std::vector<float> m_parameters;
+
+		std::vector<State> m_states;
+		uint32_t m_current_state = INVALID_ANIMATION_STATE_INDEX;
+		uint32_t m_fading_state = INVALID_ANIMATION_STATE_INDEX;
+		float m_crossfade_time = 0.0f;
+		float m_crossfade_duration = 0.0f;
+
+		std::vector<Layer> m_layers;
+
+		PosePool m_pose_pool;
+		bool m_is_bound = false;
+	};
+}
\ No newline at end of file
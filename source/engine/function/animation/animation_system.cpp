@@ -0,0 +1,159 @@
+#include "animation_system.h"
+#include "engine/core/base/macro.h"
+#include "engine/core/vulkan/vulkan_rhi.h"
+#include "engine/function/physics/physics_system.h"
+#include "engine/function/framework/component/animator_component.h"
+
+#include <Jolt/Jolt.h>
+#include <Jolt/Core/JobSystem.h>
+
+#include <algorithm>
+#include <cstring>
+
+namespace Bamboo
+{
+	// bone palettes are bound at offsets of the shared buffer, which must be aligned to minStorageBufferOffsetAlignment(at most 256)
+	const uint32_t k_bone_palette_alignment = 256;
+
+	// animators updated by each job, so that small animators don't drown in job overhead
+	const size_t k_animator_num_per_job = 4;
+
+	void AnimationSystem::init()
+	{
+		uint32_t flight_count = VulkanRHI::get().getFlightCount();
+		m_bone_buffers.resize(flight_count);
+		m_bone_buffer_capacities.assign(flight_count, 0);
+		m_bone_buffer_slots.resize(flight_count);
+	}
+
+	void AnimationSystem::tick(float delta_time)
+	{
+		if (m_ticked_animators.empty())
+		{
+			return;
+		}
+
+		// animators only touch their own poses and skeletons, so they are updated in parallel on the physics job system's threads
+		JPH::JobSystem* job_system = g_engine.physicsSystem()->getJobSystem();
+		JPH::JobSystem::Barrier* barrier = job_system->CreateBarrier();
+		for (size_t i = 0; i < m_ticked_animators.size(); i += k_animator_num_per_job)
+		{
+			size_t end = std::min(i + k_animator_num_per_job, m_ticked_animators.size());
+			JPH::JobHandle job_handle = job_system->CreateJob("Animation", JPH::Color::sGreen, [this, i, end]()
+			{
+				for (size_t a = i; a < end; ++a)
+				{
+					m_ticked_animators[a].first->update(m_ticked_animators[a].second);
+				}
+			});
+			barrier->AddJob(job_handle);
+		}
+		job_system->WaitForJobs(barrier);
+		job_system->DestroyBarrier(barrier);
+
+		m_ticked_animators.clear();
+	}
+
+	void AnimationSystem::destroy()
+	{
+		for (VmaBuffer& bone_buffer : m_bone_buffers)
+		{
+			bone_buffer.destroy();
+		}
+		m_animators.clear();
+		m_ticked_animators.clear();
+		m_bone_buffer_slots.clear();
+	}
+
+	void AnimationSystem::registerAnimator(AnimatorComponent* animator)
+	{
+		m_animators.push_back(animator);
+	}
+
+	void AnimationSystem::unregisterAnimator(AnimatorComponent* animator)
+	{
+		m_animators.erase(std::remove(m_animators.begin(), m_animators.end(), animator), m_animators.end());
+		m_ticked_animators.erase(std::remove_if(m_ticked_animators.begin(), m_ticked_animators.end(),
+			[animator](const auto& ticked_animator) { return ticked_animator.first == animator; }), m_ticked_animators.end());
+
+		// a new animator may be allocated at the same address
+		for (auto& slots : m_bone_buffer_slots)
+		{
+			for (auto& slot : slots)
+			{
+				if (slot.animator == animator)
+				{
+					slot.animator = nullptr;
+				}
+			}
+		}
+	}
+
+	void AnimationSystem::addTickedAnimator(AnimatorComponent* animator, float delta_time)
+	{
+		m_ticked_animators.push_back({ animator, delta_time });
+	}
+
+	void AnimationSystem::updateBoneBuffer()
+	{
+		if (m_animators.empty())
+		{
+			return;
+		}
+
+		// palettes are packed in animator order with the sizes of their skeletons, instead of a fixed maximum bone count
+		uint32_t animator_count = static_cast<uint32_t>(m_animators.size());
+		uint32_t buffer_size = 0;
+		for (AnimatorComponent* animator : m_animators)
+		{
+			animator->m_bone_palette_offset = buffer_size;
+			buffer_size += (animator->getBonePaletteSize() + k_bone_palette_alignment - 1) / k_bone_palette_alignment * k_bone_palette_alignment;
+		}
+
+		// the current flight's buffer is free after waiting for the flight, grow it if the palettes don't fit
+		uint32_t flight_index = VulkanRHI::get().getFlightIndex();
+		VmaBuffer& bone_buffer = m_bone_buffers[flight_index];
+		auto& slots = m_bone_buffer_slots[flight_index];
+		if (m_bone_buffer_capacities[flight_index] < buffer_size)
+		{
+			uint32_t capacity = std::max(buffer_size, m_bone_buffer_capacities[flight_index] * 2);
+			bone_buffer.destroy();
+			VulkanUtil::createBuffer(capacity, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+				VMA_MEMORY_USAGE_AUTO_PREFER_HOST, bone_buffer, false, true);
+			m_bone_buffer_capacities[flight_index] = capacity;
+			slots.clear();
+		}
+		slots.resize(animator_count, { nullptr, 0, 0 });
+
+		// throttled and culled animators keep their transforms for several frames, and only their skeletons' bones are copied
+		void* mapped_data = nullptr;
+		for (uint32_t i = 0; i < animator_count; ++i)
+		{
+			AnimatorComponent* animator = m_animators[i];
+			BonePaletteSlot slot = { animator, animator->m_bone_palette_version, animator->m_bone_palette_offset };
+			if (slots[i].animator == slot.animator && slots[i].version == slot.version && slots[i].offset == slot.offset)
+			{
+				continue;
+			}
+
+			if (!mapped_data)
+			{
+				vmaMapMemory(VulkanRHI::get().getAllocator(), bone_buffer.allocation, &mapped_data);
+			}
+			memcpy((uint8_t*)mapped_data + animator->m_bone_palette_offset, animator->m_bone_transforms.data(),
+				animator->m_bone_transforms.size() * sizeof(BoneTransform));
+			slots[i] = slot;
+		}
+
+		if (mapped_data)
+		{
+			vmaUnmapMemory(VulkanRHI::get().getAllocator(), bone_buffer.allocation);
+		}
+	}
+
+	const VmaBuffer& AnimationSystem::getBoneBuffer()
+	{
+		return m_bone_buffers[VulkanRHI::get().getFlightIndex()];
+	}
+
+}
\ No newline at end of file
@@ -0,0 +1,45 @@
+#pragma once
+
+#include "engine/core/vulkan/vulkan_util.h"
+
+#include <vector>
+
+namespace Bamboo
+{
+	// batched animation update: animators ticked by the world are sampled and their skeletons evaluated by parallel jobs,
+	// then the bone matrices of all animators are written into one shared bone buffer per flight
+	class AnimationSystem
+	{
+	public:
+		void init();
+		void tick(float delta_time);
+		void destroy();
+
+		// animators register themselves while they are alive, and queue their updates when ticked
+		void registerAnimator(class AnimatorComponent* animator);
+		void unregisterAnimator(class AnimatorComponent* animator);
+		void addTickedAnimator(class AnimatorComponent* animator, float delta_time);
+
+		// pack the bone palettes of all animators into the current flight's bone buffer in one pass,
+		// skipping the palettes that already hold an animator's latest transforms, must be called after waiting for the flight
+		void updateBoneBuffer();
+		const VmaBuffer& getBoneBuffer();
+
+	private:
+		std::vector<class AnimatorComponent*> m_animators;
+		std::vector<std::pair<class AnimatorComponent*, float>> m_ticked_animators;
+
+		// bone palette ssbos of all animators and their sizes in bytes, one per flight
+		std::vector<VmaBuffer> m_bone_buffers;
+		std::vector<uint32_t> m_bone_buffer_capacities;
+
+		// the animator, its palette version and offset written to each slot of each flight's bone buffer
+		struct BonePaletteSlot
+		{
+			class AnimatorComponent* animator;
+			uint32_t version;
+			uint32_t offset;
+		};
+		std::vector<std::vector<BonePaletteSlot>> m_bone_buffer_slots;
+	};
+}
\ No newline at end of file
@@ -1,5 +1,6 @@
 #include "animator_component.h"
 #include "engine/function/global/engine_context.h"
+#include "engine/function/animation/animation_system.h"
 #include "engine/resource/asset/asset_manager.h"
 #include "engine/function/framework/entity/entity.h"
 #include "engine/function/framework/component/animation_component.h"
@@ -15,140 +16,230 @@ CEREAL_REGISTER_POLYMORPHIC_RELATION(Bamboo::Component, Bamboo::AnimatorComponen
 
 namespace Bamboo
 {
+	// screen sizes below which animations halve their update rates
+	const std::array<float, 2> k_update_rate_screen_sizes = { 0.2f, 0.08f };
+
+	// off screen animators may still cast visible shadows
+	const uint32_t k_off_screen_update_interval = 4;
+
+	// screen size below which leaf bones like fingers and face bones are no longer sampled
+	const float k_leaf_bone_screen_size = 0.1f;
 
 	AnimatorComponent::AnimatorComponent()
 	{
-		m_bone_ubs.resize(MAX_FRAMES_IN_FLIGHT);
-		for (VmaBuffer& bone_ub : m_bone_ubs)
-		{
-			VulkanUtil::createBuffer(sizeof(BoneUBO), VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, VMA_MEMORY_USAGE_AUTO_PREFER_HOST, bone_ub);
-		}
+		g_engine.animationSystem()->registerAnimator(this);
 	}
 
 	AnimatorComponent::~AnimatorComponent()
 	{
-		for (VmaBuffer& bone_ub : m_bone_ubs)
-		{
-			bone_ub.destroy();
-		}
+		g_engine.animationSystem()->unregisterAnimator(this);
 	}
 
 	void AnimatorComponent::setSkeleton(std::shared_ptr<Skeleton>& skeleton)
 	{
-		m_skeleton_inst = *skeleton;
+		m_is_graph_bound = false;
 		REF_ASSET(m_skeleton, skeleton)
 	}
 
 	void AnimatorComponent::inflate()
 	{
-		// tick once to update bone ubo
-		tick(0.0f);
+		// update once to initialize bone palette
+		update(0.0f);
 	}
 
 	void AnimatorComponent::tick(float delta_time)
 	{
-		if (!m_animation_component)
-		{
-			m_animation_component = m_parent.lock()->getComponent(AnimationComponent);
-		}
+		// updated in batch with the other animators after the world's tick
+		g_engine.animationSystem()->addTickedAnimator(this, delta_time);
+	}
 
-		if (!m_animation_component)
+	void AnimatorComponent::update(float delta_time)
+	{
+		if (!m_skeleton)
 		{
 			return;
 		}
 
-		const auto& animations = m_animation_component->getAnimations();
-		if (animations.empty())
+		// bones keep their bind poses until the first sample
+		if (m_bone_transforms.size() != m_skeleton->m_bones.size())
 		{
-			return;
+			BoneTransform bone_transform;
+#if DUAL_QUATERNION_SKINNING
+			bone_transform.real = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+			bone_transform.dual = glm::vec4(0.0f);
+#else
+			bone_transform.matrix = glm::mat4(1.0f);
+#endif
+			m_bone_transforms.assign(m_skeleton->m_bones.size(), bone_transform);
+			m_bone_palette_version++;
 		}
 
-		const auto& animation = animations.front();
-		if (m_time < animation->m_start_time)
+		// without a graph of its own, the animator plays the first animation of its entity
+		if (!m_graph)
 		{
-			m_time = animation->m_start_time;
+			if (!m_animation_component)
+			{
+				m_animation_component = m_parent.lock()->getComponent(AnimationComponent);
+			}
+
+			if (!m_animation_component || m_animation_component->getAnimations().empty())
+			{
+				return;
+			}
+
+			const auto& animations = m_animation_component->getAnimations();
+
+			m_graph = std::make_shared<AnimationGraph>();
+			for (const auto& animation : animations)
+			{
+				m_graph->addState(animation->getName(), m_graph->addClipNode(animation), m_loop);
+			}
+			m_is_default_graph = true;
+			m_is_graph_bound = false;
 		}
 
-		// sampling animation
-		for (const auto& channel : animation->m_channels)
+		// graphs are bound again when the skeleton or the graph changes
+		if (!m_is_graph_bound || !m_graph->isBound())
 		{
-			Bone* bone = m_skeleton_inst.getBone(channel.m_bone_name);
-			if (!bone)
+			m_graph->bind(*m_skeleton);
+			m_is_graph_bound = true;
+			m_is_pose_valid = false;
+
+			// graphs without states leave the bind pose
+			m_pose.resize(m_skeleton->m_bones.size());
+			for (size_t i = 0; i < m_skeleton->m_bones.size(); ++i)
 			{
-				// skip invalid channel
-				continue;
+				m_pose.setTransform(i, m_skeleton->m_bones[i].m_local_bind_pose_transform);
 			}
+		}
 
-			const auto& sampler = animation->m_samplers[channel.m_sampler_index];
-			for (size_t i = 0; i < sampler.m_times.size() - 1; ++i)
+		// culled animators only keep time, and snap to a freshly sampled pose once they're back
+		if (m_is_culled)
+		{
+			m_is_pose_valid = false;
+		}
+		else
+		{
+			// sample when the interval has passed or shortened, distant animators skip their leaf bones
+			uint32_t update_interval = selectUpdateInterval();
+			if (!m_is_pose_valid || ++m_frames_since_sample >= m_update_interval || update_interval < m_update_interval)
 			{
-				if (m_time >= sampler.m_times[i] && m_time <= sampler.m_times[i + 1])
+				m_prev_pose = m_is_pose_valid ? m_output_pose : m_pose;
+				m_graph->evaluate(m_pose, m_screen_size < k_leaf_bone_screen_size);
+				if (!m_is_pose_valid)
 				{
-					float t = (m_time - sampler.m_times[i]) / (sampler.m_times[i + 1] - sampler.m_times[i]);
-					switch (channel.m_path_type)
-					{
-					case AnimationChannel::EPathType::Translation:
-					{
-						glm::vec4 translation = glm::mix(sampler.m_values[i], sampler.m_values[i + 1], t);
-						bone->setTranslation(translation);
-					}
-						break;
-					case AnimationChannel::EPathType::Rotation:
-					{
-						glm::quat q0 = glm::make_quat(glm::value_ptr(sampler.m_values[i]));
-						glm::quat q1 = glm::make_quat(glm::value_ptr(sampler.m_values[i + 1]));
-
-						bone->setRotation(glm::slerp(q0, q1, t));
-					}
-						break;
-					case AnimationChannel::EPathType::Scale:
-					{
-						glm::vec4 scale = glm::mix(sampler.m_values[i], sampler.m_values[i + 1], t);
-						bone->setScale(scale);
-					}
-						break;
-					default:
-					{
-						LOG_FATAL("Unknown animation channel path type {}", channel.m_path_type);
-					}
-						break;
-					}
+					m_prev_pose = m_pose;
 				}
+				m_update_interval = update_interval;
+				m_frames_since_sample = 0;
+				m_is_pose_valid = true;
+			}
+
+			// the sampled pose is reached at the end of the interval
+			float weight = static_cast<float>(m_frames_since_sample + 1) / m_update_interval;
+			if (weight < 1.0f)
+			{
+				Pose::blend(m_output_pose, m_prev_pose, m_pose, weight);
+			}
+			else
+			{
+				m_output_pose = m_pose;
 			}
+
+			// update bone transforms
+			m_skeleton->calcBoneTransforms(m_output_pose, m_bone_transforms.data());
+			m_bone_palette_version++;
+		}
+
+		m_graph->advance(delta_time);
+	}
+
+	uint32_t AnimatorComponent::selectUpdateInterval() const
+	{
+		if (!m_is_visible)
+		{
+			return k_off_screen_update_interval;
 		}
 
-		// update time
-		m_time += delta_time;
-		if (m_loop && m_time > animation->m_end_time)
+		uint32_t update_interval = 1;
+		for (float screen_size : k_update_rate_screen_sizes)
+		{
+			if (m_screen_size >= screen_size)
+			{
+				break;
+			}
+			update_interval *= 2;
+		}
+		return update_interval;
+	}
+
+	uint32_t AnimatorComponent::getBonePaletteSize()
+	{
+		return static_cast<uint32_t>(std::max(m_bone_transforms.size(), static_cast<size_t>(1)) * sizeof(BoneTransform));
+	}
+
+	void AnimatorComponent::setLODState(float screen_size, bool is_visible, bool is_culled)
+	{
+		m_screen_size = screen_size;
+		m_is_visible = is_visible;
+		m_is_culled = is_culled;
+	}
+
+	BoundingBox AnimatorComponent::calcSkinnedBoundingBox(const SkeletalMesh& skeletal_mesh) const
+	{
+		if (m_bone_transforms.empty())
 		{
-			m_time -= animation->m_duration;
+			return skeletal_mesh.m_bounding_box;
 		}
 
-		// update skeleton and bone matrices
-		m_skeleton_inst.update();
-		for (size_t i = 0; i < m_skeleton_inst.m_bones.size(); ++i)
+		BoundingBox bounding_box;
+		size_t bone_count = std::min(skeletal_mesh.m_bone_bounding_boxes.size(), m_bone_transforms.size());
+		for (size_t i = 0; i < bone_count; ++i)
 		{
-			m_bone_ubo.bone_matrices[i] = m_skeleton_inst.m_bones[i].matrix();
+			BoundingBox bone_bounding_box = skeletal_mesh.m_bone_bounding_boxes[i];
+			if (bone_bounding_box.m_min.x > bone_bounding_box.m_max.x)
+			{
+				continue;
+			}
+
+#if DUAL_QUATERNION_SKINNING
+			const BoneTransform& bone_transform = m_bone_transforms[i];
+			glm::quat real(bone_transform.real.w, bone_transform.real.x, bone_transform.real.y, bone_transform.real.z);
+			glm::quat dual(bone_transform.dual.w, bone_transform.dual.x, bone_transform.dual.y, bone_transform.dual.z);
+			glm::quat translation = dual * glm::conjugate(real) * 2.0f;
+			glm::mat4 bone_matrix = glm::mat4_cast(real);
+			bone_matrix[3] = glm::vec4(translation.x, translation.y, translation.z, 1.0f);
+#else
+			const glm::mat4& bone_matrix = m_bone_transforms[i].matrix;
+#endif
+			bounding_box.combine(bone_bounding_box.transform(bone_matrix));
 		}
+		return bounding_box;
+	}
 
-		// update uniform buffers
- 		for (VmaBuffer& bone_ub : m_bone_ubs)
- 		{
- 			VulkanUtil::updateBuffer(bone_ub, (void*)&m_bone_ubo, sizeof(BoneUBO));
- 		}
+	void AnimatorComponent::setAnimationGraph(const std::shared_ptr<AnimationGraph>& graph)
+	{
+		m_graph = graph;
+		m_is_default_graph = false;
+		m_is_graph_bound = false;
 	}
 
 	void AnimatorComponent::play(bool loop)
 	{
 		m_loop = loop;
 		m_playing = true;
-		m_time = 0.0f;
+
+		// the default graph is rebuilt from the start with the new loop mode
+		if (m_is_default_graph)
+		{
+			m_graph = nullptr;
+		}
 	}
 
 	void AnimatorComponent::bindRefs()
 	{
 		BIND_ASSET(m_skeleton, Skeleton)
-		m_skeleton_inst = *m_skeleton;
+		m_is_graph_bound = false;
 	}
 
 }
\ No newline at end of file
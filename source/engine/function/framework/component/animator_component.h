@@ -2,9 +2,14 @@
 
 #include "component.h"
 #include "engine/resource/asset/skeleton.h"
-#include "engine/core/vulkan/vulkan_util.h"
+#include "engine/resource/asset/animation.h"
+#include "engine/resource/asset/skeletal_mesh.h"
+#include "engine/core/math/pose.h"
+#include "engine/function/animation/animation_graph.h"
 #include "host_device.h"
 
+#include <limits>
+
 namespace Bamboo
 {
 	class AnimatorComponent : public Component, public IAssetRef
@@ -16,9 +21,24 @@ namespace Bamboo
 		void setSkeleton(std::shared_ptr<Skeleton>& skeleton);
 		std::shared_ptr<Skeleton> getSkeleton() { return m_skeleton; }
 
+		// the graph played by the animator, by default a graph with a state per animation of the entity playing the first one
+		void setAnimationGraph(const std::shared_ptr<AnimationGraph>& graph);
+		std::shared_ptr<AnimationGraph> getAnimationGraph() { return m_graph; }
+
 		void play(bool loop = true);
 
-		std::vector<VmaBuffer> m_bone_ubs;
+		// offset and size of the animator's bone palette in the animation system's bone buffer,
+		// a palette holds at least one transform so that it can always be bound
+		uint32_t getBonePaletteOffset() { return m_bone_palette_offset; }
+		uint32_t getBonePaletteSize();
+
+		// animation lod, set by render system from the skeletal mesh of the last frame:
+		// its projected size relative to half screen height, whether it's on screen, and whether it's culled with its shadow
+		void setLODState(float screen_size, bool is_visible, bool is_culled);
+
+		// model space bounds of the mesh skinned by the current bone transforms, the union of its bones' posed bounding boxes,
+		// since a skinned vertex is a weighted average of its posed positions. the bind pose bounds until the animator is updated
+		BoundingBox calcSkinnedBoundingBox(const SkeletalMesh& skeletal_mesh) const;
 
 	protected:
 		virtual void inflate() override;
@@ -36,13 +56,38 @@ namespace Bamboo
 
 		virtual void bindRefs() override;
 
+		// sample the animation and evaluate the skeleton's bone matrices, run by the animation system's jobs
+		friend class AnimationSystem;
+		void update(float delta_time);
+
+		uint32_t selectUpdateInterval() const;
+
 		std::shared_ptr<Skeleton> m_skeleton;
-		Skeleton m_skeleton_inst;
 
 		std::shared_ptr<class AnimationComponent> m_animation_component;
-		BoneUBO m_bone_ubo;
+		std::vector<BoneTransform> m_bone_transforms;
+		uint32_t m_bone_palette_offset = 0;
+
+		// the played graph and its sampled pose
+		std::shared_ptr<AnimationGraph> m_graph;
+		bool m_is_default_graph = false;
+		bool m_is_graph_bound = false;
+		Pose m_pose;
+
+		// throttled animators sample every update interval frames, and blend from the previous output pose to the sampled one in between
+		Pose m_prev_pose;
+		Pose m_output_pose;
+		uint32_t m_update_interval = 1;
+		uint32_t m_frames_since_sample = 0;
+		bool m_is_pose_valid = false;
+
+		float m_screen_size = std::numeric_limits<float>::max();
+		bool m_is_visible = true;
+		bool m_is_culled = false;
+
+		// bumped when bone transforms change, so that animation system only uploads changed ones
+		uint32_t m_bone_palette_version = 0;
 
-		float m_time = 0.0f;
 		bool m_loop = true;
 		bool m_playing = false;
 		bool m_paused = false;
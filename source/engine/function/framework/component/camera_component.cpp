@@ -89,6 +89,17 @@ namespace Bamboo
 		return getProjectionMatrixYInverted(m_projection_matrix);
 	}
 
+	glm::mat4 CameraComponent::getJitterMatrix()
+	{
+		// translate clip space xy by jitter * w, so the offset in ndc is the same at any depth
+		return glm::translate(glm::mat4(1.0f), glm::vec3(m_jitter, 0.0f));
+	}
+
+	glm::mat4 CameraComponent::getJitteredViewProjectionMatrix()
+	{
+		return getJitterMatrix() * m_view_projection_matrix;
+	}
+
 	void CameraComponent::setInput(bool mouse_right_button_pressed, bool mouse_focused)
 	{
 		m_mouse_right_button_pressed = mouse_right_button_pressed;
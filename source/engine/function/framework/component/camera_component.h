@@ -25,6 +25,12 @@ namespace Bamboo
 		glm::mat4 getViewMatrixNoTranslation();
 		glm::mat4 getProjectionMatrixNoYInverted();
 
+		// sub-pixel offset of the projection in ndc, which temporal upsampling accumulates over frames
+		void setJitter(const glm::vec2& jitter) { m_jitter = jitter; }
+		const glm::vec2& getJitter() { return m_jitter; }
+		glm::mat4 getJitterMatrix();
+		glm::mat4 getJitteredViewProjectionMatrix();
+
 		std::shared_ptr<class TransformComponent> getTransformComponent() { return m_transform_component; }
 		void setInput(bool mouse_right_button_pressed, bool mouse_focused);
 
@@ -101,6 +107,7 @@ namespace Bamboo
 		glm::mat4 m_view_matrix;
 		glm::mat4 m_projection_matrix;
 		glm::mat4 m_view_projection_matrix;
+		glm::vec2 m_jitter = glm::vec2(0.0f);
 
 		void* m_key_event_handle;
 		void* m_cursor_pos_event_handle;
@@ -7,6 +7,7 @@
 #include "engine/function/render/window_system.h"
 #include "engine/function/framework/world/world_manager.h"
 #include "engine/function/physics/physics_system.h"
+#include "engine/function/animation/animation_system.h"
 #include "engine/function/render/render_system.h"
 #include "engine/function/render/debug_draw_manager.h"
 #include "engine/resource/shader/shader_manager.h"
@@ -45,6 +46,10 @@ namespace Bamboo
 		m_asset_manager = std::make_shared<AssetManager>();
 		m_asset_manager->init();
 
+		// animators register to the animation system when worlds are loaded
+		m_animation_system = std::make_shared<AnimationSystem>();
+        m_animation_system->init();
+
         m_world_manager = std::make_shared<WorldManager>();
         m_world_manager->init();
 
@@ -68,6 +73,7 @@ namespace Bamboo
         m_render_system->destroy();
         m_physics_system->destroy();
         m_world_manager->destroy();
+        m_animation_system->destroy();
 		m_asset_manager->destroy();
         m_shader_manager->destroy();
         VulkanRHI::get().destroy();
@@ -22,6 +22,7 @@ namespace Bamboo
             const auto& assetManager() { return m_asset_manager; }
             const auto& worldManager() { return m_world_manager; }
 			const auto& physicsSystem() { return m_physics_system; }
+			const auto& animationSystem() { return m_animation_system; }
 			const auto& renderSystem() { return m_render_system; }
             const auto& debugDrawSystem() { return m_debug_draw_system; }
 
@@ -48,6 +49,7 @@ namespace Bamboo
 			std::shared_ptr<class AssetManager> m_asset_manager;
 			std::shared_ptr<class WorldManager> m_world_manager;
 			std::shared_ptr<class PhysicsSystem> m_physics_system;
+			std::shared_ptr<class AnimationSystem> m_animation_system;
 			std::shared_ptr<class RenderSystem> m_render_system;
 			std::shared_ptr<class DebugDrawManager> m_debug_draw_system;
 
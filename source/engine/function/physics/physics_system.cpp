@@ -276,6 +276,11 @@ namespace Bamboo
 		is_stepping = true;
 	}
 
+	JPH::JobSystem* PhysicsSystem::getJobSystem()
+	{
+		return m_job_system.get();
+	}
+
 	JPH::Vec3 glmVec3ToJPHVec3(const glm::vec3& v)
 	{
 		return JPH::Vec3(v.x, v.y, v.z);
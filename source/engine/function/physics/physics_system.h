@@ -7,6 +7,7 @@
 namespace JPH
 {
 	class PhysicsSystem;
+	class JobSystem;
 	class JobSystemThreadPool;
 	class TempAllocatorImpl;
 	class BodyInterface;
@@ -29,6 +30,9 @@ namespace Bamboo
 		void destroy();
 		void step();
 
+		// the engine's worker threads, shared with other systems' parallel jobs
+		JPH::JobSystem* getJobSystem();
+
 	private:
 		void tick();
 		void collectRigidbodies();
@@ -7,10 +7,12 @@
 
 namespace Bamboo
 {
+	const uint32_t k_group_size = 16;
 
 	BRDFLUTPass::BRDFLUTPass()
 	{
-		m_format = VK_FORMAT_R16G16_SFLOAT;
+		// the lut is stored as rg16, but written through a rgba16 storage image that needs no extended storage formats
+		m_format = VK_FORMAT_R16G16B16A16_SFLOAT;
 		m_size = 2048;
 	}
 
@@ -23,39 +25,60 @@ namespace Bamboo
 
 	void BRDFLUTPass::render()
 	{
-		// render to framebuffer
-		VkClearValue clear_values[1];
-		clear_values[0].color = { { 0.0f, 0.0f, 0.0f, 1.0f } };
-
-		VkRenderPassBeginInfo render_pass_bi{};
-		render_pass_bi.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-		render_pass_bi.renderPass = m_render_pass;
-		render_pass_bi.renderArea.extent.width = m_width;
-		render_pass_bi.renderArea.extent.height = m_height;
-		render_pass_bi.clearValueCount = 1;
-		render_pass_bi.pClearValues = clear_values;
-		render_pass_bi.framebuffer = m_framebuffer;
-
-		VkCommandBuffer command_buffer = VulkanUtil::beginInstantCommands();
-		vkCmdBeginRenderPass(command_buffer, &render_pass_bi, VK_SUBPASS_CONTENTS_INLINE);
-
-		VkViewport viewport{};
-		viewport.width = static_cast<float>(m_width);
-		viewport.height = static_cast<float>(m_height);
-		viewport.minDepth = 0.0f;
-		viewport.maxDepth = 1.0f;
-
-		VkRect2D scissor{};
-		scissor.extent.width = m_width;
-		scissor.extent.height = m_height;
-
-		vkCmdSetViewport(command_buffer, 0, 1, &viewport);
-		vkCmdSetScissor(command_buffer, 0, 1, &scissor);
-		vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pipelines[0]);
-		vkCmdDraw(command_buffer, 3, 1, 0, 0);
-		vkCmdEndRenderPass(command_buffer);
-
-		VulkanUtil::endInstantCommands(command_buffer);
+		// dispatch brdf lut on the compute queue and read it back on the same queue, this one-off bake waits for completion
+		// since the lut is serialized right away, it doesn't overlap with frame rendering
+		VkCommandBuffer command_buffer = VulkanUtil::beginInstantCommands(true);
+
+		// transition image to general layout for storage writing
+		VkImageMemoryBarrier barrier{};
+		barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+		barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+		barrier.newLayout = VK_IMAGE_LAYOUT_GENERAL;
+		barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barrier.image = m_image_view.image();
+		barrier.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
+		barrier.srcAccessMask = 0;
+		barrier.dstAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+		vkCmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 
+			0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+		// update(push) storage image descriptor
+		VkDescriptorImageInfo desc_image_info{};
+		desc_image_info.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+		desc_image_info.imageView = m_image_view.view;
+
+		VkWriteDescriptorSet desc_write{};
+		desc_write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+		desc_write.dstBinding = 0;
+		desc_write.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+		desc_write.descriptorCount = 1;
+		desc_write.pImageInfo = &desc_image_info;
+		VulkanRHI::get().getVkCmdPushDescriptorSetKHR()(command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE,
+			m_pipeline_layouts[0], 0, 1, &desc_write);
+
+		vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_pipelines[0]);
+		vkCmdDispatch(command_buffer, (m_width + k_group_size - 1) / k_group_size, (m_height + k_group_size - 1) / k_group_size, 1);
+
+		// transition image to transfer src layout for reading back
+		barrier.oldLayout = VK_IMAGE_LAYOUT_GENERAL;
+		barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+		barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+		barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+		vkCmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+			0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+		// copy image to staging buffer
+		VmaBuffer staging_buffer;
+		size_t image_size = m_width * m_height * VulkanUtil::calcFormatSize(m_format);
+		VulkanUtil::createBuffer(image_size, VK_BUFFER_USAGE_TRANSFER_DST_BIT, VMA_MEMORY_USAGE_AUTO_PREFER_HOST, staging_buffer, true);
+
+		VkBufferImageCopy region{};
+		region.imageSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1 };
+		region.imageExtent = { m_width, m_height, 1 };
+		vkCmdCopyImageToBuffer(command_buffer, m_image_view.image(), VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, staging_buffer.buffer, 1, &region);
+
+		VulkanUtil::endInstantCommands(command_buffer, true);
 
 		// write to texture2d
 		std::shared_ptr<Texture2D> texture = std::make_shared<Texture2D>();
@@ -68,8 +91,21 @@ namespace Bamboo
 		texture->m_pixel_type = EPixelType::RG16;
 		texture->m_compression_mode = ETextureCompressionMode::ZSTD;
 
-		VulkanUtil::extractImage(m_image_view.image(), m_width, m_height, m_format, texture->m_image_data, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
-		//VulkanUtil::saveImage(m_image_view.image(), m_width, m_height, m_format, "D:/Test/brdf_lut.bin", VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+		// keep the rg channels of each texel
+		void* mapped_data = nullptr;
+		vmaInvalidateAllocation(VulkanRHI::get().getAllocator(), staging_buffer.allocation, 0, VK_WHOLE_SIZE);
+		vmaMapMemory(VulkanRHI::get().getAllocator(), staging_buffer.allocation, &mapped_data);
+		const uint16_t* texels = reinterpret_cast<const uint16_t*>(mapped_data);
+		size_t texel_count = m_width * m_height;
+		texture->m_image_data.resize(texel_count * 2 * sizeof(uint16_t));
+		uint16_t* image_data = reinterpret_cast<uint16_t*>(texture->m_image_data.data());
+		for (size_t i = 0; i < texel_count; ++i)
+		{
+			image_data[i * 2 + 0] = texels[i * 4 + 0];
+			image_data[i * 2 + 1] = texels[i * 4 + 1];
+		}
+		vmaUnmapMemory(VulkanRHI::get().getAllocator(), staging_buffer.allocation);
+		staging_buffer.destroy();
 
 		texture->inflate();
 		g_engine.assetManager()->serializeAsset(texture);
@@ -77,52 +113,20 @@ namespace Bamboo
 
 	void BRDFLUTPass::createRenderPass()
 	{
-		// color attachment
-		VkAttachmentDescription color_attachment{};
-		color_attachment.format = m_format;
-		color_attachment.samples = VK_SAMPLE_COUNT_1_BIT;
-		color_attachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
-		color_attachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
-		color_attachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
-		color_attachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-		color_attachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-		color_attachment.finalLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-		VkAttachmentReference color_reference = { 0, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL };
-
-		// subpass
-		VkSubpassDescription subpass_desc{};
-		subpass_desc.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
-		subpass_desc.colorAttachmentCount = 1;
-		subpass_desc.pColorAttachments = &color_reference;
-
-		// subpass dependencies
-		std::array<VkSubpassDependency, 1> dependencies{};
-		dependencies[0].srcSubpass = 0;
-		dependencies[0].dstSubpass = VK_SUBPASS_EXTERNAL;
-		dependencies[0].srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-		dependencies[0].dstStageMask = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
-		dependencies[0].srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
-		dependencies[0].dstAccessMask = VK_ACCESS_MEMORY_READ_BIT;
-		dependencies[0].dependencyFlags = 0;
-
-		// create render pass
-		VkRenderPassCreateInfo render_pass_ci{};
-		render_pass_ci.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
-		render_pass_ci.attachmentCount = 1;
-		render_pass_ci.pAttachments = &color_attachment;
-		render_pass_ci.subpassCount = 1;
-		render_pass_ci.pSubpasses = &subpass_desc;
-		render_pass_ci.dependencyCount = static_cast<uint32_t>(dependencies.size());
-		render_pass_ci.pDependencies = dependencies.data();
-
-		VkResult result = vkCreateRenderPass(VulkanRHI::get().getDevice(), &render_pass_ci, nullptr, &m_render_pass);
-		CHECK_VULKAN_RESULT(result, "create render pass");
+		// compute pass, no render pass
 	}
 
 	void BRDFLUTPass::createDescriptorSetLayouts()
 	{
+		VkDescriptorSetLayoutBinding desc_set_layout_binding = {
+			0, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 1, VK_SHADER_STAGE_COMPUTE_BIT, nullptr
+		};
+
 		VkDescriptorSetLayoutCreateInfo desc_set_layout_ci{};
 		desc_set_layout_ci.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+		desc_set_layout_ci.flags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_PUSH_DESCRIPTOR_BIT_KHR;
+		desc_set_layout_ci.bindingCount = 1;
+		desc_set_layout_ci.pBindings = &desc_set_layout_binding;
 
 		m_desc_set_layouts.resize(1);
 		VkResult result = vkCreateDescriptorSetLayout(VulkanRHI::get().getDevice(), &desc_set_layout_ci, nullptr, &m_desc_set_layouts[0]);
@@ -143,55 +147,23 @@ namespace Bamboo
 
 	void BRDFLUTPass::createPipelines()
 	{
-		// disable culling and depth testing
-		m_rasterize_state_ci.cullMode = VK_CULL_MODE_NONE;
-		m_depth_stencil_ci.depthTestEnable = VK_FALSE;
-		m_depth_stencil_ci.depthWriteEnable = VK_FALSE;
-
-		// vertex input state
-		VkPipelineVertexInputStateCreateInfo vertex_input_ci{};
-		vertex_input_ci.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
-
-		// shader stages
-		const auto& shader_manager = g_engine.shaderManager();
-		std::vector<VkPipelineShaderStageCreateInfo> shader_stage_cis = {
-			shader_manager->getShaderStageCI("screen.vert", VK_SHADER_STAGE_VERTEX_BIT),
-			shader_manager->getShaderStageCI("brdf_lut.frag", VK_SHADER_STAGE_FRAGMENT_BIT)
-		};
-		
-		// create graphics pipeline
-		m_pipeline_ci.stageCount = static_cast<uint32_t>(shader_stage_cis.size());
-		m_pipeline_ci.pStages = shader_stage_cis.data();
-		m_pipeline_ci.pVertexInputState = &vertex_input_ci;
-		m_pipeline_ci.layout = m_pipeline_layouts[0];
-		m_pipeline_ci.renderPass = m_render_pass;
-		m_pipeline_ci.subpass = 0;
+		VkComputePipelineCreateInfo compute_pipeline_ci{};
+		compute_pipeline_ci.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+		compute_pipeline_ci.stage = g_engine.shaderManager()->getShaderStageCI("brdf_lut.comp", VK_SHADER_STAGE_COMPUTE_BIT);
+		compute_pipeline_ci.layout = m_pipeline_layouts[0];
 
 		m_pipelines.resize(1);
-		VkResult result = vkCreateGraphicsPipelines(VulkanRHI::get().getDevice(), m_pipeline_cache, 1, &m_pipeline_ci, nullptr, &m_pipelines[0]);
-		CHECK_VULKAN_RESULT(result, "create brdf lut graphics pipeline");
+		VkResult result = vkCreateComputePipelines(VulkanRHI::get().getDevice(), m_pipeline_cache, 1, &compute_pipeline_ci, nullptr, &m_pipelines[0]);
+		CHECK_VULKAN_RESULT(result, "create brdf lut compute pipeline");
 	}
 
 	void BRDFLUTPass::createFramebuffer()
 	{
-		// 1.create color images and view
+		// create storage image and view
 		VulkanUtil::createImageAndView(m_width, m_height, 1, 1, VK_SAMPLE_COUNT_1_BIT, m_format,
-			VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT, 
+			VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT, 
 			VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE,
 			VK_IMAGE_ASPECT_COLOR_BIT, m_image_view);
-
-		// 2.create framebuffer
-		VkFramebufferCreateInfo framebuffer_ci{};
-		framebuffer_ci.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
-		framebuffer_ci.renderPass = m_render_pass;
-		framebuffer_ci.attachmentCount = 1;
-		framebuffer_ci.pAttachments = &m_image_view.view;
-		framebuffer_ci.width = m_width;
-		framebuffer_ci.height = m_height;
-		framebuffer_ci.layers = 1;
-
-		VkResult result = vkCreateFramebuffer(VulkanRHI::get().getDevice(), &framebuffer_ci, nullptr, &m_framebuffer);
-		CHECK_VULKAN_RESULT(result, "create brdf lut graphics pipeline");
 	}
 
 	void BRDFLUTPass::destroyResizableObjects()
@@ -7,6 +7,9 @@
 namespace Bamboo
 {
 
+	// cascades are snapped to a light space grid whose cells are this fraction of their radii
+	const float k_cascade_snap_fraction = 0.125f;
+
 	DirectionalLightShadowPass::DirectionalLightShadowPass()
 	{
 		m_format = VulkanRHI::get().getDepthFormat();
@@ -16,52 +19,104 @@ namespace Bamboo
 
 	void DirectionalLightShadowPass::init()
 	{
-		RenderPass::init();
+		ShadowPass::init();
 
 		// create shadow cascade uniform buffers
-		m_shadow_cascade_ubs.resize(MAX_FRAMES_IN_FLIGHT);
+		m_shadow_cascade_ubs.resize(VulkanRHI::get().getFlightCount());
 		for (VmaBuffer& uniform_buffer : m_shadow_cascade_ubs)
 		{
 			VulkanUtil::createBuffer(sizeof(ShadowCascadeUBO), VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, VMA_MEMORY_USAGE_AUTO_PREFER_HOST, uniform_buffer);
 		}
+		m_shadow_cascade_ub_versions.assign(m_shadow_cascade_ubs.size(), UINT64_MAX);
 
 		createResizableObjects(m_size, m_size);
 	}
 
 	void DirectionalLightShadowPass::render()
 	{
-		VkRenderPassBeginInfo render_pass_bi{};
-		render_pass_bi.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-		render_pass_bi.renderPass = m_render_pass;
-		render_pass_bi.framebuffer = m_framebuffer;
-		render_pass_bi.renderArea.offset = { 0, 0 };
-		render_pass_bi.renderArea.extent = { m_size, m_size };
-
+		VkCommandBuffer command_buffer = VulkanRHI::get().getCommandBuffer();
+		VkImageAspectFlags aspect_flags = VulkanUtil::calcImageAspectFlags(m_format);
 		VkClearValue clear_value{};
 		clear_value.depthStencil = { 1.0f, 0 };
-		render_pass_bi.clearValueCount = 1;
-		render_pass_bi.pClearValues = &clear_value;
 
- 		VkCommandBuffer command_buffer = VulkanRHI::get().getCommandBuffer();
- 		uint32_t flight_index = VulkanRHI::get().getFlightIndex();
+		// cascades are snapped to a grid, so the cache is only refreshed when the camera crosses a cell or the light changes
+		collectShadowCasters();
+		uint64_t cache_key = calcShadowCacheKey(&m_cascade_bounds, sizeof(CascadeBounds));
+		bool is_cache_refreshed = cache_key != m_shadow_cache_key;
+		if (is_cache_refreshed)
+		{
+			m_shadow_cache_key = cache_key;
+
+			// render static casters into the cached shadow cascades
+			VulkanUtil::cmdImageBarrier(command_buffer, m_static_shadow_image_view_sampler.image(), aspect_flags, SHADOW_CASCADE_NUM,
+				VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
+				VK_PIPELINE_STAGE_TRANSFER_BIT, 0,
+				VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT, VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT);
+
+			VkRenderingAttachmentInfo depth_attachment = getRenderingAttachment(m_static_shadow_image_view_sampler.view, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL, clear_value);
+			beginRendering(command_buffer, m_size, m_size, SHADOW_CASCADE_NUM, {}, &depth_attachment);
+			renderMeshes(command_buffer, m_static_render_datas);
+			vkCmdEndRendering(command_buffer);
+
+			VulkanUtil::cmdImageBarrier(command_buffer, m_static_shadow_image_view_sampler.image(), aspect_flags, SHADOW_CASCADE_NUM,
+				VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+				VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT, VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+				VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_READ_BIT);
+		}
 
-		vkCmdBeginRenderPass(command_buffer, &render_pass_bi, VK_SUBPASS_CONTENTS_INLINE);
+		// nothing to do if the shadow cascades still hold the unchanged cache
+		if (!is_cache_refreshed && m_is_shadow_map_cached && m_dynamic_render_datas.empty())
+		{
+			m_render_datas.clear();
+			return;
+		}
+		m_is_shadow_map_cached = m_dynamic_render_datas.empty();
 
-		VkViewport viewport{};
-		viewport.x = 0.0f;
-		viewport.y = 0.0f;
-		viewport.width = static_cast<float>(m_size);
-		viewport.height = static_cast<float>(m_size);
-		viewport.minDepth = 0.0f;
-		viewport.maxDepth = 1.0f;
-		vkCmdSetViewport(command_buffer, 0, 1, &viewport);
+		// copy cached static shadow cascades into the shadow cascades of this frame
+		VkImage shadow_image = m_shadow_image_view_sampler.image();
+		VulkanUtil::cmdImageBarrier(command_buffer, shadow_image, aspect_flags, SHADOW_CASCADE_NUM,
+			VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+			VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0,
+			VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT);
+		VulkanUtil::cmdCopyImage(command_buffer, m_static_shadow_image_view_sampler.image(), shadow_image, aspect_flags, m_size, m_size, SHADOW_CASCADE_NUM);
 
-		VkRect2D scissor{};
-		scissor.offset = { 0, 0 };
-		scissor.extent = { m_size, m_size };
-		vkCmdSetScissor(command_buffer, 0, 1, &scissor);
+		if (m_dynamic_render_datas.empty())
+		{
+			// transition shadow cascades for sampling in lighting shaders
+			VulkanUtil::cmdImageBarrier(command_buffer, shadow_image, aspect_flags, SHADOW_CASCADE_NUM,
+				VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL,
+				VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT,
+				VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT);
+		}
+		else
+		{
+			// render dynamic casters on top of the static ones
+			VulkanUtil::cmdImageBarrier(command_buffer, shadow_image, aspect_flags, SHADOW_CASCADE_NUM,
+				VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
+				VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT,
+				VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT, VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT);
+
+			VkRenderingAttachmentInfo depth_attachment = getRenderingAttachment(m_shadow_image_view_sampler.view, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL, clear_value);
+			depth_attachment.loadOp = VK_ATTACHMENT_LOAD_OP_LOAD;
+			beginRendering(command_buffer, m_size, m_size, SHADOW_CASCADE_NUM, {}, &depth_attachment);
+			renderMeshes(command_buffer, m_dynamic_render_datas);
+			vkCmdEndRendering(command_buffer);
+
+			// transition shadow cascades for sampling in lighting shaders
+			VulkanUtil::cmdImageBarrier(command_buffer, shadow_image, aspect_flags, SHADOW_CASCADE_NUM,
+				VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL, VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL,
+				VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT, VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+				VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT);
+		}
+
+		m_render_datas.clear();
+	}
 
-		for (const auto& render_data : m_render_datas)
+	void DirectionalLightShadowPass::renderMeshes(VkCommandBuffer command_buffer, const std::vector<std::shared_ptr<RenderData>>& render_datas)
+	{
+		uint32_t flight_index = VulkanRHI::get().getFlightIndex();
+
+		for (const auto& render_data : render_datas)
 		{
 			std::shared_ptr<SkeletalMeshRenderData> skeletal_mesh_render_data = nullptr;
 			std::shared_ptr<StaticMeshRenderData> static_mesh_render_data = std::static_pointer_cast<StaticMeshRenderData>(render_data);
@@ -71,27 +126,38 @@ namespace Bamboo
 				skeletal_mesh_render_data = std::static_pointer_cast<SkeletalMeshRenderData>(render_data);
 			}
 
-			uint32_t pipeline_index = (uint32_t)is_skeletal_mesh;
+			// cull cascades which can't see the caster
+			uint32_t layer_mask = calcVisibleLayerMask(static_mesh_render_data->bounding_box, m_shadow_cascade_ubo.cascade_view_projs, SHADOW_CASCADE_NUM);
+			if (layer_mask == 0)
+			{
+				continue;
+			}
+			uint32_t layer_count;
+			uint32_t layer_indices = packLayerIndices(layer_mask, layer_count);
+			uint32_t instance_count = m_is_layered ? layer_count : 1;
+
+			uint32_t layout_index = (uint32_t)is_skeletal_mesh;
+			uint32_t pipeline_index = layout_index + (m_is_layered ? 2 : 0);
 			VkPipeline pipeline = m_pipelines[pipeline_index];
-			VkPipelineLayout pipeline_layout = m_pipeline_layouts[pipeline_index];
+			VkPipelineLayout pipeline_layout = m_pipeline_layouts[layout_index];
 
 			// bind pipeline
 			vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
 
-			// bind vertex and index buffer
+			// bind vertex buffer, index buffers are bound per sub mesh index type
 			VkBuffer vertexBuffers[] = { static_mesh_render_data->vertex_buffer.buffer };
 			VkDeviceSize offsets[] = { 0 };
 			vkCmdBindVertexBuffers(command_buffer, 0, 1, vertexBuffers, offsets);
-			vkCmdBindIndexBuffer(command_buffer, static_mesh_render_data->index_buffer.buffer, 0, VK_INDEX_TYPE_UINT32);
 
 			// render all sub meshes
-			std::vector<uint32_t>& index_counts = static_mesh_render_data->index_counts;
-			std::vector<uint32_t>& index_offsets = static_mesh_render_data->index_offsets;
+			std::vector<uint32_t>& index_counts = static_mesh_render_data->shadow_index_counts;
+			std::vector<uint32_t>& index_offsets = static_mesh_render_data->shadow_index_offsets;
 			size_t sub_mesh_count = index_counts.size();
+			VkIndexType index_type = VK_INDEX_TYPE_MAX_ENUM;
 			for (size_t i = 0; i < sub_mesh_count; ++i)
 			{
 				// push constants
-				updatePushConstants(command_buffer, pipeline_layout, { &static_mesh_render_data->transform_pco });
+				updatePushConstants(command_buffer, pipeline_layout, { &static_mesh_render_data->transform_pco, &layer_indices });
 
 				// update(push) sub mesh descriptors
 				std::vector<VkWriteDescriptorSet> desc_writes;
@@ -101,7 +167,8 @@ namespace Bamboo
 				// bone matrix ubo
 				if (is_skeletal_mesh)
 				{
-					addBufferDescriptorSet(desc_writes, desc_buffer_infos[0], skeletal_mesh_render_data->bone_ubs[flight_index], 0);
+					addBufferDescriptorSet(desc_writes, desc_buffer_infos[0], skeletal_mesh_render_data->bone_palette, 0,
+						VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, skeletal_mesh_render_data->bone_palette_offset, skeletal_mesh_render_data->bone_palette_size);
 				}
 
 				// shadow cascade ubo
@@ -114,17 +181,19 @@ namespace Bamboo
 					pipeline_layout, 0, static_cast<uint32_t>(desc_writes.size()), desc_writes.data());
 
 				// render sub mesh
-				vkCmdDrawIndexed(command_buffer, index_counts[i], 1, index_offsets[i], 0, 0);
+				if (static_mesh_render_data->index_types[i] != index_type)
+				{
+					index_type = static_mesh_render_data->index_types[i];
+					vkCmdBindIndexBuffer(command_buffer, static_mesh_render_data->index_buffer.buffer, 0, index_type);
+				}
+				vkCmdDrawIndexed(command_buffer, index_counts[i], instance_count, index_offsets[i], static_mesh_render_data->vertex_offsets[i], 0);
 			}
 		}
-
-		vkCmdEndRenderPass(command_buffer);
-		m_render_datas.clear();
 	}
 
 	void DirectionalLightShadowPass::destroy()
 	{
-		RenderPass::destroy();
+		ShadowPass::destroy();
 
 		// destroy shadow cascade uniform buffers
 		for (VmaBuffer& uniform_buffer : m_shadow_cascade_ubs)
@@ -135,59 +204,13 @@ namespace Bamboo
 
 	void DirectionalLightShadowPass::createRenderPass()
 	{
-		// depth attachment
-		VkAttachmentDescription depth_attachment{};
-		depth_attachment.format = m_format;
-		depth_attachment.samples = VK_SAMPLE_COUNT_1_BIT;
-		depth_attachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
-		depth_attachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
-		depth_attachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
-		depth_attachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-		depth_attachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-		depth_attachment.finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL;
-		VkAttachmentReference depth_reference = { 0, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL };
-
-		// subpass
-		VkSubpassDescription subpass_desc{};
-		subpass_desc.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
-		subpass_desc.pDepthStencilAttachment = &depth_reference;
-
-		// subpass dependencies
-		std::array<VkSubpassDependency, 2> dependencies{};
-		dependencies[0].srcSubpass = VK_SUBPASS_EXTERNAL;
-		dependencies[0].dstSubpass = 0;
-		dependencies[0].srcStageMask = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
-		dependencies[0].dstStageMask = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
-		dependencies[0].srcAccessMask = VK_ACCESS_SHADER_READ_BIT;
-		dependencies[0].dstAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
-		dependencies[0].dependencyFlags = 0;
-
-		dependencies[1].srcSubpass = 0;
-		dependencies[1].dstSubpass = VK_SUBPASS_EXTERNAL;
-		dependencies[1].srcStageMask = VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
-		dependencies[1].dstStageMask = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
-		dependencies[1].srcAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
-		dependencies[1].dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
-		dependencies[1].dependencyFlags = 0;
-
-		// create render pass
-		VkRenderPassCreateInfo render_pass_ci{};
-		render_pass_ci.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
-		render_pass_ci.attachmentCount = 1;
-		render_pass_ci.pAttachments = &depth_attachment;
-		render_pass_ci.subpassCount = 1;
-		render_pass_ci.pSubpasses = &subpass_desc;
-		render_pass_ci.dependencyCount = static_cast<uint32_t>(dependencies.size());
-		render_pass_ci.pDependencies = dependencies.data();
-
-		VkResult result = vkCreateRenderPass(VulkanRHI::get().getDevice(), &render_pass_ci, nullptr, &m_render_pass);
-		CHECK_VULKAN_RESULT(result, "create render pass");
+		// rendered with dynamic rendering, no render pass object is needed
 	}
 
 	void DirectionalLightShadowPass::createDescriptorSetLayouts()
 	{
 		std::vector<VkDescriptorSetLayoutBinding> desc_set_layout_bindings = {
-			{1, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1, VK_SHADER_STAGE_GEOMETRY_BIT, nullptr},
+			{1, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1, VK_SHADER_STAGE_GEOMETRY_BIT | VK_SHADER_STAGE_VERTEX_BIT, nullptr},
 			{2, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_FRAGMENT_BIT, nullptr}
 		};
 
@@ -201,7 +224,7 @@ namespace Bamboo
 		VkResult result = vkCreateDescriptorSetLayout(VulkanRHI::get().getDevice(), &desc_set_layout_ci, nullptr, &m_desc_set_layouts[0]);
 		CHECK_VULKAN_RESULT(result, "create static mesh descriptor set layout");
 
-		desc_set_layout_bindings.insert(desc_set_layout_bindings.begin(), { 0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1, VK_SHADER_STAGE_VERTEX_BIT, nullptr });
+		desc_set_layout_bindings.insert(desc_set_layout_bindings.begin(), { 0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_VERTEX_BIT, nullptr });
 		desc_set_layout_ci.bindingCount = static_cast<uint32_t>(desc_set_layout_bindings.size());
 		desc_set_layout_ci.pBindings = desc_set_layout_bindings.data(); 
 		result = vkCreateDescriptorSetLayout(VulkanRHI::get().getDevice(), &desc_set_layout_ci, nullptr, &m_desc_set_layouts[1]);
@@ -213,6 +236,7 @@ namespace Bamboo
 		m_push_constant_ranges =
 		{
 			{ VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(TransformPCO) },
+			{ VK_SHADER_STAGE_VERTEX_BIT, sizeof(TransformPCO), sizeof(uint32_t) }
 		};
 
 		VkPipelineLayoutCreateInfo pipeline_layout_ci{};
@@ -234,31 +258,10 @@ namespace Bamboo
 	void DirectionalLightShadowPass::createPipelines()
 	{
 		// vertex input state
-		// vertex bindings
+		// static mesh vertex bindings and attributes
 		std::vector<VkVertexInputBindingDescription> vertex_input_binding_descriptions;
-		vertex_input_binding_descriptions.resize(1, VkVertexInputBindingDescription{});
-		vertex_input_binding_descriptions[0].binding = 0;
-		vertex_input_binding_descriptions[0].stride = sizeof(StaticVertex);
-		vertex_input_binding_descriptions[0].inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
-
-		// static mesh vertex attributes
 		std::vector<VkVertexInputAttributeDescription> vertex_input_attribute_descriptions;
-		vertex_input_attribute_descriptions.resize(3, VkVertexInputAttributeDescription{});
-
-		vertex_input_attribute_descriptions[0].binding = 0;
-		vertex_input_attribute_descriptions[0].location = 0;
-		vertex_input_attribute_descriptions[0].format = VK_FORMAT_R32G32B32_SFLOAT;
-		vertex_input_attribute_descriptions[0].offset = offsetof(StaticVertex, m_position);
-
-		vertex_input_attribute_descriptions[1].binding = 0;
-		vertex_input_attribute_descriptions[1].location = 1;
-		vertex_input_attribute_descriptions[1].format = VK_FORMAT_R32G32_SFLOAT;
-		vertex_input_attribute_descriptions[1].offset = offsetof(StaticVertex, m_tex_coord);
-
-		vertex_input_attribute_descriptions[2].binding = 0;
-		vertex_input_attribute_descriptions[2].location = 2;
-		vertex_input_attribute_descriptions[2].format = VK_FORMAT_R32G32B32_SFLOAT;
-		vertex_input_attribute_descriptions[2].offset = offsetof(StaticVertex, m_normal);
+		Mesh::getVertexInputDescriptions(false, vertex_input_binding_descriptions, vertex_input_attribute_descriptions);
 
 		VkPipelineVertexInputStateCreateInfo vertex_input_ci{};
 		vertex_input_ci.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
@@ -280,26 +283,14 @@ namespace Bamboo
 		m_pipeline_ci.pStages = shader_stage_cis.data();
 		m_pipeline_ci.pVertexInputState = &vertex_input_ci;
 		m_pipeline_ci.layout = m_pipeline_layouts[0];
-		m_pipeline_ci.renderPass = m_render_pass;
-		m_pipeline_ci.subpass = 0;
+		setRenderingFormats({}, m_format);
 
-		m_pipelines.resize(2);
+		m_pipelines.resize(m_is_layered ? 4 : 2);
 		VkResult result = vkCreateGraphicsPipelines(VulkanRHI::get().getDevice(), m_pipeline_cache, 1, &m_pipeline_ci, nullptr, &m_pipelines[0]);
 		CHECK_VULKAN_RESULT(result, "create directional light shadow pass's static mesh graphics pipeline");
 
-		// skeletal mesh vertex attributes
-		vertex_input_binding_descriptions[0].stride = sizeof(SkeletalVertex);
-
-		vertex_input_attribute_descriptions.resize(5);
-		vertex_input_attribute_descriptions[3].binding = 0;
-		vertex_input_attribute_descriptions[3].location = 3;
-		vertex_input_attribute_descriptions[3].format = VK_FORMAT_R32G32B32A32_SINT;
-		vertex_input_attribute_descriptions[3].offset = offsetof(SkeletalVertex, m_bones);
-
-		vertex_input_attribute_descriptions[4].binding = 0;
-		vertex_input_attribute_descriptions[4].location = 4;
-		vertex_input_attribute_descriptions[4].format = VK_FORMAT_R32G32B32A32_SFLOAT;
-		vertex_input_attribute_descriptions[4].offset = offsetof(SkeletalVertex, m_weights);
+		// skeletal mesh vertex bindings and attributes
+		Mesh::getVertexInputDescriptions(true, vertex_input_binding_descriptions, vertex_input_attribute_descriptions);
 
 		vertex_input_ci.vertexAttributeDescriptionCount = static_cast<uint32_t>(vertex_input_attribute_descriptions.size());
 		vertex_input_ci.pVertexAttributeDescriptions = vertex_input_attribute_descriptions.data();
@@ -308,6 +299,30 @@ namespace Bamboo
 		shader_stage_cis[0] = shader_manager->getShaderStageCI("skeletal_mesh.vert", VK_SHADER_STAGE_VERTEX_BIT);
 		result = vkCreateGraphicsPipelines(VulkanRHI::get().getDevice(), m_pipeline_cache, 1, &m_pipeline_ci, nullptr, &m_pipelines[1]);
 		CHECK_VULKAN_RESULT(result, "create directional light shadow pass's static mesh graphics pipeline");
+
+		if (!m_is_layered)
+		{
+			return;
+		}
+
+		// layered pipelines select cascades in vertex shaders, without the geometry shader
+		shader_stage_cis = {
+			shader_manager->getShaderStageCI("directional_light_shadow_layered_skeletal.vert", VK_SHADER_STAGE_VERTEX_BIT),
+			shader_manager->getShaderStageCI("directional_light_shadow.frag", VK_SHADER_STAGE_FRAGMENT_BIT)
+		};
+		m_pipeline_ci.stageCount = static_cast<uint32_t>(shader_stage_cis.size());
+		m_pipeline_ci.pStages = shader_stage_cis.data();
+		result = vkCreateGraphicsPipelines(VulkanRHI::get().getDevice(), m_pipeline_cache, 1, &m_pipeline_ci, nullptr, &m_pipelines[3]);
+		CHECK_VULKAN_RESULT(result, "create directional light shadow pass's layered skeletal mesh graphics pipeline");
+
+		Mesh::getVertexInputDescriptions(false, vertex_input_binding_descriptions, vertex_input_attribute_descriptions);
+		vertex_input_ci.vertexAttributeDescriptionCount = static_cast<uint32_t>(vertex_input_attribute_descriptions.size());
+		vertex_input_ci.pVertexAttributeDescriptions = vertex_input_attribute_descriptions.data();
+
+		m_pipeline_ci.layout = m_pipeline_layouts[0];
+		shader_stage_cis[0] = shader_manager->getShaderStageCI("directional_light_shadow_layered.vert", VK_SHADER_STAGE_VERTEX_BIT);
+		result = vkCreateGraphicsPipelines(VulkanRHI::get().getDevice(), m_pipeline_cache, 1, &m_pipeline_ci, nullptr, &m_pipelines[2]);
+		CHECK_VULKAN_RESULT(result, "create directional light shadow pass's layered static mesh graphics pipeline");
 	}
 
 	void DirectionalLightShadowPass::createFramebuffer()
@@ -315,32 +330,28 @@ namespace Bamboo
 		// create depth image view sampler
 		VulkanUtil::createImageViewSampler(m_size, m_size, nullptr, 1, SHADOW_CASCADE_NUM, m_format,
 			VK_FILTER_LINEAR, VK_FILTER_LINEAR, VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE, m_shadow_image_view_sampler,
-			VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT);
+			VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT);
 
-		// create framebuffer
-		VkFramebufferCreateInfo framebuffer_ci{};
-		framebuffer_ci.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
-		framebuffer_ci.renderPass = m_render_pass;
-		framebuffer_ci.attachmentCount = 1;
-		framebuffer_ci.pAttachments = &m_shadow_image_view_sampler.view;
-		framebuffer_ci.width = m_size;
-		framebuffer_ci.height = m_size;
-		framebuffer_ci.layers = SHADOW_CASCADE_NUM;
-
-		VkResult result = vkCreateFramebuffer(VulkanRHI::get().getDevice(), &framebuffer_ci, nullptr, &m_framebuffer);
-		CHECK_VULKAN_RESULT(result, "create directional light shadow framebuffer");
+		// create cached static shadow cascades
+		VulkanUtil::createImageViewSampler(m_size, m_size, nullptr, 1, SHADOW_CASCADE_NUM, m_format,
+			VK_FILTER_LINEAR, VK_FILTER_LINEAR, VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE, m_static_shadow_image_view_sampler,
+			VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT);
+		m_shadow_cache_key = 0;
+		m_is_shadow_map_cached = false;
 	}
 
 	void DirectionalLightShadowPass::destroyResizableObjects()
 	{
 		m_shadow_image_view_sampler.destroy();
+		m_static_shadow_image_view_sampler.destroy();
 
-		RenderPass::destroyResizableObjects();
+		ShadowPass::destroyResizableObjects();
 	}
 
 	void DirectionalLightShadowPass::updateCascades(const ShadowCascadeCreateInfo& shadow_cascade_ci)
 	{
 		float cascade_splits[SHADOW_CASCADE_NUM];
+		ShadowCascadeUBO shadow_cascade_ubo;
 
 		float near = shadow_cascade_ci.camera_near;
 		float far = shadow_cascade_ci.camera_far;
@@ -365,6 +376,9 @@ namespace Bamboo
 		}
 
 		// Calculate orthographic projection matrix for each cascade
+		glm::mat4 light_rotation = glm::lookAtRH(glm::vec3(0.0f), shadow_cascade_ci.light_dir, k_up_vector);
+		glm::mat4 inv_light_rotation = glm::transpose(light_rotation);
+		m_cascade_bounds.light_dir_near = glm::vec4(shadow_cascade_ci.light_dir, cascade_frustum_near);
 		float last_cascade_split = 0.0f;
 		for (uint32_t c = 0; c < SHADOW_CASCADE_NUM; ++c)
 		{
@@ -410,20 +424,43 @@ namespace Bamboo
 				radius = std::max(radius, distance);
 			}
 
+			// the radius only depends on the camera's projection, quantize it so that float noise doesn't move the cascade,
+			// then snap the center to whole texel cells in light space, the cascade is padded by a cell to still cover the slice
+			float radius_step = std::exp2(std::floor(std::log2(std::max(radius, 1e-3f)))) / 16.0f;
+			radius = std::ceil(radius / radius_step) * radius_step;
+			float padded_radius = radius * (1.0f + k_cascade_snap_fraction);
+			float texel_size = 2.0f * padded_radius / m_size;
+			float cell_size = std::max(std::floor(radius * k_cascade_snap_fraction / texel_size), 1.0f) * texel_size;
+			glm::vec3 light_space_center = glm::vec3(light_rotation * glm::vec4(frustum_center, 1.0f));
+			light_space_center = glm::floor(light_space_center / cell_size + 0.5f) * cell_size;
+			frustum_center = glm::vec3(inv_light_rotation * glm::vec4(light_space_center, 1.0f));
+			radius = padded_radius;
+			m_cascade_bounds.spheres[c] = glm::vec4(frustum_center, radius);
+
 			glm::mat4 light_view = glm::lookAtRH(frustum_center - shadow_cascade_ci.light_dir * radius, frustum_center, k_up_vector);
 			glm::mat4 light_proj = glm::orthoRH_ZO(-radius, radius, -radius, radius, cascade_frustum_near, radius * 2.0f);
 			light_proj[1][1] *= -1.0f;
 
 			// Store split distance and matrix in cascade
-			m_shadow_cascade_ubo.cascade_view_projs[c] = light_proj * light_view;
+			shadow_cascade_ubo.cascade_view_projs[c] = light_proj * light_view;
 			m_cascade_splits[c] = -(near + cascade_split * range);
 
 			last_cascade_split = cascade_split;
 		}
 
-		// update uniform buffers
-		VmaBuffer uniform_buffer = m_shadow_cascade_ubs[VulkanRHI::get().getFlightIndex()];
-		VulkanUtil::updateBuffer(uniform_buffer, (void*)&m_shadow_cascade_ubo, sizeof(ShadowCascadeUBO));
+		// update uniform buffers of the flights which haven't seen the current cascades
+		if (memcmp(&shadow_cascade_ubo, &m_shadow_cascade_ubo, sizeof(ShadowCascadeUBO)) != 0)
+		{
+			m_shadow_cascade_ubo = shadow_cascade_ubo;
+			m_shadow_cascade_version++;
+		}
+
+		uint32_t flight_index = VulkanRHI::get().getFlightIndex();
+		if (m_shadow_cascade_ub_versions[flight_index] != m_shadow_cascade_version)
+		{
+			VulkanUtil::updateBuffer(m_shadow_cascade_ubs[flight_index], (void*)&m_shadow_cascade_ubo, sizeof(ShadowCascadeUBO));
+			m_shadow_cascade_ub_versions[flight_index] = m_shadow_cascade_version;
+		}
 	}
 
 }
\ No newline at end of file
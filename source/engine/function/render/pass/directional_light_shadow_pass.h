@@ -1,10 +1,10 @@
 #pragma once
 
-#include "render_pass.h"
+#include "shadow_pass.h"
 
 namespace Bamboo
 {
-	class DirectionalLightShadowPass : public RenderPass
+	class DirectionalLightShadowPass : public ShadowPass
 	{
 	public:
 		DirectionalLightShadowPass();
@@ -27,11 +27,30 @@ namespace Bamboo
 		float m_cascade_splits[SHADOW_CASCADE_NUM];
 
 	private:
+		void renderMeshes(VkCommandBuffer command_buffer, const std::vector<std::shared_ptr<RenderData>>& render_datas);
+
 		VkFormat m_format;
 		uint32_t m_size;
 		float m_cascade_split_lambda;
 
+		// snapped cascade bounds key the static shadow cache together with the light, instead of the camera dependent matrices
+		struct CascadeBounds
+		{
+			glm::vec4 light_dir_near;
+			glm::vec4 spheres[SHADOW_CASCADE_NUM];
+		};
+
 		VmaImageViewSampler m_shadow_image_view_sampler;
+		VmaImageViewSampler m_static_shadow_image_view_sampler;
+		CascadeBounds m_cascade_bounds;
+		uint64_t m_shadow_cache_key = 0;
+
+		// the shadow cascades hold nothing but the cached static casters, so they don't need to be copied again
+		bool m_is_shadow_map_cached = false;
+
+		// uniform buffers are only uploaded when the cascades change
 		std::vector<VmaBuffer> m_shadow_cascade_ubs;
+		std::vector<uint64_t> m_shadow_cascade_ub_versions;
+		uint64_t m_shadow_cascade_version = 0;
 	};
 }
\ No newline at end of file
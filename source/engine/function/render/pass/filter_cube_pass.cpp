@@ -159,10 +159,11 @@ namespace Bamboo
 					VkBuffer vertexBuffers[] = { m_skybox_mesh->m_vertex_buffer.buffer};
 					VkDeviceSize offsets[] = { 0 };
 					vkCmdBindVertexBuffers(command_buffer, 0, 1, vertexBuffers, offsets);
-					vkCmdBindIndexBuffer(command_buffer, m_skybox_mesh->m_index_buffer.buffer, 0, VK_INDEX_TYPE_UINT32);
+					const SubMesh& sub_mesh = m_skybox_mesh->m_sub_meshes[0];
+					vkCmdBindIndexBuffer(command_buffer, m_skybox_mesh->m_index_buffer.buffer, 0, m_skybox_mesh->getIndexType(sub_mesh));
 
 					// draw indexed mesh
-					vkCmdDrawIndexed(command_buffer, m_skybox_mesh->m_sub_meshes[0].m_index_count, 1, m_skybox_mesh->m_sub_meshes[0].m_index_offset, 0, 0);
+					vkCmdDrawIndexed(command_buffer, sub_mesh.m_index_count, 1, m_skybox_mesh->getFirstIndex(sub_mesh, sub_mesh.m_index_offset), sub_mesh.m_vertex_offset, 0);
 
 					vkCmdEndRenderPass(command_buffer);
 
@@ -346,21 +347,11 @@ namespace Bamboo
 			m_depth_stencil_ci.depthWriteEnable = VK_FALSE;
 
 			// vertex input state
-			// vertex bindings
+			// vertex bindings and attributes, only the position is used
 			std::vector<VkVertexInputBindingDescription> vertex_input_binding_descriptions;
-			vertex_input_binding_descriptions.resize(1, VkVertexInputBindingDescription{});
-			vertex_input_binding_descriptions[0].binding = 0;
-			vertex_input_binding_descriptions[0].stride = sizeof(StaticVertex);
-			vertex_input_binding_descriptions[0].inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
-
-			// vertex attributes
 			std::vector<VkVertexInputAttributeDescription> vertex_input_attribute_descriptions;
-			vertex_input_attribute_descriptions.resize(1, VkVertexInputAttributeDescription{});
-
-			vertex_input_attribute_descriptions[0].binding = 0;
-			vertex_input_attribute_descriptions[0].location = 0;
-			vertex_input_attribute_descriptions[0].format = VK_FORMAT_R32G32B32_SFLOAT;
-			vertex_input_attribute_descriptions[0].offset = offsetof(StaticVertex, m_position);
+			Mesh::getVertexInputDescriptions(false, vertex_input_binding_descriptions, vertex_input_attribute_descriptions);
+			vertex_input_attribute_descriptions.resize(1);
 
 			VkPipelineVertexInputStateCreateInfo vertex_input_ci{};
 			vertex_input_ci.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
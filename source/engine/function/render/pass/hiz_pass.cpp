@@ -0,0 +1,371 @@
+#include "hiz_pass.h"
+
+#include "engine/core/vulkan/vulkan_rhi.h"
+#include "engine/resource/shader/shader_manager.h"
+
+#include <array>
+#include <algorithm>
+
+namespace Bamboo
+{
+	const uint32_t k_group_size = 16;
+
+	// levels no larger than this are read back for cpu occlusion tests
+	const uint32_t k_max_readback_size = 128;
+
+	// the finest level whose texels cover a bounding box's screen rect with this many texels per axis is tested
+	const uint32_t k_max_test_texel_count = 4;
+
+	static uint32_t floorPowerOfTwo(uint32_t value)
+	{
+		uint32_t result = 1;
+		while (result * 2 <= value)
+		{
+			result *= 2;
+		}
+		return result;
+	}
+
+	HiZPass::HiZPass()
+	{
+		m_format = VK_FORMAT_R32_SFLOAT;
+	}
+
+	void HiZPass::render()
+	{
+		VkCommandBuffer command_buffer = VulkanRHI::get().getCommandBuffer();
+		uint32_t flight_index = VulkanRHI::get().getFlightIndex();
+
+		// main pass leaves depth in attachment layout, sample it in compute shader
+		VkFormat depth_format = VulkanRHI::get().getDepthFormat();
+		VulkanUtil::cmdImageBarrier(command_buffer, m_p_depth_texture->vma_image.image, VulkanUtil::calcImageAspectFlags(depth_format), 1,
+			VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL, VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL,
+			VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT, VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+			VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT);
+
+		// the previous pyramid has been read back, discard it
+		uint32_t mip_count = static_cast<uint32_t>(m_levels.size());
+		imageBarrier(command_buffer, 0, mip_count, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL,
+			VK_PIPELINE_STAGE_TRANSFER_BIT, 0, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_WRITE_BIT);
+
+		vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_pipelines[0]);
+
+		// reduce depth into level 0, then every level into the next one
+		for (uint32_t i = 0; i < mip_count; ++i)
+		{
+			std::array<VkDescriptorImageInfo, 2> desc_image_infos{};
+			desc_image_infos[0].sampler = m_sampler;
+			desc_image_infos[0].imageView = i == 0 ? m_depth_view : m_mip_views[i - 1];
+			desc_image_infos[0].imageLayout = i == 0 ? VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL : VK_IMAGE_LAYOUT_GENERAL;
+			desc_image_infos[1].imageView = m_mip_views[i];
+			desc_image_infos[1].imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+
+			std::array<VkWriteDescriptorSet, 2> desc_writes{};
+			for (uint32_t b = 0; b < 2; ++b)
+			{
+				desc_writes[b].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+				desc_writes[b].dstBinding = b;
+				desc_writes[b].descriptorType = b == 0 ? VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER : VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+				desc_writes[b].descriptorCount = 1;
+				desc_writes[b].pImageInfo = &desc_image_infos[b];
+			}
+			VulkanRHI::get().getVkCmdPushDescriptorSetKHR()(command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE,
+				m_pipeline_layouts[0], 0, static_cast<uint32_t>(desc_writes.size()), desc_writes.data());
+
+			const HiZLevel& level = m_levels[i];
+			glm::ivec4 sizes = i == 0 ? glm::ivec4(m_depth_extent.width, m_depth_extent.height, level.width, level.height) :
+				glm::ivec4(m_levels[i - 1].width, m_levels[i - 1].height, level.width, level.height);
+			updatePushConstants(command_buffer, m_pipeline_layouts[0], { &sizes });
+
+			vkCmdDispatch(command_buffer, (level.width + k_group_size - 1) / k_group_size, (level.height + k_group_size - 1) / k_group_size, 1);
+
+			// the level is read by the next dispatch
+			imageBarrier(command_buffer, i, 1, VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_GENERAL,
+				VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_WRITE_BIT,
+				VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_TRANSFER_READ_BIT);
+		}
+
+		// copy coarse levels to the readback buffer of current flight
+		std::vector<VkBufferImageCopy> regions;
+		for (uint32_t i = m_readback_base_mip; i < mip_count; ++i)
+		{
+			const HiZLevel& level = m_levels[i];
+
+			VkBufferImageCopy region{};
+			region.bufferOffset = level.offset * sizeof(float);
+			region.imageSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, i, 0, 1 };
+			region.imageExtent = { level.width, level.height, 1 };
+			regions.push_back(region);
+		}
+		vkCmdCopyImageToBuffer(command_buffer, m_pyramid_image.image, VK_IMAGE_LAYOUT_GENERAL, m_readback_buffers[flight_index].buffer,
+			static_cast<uint32_t>(regions.size()), regions.data());
+
+		m_readback_view_projs[flight_index] = m_camera_view_proj;
+		m_readback_valids[flight_index] = true;
+	}
+
+	bool HiZPass::isEnabled()
+	{
+		return RenderPass::isEnabled() && m_is_enabled && m_p_depth_texture && m_depth_extent.width > 0 && m_depth_extent.height > 0;
+	}
+
+	void HiZPass::setEnabled(bool is_enabled)
+	{
+		// readbacks left from before the pass was disabled may be stale for moved objects
+		if (!is_enabled)
+		{
+			std::fill(m_readback_valids.begin(), m_readback_valids.end(), false);
+		}
+		m_is_enabled = is_enabled;
+	}
+
+	void HiZPass::fetchOcclusionDepths()
+	{
+		uint32_t flight_index = VulkanRHI::get().getFlightIndex();
+		m_is_occlusion_valid = isEnabled() && m_readback_valids[flight_index];
+		if (!m_is_occlusion_valid)
+		{
+			return;
+		}
+
+		VmaBuffer& readback_buffer = m_readback_buffers[flight_index];
+		void* mapped_data = nullptr;
+		vmaInvalidateAllocation(VulkanRHI::get().getAllocator(), readback_buffer.allocation, 0, VK_WHOLE_SIZE);
+		vmaMapMemory(VulkanRHI::get().getAllocator(), readback_buffer.allocation, &mapped_data);
+		m_occlusion_depths.resize(m_readback_size);
+		memcpy(m_occlusion_depths.data(), mapped_data, m_readback_size * sizeof(float));
+		vmaUnmapMemory(VulkanRHI::get().getAllocator(), readback_buffer.allocation);
+
+		m_occlusion_view_proj = m_readback_view_projs[flight_index];
+	}
+
+	bool HiZPass::isOccluded(const BoundingBox& bounding_box) const
+	{
+		if (!m_is_occlusion_valid)
+		{
+			return false;
+		}
+
+		// screen rect and nearest depth of the bounding box
+		const glm::vec3& min = bounding_box.m_min;
+		const glm::vec3& max = bounding_box.m_max;
+		glm::vec2 rect_min(1.0f), rect_max(0.0f);
+		float min_depth = 1.0f;
+		for (uint32_t i = 0; i < 8; ++i)
+		{
+			glm::vec4 corner((i & 1) ? max.x : min.x, (i & 2) ? max.y : min.y, (i & 4) ? max.z : min.z, 1.0f);
+			glm::vec4 clip_pos = m_occlusion_view_proj * corner;
+
+			// boxes crossing the near plane are always visible
+			if (clip_pos.w <= 0.0f || clip_pos.z < 0.0f)
+			{
+				return false;
+			}
+
+			glm::vec3 ndc_pos = glm::vec3(clip_pos) / clip_pos.w;
+			glm::vec2 uv = glm::vec2(ndc_pos) * 0.5f + 0.5f;
+			rect_min = glm::min(rect_min, uv);
+			rect_max = glm::max(rect_max, uv);
+			min_depth = std::min(min_depth, ndc_pos.z);
+		}
+
+		// leave frustum culling to others
+		rect_min = glm::clamp(rect_min, 0.0f, 1.0f);
+		rect_max = glm::clamp(rect_max, 0.0f, 1.0f);
+		if (rect_min.x >= rect_max.x || rect_min.y >= rect_max.y)
+		{
+			return false;
+		}
+
+		// select the finest read back level which covers the rect with a few texels
+		uint32_t mip_count = static_cast<uint32_t>(m_levels.size());
+		uint32_t mip = m_readback_base_mip;
+		while (mip + 1 < mip_count &&
+			((rect_max.x - rect_min.x) * m_levels[mip].width > k_max_test_texel_count ||
+			(rect_max.y - rect_min.y) * m_levels[mip].height > k_max_test_texel_count))
+		{
+			mip++;
+		}
+
+		// the box is occluded if it's behind the farthest depth of all covered texels
+		const HiZLevel& level = m_levels[mip];
+		uint32_t x0 = std::min(static_cast<uint32_t>(rect_min.x * level.width), level.width - 1);
+		uint32_t y0 = std::min(static_cast<uint32_t>(rect_min.y * level.height), level.height - 1);
+		uint32_t x1 = std::min(static_cast<uint32_t>(rect_max.x * level.width), level.width - 1);
+		uint32_t y1 = std::min(static_cast<uint32_t>(rect_max.y * level.height), level.height - 1);
+		uint32_t base_offset = level.offset - m_levels[m_readback_base_mip].offset;
+		for (uint32_t y = y0; y <= y1; ++y)
+		{
+			for (uint32_t x = x0; x <= x1; ++x)
+			{
+				if (min_depth <= m_occlusion_depths[base_offset + y * level.width + x])
+				{
+					return false;
+				}
+			}
+		}
+		return true;
+	}
+
+	void HiZPass::createRenderPass()
+	{
+		// compute pass, no render pass
+	}
+
+	void HiZPass::createDescriptorSetLayouts()
+	{
+		std::vector<VkDescriptorSetLayoutBinding> desc_set_layout_bindings = {
+			{0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_COMPUTE_BIT, nullptr},
+			{1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 1, VK_SHADER_STAGE_COMPUTE_BIT, nullptr}
+		};
+
+		VkDescriptorSetLayoutCreateInfo desc_set_layout_ci{};
+		desc_set_layout_ci.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+		desc_set_layout_ci.flags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_PUSH_DESCRIPTOR_BIT_KHR;
+		desc_set_layout_ci.bindingCount = static_cast<uint32_t>(desc_set_layout_bindings.size());
+		desc_set_layout_ci.pBindings = desc_set_layout_bindings.data();
+
+		m_desc_set_layouts.resize(1);
+		VkResult result = vkCreateDescriptorSetLayout(VulkanRHI::get().getDevice(), &desc_set_layout_ci, nullptr, &m_desc_set_layouts[0]);
+		CHECK_VULKAN_RESULT(result, "create descriptor set layout");
+	}
+
+	void HiZPass::createPipelineLayouts()
+	{
+		m_push_constant_ranges =
+		{
+			{ VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(glm::ivec4) }
+		};
+
+		VkPipelineLayoutCreateInfo pipeline_layout_ci{};
+		pipeline_layout_ci.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+		pipeline_layout_ci.setLayoutCount = 1;
+		pipeline_layout_ci.pSetLayouts = &m_desc_set_layouts[0];
+		pipeline_layout_ci.pushConstantRangeCount = static_cast<uint32_t>(m_push_constant_ranges.size());
+		pipeline_layout_ci.pPushConstantRanges = m_push_constant_ranges.data();
+
+		m_pipeline_layouts.resize(1);
+		VkResult result = vkCreatePipelineLayout(VulkanRHI::get().getDevice(), &pipeline_layout_ci, nullptr, &m_pipeline_layouts[0]);
+		CHECK_VULKAN_RESULT(result, "create pipeline layout");
+	}
+
+	void HiZPass::createPipelines()
+	{
+		VkComputePipelineCreateInfo compute_pipeline_ci{};
+		compute_pipeline_ci.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+		compute_pipeline_ci.stage = g_engine.shaderManager()->getShaderStageCI("hiz_pyramid.comp", VK_SHADER_STAGE_COMPUTE_BIT);
+		compute_pipeline_ci.layout = m_pipeline_layouts[0];
+
+		m_pipelines.resize(1);
+		VkResult result = vkCreateComputePipelines(VulkanRHI::get().getDevice(), m_pipeline_cache, 1, &compute_pipeline_ci, nullptr, &m_pipelines[0]);
+		CHECK_VULKAN_RESULT(result, "create hiz pyramid compute pipeline");
+	}
+
+	void HiZPass::createFramebuffer()
+	{
+		// level 0 is the power of two below the screen size, so every other level halves it exactly
+		uint32_t width = floorPowerOfTwo(m_width);
+		uint32_t height = floorPowerOfTwo(m_height);
+		uint32_t mip_count = VulkanUtil::calcMipLevel(width, height);
+
+		m_levels.clear();
+		m_readback_base_mip = mip_count - 1;
+		m_readback_size = 0;
+		for (uint32_t i = 0; i < mip_count; ++i)
+		{
+			HiZLevel level;
+			level.width = std::max(width >> i, 1u);
+			level.height = std::max(height >> i, 1u);
+			level.offset = 0;
+			if (std::max(level.width, level.height) <= k_max_readback_size)
+			{
+				m_readback_base_mip = std::min(m_readback_base_mip, i);
+				level.offset = m_readback_size;
+				m_readback_size += level.width * level.height;
+			}
+			m_levels.push_back(level);
+		}
+
+		// create pyramid image and mip views
+		VulkanUtil::createImage(width, height, mip_count, 1, VK_SAMPLE_COUNT_1_BIT, m_format, VK_IMAGE_TILING_OPTIMAL,
+			VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT,
+			VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE, m_pyramid_image);
+
+		m_mip_views.resize(mip_count);
+		for (uint32_t i = 0; i < mip_count; ++i)
+		{
+			VkImageViewCreateInfo image_view_ci{};
+			image_view_ci.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+			image_view_ci.image = m_pyramid_image.image;
+			image_view_ci.viewType = VK_IMAGE_VIEW_TYPE_2D;
+			image_view_ci.format = m_format;
+			image_view_ci.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, i, 1, 0, 1 };
+
+			VkResult result = vkCreateImageView(VulkanRHI::get().getDevice(), &image_view_ci, nullptr, &m_mip_views[i]);
+			CHECK_VULKAN_RESULT(result, "create hiz mip image view");
+		}
+
+		// depth stencil images can only be sampled through a single aspect view
+		m_depth_view = VulkanUtil::createImageView(m_p_depth_texture->vma_image.image, VulkanRHI::get().getDepthFormat(), VK_IMAGE_ASPECT_DEPTH_BIT, 1, 1);
+		m_sampler = VulkanUtil::createSampler(VK_FILTER_NEAREST, VK_FILTER_NEAREST, 1,
+			VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE, VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE, VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE);
+
+		// create readback buffers
+		uint32_t flight_count = VulkanRHI::get().getFlightCount();
+		m_readback_buffers.resize(flight_count);
+		for (VmaBuffer& readback_buffer : m_readback_buffers)
+		{
+			VulkanUtil::createBuffer(m_readback_size * sizeof(float), VK_BUFFER_USAGE_TRANSFER_DST_BIT, VMA_MEMORY_USAGE_AUTO_PREFER_HOST, readback_buffer, true);
+		}
+		m_readback_view_projs.resize(flight_count);
+		m_readback_valids.assign(flight_count, false);
+		m_is_occlusion_valid = false;
+	}
+
+	void HiZPass::destroyResizableObjects()
+	{
+		VkDevice device = VulkanRHI::get().getDevice();
+		for (VkImageView mip_view : m_mip_views)
+		{
+			vkDestroyImageView(device, mip_view, nullptr);
+		}
+		m_mip_views.clear();
+		m_pyramid_image.destroy();
+
+		if (m_depth_view)
+		{
+			vkDestroyImageView(device, m_depth_view, nullptr);
+			m_depth_view = VK_NULL_HANDLE;
+		}
+		if (m_sampler)
+		{
+			vkDestroySampler(device, m_sampler, nullptr);
+			m_sampler = VK_NULL_HANDLE;
+		}
+
+		for (VmaBuffer& readback_buffer : m_readback_buffers)
+		{
+			readback_buffer.destroy();
+		}
+
+		RenderPass::destroyResizableObjects();
+	}
+
+	void HiZPass::imageBarrier(VkCommandBuffer command_buffer, uint32_t base_mip, uint32_t mip_count,
+		VkImageLayout old_layout, VkImageLayout new_layout, VkPipelineStageFlags src_stage, VkAccessFlags src_access,
+		VkPipelineStageFlags dst_stage, VkAccessFlags dst_access)
+	{
+		VkImageMemoryBarrier barrier{};
+		barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+		barrier.oldLayout = old_layout;
+		barrier.newLayout = new_layout;
+		barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barrier.image = m_pyramid_image.image;
+		barrier.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, base_mip, mip_count, 0, 1 };
+		barrier.srcAccessMask = src_access;
+		barrier.dstAccessMask = dst_access;
+		vkCmdPipelineBarrier(command_buffer, src_stage, dst_stage, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+	}
+
+}
\ No newline at end of file
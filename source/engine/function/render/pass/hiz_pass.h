@@ -0,0 +1,77 @@
+#pragma once
+
+#include "render_pass.h"
+
+namespace Bamboo
+{
+	// hierarchical-z: a max depth pyramid is built from the main pass depth buffer with compute shaders,
+	// its coarse levels are read back, and the next frames test bounding boxes against them on cpu,
+	// the readback of a flight is consumed when the flight is reused, so it's a few frames old and tested with its own view projection
+	class HiZPass : public RenderPass
+	{
+	public:
+		HiZPass();
+
+		virtual void render() override;
+		virtual bool isEnabled() override;
+
+		virtual void createRenderPass() override;
+		virtual void createDescriptorSetLayouts() override;
+		virtual void createPipelineLayouts() override;
+		virtual void createPipelines() override;
+		virtual void createFramebuffer() override;
+		virtual void destroyResizableObjects() override;
+
+		void setEnabled(bool is_enabled);
+		void setDepthTexture(const VmaImageViewSampler* p_depth_texture) { m_p_depth_texture = p_depth_texture; }
+
+		// rendered region at the top left of the depth texture, it's smaller than the texture under dynamic resolution
+		void setDepthExtent(const VkExtent2D& depth_extent) { m_depth_extent = depth_extent; }
+		void setCameraViewProj(const glm::mat4& camera_view_proj) { m_camera_view_proj = camera_view_proj; }
+
+		// copy the readback of current flight, must be called after the flight's previous submission finished
+		void fetchOcclusionDepths();
+
+		// true if the world space bounding box is fully behind the fetched depth pyramid
+		bool isOccluded(const BoundingBox& bounding_box) const;
+
+	private:
+		struct HiZLevel
+		{
+			uint32_t width;
+			uint32_t height;
+			uint32_t offset;
+		};
+
+		void imageBarrier(VkCommandBuffer command_buffer, uint32_t base_mip, uint32_t mip_count,
+			VkImageLayout old_layout, VkImageLayout new_layout, VkPipelineStageFlags src_stage, VkAccessFlags src_access,
+			VkPipelineStageFlags dst_stage, VkAccessFlags dst_access);
+
+		bool m_is_enabled = false;
+		VkFormat m_format;
+		const VmaImageViewSampler* m_p_depth_texture = nullptr;
+		VkExtent2D m_depth_extent = { 0, 0 };
+		glm::mat4 m_camera_view_proj;
+
+		// depth aspect view of the main pass depth stencil attachment
+		VkImageView m_depth_view = VK_NULL_HANDLE;
+		VkSampler m_sampler = VK_NULL_HANDLE;
+
+		// max depth pyramid, one view per mip level
+		VmaImage m_pyramid_image;
+		std::vector<VkImageView> m_mip_views;
+		std::vector<HiZLevel> m_levels;
+
+		// coarse levels are read back to host buffers of each flight
+		uint32_t m_readback_base_mip = 0;
+		uint32_t m_readback_size = 0;
+		std::vector<VmaBuffer> m_readback_buffers;
+		std::vector<glm::mat4> m_readback_view_projs;
+		std::vector<bool> m_readback_valids;
+
+		// fetched readback of current flight
+		bool m_is_occlusion_valid = false;
+		glm::mat4 m_occlusion_view_proj;
+		std::vector<float> m_occlusion_depths;
+	};
+}
\ No newline at end of file
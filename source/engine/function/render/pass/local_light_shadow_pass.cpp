@@ -0,0 +1,665 @@
+#include "local_light_shadow_pass.h"
+#include "engine/core/vulkan/vulkan_rhi.h"
+#include "engine/resource/shader/shader_manager.h"
+#include "engine/resource/asset/base/mesh.h"
+#include "engine/core/math/transform.h"
+
+#include <numeric>
+#include <algorithm>
+
+namespace Bamboo
+{
+
+	LocalLightShadowPass::LocalLightShadowPass()
+	{
+		m_format = VulkanRHI::get().getDepthFormat();
+		m_size = 4096;
+		m_min_tile_size = 128;
+		m_max_tile_size = 2048;
+	}
+
+	void LocalLightShadowPass::init()
+	{
+		ShadowPass::init();
+
+		createResizableObjects(m_size, m_size);
+
+		// create shadow atlas and its cached static atlas, kept in their sampling/copying layouts between frames
+		VulkanUtil::createImageViewSampler(m_size, m_size, nullptr, 1, 1, m_format,
+			VK_FILTER_LINEAR, VK_FILTER_LINEAR, VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE, m_shadow_image_view_sampler,
+			VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT);
+		VulkanUtil::createImageViewSampler(m_size, m_size, nullptr, 1, 1, m_format,
+			VK_FILTER_LINEAR, VK_FILTER_LINEAR, VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE, m_static_shadow_image_view_sampler,
+			VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT);
+		VulkanUtil::transitionImageLayout(m_shadow_image_view_sampler.image(), VK_IMAGE_LAYOUT_UNDEFINED, 
+			VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL, m_format);
+		VulkanUtil::transitionImageLayout(m_static_shadow_image_view_sampler.image(), VK_IMAGE_LAYOUT_UNDEFINED,
+			VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, m_format);
+
+		// the whole atlas starts as one free block
+		uint32_t level_count = 1;
+		while ((m_min_tile_size << (level_count - 1)) < m_size)
+		{
+			level_count++;
+		}
+		m_free_blocks.assign(level_count, {});
+		m_free_blocks.back().insert(0);
+	}
+
+	void LocalLightShadowPass::render()
+	{
+		VkCommandBuffer command_buffer = VulkanRHI::get().getCommandBuffer();
+		VkImageAspectFlags aspect_flags = VulkanUtil::calcImageAspectFlags(m_format);
+		VkImage shadow_image = m_shadow_image_view_sampler.image();
+		VkImage static_shadow_image = m_static_shadow_image_view_sampler.image();
+		VkClearValue clear_value{};
+		clear_value.depthStencil = { 1.0f, 0 };
+
+		// select the views to refresh this frame
+		collectShadowCasters();
+		const uint32_t k_full_rate_tile_size = 512;
+		uint64_t frame_index = VulkanRHI::get().getFrameIndex();
+		std::vector<ShadowView*> static_updates;
+		std::vector<ShadowView*> updates;
+		bool has_dynamic_updates = false;
+		for (auto& iter : m_shadow_lights)
+		{
+			for (ShadowView& shadow_view : iter.second.views)
+			{
+				const ShadowTile& shadow_tile = shadow_view.tile;
+				if (shadow_tile.size == 0)
+				{
+					continue;
+				}
+
+				bool has_dynamic_casters = false;
+				for (const auto& render_data : m_dynamic_render_datas)
+				{
+					const BoundingBox& bounding_box = std::static_pointer_cast<MeshRenderData>(render_data)->bounding_box;
+					if (calcVisibleLayerMask(bounding_box, &shadow_view.view_proj, 1) != 0)
+					{
+						has_dynamic_casters = true;
+						break;
+					}
+				}
+
+				// the static tile is re-rendered if its casters, the light or its place in the atlas changed
+				uint64_t cache_key = calcShadowCacheKey(&shadow_view.view_proj, sizeof(glm::mat4));
+				if (cache_key != shadow_view.cache_key || !(shadow_tile == shadow_view.static_tile))
+				{
+					shadow_view.cache_key = cache_key;
+					shadow_view.static_tile = shadow_tile;
+					static_updates.push_back(&shadow_view);
+				}
+				else if (!has_dynamic_casters && !shadow_view.has_dynamic_casters)
+				{
+					// nothing moved in the view's frustum, the atlas tile is still valid
+					continue;
+				}
+				else
+				{
+					// distant lights with small tiles refresh their dynamic casters at a lower rate
+					uint32_t update_interval = std::max(k_full_rate_tile_size / shadow_tile.size, 1u);
+					if (frame_index < shadow_view.update_frame + update_interval)
+					{
+						continue;
+					}
+				}
+
+				shadow_view.update_frame = frame_index;
+				shadow_view.has_dynamic_casters = has_dynamic_casters;
+				has_dynamic_updates |= has_dynamic_casters;
+				updates.push_back(&shadow_view);
+			}
+		}
+
+		if (updates.empty())
+		{
+			m_render_datas.clear();
+			return;
+		}
+
+		// 1.render static casters into their tiles of the cached static atlas
+		if (!static_updates.empty())
+		{
+			VulkanUtil::cmdImageBarrier(command_buffer, static_shadow_image, aspect_flags, 1,
+				VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
+				VK_PIPELINE_STAGE_TRANSFER_BIT, 0,
+				VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT, VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT);
+
+			// other tiles are kept, so only the refreshed tiles are cleared
+			VkRenderingAttachmentInfo depth_attachment = getRenderingAttachment(m_static_shadow_image_view_sampler.view, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL, clear_value);
+			depth_attachment.loadOp = VK_ATTACHMENT_LOAD_OP_LOAD;
+			beginRendering(command_buffer, m_size, m_size, 1, {}, &depth_attachment);
+			for (const ShadowView* shadow_view : static_updates)
+			{
+				const ShadowTile& shadow_tile = shadow_view->tile;
+				setTileViewport(command_buffer, shadow_tile);
+
+				VkClearAttachment clear_attachment{};
+				clear_attachment.aspectMask = aspect_flags;
+				clear_attachment.clearValue = clear_value;
+				VkClearRect clear_rect{};
+				clear_rect.rect = { { (int32_t)shadow_tile.x, (int32_t)shadow_tile.y }, { shadow_tile.size, shadow_tile.size } };
+				clear_rect.layerCount = 1;
+				vkCmdClearAttachments(command_buffer, 1, &clear_attachment, 1, &clear_rect);
+
+				renderMeshes(command_buffer, m_static_render_datas, shadow_view->view_proj);
+			}
+			vkCmdEndRendering(command_buffer);
+
+			VulkanUtil::cmdImageBarrier(command_buffer, static_shadow_image, aspect_flags, 1,
+				VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+				VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT, VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+				VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_READ_BIT);
+		}
+
+		// 2.copy the refreshed static tiles into the shadow atlas
+		VulkanUtil::cmdImageBarrier(command_buffer, shadow_image, aspect_flags, 1,
+			VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+			VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0,
+			VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT);
+		for (const ShadowView* shadow_view : updates)
+		{
+			const ShadowTile& shadow_tile = shadow_view->tile;
+			VulkanUtil::cmdCopyImageRegion(command_buffer, static_shadow_image, shadow_image, aspect_flags,
+				shadow_tile.x, shadow_tile.y, shadow_tile.size, shadow_tile.size);
+		}
+
+		if (!has_dynamic_updates)
+		{
+			// transition shadow atlas for sampling in lighting shaders
+			VulkanUtil::cmdImageBarrier(command_buffer, shadow_image, aspect_flags, 1,
+				VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL,
+				VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT,
+				VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT);
+			m_render_datas.clear();
+			return;
+		}
+
+		// 3.render dynamic casters on top of the static ones
+		VulkanUtil::cmdImageBarrier(command_buffer, shadow_image, aspect_flags, 1,
+			VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
+			VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT,
+			VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT, VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT);
+
+		VkRenderingAttachmentInfo depth_attachment = getRenderingAttachment(m_shadow_image_view_sampler.view, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL, clear_value);
+		depth_attachment.loadOp = VK_ATTACHMENT_LOAD_OP_LOAD;
+		beginRendering(command_buffer, m_size, m_size, 1, {}, &depth_attachment);
+		for (const ShadowView* shadow_view : updates)
+		{
+			if (shadow_view->has_dynamic_casters)
+			{
+				setTileViewport(command_buffer, shadow_view->tile);
+				renderMeshes(command_buffer, m_dynamic_render_datas, shadow_view->view_proj);
+			}
+		}
+		vkCmdEndRendering(command_buffer);
+
+		// transition shadow atlas for sampling in lighting shaders
+		VulkanUtil::cmdImageBarrier(command_buffer, shadow_image, aspect_flags, 1,
+			VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL, VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL,
+			VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT, VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+			VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT);
+
+		m_render_datas.clear();
+	}
+
+	void LocalLightShadowPass::setTileViewport(VkCommandBuffer command_buffer, const ShadowTile& shadow_tile)
+	{
+		VkViewport viewport{};
+		viewport.x = static_cast<float>(shadow_tile.x);
+		viewport.y = static_cast<float>(shadow_tile.y);
+		viewport.width = static_cast<float>(shadow_tile.size);
+		viewport.height = static_cast<float>(shadow_tile.size);
+		viewport.minDepth = 0.0f;
+		viewport.maxDepth = 1.0f;
+		vkCmdSetViewport(command_buffer, 0, 1, &viewport);
+
+		VkRect2D scissor{};
+		scissor.offset = { (int32_t)shadow_tile.x, (int32_t)shadow_tile.y };
+		scissor.extent = { shadow_tile.size, shadow_tile.size };
+		vkCmdSetScissor(command_buffer, 0, 1, &scissor);
+	}
+
+	void LocalLightShadowPass::renderMeshes(VkCommandBuffer command_buffer, const std::vector<std::shared_ptr<RenderData>>& render_datas, const glm::mat4& view_proj)
+	{
+		for (const auto& render_data : render_datas)
+		{
+			std::shared_ptr<SkeletalMeshRenderData> skeletal_mesh_render_data = nullptr;
+			std::shared_ptr<StaticMeshRenderData> static_mesh_render_data = std::static_pointer_cast<StaticMeshRenderData>(render_data);
+			bool is_skeletal_mesh = render_data->type == ERenderDataType::SkeletalMesh;
+			if (is_skeletal_mesh)
+			{
+				skeletal_mesh_render_data = std::static_pointer_cast<SkeletalMeshRenderData>(render_data);
+			}
+
+			// cull casters out of the light's frustum
+			if (calcVisibleLayerMask(static_mesh_render_data->bounding_box, &view_proj, 1) == 0)
+			{
+				continue;
+			}
+
+			uint32_t pipeline_index = (uint32_t)is_skeletal_mesh;
+			VkPipeline pipeline = m_pipelines[pipeline_index];
+			VkPipelineLayout pipeline_layout = m_pipeline_layouts[pipeline_index];
+
+			// bind pipeline
+			vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
+
+			// bind vertex buffer, index buffers are bound per sub mesh index type
+			VkBuffer vertexBuffers[] = { static_mesh_render_data->vertex_buffer.buffer };
+			VkDeviceSize offsets[] = { 0 };
+			vkCmdBindVertexBuffers(command_buffer, 0, 1, vertexBuffers, offsets);
+
+			// render all sub meshes
+			std::vector<uint32_t>& index_counts = static_mesh_render_data->shadow_index_counts;
+			std::vector<uint32_t>& index_offsets = static_mesh_render_data->shadow_index_offsets;
+			size_t sub_mesh_count = index_counts.size();
+			VkIndexType index_type = VK_INDEX_TYPE_MAX_ENUM;
+			for (size_t i = 0; i < sub_mesh_count; ++i)
+			{
+				// push constants
+				TransformPCO transform_pco = static_mesh_render_data->transform_pco;
+				transform_pco.mvp = view_proj * transform_pco.m;
+				updatePushConstants(command_buffer, pipeline_layout, { &transform_pco });
+
+				// update(push) sub mesh descriptors
+				std::vector<VkWriteDescriptorSet> desc_writes;
+				std::array<VkDescriptorBufferInfo, 1> desc_buffer_infos{};
+				std::array<VkDescriptorImageInfo, 1> desc_image_infos{};
+
+				// bone matrix ubo
+				if (is_skeletal_mesh)
+				{
+					addBufferDescriptorSet(desc_writes, desc_buffer_infos[0], skeletal_mesh_render_data->bone_palette, 0,
+						VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, skeletal_mesh_render_data->bone_palette_offset, skeletal_mesh_render_data->bone_palette_size);
+				}
+
+				// base color texture image sampler
+				addImageDescriptorSet(desc_writes, desc_image_infos[0], static_mesh_render_data->pbr_textures[i].base_color_texure, 1);
+
+				VulkanRHI::get().getVkCmdPushDescriptorSetKHR()(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
+					pipeline_layout, 0, static_cast<uint32_t>(desc_writes.size()), desc_writes.data());
+
+				// render sub mesh
+				if (static_mesh_render_data->index_types[i] != index_type)
+				{
+					index_type = static_mesh_render_data->index_types[i];
+					vkCmdBindIndexBuffer(command_buffer, static_mesh_render_data->index_buffer.buffer, 0, index_type);
+				}
+				vkCmdDrawIndexed(command_buffer, index_counts[i], 1, index_offsets[i], static_mesh_render_data->vertex_offsets[i], 0);
+			}
+		}
+	}
+
+	void LocalLightShadowPass::createRenderPass()
+	{
+		// rendered with dynamic rendering, no render pass object is needed
+	}
+
+	void LocalLightShadowPass::createDescriptorSetLayouts()
+	{
+		std::vector<VkDescriptorSetLayoutBinding> desc_set_layout_bindings = {
+			{1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_FRAGMENT_BIT, nullptr}
+		};
+
+		VkDescriptorSetLayoutCreateInfo desc_set_layout_ci{};
+		desc_set_layout_ci.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+		desc_set_layout_ci.flags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_PUSH_DESCRIPTOR_BIT_KHR;
+		desc_set_layout_ci.pBindings = desc_set_layout_bindings.data();
+		desc_set_layout_ci.bindingCount = static_cast<uint32_t>(desc_set_layout_bindings.size());
+
+		m_desc_set_layouts.resize(2);
+		VkResult result = vkCreateDescriptorSetLayout(VulkanRHI::get().getDevice(), &desc_set_layout_ci, nullptr, &m_desc_set_layouts[0]);
+		CHECK_VULKAN_RESULT(result, "create static mesh descriptor set layout");
+
+		desc_set_layout_bindings.insert(desc_set_layout_bindings.begin(), { 0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_VERTEX_BIT, nullptr });
+		desc_set_layout_ci.bindingCount = static_cast<uint32_t>(desc_set_layout_bindings.size());
+		desc_set_layout_ci.pBindings = desc_set_layout_bindings.data();
+		result = vkCreateDescriptorSetLayout(VulkanRHI::get().getDevice(), &desc_set_layout_ci, nullptr, &m_desc_set_layouts[1]);
+		CHECK_VULKAN_RESULT(result, "create skeletal mesh descriptor set layout");
+	}
+
+	void LocalLightShadowPass::createPipelineLayouts()
+	{
+		m_push_constant_ranges =
+		{
+			{ VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(TransformPCO) },
+		};
+
+		VkPipelineLayoutCreateInfo pipeline_layout_ci{};
+		pipeline_layout_ci.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+		pipeline_layout_ci.setLayoutCount = 1;
+		pipeline_layout_ci.pSetLayouts = &m_desc_set_layouts[0];
+		pipeline_layout_ci.pushConstantRangeCount = static_cast<uint32_t>(m_push_constant_ranges.size());
+		pipeline_layout_ci.pPushConstantRanges = m_push_constant_ranges.data();
+
+		m_pipeline_layouts.resize(2);
+		VkResult result = vkCreatePipelineLayout(VulkanRHI::get().getDevice(), &pipeline_layout_ci, nullptr, &m_pipeline_layouts[0]);
+		CHECK_VULKAN_RESULT(result, "create static mesh pipeline layout");
+
+		pipeline_layout_ci.pSetLayouts = &m_desc_set_layouts[1];
+		result = vkCreatePipelineLayout(VulkanRHI::get().getDevice(), &pipeline_layout_ci, nullptr, &m_pipeline_layouts[1]);
+		CHECK_VULKAN_RESULT(result, "create skeletal mesh pipeline layout");
+	}
+
+	void LocalLightShadowPass::createPipelines()
+	{
+		// vertex input state
+		// static mesh vertex bindings and attributes
+		std::vector<VkVertexInputBindingDescription> vertex_input_binding_descriptions;
+		std::vector<VkVertexInputAttributeDescription> vertex_input_attribute_descriptions;
+		Mesh::getVertexInputDescriptions(false, vertex_input_binding_descriptions, vertex_input_attribute_descriptions);
+
+		VkPipelineVertexInputStateCreateInfo vertex_input_ci{};
+		vertex_input_ci.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+		vertex_input_ci.vertexBindingDescriptionCount = static_cast<uint32_t>(vertex_input_binding_descriptions.size());
+		vertex_input_ci.pVertexBindingDescriptions = vertex_input_binding_descriptions.data();
+		vertex_input_ci.vertexAttributeDescriptionCount = static_cast<uint32_t>(vertex_input_attribute_descriptions.size());
+		vertex_input_ci.pVertexAttributeDescriptions = vertex_input_attribute_descriptions.data();
+
+		// shader stages
+		const auto& shader_manager = g_engine.shaderManager();
+		std::vector<VkPipelineShaderStageCreateInfo> shader_stage_cis = {
+			shader_manager->getShaderStageCI("static_mesh.vert", VK_SHADER_STAGE_VERTEX_BIT),
+			shader_manager->getShaderStageCI("local_light_shadow.frag", VK_SHADER_STAGE_FRAGMENT_BIT)
+		};
+
+		// create graphics pipeline
+		m_pipeline_ci.stageCount = static_cast<uint32_t>(shader_stage_cis.size());
+		m_pipeline_ci.pStages = shader_stage_cis.data();
+		m_pipeline_ci.pVertexInputState = &vertex_input_ci;
+		m_pipeline_ci.layout = m_pipeline_layouts[0];
+		setRenderingFormats({}, m_format);
+
+		m_pipelines.resize(2);
+		VkResult result = vkCreateGraphicsPipelines(VulkanRHI::get().getDevice(), m_pipeline_cache, 1, &m_pipeline_ci, nullptr, &m_pipelines[0]);
+		CHECK_VULKAN_RESULT(result, "create local light shadow pass's static mesh graphics pipeline");
+
+		// skeletal mesh vertex bindings and attributes
+		Mesh::getVertexInputDescriptions(true, vertex_input_binding_descriptions, vertex_input_attribute_descriptions);
+
+		vertex_input_ci.vertexAttributeDescriptionCount = static_cast<uint32_t>(vertex_input_attribute_descriptions.size());
+		vertex_input_ci.pVertexAttributeDescriptions = vertex_input_attribute_descriptions.data();
+
+		m_pipeline_ci.layout = m_pipeline_layouts[1];
+		shader_stage_cis[0] = shader_manager->getShaderStageCI("skeletal_mesh.vert", VK_SHADER_STAGE_VERTEX_BIT);
+		result = vkCreateGraphicsPipelines(VulkanRHI::get().getDevice(), m_pipeline_cache, 1, &m_pipeline_ci, nullptr, &m_pipelines[1]);
+		CHECK_VULKAN_RESULT(result, "create local light shadow pass's skeletal mesh graphics pipeline");
+	}
+
+
+	void LocalLightShadowPass::updateLights(const std::vector<ShadowCubeCreateInfo>& shadow_cube_cis, const std::vector<ShadowFrustumCreateInfo>& shadow_frustum_cis)
+	{
+		uint64_t frame_index = VulkanRHI::get().getFrameIndex();
+		std::vector<ShadowLight*> shadow_lights;
+		std::vector<uint32_t> tile_sizes;
+		auto addShadowLight = [&](uint32_t light_id, bool is_point_light, float importance)
+		{
+			uint64_t light_key = ((uint64_t)light_id << 1) | (uint64_t)is_point_light;
+			ShadowLight* shadow_light = &m_shadow_lights[light_key];
+			shadow_light->views.resize(is_point_light ? SHADOW_FACE_NUM : 1);
+			shadow_light->last_used_frame = frame_index;
+			shadow_lights.push_back(shadow_light);
+			tile_sizes.push_back(selectTileSize(importance, shadow_light->requested_tile_size));
+			return shadow_light;
+		};
+
+		// point lights render their cube faces into six tiles, looking along +x, -x, +y, -y, +z, -z,
+		// the lighting shaders select the face by the major axis of the light to fragment vector
+		const glm::vec3 k_face_dirs[SHADOW_FACE_NUM] = {
+			glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(-1.0f, 0.0f, 0.0f),
+			glm::vec3(0.0f, 1.0f, 0.0f), glm::vec3(0.0f, -1.0f, 0.0f),
+			glm::vec3(0.0f, 0.0f, 1.0f), glm::vec3(0.0f, 0.0f, -1.0f)
+		};
+		m_point_lights.clear();
+		for (const ShadowCubeCreateInfo& shadow_cube_ci : shadow_cube_cis)
+		{
+			ShadowLight* shadow_light = addShadowLight(shadow_cube_ci.light_id, true, shadow_cube_ci.importance);
+			glm::mat4 proj = glm::perspectiveRH_ZO(glm::radians(90.0f), 1.0f, shadow_cube_ci.light_near, shadow_cube_ci.light_far);
+			proj[1][1] *= -1.0f;
+			for (uint32_t f = 0; f < SHADOW_FACE_NUM; ++f)
+			{
+				glm::vec3 up_vector = k_face_dirs[f].y == 0.0f ? k_up_vector : glm::vec3(0.0f, 0.0f, 1.0f);
+				glm::mat4 view = glm::lookAtRH(shadow_cube_ci.light_pos, shadow_cube_ci.light_pos + k_face_dirs[f], up_vector);
+				shadow_light->views[f].view_proj = proj * view;
+			}
+			m_point_lights.push_back(shadow_light);
+		}
+
+		m_spot_lights.clear();
+		for (const ShadowFrustumCreateInfo& shadow_frustum_ci : shadow_frustum_cis)
+		{
+			ShadowLight* shadow_light = addShadowLight(shadow_frustum_ci.light_id, false, shadow_frustum_ci.importance);
+			glm::mat4 view = glm::lookAtRH(shadow_frustum_ci.light_pos, shadow_frustum_ci.light_pos + shadow_frustum_ci.light_dir, k_up_vector);
+			float fov_angle = std::min(shadow_frustum_ci.light_angle * 2.0f, 180.0f);
+			glm::mat4 proj = glm::perspectiveRH_ZO(glm::radians(fov_angle), 1.0f, shadow_frustum_ci.light_near, shadow_frustum_ci.light_far);
+			proj[1][1] *= -1.0f;
+			shadow_light->views[0].view_proj = proj * view;
+			m_spot_lights.push_back(shadow_light);
+		}
+
+		// release the tiles of lights which are gone
+		for (auto iter = m_shadow_lights.begin(); iter != m_shadow_lights.end();)
+		{
+			if (iter->second.last_used_frame != frame_index)
+			{
+				for (const ShadowView& shadow_view : iter->second.views)
+				{
+					freeTile(shadow_view.tile);
+				}
+				iter = m_shadow_lights.erase(iter);
+			}
+			else
+			{
+				++iter;
+			}
+		}
+
+		allocateShadowTiles(shadow_lights, tile_sizes);
+	}
+
+	uint32_t LocalLightShadowPass::selectTileSize(float importance, uint32_t requested_tile_size)
+	{
+		// the largest power of two not exceeding the light's projected size in the atlas
+		float projected_size = importance * m_size;
+		uint32_t tile_size = m_max_tile_size;
+		while (tile_size > m_min_tile_size && tile_size > projected_size)
+		{
+			tile_size /= 2;
+		}
+
+		// lights hovering around a power of two boundary keep their larger tiles instead of flipping every frame
+		if (tile_size * 2 == requested_tile_size)
+		{
+			tile_size = requested_tile_size;
+		}
+		return tile_size;
+	}
+
+	void LocalLightShadowPass::allocateShadowTiles(const std::vector<ShadowLight*>& shadow_lights, std::vector<uint32_t>& tile_sizes)
+	{
+		// halve the largest tiles until all of them fit in the atlas
+		uint64_t used_area = 0;
+		for (size_t i = 0; i < shadow_lights.size(); ++i)
+		{
+			used_area += (uint64_t)tile_sizes[i] * tile_sizes[i] * shadow_lights[i]->views.size();
+		}
+
+		uint64_t atlas_area = (uint64_t)m_size * m_size;
+		while (used_area > atlas_area)
+		{
+			uint32_t max_tile_size = *std::max_element(tile_sizes.begin(), tile_sizes.end());
+			if (max_tile_size == m_min_tile_size)
+			{
+				break;
+			}
+
+			for (size_t i = 0; i < shadow_lights.size(); ++i)
+			{
+				if (tile_sizes[i] == max_tile_size)
+				{
+					used_area -= (uint64_t)tile_sizes[i] * tile_sizes[i] * 3 / 4 * shadow_lights[i]->views.size();
+					tile_sizes[i] /= 2;
+				}
+			}
+		}
+
+		// lights keep their tiles and cached contents until their requested tile sizes change
+		for (size_t i = 0; i < shadow_lights.size(); ++i)
+		{
+			ShadowLight* shadow_light = shadow_lights[i];
+			if (shadow_light->requested_tile_size != tile_sizes[i])
+			{
+				for (ShadowView& shadow_view : shadow_light->views)
+				{
+					freeTile(shadow_view.tile);
+					shadow_view.tile = ShadowTile{};
+				}
+				shadow_light->tile_size = 0;
+			}
+		}
+
+		// place larger tiles first, a light which doesn't fit falls back to smaller tiles or is shaded without shadow
+		std::vector<size_t> order(shadow_lights.size());
+		std::iota(order.begin(), order.end(), 0);
+		std::stable_sort(order.begin(), order.end(), [&tile_sizes](size_t a, size_t b) { return tile_sizes[a] > tile_sizes[b]; });
+
+		for (size_t i : order)
+		{
+			ShadowLight* shadow_light = shadow_lights[i];
+			for (uint32_t tile_size = tile_sizes[i]; tile_size >= m_min_tile_size && shadow_light->tile_size == 0; tile_size /= 2)
+			{
+				size_t v = 0;
+				for (; v < shadow_light->views.size(); ++v)
+				{
+					if (!allocateTile(tile_size, shadow_light->views[v].tile))
+					{
+						break;
+					}
+				}
+
+				if (v == shadow_light->views.size())
+				{
+					shadow_light->tile_size = tile_size;
+				}
+				else
+				{
+					for (size_t u = 0; u < v; ++u)
+					{
+						freeTile(shadow_light->views[u].tile);
+						shadow_light->views[u].tile = ShadowTile{};
+					}
+				}
+			}
+			shadow_light->requested_tile_size = tile_sizes[i];
+		}
+	}
+
+	bool LocalLightShadowPass::allocateTile(uint32_t tile_size, ShadowTile& tile)
+	{
+		uint32_t level = 0;
+		while ((m_min_tile_size << level) < tile_size)
+		{
+			level++;
+		}
+
+		// take the first free block of the smallest level which can hold the tile
+		uint32_t block_level = level;
+		while (block_level < m_free_blocks.size() && m_free_blocks[block_level].empty())
+		{
+			block_level++;
+		}
+		if (block_level == m_free_blocks.size())
+		{
+			return false;
+		}
+
+		uint32_t offset = *m_free_blocks[block_level].begin();
+		m_free_blocks[block_level].erase(m_free_blocks[block_level].begin());
+
+		// split it down to the tile's level, keeping the first quarter and freeing the other three
+		while (block_level > level)
+		{
+			block_level--;
+			for (uint32_t i = 1; i < 4; ++i)
+			{
+				m_free_blocks[block_level].insert(offset + (i << (2 * block_level)));
+			}
+		}
+
+		// morton offset to tile position
+		uint32_t x = 0, y = 0;
+		for (uint32_t bit = 0; bit + 1 < m_free_blocks.size(); ++bit)
+		{
+			x |= ((offset >> (2 * bit)) & 1) << bit;
+			y |= ((offset >> (2 * bit + 1)) & 1) << bit;
+		}
+		tile = { x * m_min_tile_size, y * m_min_tile_size, tile_size };
+		return true;
+	}
+
+	void LocalLightShadowPass::freeTile(const ShadowTile& tile)
+	{
+		if (tile.size == 0)
+		{
+			return;
+		}
+
+		uint32_t level = 0;
+		while ((m_min_tile_size << level) < tile.size)
+		{
+			level++;
+		}
+
+		// tile position to morton offset
+		uint32_t x = tile.x / m_min_tile_size, y = tile.y / m_min_tile_size;
+		uint32_t offset = 0;
+		for (uint32_t bit = 0; bit + 1 < m_free_blocks.size(); ++bit)
+		{
+			offset |= ((x >> bit) & 1) << (2 * bit);
+			offset |= ((y >> bit) & 1) << (2 * bit + 1);
+		}
+
+		// merge the block with its three buddies while they're all free
+		while (level + 1 < m_free_blocks.size())
+		{
+			uint32_t block_count = 1u << (2 * level);
+			uint32_t parent_offset = offset & ~(block_count * 4 - 1);
+			bool is_mergeable = true;
+			for (uint32_t i = 0; i < 4 && is_mergeable; ++i)
+			{
+				uint32_t buddy_offset = parent_offset + i * block_count;
+				is_mergeable = buddy_offset == offset || m_free_blocks[level].count(buddy_offset) != 0;
+			}
+			if (!is_mergeable)
+			{
+				break;
+			}
+
+			for (uint32_t i = 0; i < 4; ++i)
+			{
+				m_free_blocks[level].erase(parent_offset + i * block_count);
+			}
+			offset = parent_offset;
+			level++;
+		}
+		m_free_blocks[level].insert(offset);
+	}
+
+	glm::vec4 LocalLightShadowPass::calcAtlasRect(const ShadowTile& tile)
+	{
+		float inv_size = 1.0f / m_size;
+		return glm::vec4(tile.x * inv_size, tile.y * inv_size, tile.size * inv_size, tile.size * inv_size);
+	}
+
+	void LocalLightShadowPass::destroyResizableObjects()
+	{
+		m_shadow_image_view_sampler.destroy();
+		m_static_shadow_image_view_sampler.destroy();
+
+		ShadowPass::destroyResizableObjects();
+	}
+
+}
\ No newline at end of file
@@ -0,0 +1,96 @@
+#pragma once
+
+#include "shadow_pass.h"
+
+#include <map>
+#include <set>
+
+namespace Bamboo
+{
+	// point and spot light shadows, every spot light frustum and point light cube face is rendered into a tile of one shared atlas
+	class LocalLightShadowPass : public ShadowPass
+	{
+	public:
+		LocalLightShadowPass();
+
+		virtual void init() override;
+		virtual void render() override;
+
+		virtual void createRenderPass() override;
+		virtual void createDescriptorSetLayouts() override;
+		virtual void createPipelineLayouts() override;
+		virtual void createPipelines() override;
+		virtual void createFramebuffer() override {}
+		virtual void destroyResizableObjects() override;
+
+		void updateLights(const std::vector<ShadowCubeCreateInfo>& shadow_cube_cis, const std::vector<ShadowFrustumCreateInfo>& shadow_frustum_cis);
+		const VmaImageViewSampler& getShadowAtlasImageViewSampler() { return m_shadow_image_view_sampler; }
+
+		// view projection and atlas tile of the p-th point light's cube face or the p-th spot light,
+		// tiles are uv offset(xy) and scale(zw), with zero scale if the light got no tile
+		const glm::mat4& getPointLightViewProj(size_t p, uint32_t face) { return m_point_lights[p]->views[face].view_proj; }
+		glm::vec4 getPointLightAtlasRect(size_t p, uint32_t face) { return calcAtlasRect(m_point_lights[p]->views[face].tile); }
+		const glm::mat4& getSpotLightViewProj(size_t p) { return m_spot_lights[p]->views[0].view_proj; }
+		glm::vec4 getSpotLightAtlasRect(size_t p) { return calcAtlasRect(m_spot_lights[p]->views[0].tile); }
+
+	private:
+		struct ShadowTile
+		{
+			uint32_t x = 0;
+			uint32_t y = 0;
+			uint32_t size = 0;
+
+			bool operator==(const ShadowTile& other) const { return x == other.x && y == other.y && size == other.size; }
+		};
+
+		// a spot light frustum or a point light cube face
+		struct ShadowView
+		{
+			glm::mat4 view_proj;
+			ShadowTile tile;
+
+			// cached static casters are valid while the key and the tile they were rendered into are unchanged
+			ShadowTile static_tile;
+			uint64_t cache_key = 0;
+
+			// time slicing: small tiles of distant lights refresh their dynamic casters every few frames
+			uint64_t update_frame = 0;
+			bool has_dynamic_casters = false;
+		};
+
+		// lights keep their tiles between frames until their tile sizes change
+		struct ShadowLight
+		{
+			std::vector<ShadowView> views;
+			uint32_t requested_tile_size = 0;
+			uint32_t tile_size = 0;
+			uint64_t last_used_frame = 0;
+		};
+
+		uint32_t selectTileSize(float importance, uint32_t requested_tile_size);
+		void allocateShadowTiles(const std::vector<ShadowLight*>& shadow_lights, std::vector<uint32_t>& tile_sizes);
+		bool allocateTile(uint32_t tile_size, ShadowTile& tile);
+		void freeTile(const ShadowTile& tile);
+		glm::vec4 calcAtlasRect(const ShadowTile& tile);
+
+		void renderMeshes(VkCommandBuffer command_buffer, const std::vector<std::shared_ptr<RenderData>>& render_datas, const glm::mat4& view_proj);
+		void setTileViewport(VkCommandBuffer command_buffer, const ShadowTile& shadow_tile);
+
+		VkFormat m_format;
+		uint32_t m_size;
+		uint32_t m_min_tile_size;
+		uint32_t m_max_tile_size;
+
+		VmaImageViewSampler m_shadow_image_view_sampler;
+		VmaImageViewSampler m_static_shadow_image_view_sampler;
+
+		// lights by their entities and types, and this frame's point/spot lights in the order of their create infos
+		std::map<uint64_t, ShadowLight> m_shadow_lights;
+		std::vector<ShadowLight*> m_point_lights;
+		std::vector<ShadowLight*> m_spot_lights;
+
+		// buddy allocator over the atlas, free blocks of each level by their offsets along the morton curve of minimum tiles,
+		// a block of level l spans 4^l minimum tiles
+		std::vector<std::set<uint32_t>> m_free_blocks;
+	};
+}
\ No newline at end of file
@@ -7,37 +7,66 @@
 #include "engine/resource/asset/base/mesh.h"
 #include "engine/function/render/render_data.h"
 
+#include <algorithm>
+
 namespace Bamboo
 {
 
 	MainPass::MainPass()
 	{
+		// compact gbuffer: octahedral normal and roughness in 10 bit channels, base color and metallic in srgb 8 bit channels,
+		// emissive and occlusion are written to the color attachment which composition reads before overwriting it
 		m_formats = {
 			VK_FORMAT_R8G8B8A8_UNORM,
-			VK_FORMAT_R16G16B16A16_SFLOAT,
-			VK_FORMAT_R8G8B8A8_UNORM,
-			VK_FORMAT_R8G8B8A8_UNORM,
-			VK_FORMAT_R8G8B8A8_UNORM,
-			VulkanRHI::get().getDepthFormat()
+			VulkanRHI::get().getColorAttachmentFormat({ VK_FORMAT_A2B10G10R10_UNORM_PACK32, VK_FORMAT_R16G16B16A16_UNORM, VK_FORMAT_R16G16B16A16_SFLOAT }),
+			VulkanRHI::get().getColorAttachmentFormat({ VK_FORMAT_R8G8B8A8_SRGB, VK_FORMAT_R8G8B8A8_UNORM }),
+			VulkanRHI::get().getDepthFormat(),
+			VK_FORMAT_R16G16_SFLOAT
 		};
+
+		// composition writes the most descriptors: 9 textures, the local light shadow atlas, lighting ubo and light ssbos
+		m_desc_writes.reserve(12);
+		m_desc_image_infos.resize(10);
+	}
+
+	void MainPass::init()
+	{
+		RenderPass::init();
+
+		const uint32_t k_max_sets = 64;
+		m_desc_set_cache.init({
+			{ VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT, k_max_sets * 4 },
+			{ VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, k_max_sets * 5 },
+			{ VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, k_max_sets },
+			{ VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, k_max_sets * 2 }
+		}, k_max_sets);
+	}
+
+	void MainPass::destroy()
+	{
+		m_desc_set_cache.destroy();
+
+		RenderPass::destroy();
 	}
 
 	void MainPass::render()
 	{
+		m_desc_set_cache.tick();
+
 		VkRenderPassBeginInfo render_pass_bi{};
 		render_pass_bi.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
 		render_pass_bi.renderPass = m_render_pass;
 		render_pass_bi.framebuffer = m_framebuffer;
+		VkExtent2D render_extent = getRenderExtent();
 		render_pass_bi.renderArea.offset = { 0, 0 };
-		render_pass_bi.renderArea.extent = { m_width, m_height };
+		render_pass_bi.renderArea.extent = render_extent;
 
-		std::array<VkClearValue, 6> clear_values{};
+		std::array<VkClearValue, 5> clear_values{};
 		clear_values[0].color = { { 0.0f, 0.0f, 0.0f, 1.0f } };
 		clear_values[1].color = { { 0.0f, 0.0f, 0.0f, 0.0f } };
 		clear_values[2].color = { { 0.0f, 0.0f, 0.0f, 0.0f } };
-		clear_values[3].color = { { 0.0f, 0.0f, 0.0f, 0.0f } };
-		clear_values[4].color = { { 0.0f, 0.0f, 0.0f, 0.0f } };
-		clear_values[5].depthStencil = { 1.0f, 0 };
+		clear_values[3].depthStencil = { 1.0f, 0 };
+		clear_values[4].color = { { BACKGROUND_VELOCITY, BACKGROUND_VELOCITY, 0.0f, 0.0f } };
 		render_pass_bi.clearValueCount = static_cast<uint32_t>(clear_values.size());
 		render_pass_bi.pClearValues = clear_values.data();
 
@@ -48,15 +77,15 @@ namespace Bamboo
 		VkViewport viewport{};
 		viewport.x = 0.0f;
 		viewport.y = 0.0f;
-		viewport.width = static_cast<float>(m_width);
-		viewport.height = static_cast<float>(m_height);
+		viewport.width = static_cast<float>(render_extent.width);
+		viewport.height = static_cast<float>(render_extent.height);
 		viewport.minDepth = 0.0f;
 		viewport.maxDepth = 1.0f;
 		vkCmdSetViewport(command_buffer, 0, 1, &viewport);
 
 		VkRect2D scissor{};
 		scissor.offset = { 0, 0 };
-		scissor.extent = { m_width, m_height };
+		scissor.extent = render_extent;
 		vkCmdSetScissor(command_buffer, 0, 1, &scissor);
 
 		// 1.deferred subpass
@@ -72,36 +101,9 @@ namespace Bamboo
 		{
 			vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pipelines[2]);
 
-			std::vector<VkWriteDescriptorSet> desc_writes;
-			std::array<VkDescriptorBufferInfo, 1> desc_buffer_infos{};
-
-			// lighting uniform buffer
-			addBufferDescriptorSet(desc_writes, desc_buffer_infos[0], m_lighting_render_data->lighting_ubs[flight_index], 11);
-
-			// input attachments and ibl textures
-			std::vector<VmaImageViewSampler> textures = {
-				m_normal_texture_sampler,
-				m_base_color_texture_sampler,
-				m_emissive_texture_sampler,
-				m_metallic_roughness_occlusion_texture_sampler,
-				m_depth_stencil_texture_sampler,
-				m_lighting_render_data->irradiance_texture,
-				m_lighting_render_data->prefilter_texture,
-				m_lighting_render_data->brdf_lut_texture,
-				m_lighting_render_data->directional_light_shadow_texture
-			};
-			std::vector<VmaImageViewSampler> point_light_shadow_textures = m_lighting_render_data->point_light_shadow_textures;
-			std::vector<VmaImageViewSampler> spot_light_shadow_textures = m_lighting_render_data->spot_light_shadow_textures;
-			std::vector<VkDescriptorImageInfo> desc_image_infos(textures.size() + point_light_shadow_textures.size() + spot_light_shadow_textures.size(), VkDescriptorImageInfo{});
-			for (size_t i = 0; i < textures.size(); ++i)
-			{
-				addImageDescriptorSet(desc_writes, desc_image_infos[i], textures[i], i);
-			}
-			addImagesDescriptorSet(desc_writes, &desc_image_infos[textures.size()], point_light_shadow_textures, textures.size());
-			addImagesDescriptorSet(desc_writes, &desc_image_infos[textures.size() + point_light_shadow_textures.size()], spot_light_shadow_textures, textures.size() + 1);
-
-			VulkanRHI::get().getVkCmdPushDescriptorSetKHR()(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
-				m_pipeline_layouts[2], 0, static_cast<uint32_t>(desc_writes.size()), desc_writes.data());
+			// gbuffer inputs, ibl and shadow textures only change on resize or scene change, so the set is cached
+			VkDescriptorSet desc_set = getCompositionDescriptorSet(flight_index);
+			vkCmdBindDescriptorSets(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pipeline_layouts[2], 0, 1, &desc_set, 0, nullptr);
 			vkCmdDraw(command_buffer, 3, 1, 0, 0);
 		}
 		
@@ -120,7 +122,8 @@ namespace Bamboo
 			vkCmdBindVertexBuffers(command_buffer, 0, 1, vertexBuffers, offsets);
 
 			// push constants
-			vkCmdPushConstants(command_buffer, m_pipeline_layouts[6], VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(glm::mat4), &m_lighting_render_data->camera_view_proj);
+			glm::mat4 camera_view_proj = m_jitter_matrix * m_lighting_render_data->camera_view_proj;
+			vkCmdPushConstants(command_buffer, m_pipeline_layouts[6], VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(glm::mat4), &camera_view_proj);
 			vkCmdDraw(command_buffer, ddm->getVertexCount(), 1, 0, 0);
 		}
 
@@ -134,19 +137,17 @@ namespace Bamboo
 			VkBuffer vertexBuffers[] = { m_skybox_render_data->vertex_buffer.buffer };
 			VkDeviceSize offsets[] = { 0 };
 			vkCmdBindVertexBuffers(command_buffer, 0, 1, vertexBuffers, offsets);
-			vkCmdBindIndexBuffer(command_buffer, m_skybox_render_data->index_buffer.buffer, 0, VK_INDEX_TYPE_UINT32);
+			vkCmdBindIndexBuffer(command_buffer, m_skybox_render_data->index_buffer.buffer, 0, m_skybox_render_data->index_type);
 
 			// push constants
-			vkCmdPushConstants(command_buffer, m_pipeline_layouts[5], VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(TransformPCO), &m_skybox_render_data->transform_pco);
-
-			// update(push) sub mesh descriptors
-			std::vector<VkWriteDescriptorSet> desc_writes;
-			VkDescriptorImageInfo desc_image_info{};
-			addImageDescriptorSet(desc_writes, desc_image_info, m_skybox_render_data->env_texture, 0);
-
-			VulkanRHI::get().getVkCmdPushDescriptorSetKHR()(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
-				m_pipeline_layouts[5], 0, static_cast<uint32_t>(desc_writes.size()), desc_writes.data());
-			vkCmdDrawIndexed(command_buffer, m_skybox_render_data->index_count, 1, 0, 0, 0);
+			TransformPCO transform_pco = m_skybox_render_data->transform_pco;
+			transform_pco.mvp = m_jitter_matrix * transform_pco.mvp;
+			vkCmdPushConstants(command_buffer, m_pipeline_layouts[5], VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(TransformPCO), &transform_pco);
+
+			// bind cached environment texture descriptor set
+			VkDescriptorSet desc_set = getTextureDescriptorSet(m_desc_set_layouts[5], m_skybox_render_data->env_texture);
+			vkCmdBindDescriptorSets(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pipeline_layouts[5], 0, 1, &desc_set, 0, nullptr);
+			vkCmdDrawIndexed(command_buffer, m_skybox_render_data->index_count, 1, m_skybox_render_data->first_index, m_skybox_render_data->vertex_offset, 0);
 		}
 
 		// 3.3 render transparency meshes
@@ -157,18 +158,20 @@ namespace Bamboo
 
 		// 3.4 render billboards
 		vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pipelines[7]);
+		VkImageView bound_billboard_view = VK_NULL_HANDLE;
 		for (const auto& render_data : m_billboard_render_datas)
 		{
 			// push constants
 			vkCmdPushConstants(command_buffer, m_pipeline_layouts[7], VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_GEOMETRY_BIT,
 				0, sizeof(glm::vec4) + sizeof(glm::vec2), &render_data->position);
 
-			std::vector<VkWriteDescriptorSet> desc_writes;
-			VkDescriptorImageInfo desc_image_info{};
-			addImageDescriptorSet(desc_writes, desc_image_info, render_data->texture, 0);
-
-			VulkanRHI::get().getVkCmdPushDescriptorSetKHR()(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
-				m_pipeline_layouts[7], 0, static_cast<uint32_t>(desc_writes.size()), desc_writes.data());
+			// billboards share a few icon textures, only rebind when the icon changes
+			if (render_data->texture.view != bound_billboard_view)
+			{
+				VkDescriptorSet desc_set = getTextureDescriptorSet(m_desc_set_layouts[7], render_data->texture);
+				vkCmdBindDescriptorSets(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pipeline_layouts[7], 0, 1, &desc_set, 0, nullptr);
+				bound_billboard_view = render_data->texture.view;
+			}
 			vkCmdDraw(command_buffer, 1, 1, 0, 0);
 		}
 
@@ -177,56 +180,61 @@ namespace Bamboo
 
 	void MainPass::createRenderPass()
 	{
-		// attachments
-		std::array<VkAttachmentDescription, 6> attachments{};
-		std::array<VkAttachmentReference, 6> references{};
-		std::array<VkAttachmentReference, 5> input_references{};
-		for (uint32_t i = 0; i < 6; ++i)
+		// attachments, color(0) which also holds emissive and occlusion before composition, gbuffer(1-2), depth(3),
+		// and velocity(4) which is sampled by temporal upsampling
+		std::array<VkAttachmentDescription, 5> attachments{};
+		std::array<VkAttachmentReference, 5> references{};
+		for (uint32_t i = 0; i < 5; ++i)
 		{
+			bool is_sampled = i == 0 || i == 4;
 			attachments[i].samples = VK_SAMPLE_COUNT_1_BIT;
 			attachments[i].loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
-			attachments[i].storeOp = (i == 0 || i == 5) ? VK_ATTACHMENT_STORE_OP_STORE : VK_ATTACHMENT_STORE_OP_DONT_CARE;
+			attachments[i].storeOp = (is_sampled || i == 3) ? VK_ATTACHMENT_STORE_OP_STORE : VK_ATTACHMENT_STORE_OP_DONT_CARE;
 			attachments[i].stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
 			attachments[i].stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
 			attachments[i].initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-			attachments[i].finalLayout = i == 0 ? VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL : (
-				i == 5 ? VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL : VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
+			attachments[i].finalLayout = is_sampled ? VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL : (
+				i == 3 ? VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL : VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
 			attachments[i].format = m_formats[i];
 
 			references[i].attachment = i;
-			references[i].layout = i == 5 ? VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL : VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+			references[i].layout = i == 3 ? VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL : VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
 		}
 
-		for (uint32_t i = 0; i < 5; ++i)
-		{
-			input_references[i].attachment = i + 1;
-			input_references[i].layout = i == 4 ? VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL : VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-		}
+		// composition reads the emissive color attachment as input and writes the lit color to it, which needs the general layout
+		VkAttachmentReference composition_reference = { 0, VK_IMAGE_LAYOUT_GENERAL };
+		std::array<VkAttachmentReference, 4> input_references = { {
+			{ 1, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL },
+			{ 2, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL },
+			composition_reference,
+			{ 3, VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL }
+		} };
 
 		// subpasses
 		std::array<VkSubpassDescription, 3> subpass_descs{};
 
 		// gbuffer subpass
+		std::array<VkAttachmentReference, 4> gbuffer_references = { references[0], references[1], references[2], references[4] };
 		subpass_descs[0].pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
-		subpass_descs[0].colorAttachmentCount = 4;
-		subpass_descs[0].pColorAttachments = &references[1];
-		subpass_descs[0].pDepthStencilAttachment = &references[5];
+		subpass_descs[0].colorAttachmentCount = static_cast<uint32_t>(gbuffer_references.size());
+		subpass_descs[0].pColorAttachments = gbuffer_references.data();
+		subpass_descs[0].pDepthStencilAttachment = &references[3];
 
 		// composition subpass
 		subpass_descs[1].pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
 		subpass_descs[1].colorAttachmentCount = 1;
-		subpass_descs[1].pColorAttachments = &references[0];
-		subpass_descs[1].inputAttachmentCount = 5;
-		subpass_descs[1].pInputAttachments = &input_references[0];
+		subpass_descs[1].pColorAttachments = &composition_reference;
+		subpass_descs[1].inputAttachmentCount = static_cast<uint32_t>(input_references.size());
+		subpass_descs[1].pInputAttachments = input_references.data();
 
 		// forward subpass
 		subpass_descs[2].pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
 		subpass_descs[2].colorAttachmentCount = 1;
 		subpass_descs[2].pColorAttachments = &references[0];
-		subpass_descs[2].pDepthStencilAttachment = &references[5];
+		subpass_descs[2].pDepthStencilAttachment = &references[3];
 
 		// subpass dependencies
-		std::array<VkSubpassDependency, 4> dependencies{};
+		std::array<VkSubpassDependency, 5> dependencies{};
 		dependencies[0].srcSubpass = VK_SUBPASS_EXTERNAL;
 		dependencies[0].dstSubpass = 0;
 		dependencies[0].srcStageMask = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
@@ -235,13 +243,13 @@ namespace Bamboo
 		dependencies[0].dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
 		dependencies[0].dependencyFlags = 0;
 
-		// transitions the gbuffer input attachment from color attachment to shader read
+		// transitions the gbuffer input attachment from color attachment to shader read, and orders the color attachment writes
 		dependencies[1].srcSubpass = 0;
 		dependencies[1].dstSubpass = 1;
 		dependencies[1].srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-		dependencies[1].dstStageMask = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+		dependencies[1].dstStageMask = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
 		dependencies[1].srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
-		dependencies[1].dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+		dependencies[1].dstAccessMask = VK_ACCESS_INPUT_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
 		dependencies[1].dependencyFlags = VK_DEPENDENCY_BY_REGION_BIT;
 
 		dependencies[2].srcSubpass = 1;
@@ -260,6 +268,15 @@ namespace Bamboo
 		dependencies[3].dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
 		dependencies[3].dependencyFlags = VK_DEPENDENCY_BY_REGION_BIT;
 
+		// velocity is only written by gbuffer subpass
+		dependencies[4].srcSubpass = 0;
+		dependencies[4].dstSubpass = VK_SUBPASS_EXTERNAL;
+		dependencies[4].srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+		dependencies[4].dstStageMask = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+		dependencies[4].srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+		dependencies[4].dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+		dependencies[4].dependencyFlags = 0;
+
 		// create render pass
 		VkRenderPassCreateInfo render_pass_ci{};
 		render_pass_ci.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
@@ -295,32 +312,34 @@ namespace Bamboo
 		VkResult result = vkCreateDescriptorSetLayout(VulkanRHI::get().getDevice(), &desc_set_layout_ci, nullptr, &m_desc_set_layouts[0]);
 		CHECK_VULKAN_RESULT(result, "create gbuffer static mesh descriptor set layout");
 
-		desc_set_layout_bindings.insert(desc_set_layout_bindings.begin(), { 0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1, VK_SHADER_STAGE_VERTEX_BIT, nullptr });
+		desc_set_layout_bindings.insert(desc_set_layout_bindings.begin(), { 0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_VERTEX_BIT, nullptr });
 		desc_set_layout_ci.bindingCount = static_cast<uint32_t>(desc_set_layout_bindings.size());
 		desc_set_layout_ci.pBindings = desc_set_layout_bindings.data();
 		result = vkCreateDescriptorSetLayout(VulkanRHI::get().getDevice(), &desc_set_layout_ci, nullptr, &m_desc_set_layouts[1]);
 		CHECK_VULKAN_RESULT(result, "create gbuffer skeletal mesh descriptor set layout");
 
-		// composition descriptor set layouts
+		// composition descriptor set layouts, allocated from the descriptor set cache instead of pushed
+		desc_set_layout_ci.flags = 0;
 		desc_set_layout_bindings = {
 			{0, VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT, 1, VK_SHADER_STAGE_FRAGMENT_BIT, nullptr},
 			{1, VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT, 1, VK_SHADER_STAGE_FRAGMENT_BIT, nullptr},
 			{2, VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT, 1, VK_SHADER_STAGE_FRAGMENT_BIT, nullptr},
 			{3, VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT, 1, VK_SHADER_STAGE_FRAGMENT_BIT, nullptr},
-			{4, VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT, 1, VK_SHADER_STAGE_FRAGMENT_BIT, nullptr},
 			{5, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_FRAGMENT_BIT, nullptr},
 			{6, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_FRAGMENT_BIT, nullptr},
 			{7, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_FRAGMENT_BIT, nullptr},
 			{8, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_FRAGMENT_BIT, nullptr},
-			{9, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, MAX_POINT_LIGHT_NUM, VK_SHADER_STAGE_FRAGMENT_BIT, nullptr},
-			{10, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, MAX_SPOT_LIGHT_NUM, VK_SHADER_STAGE_FRAGMENT_BIT, nullptr},
+			{10, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_FRAGMENT_BIT, nullptr},
 			{11, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1, VK_SHADER_STAGE_FRAGMENT_BIT, nullptr},
+			{12, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_FRAGMENT_BIT, nullptr},
+			{13, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_FRAGMENT_BIT, nullptr},
 		};
 
 		desc_set_layout_ci.bindingCount = static_cast<uint32_t>(desc_set_layout_bindings.size());
 		desc_set_layout_ci.pBindings = desc_set_layout_bindings.data();
 		result = vkCreateDescriptorSetLayout(VulkanRHI::get().getDevice(), &desc_set_layout_ci, nullptr, &m_desc_set_layouts[2]);
 		CHECK_VULKAN_RESULT(result, "create composition descriptor set layout");
+		desc_set_layout_ci.flags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_PUSH_DESCRIPTOR_BIT_KHR;
 
 		// transparency descriptor set layouts
 		desc_set_layout_bindings = {
@@ -332,9 +351,10 @@ namespace Bamboo
 			{6, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_FRAGMENT_BIT, nullptr},
 			{7, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_FRAGMENT_BIT, nullptr},
 			{8, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_FRAGMENT_BIT, nullptr},
-			{9, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, MAX_POINT_LIGHT_NUM, VK_SHADER_STAGE_FRAGMENT_BIT, nullptr},
-			{10, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, MAX_SPOT_LIGHT_NUM, VK_SHADER_STAGE_FRAGMENT_BIT, nullptr},
+			{10, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_FRAGMENT_BIT, nullptr},
 			{11, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1, VK_SHADER_STAGE_FRAGMENT_BIT, nullptr},
+			{12, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_FRAGMENT_BIT, nullptr},
+			{13, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_FRAGMENT_BIT, nullptr},
 		};
 
 		desc_set_layout_ci.bindingCount = static_cast<uint32_t>(desc_set_layout_bindings.size());
@@ -342,13 +362,14 @@ namespace Bamboo
 		result = vkCreateDescriptorSetLayout(VulkanRHI::get().getDevice(), &desc_set_layout_ci, nullptr, &m_desc_set_layouts[3]);
 		CHECK_VULKAN_RESULT(result, "create transparency static mesh descriptor set layout");
 
-		desc_set_layout_bindings.insert(desc_set_layout_bindings.begin(), { 0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1, VK_SHADER_STAGE_VERTEX_BIT, nullptr });
+		desc_set_layout_bindings.insert(desc_set_layout_bindings.begin(), { 0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_VERTEX_BIT, nullptr });
 		desc_set_layout_ci.bindingCount = static_cast<uint32_t>(desc_set_layout_bindings.size());
 		desc_set_layout_ci.pBindings = desc_set_layout_bindings.data();
 		result = vkCreateDescriptorSetLayout(VulkanRHI::get().getDevice(), &desc_set_layout_ci, nullptr, &m_desc_set_layouts[4]);
 		CHECK_VULKAN_RESULT(result, "create transparency skeletal mesh descriptor set layout");
 
-		// skybox descriptor set layouts
+		// skybox descriptor set layouts, cached
+		desc_set_layout_ci.flags = 0;
 		desc_set_layout_bindings = {
 			{0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_FRAGMENT_BIT, nullptr}
 		};
@@ -358,7 +379,7 @@ namespace Bamboo
 		result = vkCreateDescriptorSetLayout(VulkanRHI::get().getDevice(), &desc_set_layout_ci, nullptr, &m_desc_set_layouts[5]);
 		CHECK_VULKAN_RESULT(result, "create skybox descriptor set layout");
 
-		// billboard descriptor set layouts
+		// billboard descriptor set layouts, cached
 		result = vkCreateDescriptorSetLayout(VulkanRHI::get().getDevice(), &desc_set_layout_ci, nullptr, &m_desc_set_layouts[7]);
 		CHECK_VULKAN_RESULT(result, "create billboard descriptor set layout");
 
@@ -444,31 +465,10 @@ namespace Bamboo
 		m_color_blend_ci.pAttachments = m_color_blend_attachments.data();
 
 		// vertex input
-		// vertex bindings
+		// static mesh vertex bindings and attributes, the gbuffer reads previous positions for motion vectors
 		std::vector<VkVertexInputBindingDescription> vertex_input_binding_descriptions;
-		vertex_input_binding_descriptions.resize(1, VkVertexInputBindingDescription{});
-		vertex_input_binding_descriptions[0].binding = 0;
-		vertex_input_binding_descriptions[0].stride = sizeof(StaticVertex);
-		vertex_input_binding_descriptions[0].inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
-
-		// vertex attributes
 		std::vector<VkVertexInputAttributeDescription> vertex_input_attribute_descriptions;
-		vertex_input_attribute_descriptions.resize(3, VkVertexInputAttributeDescription{});
-
-		vertex_input_attribute_descriptions[0].binding = 0;
-		vertex_input_attribute_descriptions[0].location = 0;
-		vertex_input_attribute_descriptions[0].format = VK_FORMAT_R32G32B32_SFLOAT;
-		vertex_input_attribute_descriptions[0].offset = offsetof(StaticVertex, m_position);
-
-		vertex_input_attribute_descriptions[1].binding = 0;
-		vertex_input_attribute_descriptions[1].location = 1;
-		vertex_input_attribute_descriptions[1].format = VK_FORMAT_R32G32_SFLOAT;
-		vertex_input_attribute_descriptions[1].offset = offsetof(StaticVertex, m_tex_coord);
-
-		vertex_input_attribute_descriptions[2].binding = 0;
-		vertex_input_attribute_descriptions[2].location = 2;
-		vertex_input_attribute_descriptions[2].format = VK_FORMAT_R32G32B32_SFLOAT;
-		vertex_input_attribute_descriptions[2].offset = offsetof(StaticVertex, m_normal);
+		Mesh::getVertexInputDescriptions(false, vertex_input_binding_descriptions, vertex_input_attribute_descriptions, true);
 
 		VkPipelineVertexInputStateCreateInfo vertex_input_ci{};
 		vertex_input_ci.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
@@ -480,7 +480,7 @@ namespace Bamboo
 		// shader stages
 		const auto& shader_manager = g_engine.shaderManager();
 		std::vector<VkPipelineShaderStageCreateInfo> shader_stage_cis = {
-			shader_manager->getShaderStageCI("static_mesh.vert", VK_SHADER_STAGE_VERTEX_BIT),
+			shader_manager->getShaderStageCI("static_mesh_motion.vert", VK_SHADER_STAGE_VERTEX_BIT),
 			shader_manager->getShaderStageCI("gbuffer.frag", VK_SHADER_STAGE_FRAGMENT_BIT)
 		};
 
@@ -498,7 +498,13 @@ namespace Bamboo
 		VkResult result = vkCreateGraphicsPipelines(VulkanRHI::get().getDevice(), m_pipeline_cache, 1, &m_pipeline_ci, nullptr, &m_pipelines[0]);
 		CHECK_VULKAN_RESULT(result, "create gbuffer static mesh graphics pipeline");
 
-		// create transparency static mesh pipeline
+		// create transparency static mesh pipeline, it writes no motion vectors
+		Mesh::getVertexInputDescriptions(false, vertex_input_binding_descriptions, vertex_input_attribute_descriptions);
+		vertex_input_ci.vertexBindingDescriptionCount = static_cast<uint32_t>(vertex_input_binding_descriptions.size());
+		vertex_input_ci.pVertexBindingDescriptions = vertex_input_binding_descriptions.data();
+		vertex_input_ci.vertexAttributeDescriptionCount = static_cast<uint32_t>(vertex_input_attribute_descriptions.size());
+		vertex_input_ci.pVertexAttributeDescriptions = vertex_input_attribute_descriptions.data();
+		shader_stage_cis[0] = shader_manager->getShaderStageCI("static_mesh.vert", VK_SHADER_STAGE_VERTEX_BIT);
 		m_color_blend_ci.attachmentCount = 1;
 		m_color_blend_attachments[0].blendEnable = VK_TRUE;
 		shader_stage_cis[1] = shader_manager->getShaderStageCI("forward_lighting.frag", VK_SHADER_STAGE_FRAGMENT_BIT);
@@ -525,18 +531,7 @@ namespace Bamboo
 		m_depth_stencil_ci.depthCompareOp = VK_COMPARE_OP_LESS;
 
 		// create gbuffer skeletal mesh pipeline
-		vertex_input_binding_descriptions[0].stride = sizeof(SkeletalVertex);
-
-		vertex_input_attribute_descriptions.resize(5);
-		vertex_input_attribute_descriptions[3].binding = 0;
-		vertex_input_attribute_descriptions[3].location = 3;
-		vertex_input_attribute_descriptions[3].format = VK_FORMAT_R32G32B32A32_SINT;
-		vertex_input_attribute_descriptions[3].offset = offsetof(SkeletalVertex, m_bones);
-
-		vertex_input_attribute_descriptions[4].binding = 0;
-		vertex_input_attribute_descriptions[4].location = 4;
-		vertex_input_attribute_descriptions[4].format = VK_FORMAT_R32G32B32A32_SFLOAT;
-		vertex_input_attribute_descriptions[4].offset = offsetof(SkeletalVertex, m_weights);
+		Mesh::getVertexInputDescriptions(true, vertex_input_binding_descriptions, vertex_input_attribute_descriptions);
 
 		vertex_input_ci.vertexAttributeDescriptionCount = static_cast<uint32_t>(vertex_input_attribute_descriptions.size());
 		vertex_input_ci.pVertexAttributeDescriptions = vertex_input_attribute_descriptions.data();
@@ -606,6 +601,7 @@ namespace Bamboo
 		// vertex input
 		vertex_input_binding_descriptions[0].stride = sizeof(DebugDrawVertex);
 		vertex_input_attribute_descriptions[1].format = VK_FORMAT_R32G32B32_SFLOAT;
+		vertex_input_attribute_descriptions[1].offset = offsetof(DebugDrawVertex, color);
 		vertex_input_ci.vertexAttributeDescriptionCount = 2;
 
 		// shader stages
@@ -625,33 +621,31 @@ namespace Bamboo
 
 	void MainPass::createFramebuffer()
 	{
+		// color texture is sampled by later passes, it's only an input attachment of composition
 		VulkanUtil::createImageViewSampler(m_width, m_height, nullptr, 1, 1, m_formats[0],
 			VK_FILTER_LINEAR, VK_FILTER_LINEAR, VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE, m_color_texture_sampler,
-			VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT);
+			VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT);
+		m_color_texture_sampler.descriptor_type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
 		VulkanUtil::createImageViewSampler(m_width, m_height, nullptr, 1, 1, m_formats[1], 
-			VK_FILTER_NEAREST, VK_FILTER_NEAREST, VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE, m_normal_texture_sampler, 
+			VK_FILTER_NEAREST, VK_FILTER_NEAREST, VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE, m_normal_roughness_texture_sampler, 
 			VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT);
 		VulkanUtil::createImageViewSampler(m_width, m_height, nullptr, 1, 1, m_formats[2], 
-			VK_FILTER_NEAREST, VK_FILTER_NEAREST, VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE, m_base_color_texture_sampler, 
-			VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT);
-		VulkanUtil::createImageViewSampler(m_width, m_height, nullptr, 1, 1, m_formats[3],
-			VK_FILTER_NEAREST, VK_FILTER_NEAREST, VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE, m_emissive_texture_sampler, 
+			VK_FILTER_NEAREST, VK_FILTER_NEAREST, VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE, m_base_color_metallic_texture_sampler, 
 			VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT);
-		VulkanUtil::createImageViewSampler(m_width, m_height, nullptr, 1, 1, m_formats[4], 
-			VK_FILTER_NEAREST, VK_FILTER_NEAREST, VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE, m_metallic_roughness_occlusion_texture_sampler, 
-			VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT);
-		VulkanUtil::createImageViewSampler(m_width, m_height, nullptr, 1, 1, m_formats[5], 
+		VulkanUtil::createImageViewSampler(m_width, m_height, nullptr, 1, 1, m_formats[3], 
 			VK_FILTER_NEAREST, VK_FILTER_NEAREST, VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE, m_depth_stencil_texture_sampler,
 			VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT);
+		VulkanUtil::createImageViewSampler(m_width, m_height, nullptr, 1, 1, m_formats[4],
+			VK_FILTER_NEAREST, VK_FILTER_NEAREST, VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE, m_velocity_texture_sampler,
+			VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT);
 
 		// 2.create framebuffer
 		std::vector<VkImageView> attachments = {
 			m_color_texture_sampler.view,
-			m_normal_texture_sampler.view,
-			m_base_color_texture_sampler.view,
-			m_emissive_texture_sampler.view,
-			m_metallic_roughness_occlusion_texture_sampler.view,
-			m_depth_stencil_texture_sampler.view
+			m_normal_roughness_texture_sampler.view,
+			m_base_color_metallic_texture_sampler.view,
+			m_depth_stencil_texture_sampler.view,
+			m_velocity_texture_sampler.view
 		};
 
 		VkFramebufferCreateInfo framebuffer_ci{};
@@ -670,15 +664,56 @@ namespace Bamboo
 	void MainPass::destroyResizableObjects()
 	{
 		m_color_texture_sampler.destroy();
-		m_normal_texture_sampler.destroy();
-		m_base_color_texture_sampler.destroy();
-		m_emissive_texture_sampler.destroy();
-		m_metallic_roughness_occlusion_texture_sampler.destroy();
+		m_normal_roughness_texture_sampler.destroy();
+		m_base_color_metallic_texture_sampler.destroy();
 		m_depth_stencil_texture_sampler.destroy();
+		m_velocity_texture_sampler.destroy();
+		m_desc_set_cache.clear();
 
 		RenderPass::destroyResizableObjects();
 	}
 
+	VkExtent2D MainPass::getRenderExtent()
+	{
+		return { std::max(static_cast<uint32_t>(m_width * m_render_scale), 1u), std::max(static_cast<uint32_t>(m_height * m_render_scale), 1u) };
+	}
+
+	VkDescriptorSet MainPass::getCompositionDescriptorSet(uint32_t flight_index)
+	{
+		m_desc_writes.clear();
+
+		// input attachments and ibl textures
+		VmaImageViewSampler emissive_occlusion_texture_sampler = m_color_texture_sampler;
+		emissive_occlusion_texture_sampler.image_layout = VK_IMAGE_LAYOUT_GENERAL;
+		emissive_occlusion_texture_sampler.descriptor_type = VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT;
+		addImageDescriptorSet(m_desc_writes, m_desc_image_infos[0], m_normal_roughness_texture_sampler, 0);
+		addImageDescriptorSet(m_desc_writes, m_desc_image_infos[1], m_base_color_metallic_texture_sampler, 1);
+		addImageDescriptorSet(m_desc_writes, m_desc_image_infos[2], emissive_occlusion_texture_sampler, 2);
+		addImageDescriptorSet(m_desc_writes, m_desc_image_infos[3], m_depth_stencil_texture_sampler, 3);
+		addImageDescriptorSet(m_desc_writes, m_desc_image_infos[5], m_lighting_render_data->irradiance_texture, 5);
+		addImageDescriptorSet(m_desc_writes, m_desc_image_infos[6], m_lighting_render_data->prefilter_texture, 6);
+		addImageDescriptorSet(m_desc_writes, m_desc_image_infos[7], m_lighting_render_data->brdf_lut_texture, 7);
+		addImageDescriptorSet(m_desc_writes, m_desc_image_infos[8], m_lighting_render_data->directional_light_shadow_texture, 8);
+
+		// point and spot light shadow atlas
+		addImageDescriptorSet(m_desc_writes, m_desc_image_infos[9], m_lighting_render_data->local_light_shadow_atlas, 10);
+
+		// lighting uniform buffer and clustered light storage buffers
+		addBufferDescriptorSet(m_desc_writes, m_desc_buffer_infos[0], m_lighting_render_data->lighting_ubs[flight_index], 11);
+		addBufferDescriptorSet(m_desc_writes, m_desc_buffer_infos[1], m_lighting_render_data->light_sbs[flight_index], 12, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
+		addBufferDescriptorSet(m_desc_writes, m_desc_buffer_infos[2], m_lighting_render_data->light_cluster_sbs[flight_index], 13, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
+
+		return m_desc_set_cache.getDescriptorSet(m_desc_set_layouts[2], m_desc_writes);
+	}
+
+	VkDescriptorSet MainPass::getTextureDescriptorSet(VkDescriptorSetLayout desc_set_layout, const VmaImageViewSampler& texture)
+	{
+		m_desc_writes.clear();
+		addImageDescriptorSet(m_desc_writes, m_desc_image_infos[0], texture, 0);
+
+		return m_desc_set_cache.getDescriptorSet(desc_set_layout, m_desc_writes);
+	}
+
 	void MainPass::render_mesh(const std::shared_ptr<RenderData>& render_data, ERendererType renderer_type)
 	{
 		VkCommandBuffer command_buffer = VulkanRHI::get().getCommandBuffer();
@@ -699,73 +734,85 @@ namespace Bamboo
 		// bind pipeline
 		vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
 
-		// bind vertex and index buffer
-		VkBuffer vertexBuffers[] = { static_mesh_render_data->vertex_buffer.buffer };
-		VkDeviceSize offsets[] = { 0 };
-		vkCmdBindVertexBuffers(command_buffer, 0, 1, vertexBuffers, offsets);
-		vkCmdBindIndexBuffer(command_buffer, static_mesh_render_data->index_buffer.buffer, 0, VK_INDEX_TYPE_UINT32);
+		// bind vertex buffers, static meshes also bind their previous vertices, index buffers are bound per sub mesh index type
+		VkBuffer vertexBuffers[] = { static_mesh_render_data->vertex_buffer.buffer, static_mesh_render_data->prev_vertex_buffer.buffer };
+		VkDeviceSize offsets[] = { 0, 0 };
+		vkCmdBindVertexBuffers(command_buffer, 0, is_skeletal_mesh ? 1 : 2, vertexBuffers, offsets);
+
+		// both frames' projections are jittered alike, so motion vectors are free of jitter
+		TransformPCO transform_pco = static_mesh_render_data->transform_pco;
+		transform_pco.mvp = m_jitter_matrix * transform_pco.mvp;
+		transform_pco.prev_mvp = m_jitter_matrix * transform_pco.prev_mvp;
 
 		// render all sub meshes
 		std::vector<uint32_t>& index_counts = static_mesh_render_data->index_counts;
 		std::vector<uint32_t>& index_offsets = static_mesh_render_data->index_offsets;
 		size_t sub_mesh_count = index_counts.size();
+		VkIndexType index_type = VK_INDEX_TYPE_MAX_ENUM;
 		for (size_t i = 0; i < sub_mesh_count; ++i)
 		{
 			// push constants
-			updatePushConstants(command_buffer, pipeline_layout, { &static_mesh_render_data->transform_pco, &static_mesh_render_data->material_pcos[i] });
+			updatePushConstants(command_buffer, pipeline_layout, { &transform_pco, &static_mesh_render_data->material_pcos[i] });
 
-			// update(push) sub mesh descriptors
-			std::vector<VkWriteDescriptorSet> desc_writes;
-			std::array<VkDescriptorBufferInfo, 2> desc_buffer_infos{};
-			std::array<VkDescriptorImageInfo, 24> desc_image_infos{};
+			// update(push) sub mesh descriptors, reusing the descriptor writes storage
+			std::vector<VkWriteDescriptorSet>& desc_writes = m_desc_writes;
+			std::array<VkDescriptorBufferInfo, 4> desc_buffer_infos{};
+			// 5 forward lighting textures followed by 4 material textures
+			std::array<VkDescriptorImageInfo, 9> desc_image_infos{};
+			desc_writes.clear();
 
 			// bone matrix ubo
 			if (is_skeletal_mesh)
 			{
-				addBufferDescriptorSet(desc_writes, desc_buffer_infos[0], skeletal_mesh_render_data->bone_ubs[flight_index], 0);
+				addBufferDescriptorSet(desc_writes, desc_buffer_infos[0], skeletal_mesh_render_data->bone_palette, 0,
+					VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, skeletal_mesh_render_data->bone_palette_offset, skeletal_mesh_render_data->bone_palette_size);
 			}
 
 			// forward rendering
 			if (renderer_type == ERendererType::Forward)
 			{
-				// lighting ubo
+				// lighting ubo and clustered light ssbos
 				addBufferDescriptorSet(desc_writes, desc_buffer_infos[1], m_lighting_render_data->lighting_ubs[flight_index], 11);
+				addBufferDescriptorSet(desc_writes, desc_buffer_infos[2], m_lighting_render_data->light_sbs[flight_index], 12, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
+				addBufferDescriptorSet(desc_writes, desc_buffer_infos[3], m_lighting_render_data->light_cluster_sbs[flight_index], 13, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
 
 				// ibl textures
-				std::vector<VmaImageViewSampler> ibl_textures = {
-					m_lighting_render_data->irradiance_texture,
-					m_lighting_render_data->prefilter_texture,
-					m_lighting_render_data->brdf_lut_texture,
-					m_lighting_render_data->directional_light_shadow_texture,
-				};
-				const uint32_t k_binding_offset = 5;
-				for (size_t t = 0; t < ibl_textures.size(); ++t)
-				{
-					addImageDescriptorSet(desc_writes, desc_image_infos[t], ibl_textures[t], static_cast<uint32_t>(t + k_binding_offset));
-				}
-
-				addImagesDescriptorSet(desc_writes, &desc_image_infos[ibl_textures.size()], m_lighting_render_data->point_light_shadow_textures, ibl_textures.size() + k_binding_offset);
-				addImagesDescriptorSet(desc_writes, &desc_image_infos[ibl_textures.size() + m_lighting_render_data->point_light_shadow_textures.size()], 
-					m_lighting_render_data->spot_light_shadow_textures, ibl_textures.size() + k_binding_offset + 1);
+				addImageDescriptorSet(desc_writes, desc_image_infos[0], m_lighting_render_data->irradiance_texture, 5);
+				addImageDescriptorSet(desc_writes, desc_image_infos[1], m_lighting_render_data->prefilter_texture, 6);
+				addImageDescriptorSet(desc_writes, desc_image_infos[2], m_lighting_render_data->brdf_lut_texture, 7);
+				addImageDescriptorSet(desc_writes, desc_image_infos[3], m_lighting_render_data->directional_light_shadow_texture, 8);
+				addImageDescriptorSet(desc_writes, desc_image_infos[4], m_lighting_render_data->local_light_shadow_atlas, 10);
 			}
 			
 			// image sampler
-			std::vector<VmaImageViewSampler> pbr_textures = {
-				static_mesh_render_data->pbr_textures[i].base_color_texure,
-				static_mesh_render_data->pbr_textures[i].metallic_roughness_occlusion_texure,
-				static_mesh_render_data->pbr_textures[i].normal_texure,
-				static_mesh_render_data->pbr_textures[i].emissive_texure,
-			};
-			for (size_t t = 0; t < pbr_textures.size(); ++t)
-			{
-				addImageDescriptorSet(desc_writes, desc_image_infos[t + 20], pbr_textures[t], static_cast<uint32_t>(t + 1));
-			}
+			const PBRTexture& pbr_texture = static_mesh_render_data->pbr_textures[i];
+			addImageDescriptorSet(desc_writes, desc_image_infos[5], pbr_texture.base_color_texure, 1);
+			addImageDescriptorSet(desc_writes, desc_image_infos[6], pbr_texture.metallic_roughness_occlusion_texure, 2);
+			addImageDescriptorSet(desc_writes, desc_image_infos[7], pbr_texture.normal_texure, 3);
+			addImageDescriptorSet(desc_writes, desc_image_infos[8], pbr_texture.emissive_texure, 4);
 
 			VulkanRHI::get().getVkCmdPushDescriptorSetKHR()(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
 				pipeline_layout, 0, static_cast<uint32_t>(desc_writes.size()), desc_writes.data());
 
 			// render sub mesh
-			vkCmdDrawIndexed(command_buffer, index_counts[i], 1, index_offsets[i], 0, 0);
+			if (static_mesh_render_data->index_types[i] != index_type)
+			{
+				index_type = static_mesh_render_data->index_types[i];
+				vkCmdBindIndexBuffer(command_buffer, static_mesh_render_data->index_buffer.buffer, 0, index_type);
+			}
+
+			// meshlets which survived gpu culling are drawn with the draw count written by meshlet cull pass
+			if (static_mesh_render_data->meshlet_draw_count_buffer.buffer && static_mesh_render_data->meshlet_counts[i] > 0)
+			{
+				vkCmdDrawIndexedIndirectCount(command_buffer, static_mesh_render_data->meshlet_draw_command_buffer.buffer,
+					sizeof(VkDrawIndexedIndirectCommand) * static_mesh_render_data->meshlet_draw_offsets[i],
+					static_mesh_render_data->meshlet_draw_count_buffer.buffer, sizeof(uint32_t) * static_mesh_render_data->meshlet_count_indices[i],
+					static_mesh_render_data->meshlet_counts[i], sizeof(VkDrawIndexedIndirectCommand));
+			}
+			else
+			{
+				vkCmdDrawIndexed(command_buffer, index_counts[i], 1, index_offsets[i], static_mesh_render_data->vertex_offsets[i], 0);
+			}
 		}
 	}
 
@@ -1,6 +1,9 @@
 #pragma once
 
 #include "render_pass.h"
+#include "engine/core/vulkan/descriptor_set_cache.h"
+
+#include <array>
 
 namespace Bamboo
 {
@@ -9,7 +12,9 @@ namespace Bamboo
 	public:
 		MainPass();
 
+		virtual void init() override;
 		virtual void render() override;
+		virtual void destroy() override;
 
 		virtual void createRenderPass() override;
 		virtual void createDescriptorSetLayouts() override;
@@ -28,6 +33,14 @@ namespace Bamboo
 		}
 
 		const VmaImageViewSampler* getColorTexture() { return &m_color_texture_sampler; }
+		const VmaImageViewSampler* getDepthTexture() { return &m_depth_stencil_texture_sampler; }
+		const VmaImageViewSampler* getVelocityTexture() { return &m_velocity_texture_sampler; }
+
+		// dynamic resolution: only the top left render scale region of the attachments is rendered,
+		// jitter offsets the projection of all drawn geometry for temporal upsampling
+		void setRenderScale(float render_scale) { m_render_scale = render_scale; }
+		VkExtent2D getRenderExtent();
+		void setJitterMatrix(const glm::mat4& jitter_matrix) { m_jitter_matrix = jitter_matrix; }
 
 	private:
 		enum class ERendererType
@@ -36,21 +49,31 @@ namespace Bamboo
 		};
 
 		void render_mesh(const std::shared_ptr<RenderData>& render_data, ERendererType renderer_type);
+		VkDescriptorSet getCompositionDescriptorSet(uint32_t flight_index);
+		VkDescriptorSet getTextureDescriptorSet(VkDescriptorSetLayout desc_set_layout, const VmaImageViewSampler& texture);
 
 		std::vector<VkFormat> m_formats;
 
 		// color attachment
 		VmaImageViewSampler m_color_texture_sampler;
 
-		// gbuffer attachment
-		VmaImageViewSampler m_normal_texture_sampler;
-		VmaImageViewSampler m_base_color_texture_sampler;
-		VmaImageViewSampler m_emissive_texture_sampler;
-		VmaImageViewSampler m_metallic_roughness_occlusion_texture_sampler;
+		// gbuffer attachment, emissive and occlusion are written to the color attachment
+		VmaImageViewSampler m_normal_roughness_texture_sampler;
+		VmaImageViewSampler m_base_color_metallic_texture_sampler;
+		VmaImageViewSampler m_velocity_texture_sampler;
 
 		// depth stencil attachment
 		VmaImageViewSampler m_depth_stencil_texture_sampler;
 
+		float m_render_scale = 1.0f;
+		glm::mat4 m_jitter_matrix = glm::mat4(1.0f);
+
+		// cached descriptor sets of composition, skybox and billboards, and reused descriptor writes
+		DescriptorSetCache m_desc_set_cache;
+		std::vector<VkWriteDescriptorSet> m_desc_writes;
+		std::vector<VkDescriptorImageInfo> m_desc_image_infos;
+		std::array<VkDescriptorBufferInfo, 3> m_desc_buffer_infos;
+
 		// extra render data
 		std::vector<std::shared_ptr<RenderData>> m_transparency_render_datas;
 		std::shared_ptr<LightingRenderData> m_lighting_render_data;
@@ -0,0 +1,263 @@
+#include "meshlet_cull_pass.h"
+
+#include "engine/core/vulkan/vulkan_rhi.h"
+#include "engine/resource/shader/shader_manager.h"
+
+#include <array>
+#include <algorithm>
+
+namespace Bamboo
+{
+	// indirect draw commands and sub mesh draw counts of a frame, sub meshes beyond them are drawn whole
+	const uint32_t k_max_meshlet_draw_count = 1 << 16;
+	const uint32_t k_max_meshlet_batch_count = 4096;
+
+	// cone culling is only valid if the transform keeps angles and winding
+	const float k_max_scale_ratio = 1.01f;
+
+	MeshletCullPass::MeshletCullPass()
+	{
+		m_camera_view_proj = glm::mat4(1.0f);
+		m_camera_pos = glm::vec3(0.0f);
+	}
+
+	void MeshletCullPass::init()
+	{
+		RenderPass::init();
+
+		uint32_t flight_count = VulkanRHI::get().getFlightCount();
+		m_draw_command_buffers.resize(flight_count);
+		m_draw_count_buffers.resize(flight_count);
+		for (uint32_t i = 0; i < flight_count; ++i)
+		{
+			VulkanUtil::createBuffer(sizeof(VkDrawIndexedIndirectCommand) * k_max_meshlet_draw_count,
+				VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT,
+				VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE, m_draw_command_buffers[i]);
+			VulkanUtil::createBuffer(sizeof(uint32_t) * k_max_meshlet_batch_count,
+				VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+				VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE, m_draw_count_buffers[i]);
+		}
+	}
+
+	void MeshletCullPass::render()
+	{
+		VkCommandBuffer command_buffer = VulkanRHI::get().getCommandBuffer();
+		uint32_t flight_index = VulkanRHI::get().getFlightIndex();
+		const VmaBuffer& draw_command_buffer = m_draw_command_buffers[flight_index];
+		const VmaBuffer& draw_count_buffer = m_draw_count_buffers[flight_index];
+
+		// reset draw counts, which are appended by compute shaders
+		uint32_t batch_count = static_cast<uint32_t>(m_meshlet_batches.size());
+		vkCmdFillBuffer(command_buffer, draw_count_buffer.buffer, 0, sizeof(uint32_t) * batch_count, 0);
+
+		VkMemoryBarrier barrier{};
+		barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+		barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+		vkCmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+			0, 1, &barrier, 0, nullptr, 0, nullptr);
+
+		vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_pipelines[0]);
+
+		// cull the meshlets of every sub mesh
+		VkBuffer bound_meshlet_buffer = VK_NULL_HANDLE;
+		for (const MeshletBatch& meshlet_batch : m_meshlet_batches)
+		{
+			if (meshlet_batch.meshlet_buffer.buffer != bound_meshlet_buffer)
+			{
+				std::array<VkDescriptorBufferInfo, 3> desc_buffer_infos{};
+				desc_buffer_infos[0] = { meshlet_batch.meshlet_buffer.buffer, 0, VK_WHOLE_SIZE };
+				desc_buffer_infos[1] = { draw_command_buffer.buffer, 0, VK_WHOLE_SIZE };
+				desc_buffer_infos[2] = { draw_count_buffer.buffer, 0, VK_WHOLE_SIZE };
+
+				std::array<VkWriteDescriptorSet, 3> desc_writes{};
+				for (uint32_t b = 0; b < 3; ++b)
+				{
+					desc_writes[b].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+					desc_writes[b].dstBinding = b;
+					desc_writes[b].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+					desc_writes[b].descriptorCount = 1;
+					desc_writes[b].pBufferInfo = &desc_buffer_infos[b];
+				}
+				VulkanRHI::get().getVkCmdPushDescriptorSetKHR()(command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE,
+					m_pipeline_layouts[0], 0, static_cast<uint32_t>(desc_writes.size()), desc_writes.data());
+				bound_meshlet_buffer = meshlet_batch.meshlet_buffer.buffer;
+			}
+
+			updatePushConstants(command_buffer, m_pipeline_layouts[0], { &meshlet_batch.meshlet_cull_pco });
+
+			uint32_t meshlet_count = meshlet_batch.meshlet_cull_pco.meshlet_count;
+			vkCmdDispatch(command_buffer, (meshlet_count + MESHLET_CULL_GROUP_SIZE - 1) / MESHLET_CULL_GROUP_SIZE, 1, 1);
+		}
+
+		// draw commands and counts are read by indirect draws of main pass
+		barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+		barrier.dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT;
+		vkCmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT,
+			0, 1, &barrier, 0, nullptr, 0, nullptr);
+	}
+
+	void MeshletCullPass::destroy()
+	{
+		for (VmaBuffer& draw_command_buffer : m_draw_command_buffers)
+		{
+			draw_command_buffer.destroy();
+		}
+		for (VmaBuffer& draw_count_buffer : m_draw_count_buffers)
+		{
+			draw_count_buffer.destroy();
+		}
+
+		RenderPass::destroy();
+	}
+
+	bool MeshletCullPass::isEnabled()
+	{
+		return RenderPass::isEnabled() && m_is_enabled && !m_meshlet_batches.empty();
+	}
+
+	void MeshletCullPass::assignMeshletDraws()
+	{
+		m_meshlet_batches.clear();
+		if (!m_is_enabled)
+		{
+			return;
+		}
+
+		// world space frustum planes of the camera with [0, 1] depth, normalized so their distances are metric
+		std::array<glm::vec4, 6> frustum_planes;
+		glm::vec4 rows[4];
+		for (int i = 0; i < 4; ++i)
+		{
+			rows[i] = glm::vec4(m_camera_view_proj[0][i], m_camera_view_proj[1][i], m_camera_view_proj[2][i], m_camera_view_proj[3][i]);
+		}
+		frustum_planes[0] = rows[3] + rows[0];
+		frustum_planes[1] = rows[3] - rows[0];
+		frustum_planes[2] = rows[3] + rows[1];
+		frustum_planes[3] = rows[3] - rows[1];
+		frustum_planes[4] = rows[2];
+		frustum_planes[5] = rows[3] - rows[2];
+		for (glm::vec4& frustum_plane : frustum_planes)
+		{
+			frustum_plane /= glm::length(glm::vec3(frustum_plane));
+		}
+
+		uint32_t flight_index = VulkanRHI::get().getFlightIndex();
+		uint32_t draw_count = 0;
+		for (const auto& render_data : m_render_datas)
+		{
+			std::shared_ptr<MeshRenderData> mesh_render_data = std::static_pointer_cast<MeshRenderData>(render_data);
+			size_t sub_mesh_count = mesh_render_data->meshlet_counts.size();
+			mesh_render_data->meshlet_draw_offsets.assign(sub_mesh_count, 0);
+			mesh_render_data->meshlet_count_indices.assign(sub_mesh_count, 0);
+
+			// planes are transformed to object space, and scaled by the largest axis scale to bound the world space radius
+			const glm::mat4& m = mesh_render_data->transform_pco.m;
+			glm::vec3 scales(glm::length(glm::vec3(m[0])), glm::length(glm::vec3(m[1])), glm::length(glm::vec3(m[2])));
+			float max_scale = std::max(std::max(scales.x, scales.y), scales.z);
+			float min_scale = std::min(std::min(scales.x, scales.y), scales.z);
+			if (!mesh_render_data->meshlet_buffer.buffer || min_scale <= 0.0f)
+			{
+				std::fill(mesh_render_data->meshlet_counts.begin(), mesh_render_data->meshlet_counts.end(), 0);
+				continue;
+			}
+			bool is_cone_culled = max_scale <= min_scale * k_max_scale_ratio && glm::determinant(glm::mat3(m)) > 0.0f;
+
+			MeshletCullPCO meshlet_cull_pco{};
+			for (size_t p = 0; p < frustum_planes.size(); ++p)
+			{
+				meshlet_cull_pco.frustum_planes[p] = frustum_planes[p] * m / max_scale;
+			}
+			meshlet_cull_pco.camera_pos = glm::vec4(glm::vec3(glm::inverse(m) * glm::vec4(m_camera_pos, 1.0f)), is_cone_culled ? 1.0f : 0.0f);
+
+			for (size_t i = 0; i < sub_mesh_count; ++i)
+			{
+				uint32_t meshlet_count = mesh_render_data->meshlet_counts[i];
+				if (meshlet_count == 0)
+				{
+					continue;
+				}
+
+				// out of indirect draws, draw the sub mesh whole
+				if (draw_count + meshlet_count > k_max_meshlet_draw_count || m_meshlet_batches.size() >= k_max_meshlet_batch_count)
+				{
+					mesh_render_data->meshlet_counts[i] = 0;
+					continue;
+				}
+
+				meshlet_cull_pco.meshlet_offset = mesh_render_data->meshlet_offsets[i];
+				meshlet_cull_pco.meshlet_count = meshlet_count;
+				meshlet_cull_pco.draw_offset = draw_count;
+				meshlet_cull_pco.count_index = static_cast<uint32_t>(m_meshlet_batches.size());
+				mesh_render_data->meshlet_draw_offsets[i] = meshlet_cull_pco.draw_offset;
+				mesh_render_data->meshlet_count_indices[i] = meshlet_cull_pco.count_index;
+				m_meshlet_batches.push_back({ mesh_render_data->meshlet_buffer, meshlet_cull_pco });
+				draw_count += meshlet_count;
+			}
+
+			mesh_render_data->meshlet_draw_command_buffer = m_draw_command_buffers[flight_index];
+			mesh_render_data->meshlet_draw_count_buffer = m_draw_count_buffers[flight_index];
+		}
+	}
+
+	void MeshletCullPass::createRenderPass()
+	{
+		// compute pass, no render pass
+	}
+
+	void MeshletCullPass::createDescriptorSetLayouts()
+	{
+		std::vector<VkDescriptorSetLayoutBinding> desc_set_layout_bindings = {
+			{0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_COMPUTE_BIT, nullptr},
+			{1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_COMPUTE_BIT, nullptr},
+			{2, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_COMPUTE_BIT, nullptr}
+		};
+
+		VkDescriptorSetLayoutCreateInfo desc_set_layout_ci{};
+		desc_set_layout_ci.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+		desc_set_layout_ci.flags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_PUSH_DESCRIPTOR_BIT_KHR;
+		desc_set_layout_ci.bindingCount = static_cast<uint32_t>(desc_set_layout_bindings.size());
+		desc_set_layout_ci.pBindings = desc_set_layout_bindings.data();
+
+		m_desc_set_layouts.resize(1);
+		VkResult result = vkCreateDescriptorSetLayout(VulkanRHI::get().getDevice(), &desc_set_layout_ci, nullptr, &m_desc_set_layouts[0]);
+		CHECK_VULKAN_RESULT(result, "create descriptor set layout");
+	}
+
+	void MeshletCullPass::createPipelineLayouts()
+	{
+		m_push_constant_ranges =
+		{
+			{ VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(MeshletCullPCO) }
+		};
+
+		VkPipelineLayoutCreateInfo pipeline_layout_ci{};
+		pipeline_layout_ci.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+		pipeline_layout_ci.setLayoutCount = 1;
+		pipeline_layout_ci.pSetLayouts = &m_desc_set_layouts[0];
+		pipeline_layout_ci.pushConstantRangeCount = static_cast<uint32_t>(m_push_constant_ranges.size());
+		pipeline_layout_ci.pPushConstantRanges = m_push_constant_ranges.data();
+
+		m_pipeline_layouts.resize(1);
+		VkResult result = vkCreatePipelineLayout(VulkanRHI::get().getDevice(), &pipeline_layout_ci, nullptr, &m_pipeline_layouts[0]);
+		CHECK_VULKAN_RESULT(result, "create pipeline layout");
+	}
+
+	void MeshletCullPass::createPipelines()
+	{
+		VkComputePipelineCreateInfo compute_pipeline_ci{};
+		compute_pipeline_ci.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+		compute_pipeline_ci.stage = g_engine.shaderManager()->getShaderStageCI("meshlet_cull.comp", VK_SHADER_STAGE_COMPUTE_BIT);
+		compute_pipeline_ci.layout = m_pipeline_layouts[0];
+
+		m_pipelines.resize(1);
+		VkResult result = vkCreateComputePipelines(VulkanRHI::get().getDevice(), m_pipeline_cache, 1, &compute_pipeline_ci, nullptr, &m_pipelines[0]);
+		CHECK_VULKAN_RESULT(result, "create meshlet cull compute pipeline");
+	}
+
+	void MeshletCullPass::createFramebuffer()
+	{
+		// compute pass, no framebuffer
+	}
+
+}
\ No newline at end of file
@@ -0,0 +1,49 @@
+#pragma once
+
+#include "render_pass.h"
+
+namespace Bamboo
+{
+	// meshlet culling: the meshlets of static mesh sub meshes are tested against the camera frustum and their normal cones
+	// by compute shaders, which append the visible ones to indirect draw commands of each sub mesh,
+	// main pass draws them with the draw counts written on gpu
+	class MeshletCullPass : public RenderPass
+	{
+	public:
+		MeshletCullPass();
+
+		virtual void init() override;
+		virtual void render() override;
+		virtual void destroy() override;
+		virtual bool isEnabled() override;
+
+		virtual void createRenderPass() override;
+		virtual void createDescriptorSetLayouts() override;
+		virtual void createPipelineLayouts() override;
+		virtual void createPipelines() override;
+		virtual void createFramebuffer() override;
+
+		void setEnabled(bool is_enabled) { m_is_enabled = is_enabled; }
+		void setCamera(const glm::mat4& camera_view_proj, const glm::vec3& camera_pos) { m_camera_view_proj = camera_view_proj; m_camera_pos = camera_pos; }
+
+		// assign indirect draws to the sub meshes of render datas which have meshlets, the others are drawn whole,
+		// must be called after the render datas are set
+		void assignMeshletDraws();
+
+	private:
+		struct MeshletBatch
+		{
+			VmaBuffer meshlet_buffer;
+			MeshletCullPCO meshlet_cull_pco;
+		};
+
+		bool m_is_enabled = false;
+		glm::mat4 m_camera_view_proj;
+		glm::vec3 m_camera_pos;
+		std::vector<MeshletBatch> m_meshlet_batches;
+
+		// indirect draw commands and their counts of each flight
+		std::vector<VmaBuffer> m_draw_command_buffers;
+		std::vector<VmaBuffer> m_draw_count_buffers;
+	};
+}
\ No newline at end of file
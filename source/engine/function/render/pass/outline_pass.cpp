@@ -14,36 +14,20 @@ namespace Bamboo
 
 	void OutlinePass::render()
 	{
-		// render to framebuffer
-		VkClearValue clear_values[1];
-		clear_values[0].color = { { 0.0f, 0.0f, 0.0f, 0.0f } };
-
-		VkRenderPassBeginInfo render_pass_bi{};
-		render_pass_bi.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-		render_pass_bi.renderPass = m_render_passes[0];
-		render_pass_bi.renderArea.extent.width = m_width;
-		render_pass_bi.renderArea.extent.height = m_height;
-		render_pass_bi.clearValueCount = 1;
-		render_pass_bi.pClearValues = clear_values;
-		render_pass_bi.framebuffer = m_framebuffers[0];
-
 		VkCommandBuffer command_buffer = VulkanRHI::get().getCommandBuffer();
-		uint32_t flight_index = VulkanRHI::get().getFlightIndex();
-
-		VkViewport viewport{};
-		viewport.width = static_cast<float>(m_width);
-		viewport.height = static_cast<float>(m_height);
-		viewport.minDepth = 0.0f;
-		viewport.maxDepth = 1.0f;
-
-		VkRect2D scissor{};
-		scissor.extent.width = m_width;
-		scissor.extent.height = m_height;
 
-		vkCmdSetViewport(command_buffer, 0, 1, &viewport);
-		vkCmdSetScissor(command_buffer, 0, 1, &scissor);
+		// transition outline color texture to color attachment, previous contents are discarded
+		VkImageAspectFlags aspect_flags = VulkanUtil::calcImageAspectFlags(m_format);
+		VulkanUtil::cmdImageBarrier(command_buffer, m_color_texture_samplers[0].image(), aspect_flags, 1,
+			VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+			VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0,
+			VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT);
 
-		vkCmdBeginRenderPass(command_buffer, &render_pass_bi, VK_SUBPASS_CONTENTS_INLINE);
+		// render to outline color texture
+		VkClearValue clear_value;
+		clear_value.color = { { 0.0f, 0.0f, 0.0f, 0.0f } };
+		beginRendering(command_buffer, m_width, m_height, 1, {
+			getRenderingAttachment(m_color_texture_samplers[0].view, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, clear_value) });
 
 		// render meshes
 		for (const auto& render_data : m_render_datas)
@@ -65,16 +49,16 @@ namespace Bamboo
 				// bind pipeline
 				vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
 
-				// bind vertex and index buffer
+				// bind vertex buffer, index buffers are bound per sub mesh index type
 				VkBuffer vertexBuffers[] = { static_mesh_render_data->vertex_buffer.buffer };
 				VkDeviceSize offsets[] = { 0 };
 				vkCmdBindVertexBuffers(command_buffer, 0, 1, vertexBuffers, offsets);
-				vkCmdBindIndexBuffer(command_buffer, static_mesh_render_data->index_buffer.buffer, 0, VK_INDEX_TYPE_UINT32);
 
 				// render all sub meshes
 				std::vector<uint32_t>& index_counts = static_mesh_render_data->index_counts;
 				std::vector<uint32_t>& index_offsets = static_mesh_render_data->index_offsets;
 				size_t sub_mesh_count = index_counts.size();
+				VkIndexType index_type = VK_INDEX_TYPE_MAX_ENUM;
 				for (size_t i = 0; i < sub_mesh_count; ++i)
 				{
 					// push constants
@@ -88,7 +72,8 @@ namespace Bamboo
 					// bone matrix ubo
 					if (is_skeletal_mesh)
 					{
-						addBufferDescriptorSet(desc_writes, desc_buffer_infos[0], skeletal_mesh_render_data->bone_ubs[flight_index], 0);
+						addBufferDescriptorSet(desc_writes, desc_buffer_infos[0], skeletal_mesh_render_data->bone_palette, 0,
+							VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, skeletal_mesh_render_data->bone_palette_offset, skeletal_mesh_render_data->bone_palette_size);
 					}
 
 					// base color texture image sampler
@@ -98,7 +83,12 @@ namespace Bamboo
 						pipeline_layout, 0, static_cast<uint32_t>(desc_writes.size()), desc_writes.data());
 
 					// render sub mesh
-					vkCmdDrawIndexed(command_buffer, index_counts[i], 1, index_offsets[i], 0, 0);
+					if (static_mesh_render_data->index_types[i] != index_type)
+					{
+						index_type = static_mesh_render_data->index_types[i];
+						vkCmdBindIndexBuffer(command_buffer, static_mesh_render_data->index_buffer.buffer, 0, index_type);
+					}
+					vkCmdDrawIndexed(command_buffer, index_counts[i], 1, index_offsets[i], static_mesh_render_data->vertex_offsets[i], 0);
 				}
 			}
 		}
@@ -120,12 +110,21 @@ namespace Bamboo
 			vkCmdDraw(command_buffer, 1, 1, 0, 0);
 		}
 
-		vkCmdEndRenderPass(command_buffer);
+		vkCmdEndRendering(command_buffer);
+
+		// outline color texture is sampled by the blur pass, which renders to the blurred color texture
+		VulkanUtil::cmdImageBarrier(command_buffer, m_color_texture_samplers[0].image(), aspect_flags, 1,
+			VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+			VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
+			VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT);
+		VulkanUtil::cmdImageBarrier(command_buffer, m_color_texture_samplers[1].image(), aspect_flags, 1,
+			VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+			VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0,
+			VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT);
 
 		// blur pass
-		render_pass_bi.renderPass = m_render_passes[1];
-		render_pass_bi.framebuffer = m_framebuffers[1];
-		vkCmdBeginRenderPass(command_buffer, &render_pass_bi, VK_SUBPASS_CONTENTS_INLINE);
+		beginRendering(command_buffer, m_width, m_height, 1, {
+			getRenderingAttachment(m_color_texture_samplers[1].view, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, clear_value) });
 		vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pipelines[3]);
 
 		std::vector<VkWriteDescriptorSet> desc_writes;
@@ -137,81 +136,18 @@ namespace Bamboo
 		VulkanRHI::get().getVkCmdPushDescriptorSetKHR()(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
 			m_pipeline_layouts[3], 0, static_cast<uint32_t>(desc_writes.size()), desc_writes.data());
 		vkCmdDraw(command_buffer, 3, 1, 0, 0);
-		vkCmdEndRenderPass(command_buffer);
-	}
-
-	void OutlinePass::destroy()
-	{
-		RenderPass::destroy();
+		vkCmdEndRendering(command_buffer);
 
-		for (uint32_t i = 0; i < 2; ++i)
-		{
-			vkDestroyRenderPass(VulkanRHI::get().getDevice(), m_render_passes[i], nullptr);
-		}
+		// transition blurred color texture for sampling in postprocess pass
+		VulkanUtil::cmdImageBarrier(command_buffer, m_color_texture_samplers[1].image(), aspect_flags, 1,
+			VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+			VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
+			VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT);
 	}
 
 	void OutlinePass::createRenderPass()
 	{
-		// color attachment
-		std::array<VkAttachmentDescription, 1> attachments = {};
-		attachments[0].format = m_format;
-		attachments[0].samples = VK_SAMPLE_COUNT_1_BIT;
-		attachments[0].loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
-		attachments[0].storeOp = VK_ATTACHMENT_STORE_OP_STORE;
-		attachments[0].stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
-		attachments[0].stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-		attachments[0].initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-		attachments[0].finalLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-		VkAttachmentReference color_reference = { 0, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL };
-
-		// subpass
-		VkSubpassDescription subpass_desc{};
-		subpass_desc.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
-		subpass_desc.colorAttachmentCount = 1;
-		subpass_desc.pColorAttachments = &color_reference;
-
-		// subpass dependencies
-		std::array<VkSubpassDependency, 2> dependencies;
-		dependencies[0].srcSubpass = 0;
-		dependencies[0].dstSubpass = VK_SUBPASS_EXTERNAL;
-		dependencies[0].srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-		dependencies[0].dstStageMask = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
-		dependencies[0].srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
-		dependencies[0].dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
-		dependencies[0].dependencyFlags = 0;
-
-		// create outline render pass
-		VkRenderPassCreateInfo render_pass_ci{};
-		render_pass_ci.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
-		render_pass_ci.attachmentCount = 1;
-		render_pass_ci.pAttachments = attachments.data();
-		render_pass_ci.subpassCount = 1;
-		render_pass_ci.pSubpasses = &subpass_desc;
-		render_pass_ci.dependencyCount = 1;
-		render_pass_ci.pDependencies = dependencies.data();
-
-		VkResult result = vkCreateRenderPass(VulkanRHI::get().getDevice(), &render_pass_ci, nullptr, &m_render_passes[0]);
-		CHECK_VULKAN_RESULT(result, "create outline render pass");
-
-		// create blur render pass
-		dependencies[0].srcSubpass = VK_SUBPASS_EXTERNAL;
-		dependencies[0].dstSubpass = 0;
-		dependencies[0].srcStageMask = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
-		dependencies[0].dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-		dependencies[0].srcAccessMask = VK_ACCESS_SHADER_READ_BIT;
-		dependencies[0].dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
-		dependencies[0].dependencyFlags = 0;
-
-		dependencies[1].srcSubpass = 0;
-		dependencies[1].dstSubpass = VK_SUBPASS_EXTERNAL;
-		dependencies[1].srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-		dependencies[1].dstStageMask = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
-		dependencies[1].srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
-		dependencies[1].dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
-		dependencies[1].dependencyFlags = 0;
-
-		result = vkCreateRenderPass(VulkanRHI::get().getDevice(), &render_pass_ci, nullptr, &m_render_passes[1]);
-		CHECK_VULKAN_RESULT(result, "create blur render pass");
+		// rendered with dynamic rendering, no render pass objects are needed
 	}
 
 	void OutlinePass::createDescriptorSetLayouts()
@@ -230,7 +166,7 @@ namespace Bamboo
 		VkResult result = vkCreateDescriptorSetLayout(VulkanRHI::get().getDevice(), &desc_set_layout_ci, nullptr, &m_desc_set_layouts[0]);
 		CHECK_VULKAN_RESULT(result, "create static mesh/billboard descriptor set layout");
 
-		desc_set_layout_bindings.insert(desc_set_layout_bindings.begin(), { 0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1, VK_SHADER_STAGE_VERTEX_BIT, nullptr });
+		desc_set_layout_bindings.insert(desc_set_layout_bindings.begin(), { 0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_VERTEX_BIT, nullptr });
 		desc_set_layout_ci.bindingCount = static_cast<uint32_t>(desc_set_layout_bindings.size());
 		desc_set_layout_ci.pBindings = desc_set_layout_bindings.data();
 		result = vkCreateDescriptorSetLayout(VulkanRHI::get().getDevice(), &desc_set_layout_ci, nullptr, &m_desc_set_layouts[1]);
@@ -290,31 +226,10 @@ namespace Bamboo
 	void OutlinePass::createPipelines()
 	{
 		// vertex input state
-		// vertex bindings
+		// static mesh vertex bindings and attributes
 		std::vector<VkVertexInputBindingDescription> vertex_input_binding_descriptions;
-		vertex_input_binding_descriptions.resize(1, VkVertexInputBindingDescription{});
-		vertex_input_binding_descriptions[0].binding = 0;
-		vertex_input_binding_descriptions[0].stride = sizeof(StaticVertex);
-		vertex_input_binding_descriptions[0].inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
-
-		// static mesh vertex attributes
 		std::vector<VkVertexInputAttributeDescription> vertex_input_attribute_descriptions;
-		vertex_input_attribute_descriptions.resize(3, VkVertexInputAttributeDescription{});
-
-		vertex_input_attribute_descriptions[0].binding = 0;
-		vertex_input_attribute_descriptions[0].location = 0;
-		vertex_input_attribute_descriptions[0].format = VK_FORMAT_R32G32B32_SFLOAT;
-		vertex_input_attribute_descriptions[0].offset = offsetof(StaticVertex, m_position);
-
-		vertex_input_attribute_descriptions[1].binding = 0;
-		vertex_input_attribute_descriptions[1].location = 1;
-		vertex_input_attribute_descriptions[1].format = VK_FORMAT_R32G32_SFLOAT;
-		vertex_input_attribute_descriptions[1].offset = offsetof(StaticVertex, m_tex_coord);
-
-		vertex_input_attribute_descriptions[2].binding = 0;
-		vertex_input_attribute_descriptions[2].location = 2;
-		vertex_input_attribute_descriptions[2].format = VK_FORMAT_R32G32B32_SFLOAT;
-		vertex_input_attribute_descriptions[2].offset = offsetof(StaticVertex, m_normal);
+		Mesh::getVertexInputDescriptions(false, vertex_input_binding_descriptions, vertex_input_attribute_descriptions);
 
 		VkPipelineVertexInputStateCreateInfo vertex_input_ci{};
 		vertex_input_ci.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
@@ -335,26 +250,14 @@ namespace Bamboo
 		m_pipeline_ci.pStages = shader_stage_cis.data();
 		m_pipeline_ci.pVertexInputState = &vertex_input_ci;
 		m_pipeline_ci.layout = m_pipeline_layouts[0];
-		m_pipeline_ci.renderPass = m_render_passes[0];
-		m_pipeline_ci.subpass = 0;
+		setRenderingFormats({ m_format });
 
 		m_pipelines.resize(4);
 		VkResult result = vkCreateGraphicsPipelines(VulkanRHI::get().getDevice(), m_pipeline_cache, 1, &m_pipeline_ci, nullptr, &m_pipelines[0]);
 		CHECK_VULKAN_RESULT(result, "create outline pass's static mesh graphics pipeline");
 
-		// skeletal mesh vertex attributes
-		vertex_input_binding_descriptions[0].stride = sizeof(SkeletalVertex);
-
-		vertex_input_attribute_descriptions.resize(5);
-		vertex_input_attribute_descriptions[3].binding = 0;
-		vertex_input_attribute_descriptions[3].location = 3;
-		vertex_input_attribute_descriptions[3].format = VK_FORMAT_R32G32B32A32_SINT;
-		vertex_input_attribute_descriptions[3].offset = offsetof(SkeletalVertex, m_bones);
-
-		vertex_input_attribute_descriptions[4].binding = 0;
-		vertex_input_attribute_descriptions[4].location = 4;
-		vertex_input_attribute_descriptions[4].format = VK_FORMAT_R32G32B32A32_SFLOAT;
-		vertex_input_attribute_descriptions[4].offset = offsetof(SkeletalVertex, m_weights);
+		// skeletal mesh vertex bindings and attributes
+		Mesh::getVertexInputDescriptions(true, vertex_input_binding_descriptions, vertex_input_attribute_descriptions);
 
 		vertex_input_ci.vertexAttributeDescriptionCount = static_cast<uint32_t>(vertex_input_attribute_descriptions.size());
 		vertex_input_ci.pVertexAttributeDescriptions = vertex_input_attribute_descriptions.data();
@@ -403,7 +306,6 @@ namespace Bamboo
 			shader_manager->getShaderStageCI("box_blur.frag", VK_SHADER_STAGE_FRAGMENT_BIT)
 		};
 
-		m_pipeline_ci.renderPass = m_render_passes[1];
 		m_pipeline_ci.pVertexInputState = &blur_vertex_input_ci;
 		m_pipeline_ci.layout = m_pipeline_layouts[3];
 		m_pipeline_ci.stageCount = static_cast<uint32_t>(shader_stage_cis.size());
@@ -414,25 +316,12 @@ namespace Bamboo
 
 	void OutlinePass::createFramebuffer()
 	{
+		// create color images and views, rendered with dynamic rendering so no framebuffers are needed
 		for (uint32_t i = 0; i < 2; ++i)
 		{
-			// 1.create color images and view
 			VulkanUtil::createImageViewSampler(m_width, m_height, nullptr, 1, 1, m_format,
 				VK_FILTER_LINEAR, VK_FILTER_LINEAR, VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE, m_color_texture_samplers[i],
 				VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT);
-
-			// 2.create framebuffer
-			VkFramebufferCreateInfo framebuffer_ci{};
-			framebuffer_ci.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
-			framebuffer_ci.renderPass = m_render_passes[i];
-			framebuffer_ci.attachmentCount = 1;
-			framebuffer_ci.pAttachments = &m_color_texture_samplers[i].view;
-			framebuffer_ci.width = m_width;
-			framebuffer_ci.height = m_height;
-			framebuffer_ci.layers = 1;
-
-			VkResult result = vkCreateFramebuffer(VulkanRHI::get().getDevice(), &framebuffer_ci, nullptr, &m_framebuffers[i]);
-			CHECK_VULKAN_RESULT(result, "create outline pass frame buffer");
 		}
 
 		VulkanUtil::transitionImageLayout(m_color_texture_samplers[1].image(), VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, m_format);
@@ -443,10 +332,6 @@ namespace Bamboo
 		for (uint32_t i = 0; i < 2; ++i)
 		{
 			m_color_texture_samplers[i].destroy();
-			if (m_color_texture_samplers[i].view)
-			{
-				vkDestroyFramebuffer(VulkanRHI::get().getDevice(), m_framebuffers[i], nullptr);
-			}
 		}
 
 		RenderPass::destroyResizableObjects();
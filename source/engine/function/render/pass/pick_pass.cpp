@@ -25,37 +25,27 @@ namespace Bamboo
 		StopWatch stop_watch;
 		stop_watch.start();
 
-		// render to framebuffer
+		VkCommandBuffer command_buffer = VulkanUtil::beginInstantCommands();
+
+		// transition color/depth images to attachments, previous contents are discarded
+		VkImageAspectFlags color_aspect_flags = VulkanUtil::calcImageAspectFlags(m_formats[0]);
+		VulkanUtil::cmdImageBarrier(command_buffer, m_color_image_view.image(), color_aspect_flags, 1,
+			VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+			VK_PIPELINE_STAGE_TRANSFER_BIT, 0,
+			VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT);
+		VulkanUtil::cmdImageBarrier(command_buffer, m_depth_image_view.image(), VulkanUtil::calcImageAspectFlags(m_formats[1]), 1,
+			VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
+			VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT, 0,
+			VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT, VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT);
+
+		// render to color image, depth is only needed during rendering
 		VkClearValue clear_values[2];
 		clear_values[0].color = { { 0.0f, 0.0f, 0.0f, 1.0f } };
 		clear_values[1].depthStencil = { 1.0f, 0 };
-
-		VkRenderPassBeginInfo render_pass_bi{};
-		render_pass_bi.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-		render_pass_bi.renderPass = m_render_pass;
-		render_pass_bi.renderArea.extent.width = m_width;
-		render_pass_bi.renderArea.extent.height = m_height;
-		render_pass_bi.clearValueCount = 2;
-		render_pass_bi.pClearValues = clear_values;
-		render_pass_bi.framebuffer = m_framebuffer;
-
-		VkCommandBuffer command_buffer = VulkanUtil::beginInstantCommands();
-		uint32_t flight_index = 0;
-
-		VkViewport viewport{};
-		viewport.width = static_cast<float>(m_width);
-		viewport.height = static_cast<float>(m_height);
-		viewport.minDepth = 0.0f;
-		viewport.maxDepth = 1.0f;
-
-		VkRect2D scissor{};
-		scissor.extent.width = m_width;
-		scissor.extent.height = m_height;
-
-		vkCmdSetViewport(command_buffer, 0, 1, &viewport);
-		vkCmdSetScissor(command_buffer, 0, 1, &scissor);
-
-		vkCmdBeginRenderPass(command_buffer, &render_pass_bi, VK_SUBPASS_CONTENTS_INLINE);
+		VkRenderingAttachmentInfo depth_attachment = getRenderingAttachment(m_depth_image_view.view, 
+			VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL, clear_values[1], VK_ATTACHMENT_STORE_OP_DONT_CARE);
+		beginRendering(command_buffer, m_width, m_height, 1, {
+			getRenderingAttachment(m_color_image_view.view, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, clear_values[0]) }, &depth_attachment);
 
 		// render meshes
 		uint32_t entity_index = 0;
@@ -76,16 +66,16 @@ namespace Bamboo
 			// bind pipeline
 			vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
 
-			// bind vertex and index buffer
+			// bind vertex buffer, index buffers are bound per sub mesh index type
 			VkBuffer vertexBuffers[] = { static_mesh_render_data->vertex_buffer.buffer };
 			VkDeviceSize offsets[] = { 0 };
 			vkCmdBindVertexBuffers(command_buffer, 0, 1, vertexBuffers, offsets);
-			vkCmdBindIndexBuffer(command_buffer, static_mesh_render_data->index_buffer.buffer, 0, VK_INDEX_TYPE_UINT32);
 
 			// render all sub meshes
 			std::vector<uint32_t>& index_counts = static_mesh_render_data->index_counts;
 			std::vector<uint32_t>& index_offsets = static_mesh_render_data->index_offsets;
 			size_t sub_mesh_count = index_counts.size();
+			VkIndexType index_type = VK_INDEX_TYPE_MAX_ENUM;
 			glm::vec4 color = encodeEntityID(m_entity_ids[entity_index++]);
 			for (size_t i = 0; i < sub_mesh_count; ++i)
 			{
@@ -99,14 +89,20 @@ namespace Bamboo
 					std::vector<VkWriteDescriptorSet> desc_writes;
 					std::array<VkDescriptorBufferInfo, 1> desc_buffer_infos{};
 
-					addBufferDescriptorSet(desc_writes, desc_buffer_infos[0], skeletal_mesh_render_data->bone_ubs[flight_index], 0);
+					addBufferDescriptorSet(desc_writes, desc_buffer_infos[0], skeletal_mesh_render_data->bone_palette, 0,
+						VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, skeletal_mesh_render_data->bone_palette_offset, skeletal_mesh_render_data->bone_palette_size);
 
 					VulkanRHI::get().getVkCmdPushDescriptorSetKHR()(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
 						pipeline_layout, 0, static_cast<uint32_t>(desc_writes.size()), desc_writes.data());
 				}
 
 				// render sub mesh
-				vkCmdDrawIndexed(command_buffer, index_counts[i], 1, index_offsets[i], 0, 0);
+				if (static_mesh_render_data->index_types[i] != index_type)
+				{
+					index_type = static_mesh_render_data->index_types[i];
+					vkCmdBindIndexBuffer(command_buffer, static_mesh_render_data->index_buffer.buffer, 0, index_type);
+				}
+				vkCmdDrawIndexed(command_buffer, index_counts[i], 1, index_offsets[i], static_mesh_render_data->vertex_offsets[i], 0);
 			}
 		}
 
@@ -121,12 +117,18 @@ namespace Bamboo
 			vkCmdDraw(command_buffer, 1, 1, 0, 0);
 		}
 
-		vkCmdEndRenderPass(command_buffer);
+		vkCmdEndRendering(command_buffer);
+
+		// transition color image for copying back to host
+		VulkanUtil::cmdImageBarrier(command_buffer, m_color_image_view.image(), color_aspect_flags, 1,
+			VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+			VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
+			VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_READ_BIT);
 
 		VulkanUtil::endInstantCommands(command_buffer);
 
 		std::vector<uint8_t> image_data;
-		VulkanUtil::extractImage(m_color_image_view.image(), m_width, m_height, m_formats[0], image_data);
+		VulkanUtil::extractImage(m_color_image_view.image(), m_width, m_height, m_formats[0], image_data, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL);
 
 		uint32_t entity_id = decodeEntityID(&image_data[(m_mouse_y * m_width + m_mouse_x) * 4]);
 		g_engine.eventSystem()->asyncDispatch(std::make_shared<SelectEntityEvent>(entity_id));
@@ -137,48 +139,7 @@ namespace Bamboo
 
 	void PickPass::createRenderPass()
 	{
-		// color attachment
-		std::array<VkAttachmentDescription, 2> attachments = {};
-		attachments[0].format = m_formats[0];
-		attachments[0].samples = VK_SAMPLE_COUNT_1_BIT;
-		attachments[0].loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
-		attachments[0].storeOp = VK_ATTACHMENT_STORE_OP_STORE;
-		attachments[0].stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
-		attachments[0].stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-		attachments[0].initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-		attachments[0].finalLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
-		VkAttachmentReference color_reference = { 0, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL };
-
-		// depth attachment
-		attachments[1].format = m_formats[1];
-		attachments[1].samples = VK_SAMPLE_COUNT_1_BIT;
-		attachments[1].loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
-		attachments[1].storeOp = VK_ATTACHMENT_STORE_OP_STORE;
-		attachments[1].stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
-		attachments[1].stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-		attachments[1].initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-		attachments[1].finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
-		VkAttachmentReference depth_reference = { 1, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL };
-
-		// subpass
-		VkSubpassDescription subpass_desc{};
-		subpass_desc.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
-		subpass_desc.colorAttachmentCount = 1;
-		subpass_desc.pColorAttachments = &color_reference;
-		subpass_desc.pDepthStencilAttachment = &depth_reference;
-
-		// create render pass
-		VkRenderPassCreateInfo render_pass_ci{};
-		render_pass_ci.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
-		render_pass_ci.attachmentCount = 2;
-		render_pass_ci.pAttachments = attachments.data();
-		render_pass_ci.subpassCount = 1;
-		render_pass_ci.pSubpasses = &subpass_desc;
-		render_pass_ci.dependencyCount = 0;
-		render_pass_ci.pDependencies = nullptr;
-
-		VkResult result = vkCreateRenderPass(VulkanRHI::get().getDevice(), &render_pass_ci, nullptr, &m_render_pass);
-		CHECK_VULKAN_RESULT(result, "create render pass");
+		// rendered with dynamic rendering, no render pass object is needed
 	}
 
 	void PickPass::createDescriptorSetLayouts()
@@ -192,7 +153,7 @@ namespace Bamboo
 		CHECK_VULKAN_RESULT(result, "create static mesh/billboard descriptor set layout");
 
 		std::vector<VkDescriptorSetLayoutBinding> desc_set_layout_bindings = {
-			{ 0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1, VK_SHADER_STAGE_VERTEX_BIT, nullptr }
+			{ 0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_VERTEX_BIT, nullptr }
 		};
 		desc_set_layout_ci.bindingCount = static_cast<uint32_t>(desc_set_layout_bindings.size());
 		desc_set_layout_ci.pBindings = desc_set_layout_bindings.data();
@@ -239,31 +200,10 @@ namespace Bamboo
 	void PickPass::createPipelines()
 	{
 		// vertex input state
-		// vertex bindings
+		// static mesh vertex bindings and attributes
 		std::vector<VkVertexInputBindingDescription> vertex_input_binding_descriptions;
-		vertex_input_binding_descriptions.resize(1, VkVertexInputBindingDescription{});
-		vertex_input_binding_descriptions[0].binding = 0;
-		vertex_input_binding_descriptions[0].stride = sizeof(StaticVertex);
-		vertex_input_binding_descriptions[0].inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
-
-		// static mesh vertex attributes
 		std::vector<VkVertexInputAttributeDescription> vertex_input_attribute_descriptions;
-		vertex_input_attribute_descriptions.resize(3, VkVertexInputAttributeDescription{});
-
-		vertex_input_attribute_descriptions[0].binding = 0;
-		vertex_input_attribute_descriptions[0].location = 0;
-		vertex_input_attribute_descriptions[0].format = VK_FORMAT_R32G32B32_SFLOAT;
-		vertex_input_attribute_descriptions[0].offset = offsetof(StaticVertex, m_position);
-
-		vertex_input_attribute_descriptions[1].binding = 0;
-		vertex_input_attribute_descriptions[1].location = 1;
-		vertex_input_attribute_descriptions[1].format = VK_FORMAT_R32G32_SFLOAT;
-		vertex_input_attribute_descriptions[1].offset = offsetof(StaticVertex, m_tex_coord);
-
-		vertex_input_attribute_descriptions[2].binding = 0;
-		vertex_input_attribute_descriptions[2].location = 2;
-		vertex_input_attribute_descriptions[2].format = VK_FORMAT_R32G32B32_SFLOAT;
-		vertex_input_attribute_descriptions[2].offset = offsetof(StaticVertex, m_normal);
+		Mesh::getVertexInputDescriptions(false, vertex_input_binding_descriptions, vertex_input_attribute_descriptions);
 
 		VkPipelineVertexInputStateCreateInfo vertex_input_ci{};
 		vertex_input_ci.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
@@ -284,26 +224,14 @@ namespace Bamboo
 		m_pipeline_ci.pStages = shader_stage_cis.data();
 		m_pipeline_ci.pVertexInputState = &vertex_input_ci;
 		m_pipeline_ci.layout = m_pipeline_layouts[0];
-		m_pipeline_ci.renderPass = m_render_pass;
-		m_pipeline_ci.subpass = 0;
+		setRenderingFormats({ m_formats[0] }, m_formats[1]);
 
 		m_pipelines.resize(3);
 		VkResult result = vkCreateGraphicsPipelines(VulkanRHI::get().getDevice(), m_pipeline_cache, 1, &m_pipeline_ci, nullptr, &m_pipelines[0]);
 		CHECK_VULKAN_RESULT(result, "create pick pass's static mesh graphics pipeline");
 
-		// skeletal mesh vertex attributes
-		vertex_input_binding_descriptions[0].stride = sizeof(SkeletalVertex);
-
-		vertex_input_attribute_descriptions.resize(5);
-		vertex_input_attribute_descriptions[3].binding = 0;
-		vertex_input_attribute_descriptions[3].location = 3;
-		vertex_input_attribute_descriptions[3].format = VK_FORMAT_R32G32B32A32_SINT;
-		vertex_input_attribute_descriptions[3].offset = offsetof(SkeletalVertex, m_bones);
-
-		vertex_input_attribute_descriptions[4].binding = 0;
-		vertex_input_attribute_descriptions[4].location = 4;
-		vertex_input_attribute_descriptions[4].format = VK_FORMAT_R32G32B32A32_SFLOAT;
-		vertex_input_attribute_descriptions[4].offset = offsetof(SkeletalVertex, m_weights);
+		// skeletal mesh vertex bindings and attributes
+		Mesh::getVertexInputDescriptions(true, vertex_input_binding_descriptions, vertex_input_attribute_descriptions);
 
 		vertex_input_ci.vertexAttributeDescriptionCount = static_cast<uint32_t>(vertex_input_attribute_descriptions.size());
 		vertex_input_ci.pVertexAttributeDescriptions = vertex_input_attribute_descriptions.data();
@@ -337,7 +265,7 @@ namespace Bamboo
 
 	void PickPass::createFramebuffer()
 	{
-		// 1.create color/depth images and view
+		// create color/depth images and views, rendered with dynamic rendering so no framebuffer is needed
 		VulkanUtil::createImageAndView(m_width, m_height, 1, 1, VK_SAMPLE_COUNT_1_BIT, m_formats[0],
 			VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT,
 			VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE,
@@ -346,24 +274,6 @@ namespace Bamboo
 			VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT,
 			VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE,
 			VK_IMAGE_ASPECT_DEPTH_BIT, m_depth_image_view);
-
-		// 2.create framebuffer
-		std::array<VkImageView, 2> attachments = {
-			m_color_image_view.view,
-			m_depth_image_view.view
-		};
-
-		VkFramebufferCreateInfo framebuffer_ci{};
-		framebuffer_ci.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
-		framebuffer_ci.renderPass = m_render_pass;
-		framebuffer_ci.attachmentCount = 2;
-		framebuffer_ci.pAttachments = attachments.data();
-		framebuffer_ci.width = m_width;
-		framebuffer_ci.height = m_height;
-		framebuffer_ci.layers = 1;
-
-		VkResult result = vkCreateFramebuffer(VulkanRHI::get().getDevice(), &framebuffer_ci, nullptr, &m_framebuffer);
-		CHECK_VULKAN_RESULT(result, "create pick pass frame buffer");
 	}
 
 	void PickPass::createResizableObjects(uint32_t width, uint32_t height)
@@ -21,36 +21,24 @@ namespace Bamboo
 	{
 		std::shared_ptr<PostProcessRenderData> postprocess_render_data = std::static_pointer_cast<PostProcessRenderData>(m_render_datas.front());
 
-		// render to framebuffer
-		VkClearValue clear_value;
-		clear_value.color = { { 0.0f, 0.0f, 0.0f, 1.0f } };
-
-		VkRenderPassBeginInfo render_pass_bi{};
-		render_pass_bi.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-		render_pass_bi.renderPass = m_render_pass;
-		render_pass_bi.renderArea.extent.width = m_width;
-		render_pass_bi.renderArea.extent.height = m_height;
-		render_pass_bi.clearValueCount = 1;
-		render_pass_bi.pClearValues = &clear_value;
-		render_pass_bi.framebuffer = m_framebuffer;
-
 		VkCommandBuffer command_buffer = VulkanRHI::get().getCommandBuffer();
 		uint32_t flight_index = VulkanRHI::get().getFlightIndex();
 
-		VkViewport viewport{};
-		viewport.width = static_cast<float>(m_width);
-		viewport.height = static_cast<float>(m_height);
-		viewport.minDepth = 0.0f;
-		viewport.maxDepth = 1.0f;
-
-		VkRect2D scissor{};
-		scissor.extent.width = m_width;
-		scissor.extent.height = m_height;
+		// transition color texture to color attachment, previous contents are discarded
+		VkImageAspectFlags aspect_flags = VulkanUtil::calcImageAspectFlags(m_format);
+		VulkanUtil::cmdImageBarrier(command_buffer, m_color_texture_sampler.image(), aspect_flags, 1,
+			VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+			VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0,
+			VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT);
 
-		vkCmdSetViewport(command_buffer, 0, 1, &viewport);
-		vkCmdSetScissor(command_buffer, 0, 1, &scissor);
+		// render to color texture
+		VkClearValue clear_value;
+		clear_value.color = { { 0.0f, 0.0f, 0.0f, 1.0f } };
+		std::vector<VkRenderingAttachmentInfo> color_attachments = {
+			getRenderingAttachment(m_color_texture_sampler.view, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, clear_value)
+		};
+		beginRendering(command_buffer, m_width, m_height, 1, color_attachments);
 
-		vkCmdBeginRenderPass(command_buffer, &render_pass_bi, VK_SUBPASS_CONTENTS_INLINE);
 		vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pipelines[0]);
 
 		std::vector<VkWriteDescriptorSet> desc_writes;
@@ -69,7 +57,13 @@ namespace Bamboo
 		VulkanRHI::get().getVkCmdPushDescriptorSetKHR()(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
 			m_pipeline_layouts[0], 0, static_cast<uint32_t>(desc_writes.size()), desc_writes.data());
 		vkCmdDraw(command_buffer, 3, 1, 0, 0);
-		vkCmdEndRenderPass(command_buffer);
+		vkCmdEndRendering(command_buffer);
+
+		// transition color texture for sampling in ui pass
+		VulkanUtil::cmdImageBarrier(command_buffer, m_color_texture_sampler.image(), aspect_flags, 1,
+			VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+			VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
+			VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT);
 	}
 
 	void PostprocessPass::destroy()
@@ -81,54 +75,7 @@ namespace Bamboo
 
 	void PostprocessPass::createRenderPass()
 	{
-		// color attachment
-		VkAttachmentDescription color_attachment{};
-		color_attachment.format = m_format;
-		color_attachment.samples = VK_SAMPLE_COUNT_1_BIT;
-		color_attachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
-		color_attachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
-		color_attachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
-		color_attachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-		color_attachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-		color_attachment.finalLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-		VkAttachmentReference color_reference = { 0, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL };
-
-		// subpass
-		VkSubpassDescription subpass_desc{};
-		subpass_desc.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
-		subpass_desc.colorAttachmentCount = 1;
-		subpass_desc.pColorAttachments = &color_reference;
-
-		// subpass dependencies
-		std::array<VkSubpassDependency, 2> dependencies;
-		dependencies[0].srcSubpass = VK_SUBPASS_EXTERNAL;
-		dependencies[0].dstSubpass = 0;
-		dependencies[0].srcStageMask = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
-		dependencies[0].dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-		dependencies[0].srcAccessMask = VK_ACCESS_SHADER_READ_BIT;
-		dependencies[0].dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
-		dependencies[0].dependencyFlags = 0;
-
-		dependencies[1].srcSubpass = 0;
-		dependencies[1].dstSubpass = VK_SUBPASS_EXTERNAL;
-		dependencies[1].srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-		dependencies[1].dstStageMask = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
-		dependencies[1].srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
-		dependencies[1].dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
-		dependencies[1].dependencyFlags = 0;
-
-		// create render pass
-		VkRenderPassCreateInfo render_pass_ci{};
-		render_pass_ci.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
-		render_pass_ci.attachmentCount = 1;
-		render_pass_ci.pAttachments = &color_attachment;
-		render_pass_ci.subpassCount = 1;
-		render_pass_ci.pSubpasses = &subpass_desc;
-		render_pass_ci.dependencyCount = 2;
-		render_pass_ci.pDependencies = dependencies.data();
-
-		VkResult result = vkCreateRenderPass(VulkanRHI::get().getDevice(), &render_pass_ci, nullptr, &m_render_pass);
-		CHECK_VULKAN_RESULT(result, "create postprocess render pass");
+		// rendered with dynamic rendering, no render pass object is needed
 	}
 
 	void PostprocessPass::createDescriptorSetLayouts()
@@ -188,7 +135,7 @@ namespace Bamboo
 			shader_manager->getShaderStageCI("outline_color_grading.frag", VK_SHADER_STAGE_FRAGMENT_BIT)
 		};
 
-		m_pipeline_ci.renderPass = m_render_pass;
+		setRenderingFormats({ m_format });
 		m_pipeline_ci.pVertexInputState = &vertex_input_ci;
 		m_pipeline_ci.layout = m_pipeline_layouts[0];
 		m_pipeline_ci.stageCount = static_cast<uint32_t>(shader_stage_cis.size());
@@ -201,23 +148,10 @@ namespace Bamboo
 
 	void PostprocessPass::createFramebuffer()
 	{
-		// 1.create color images and view
+		// create color image and view, rendered with dynamic rendering so no framebuffer is needed
 		VulkanUtil::createImageViewSampler(m_width, m_height, nullptr, 1, 1, m_format,
 			VK_FILTER_LINEAR, VK_FILTER_LINEAR, VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE, m_color_texture_sampler,
 			VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT);
-
-		// 2.create framebuffer
-		VkFramebufferCreateInfo framebuffer_ci{};
-		framebuffer_ci.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
-		framebuffer_ci.renderPass = m_render_pass;
-		framebuffer_ci.attachmentCount = 1;
-		framebuffer_ci.pAttachments = &m_color_texture_sampler.view;
-		framebuffer_ci.width = m_width;
-		framebuffer_ci.height = m_height;
-		framebuffer_ci.layers = 1;
-
-		VkResult result = vkCreateFramebuffer(VulkanRHI::get().getDevice(), &framebuffer_ci, nullptr, &m_framebuffer);
-		CHECK_VULKAN_RESULT(result, "create postprocess pass frame buffer");
 	}
 
 	void PostprocessPass::destroyResizableObjects()
@@ -308,7 +242,7 @@ namespace Bamboo
 			1,
 			&buffer_copy_region);
 		VulkanUtil::endInstantCommands(command_buffer);
-		vmaDestroyBuffer(VulkanRHI::get().getAllocator(), staging_buffer.buffer, staging_buffer.allocation);
+		staging_buffer.destroy();
 
 		// transition image layout
 		VulkanUtil::transitionImageLayout(m_color_grading_texture_sampler.image(), VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, m_format);
@@ -167,18 +167,19 @@ namespace Bamboo
 	}
 
 	void RenderPass::addBufferDescriptorSet(std::vector<VkWriteDescriptorSet>& desc_writes,
-		VkDescriptorBufferInfo& desc_buffer_info, VmaBuffer buffer, uint32_t binding)
+		VkDescriptorBufferInfo& desc_buffer_info, VmaBuffer buffer, uint32_t binding, VkDescriptorType desc_type,
+		VkDeviceSize offset, VkDeviceSize range)
 	{
 		desc_buffer_info.buffer = buffer.buffer;
-		desc_buffer_info.offset = 0;
-		desc_buffer_info.range = buffer.size;
+		desc_buffer_info.offset = offset;
+		desc_buffer_info.range = range == VK_WHOLE_SIZE ? buffer.size - offset : range;
 
 		VkWriteDescriptorSet desc_write{};
 		desc_write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
 		desc_write.dstSet = 0;
 		desc_write.dstBinding = binding;
 		desc_write.dstArrayElement = 0;
-		desc_write.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+		desc_write.descriptorType = desc_type;
 		desc_write.descriptorCount = 1;
 		desc_write.pBufferInfo = &desc_buffer_info;
 		desc_writes.push_back(desc_write);
@@ -223,4 +224,60 @@ namespace Bamboo
 		desc_writes.push_back(desc_write);
 	}
 
+	void RenderPass::setRenderingFormats(const std::vector<VkFormat>& color_formats, VkFormat depth_format)
+	{
+		m_rendering_color_formats = color_formats;
+
+		m_pipeline_rendering_ci.sType = VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO;
+		m_pipeline_rendering_ci.colorAttachmentCount = static_cast<uint32_t>(m_rendering_color_formats.size());
+		m_pipeline_rendering_ci.pColorAttachmentFormats = m_rendering_color_formats.data();
+		m_pipeline_rendering_ci.depthAttachmentFormat = depth_format;
+		m_pipeline_rendering_ci.stencilAttachmentFormat = VK_FORMAT_UNDEFINED;
+
+		m_pipeline_ci.pNext = &m_pipeline_rendering_ci;
+		m_pipeline_ci.renderPass = VK_NULL_HANDLE;
+		m_pipeline_ci.subpass = 0;
+	}
+
+	VkRenderingAttachmentInfo RenderPass::getRenderingAttachment(VkImageView view, VkImageLayout layout, VkClearValue clear_value,
+		VkAttachmentStoreOp store_op)
+	{
+		VkRenderingAttachmentInfo rendering_attachment{};
+		rendering_attachment.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO;
+		rendering_attachment.imageView = view;
+		rendering_attachment.imageLayout = layout;
+		rendering_attachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+		rendering_attachment.storeOp = store_op;
+		rendering_attachment.clearValue = clear_value;
+		return rendering_attachment;
+	}
+
+	void RenderPass::beginRendering(VkCommandBuffer command_buffer, uint32_t width, uint32_t height, uint32_t layers,
+		const std::vector<VkRenderingAttachmentInfo>& color_attachments, const VkRenderingAttachmentInfo* p_depth_attachment)
+	{
+		VkRenderingInfo rendering_info{};
+		rendering_info.sType = VK_STRUCTURE_TYPE_RENDERING_INFO;
+		rendering_info.renderArea.offset = { 0, 0 };
+		rendering_info.renderArea.extent = { width, height };
+		rendering_info.layerCount = layers;
+		rendering_info.colorAttachmentCount = static_cast<uint32_t>(color_attachments.size());
+		rendering_info.pColorAttachments = color_attachments.data();
+		rendering_info.pDepthAttachment = p_depth_attachment;
+		vkCmdBeginRendering(command_buffer, &rendering_info);
+
+		VkViewport viewport{};
+		viewport.x = 0.0f;
+		viewport.y = 0.0f;
+		viewport.width = static_cast<float>(width);
+		viewport.height = static_cast<float>(height);
+		viewport.minDepth = 0.0f;
+		viewport.maxDepth = 1.0f;
+		vkCmdSetViewport(command_buffer, 0, 1, &viewport);
+
+		VkRect2D scissor{};
+		scissor.offset = { 0, 0 };
+		scissor.extent = { width, height };
+		vkCmdSetScissor(command_buffer, 0, 1, &scissor);
+	}
+
 }
\ No newline at end of file
@@ -28,12 +28,21 @@ namespace Bamboo
 		void updatePushConstants(VkCommandBuffer command_buffer, VkPipelineLayout pipeline_layout, 
 			const std::vector<const void*>& pcos, std::vector<VkPushConstantRange> push_constant_ranges = {});
 		void addBufferDescriptorSet(std::vector<VkWriteDescriptorSet>& desc_writes, 
-			VkDescriptorBufferInfo& desc_buffer_info, VmaBuffer buffer, uint32_t binding);
+			VkDescriptorBufferInfo& desc_buffer_info, VmaBuffer buffer, uint32_t binding, 
+			VkDescriptorType desc_type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, VkDeviceSize offset = 0, VkDeviceSize range = VK_WHOLE_SIZE);
 		void addImageDescriptorSet(std::vector<VkWriteDescriptorSet>& desc_writes, 
 			VkDescriptorImageInfo& desc_image_info, VmaImageViewSampler texture, uint32_t binding);
 		void addImagesDescriptorSet(std::vector<VkWriteDescriptorSet>& desc_writes,
 			VkDescriptorImageInfo* p_desc_image_info, const std::vector<VmaImageViewSampler>& textures, uint32_t binding);
 
+		// dynamic rendering: passes without subpasses render without VkRenderPass/VkFramebuffer,
+		// their pipelines are created against the attachment formats instead
+		void setRenderingFormats(const std::vector<VkFormat>& color_formats, VkFormat depth_format = VK_FORMAT_UNDEFINED);
+		VkRenderingAttachmentInfo getRenderingAttachment(VkImageView view, VkImageLayout layout, VkClearValue clear_value,
+			VkAttachmentStoreOp store_op = VK_ATTACHMENT_STORE_OP_STORE);
+		void beginRendering(VkCommandBuffer command_buffer, uint32_t width, uint32_t height, uint32_t layers,
+			const std::vector<VkRenderingAttachmentInfo>& color_attachments, const VkRenderingAttachmentInfo* p_depth_attachment = nullptr);
+
 		// vulkan objects
 		VkRenderPass m_render_pass = VK_NULL_HANDLE;
 		VkDescriptorPool m_descriptor_pool = VK_NULL_HANDLE;
@@ -54,6 +63,10 @@ namespace Bamboo
 		std::vector<VkDynamicState> m_dynamic_states;
 		VkPipelineDynamicStateCreateInfo m_dynamic_state_ci{};
 
+		// dynamic rendering attachment formats
+		std::vector<VkFormat> m_rendering_color_formats;
+		VkPipelineRenderingCreateInfo m_pipeline_rendering_ci{};
+
 		std::vector<VkPipeline> m_pipelines;
 		VkFramebuffer m_framebuffer = VK_NULL_HANDLE;
 
@@ -0,0 +1,113 @@
+#include "shadow_pass.h"
+#include "engine/core/vulkan/vulkan_rhi.h"
+
+#include <array>
+
+namespace Bamboo
+{
+
+	static uint64_t hashBytes(uint64_t hash, const void* data, size_t size)
+	{
+		// FNV-1a
+		const uint8_t* bytes = static_cast<const uint8_t*>(data);
+		for (size_t i = 0; i < size; ++i)
+		{
+			hash ^= bytes[i];
+			hash *= 1099511628211ull;
+		}
+		return hash;
+	}
+
+	ShadowPass::ShadowPass()
+	{
+		m_is_layered = VulkanRHI::get().isShaderOutputLayerSupported();
+	}
+
+	void ShadowPass::collectShadowCasters()
+	{
+		m_static_render_datas.clear();
+		m_dynamic_render_datas.clear();
+		m_static_caster_hash = 14695981039346656037ull;
+
+		for (const auto& render_data : m_render_datas)
+		{
+			std::shared_ptr<StaticMeshRenderData> static_mesh_render_data = std::static_pointer_cast<StaticMeshRenderData>(render_data);
+			if (!static_mesh_render_data->is_static)
+			{
+				m_dynamic_render_datas.push_back(render_data);
+				continue;
+			}
+			m_static_render_datas.push_back(render_data);
+
+			// buffers and textures are hashed by handle, so re-streamed meshes and textures refresh the cache too
+			m_static_caster_hash = hashBytes(m_static_caster_hash, &static_mesh_render_data->vertex_buffer.buffer, sizeof(VkBuffer));
+			m_static_caster_hash = hashBytes(m_static_caster_hash, &static_mesh_render_data->index_buffer.buffer, sizeof(VkBuffer));
+			m_static_caster_hash = hashBytes(m_static_caster_hash, &static_mesh_render_data->transform_pco.m, sizeof(glm::mat4));
+			for (size_t i = 0; i < static_mesh_render_data->shadow_index_counts.size(); ++i)
+			{
+				m_static_caster_hash = hashBytes(m_static_caster_hash, &static_mesh_render_data->shadow_index_counts[i], sizeof(uint32_t));
+				m_static_caster_hash = hashBytes(m_static_caster_hash, &static_mesh_render_data->shadow_index_offsets[i], sizeof(uint32_t));
+				m_static_caster_hash = hashBytes(m_static_caster_hash, &static_mesh_render_data->pbr_textures[i].base_color_texure.view, sizeof(VkImageView));
+			}
+		}
+	}
+
+	uint64_t ShadowPass::calcShadowCacheKey(const void* light_data, size_t size)
+	{
+		return hashBytes(m_static_caster_hash, light_data, size);
+	}
+
+	uint32_t ShadowPass::calcVisibleLayerMask(const BoundingBox& bounding_box, const glm::mat4* view_projs, uint32_t layer_count)
+	{
+		const glm::vec3& min = bounding_box.m_min;
+		const glm::vec3& max = bounding_box.m_max;
+		std::array<glm::vec4, 8> corners = {
+			glm::vec4(min.x, min.y, min.z, 1.0f), glm::vec4(max.x, min.y, min.z, 1.0f),
+			glm::vec4(min.x, max.y, min.z, 1.0f), glm::vec4(max.x, max.y, min.z, 1.0f),
+			glm::vec4(min.x, min.y, max.z, 1.0f), glm::vec4(max.x, min.y, max.z, 1.0f),
+			glm::vec4(min.x, max.y, max.z, 1.0f), glm::vec4(max.x, max.y, max.z, 1.0f)
+		};
+
+		uint32_t layer_mask = 0;
+		for (uint32_t i = 0; i < layer_count; ++i)
+		{
+			// culled if all corners are outside of one side plane in clip space,
+			// near and far planes aren't tested since casters out of depth range are culled by the rasterizer anyway
+			std::array<uint32_t, 4> outside_counts = { 0, 0, 0, 0 };
+			for (const glm::vec4& corner : corners)
+			{
+				glm::vec4 clip_pos = view_projs[i] * corner;
+				outside_counts[0] += clip_pos.x < -clip_pos.w;
+				outside_counts[1] += clip_pos.x > clip_pos.w;
+				outside_counts[2] += clip_pos.y < -clip_pos.w;
+				outside_counts[3] += clip_pos.y > clip_pos.w;
+			}
+
+			bool is_culled = false;
+			for (uint32_t outside_count : outside_counts)
+			{
+				is_culled |= outside_count == corners.size();
+			}
+			if (!is_culled)
+			{
+				layer_mask |= 1 << i;
+			}
+		}
+		return layer_mask;
+	}
+
+	uint32_t ShadowPass::packLayerIndices(uint32_t layer_mask, uint32_t& layer_count)
+	{
+		uint32_t layer_indices = 0;
+		layer_count = 0;
+		for (uint32_t i = 0; i < 8; ++i)
+		{
+			if (layer_mask & (1 << i))
+			{
+				layer_indices |= i << (4 * layer_count++);
+			}
+		}
+		return layer_indices;
+	}
+
+}
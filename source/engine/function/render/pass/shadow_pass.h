@@ -0,0 +1,36 @@
+#pragma once
+
+#include "render_pass.h"
+
+namespace Bamboo
+{
+	// base of light shadow passes, static casters are rendered once into cached shadow maps per light,
+	// which are only refreshed when a static caster or the light changes,
+	// every frame the cache is copied into the shadow map and only dynamic casters are rendered on top of it
+	class ShadowPass : public RenderPass
+	{
+	public:
+		ShadowPass();
+
+	protected:
+		// split m_render_datas into static and dynamic casters, and hash the static ones
+		void collectShadowCasters();
+
+		// static casters' hash combined with the light parameters, a cached shadow map is valid while its key is unchanged
+		uint64_t calcShadowCacheKey(const void* light_data, size_t size);
+
+		// bit i is set if the world space bounding box may be visible in the i-th layer's view projection
+		static uint32_t calcVisibleLayerMask(const BoundingBox& bounding_box, const glm::mat4* view_projs, uint32_t layer_count);
+
+		// pack indices of the visible layers in 4 bits each, layered pipelines render one instance per visible layer
+		static uint32_t packLayerIndices(uint32_t layer_mask, uint32_t& layer_count);
+
+		// cube faces/cascades are selected with gl_Layer from vertex shader instances if supported,
+		// otherwise a geometry shader amplifies every triangle to all layers
+		bool m_is_layered;
+
+		std::vector<std::shared_ptr<RenderData>> m_static_render_datas;
+		std::vector<std::shared_ptr<RenderData>> m_dynamic_render_datas;
+		uint64_t m_static_caster_hash = 0;
+	};
+}
@@ -0,0 +1,243 @@
+#include "skinning_pass.h"
+
+#include "engine/core/vulkan/vulkan_rhi.h"
+#include "engine/resource/shader/shader_manager.h"
+#include "engine/resource/asset/base/mesh.h"
+
+#include <array>
+
+namespace Bamboo
+{
+	// compute shaders address vertices as 32 bit words
+#if QUANTIZED_VERTEX
+	static_assert(sizeof(QuantizedStaticVertex) == STATIC_VERTEX_WORD_NUM * sizeof(uint32_t), "static vertex size mismatch");
+	static_assert(sizeof(QuantizedSkeletalVertex) == SKELETAL_VERTEX_WORD_NUM * sizeof(uint32_t), "skeletal vertex size mismatch");
+#else
+	static_assert(sizeof(StaticVertex) == STATIC_VERTEX_WORD_NUM * sizeof(uint32_t), "static vertex size mismatch");
+	static_assert(sizeof(SkeletalVertex) == SKELETAL_VERTEX_WORD_NUM * sizeof(uint32_t), "skeletal vertex size mismatch");
+#endif
+
+	void SkinningPass::render()
+	{
+		// skinning only depends on the animation system's bone palettes, so it's recorded on the async compute queue
+		VkCommandBuffer command_buffer = VulkanRHI::get().getComputeCommandBuffer();
+		vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_pipelines[0]);
+
+		// skin the vertices of every skeletal mesh
+		for (const SkinningBatch& skinning_batch : m_skinning_batches)
+		{
+			std::array<VkDescriptorBufferInfo, 3> desc_buffer_infos{};
+			desc_buffer_infos[0] = { skinning_batch.bone_palette.buffer, skinning_batch.bone_palette_offset, skinning_batch.bone_palette_size };
+			desc_buffer_infos[1] = { skinning_batch.skeletal_vertex_buffer.buffer, 0, VK_WHOLE_SIZE };
+			desc_buffer_infos[2] = { skinning_batch.static_vertex_buffer.buffer, 0, VK_WHOLE_SIZE };
+
+			std::array<VkWriteDescriptorSet, 3> desc_writes{};
+			for (uint32_t b = 0; b < 3; ++b)
+			{
+				desc_writes[b].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+				desc_writes[b].dstBinding = b;
+				desc_writes[b].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+				desc_writes[b].descriptorCount = 1;
+				desc_writes[b].pBufferInfo = &desc_buffer_infos[b];
+			}
+			VulkanRHI::get().getVkCmdPushDescriptorSetKHR()(command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE,
+				m_pipeline_layouts[0], 0, static_cast<uint32_t>(desc_writes.size()), desc_writes.data());
+
+			updatePushConstants(command_buffer, m_pipeline_layouts[0], { &skinning_batch.skinning_pco });
+
+			uint32_t vertex_count = skinning_batch.skinning_pco.vertex_count;
+			vkCmdDispatch(command_buffer, (vertex_count + SKINNING_GROUP_SIZE - 1) / SKINNING_GROUP_SIZE, 1, 1);
+		}
+
+		// the graphics submit waits on the compute semaphore at the vertex input stage, which makes the skinned vertices visible,
+		// on a dedicated compute family the exclusive skinned buffers are also released to the graphics family and acquired there
+		if (!VulkanRHI::get().isAsyncCompute())
+		{
+			return;
+		}
+
+		std::vector<VkBufferMemoryBarrier> release_barriers;
+		for (const SkinningBatch& skinning_batch : m_skinning_batches)
+		{
+			VkBufferMemoryBarrier barrier{};
+			barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+			barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+			barrier.dstAccessMask = 0;
+			barrier.srcQueueFamilyIndex = VulkanRHI::get().getComputeQueueFamily();
+			barrier.dstQueueFamilyIndex = VulkanRHI::get().getGraphicsQueueFamily();
+			barrier.buffer = skinning_batch.static_vertex_buffer.buffer;
+			barrier.offset = 0;
+			barrier.size = VK_WHOLE_SIZE;
+			release_barriers.push_back(barrier);
+		}
+		vkCmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+			0, 0, nullptr, static_cast<uint32_t>(release_barriers.size()), release_barriers.data(), 0, nullptr);
+
+		// the acquire barriers must match the release barriers except for their access masks
+		std::vector<VkBufferMemoryBarrier> acquire_barriers = release_barriers;
+		for (VkBufferMemoryBarrier& barrier : acquire_barriers)
+		{
+			barrier.srcAccessMask = 0;
+			barrier.dstAccessMask = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT;
+		}
+		vkCmdPipelineBarrier(VulkanRHI::get().getCommandBuffer(), VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,
+			0, 0, nullptr, static_cast<uint32_t>(acquire_barriers.size()), acquire_barriers.data(), 0, nullptr);
+	}
+
+	void SkinningPass::destroy()
+	{
+		for (auto& iter : m_skinned_vertex_buffers)
+		{
+			for (VmaBuffer& vertex_buffer : iter.second.vertex_buffers)
+			{
+				vertex_buffer.destroy();
+			}
+		}
+		m_skinned_vertex_buffers.clear();
+
+		RenderPass::destroy();
+	}
+
+	bool SkinningPass::isEnabled()
+	{
+		return RenderPass::isEnabled() && m_is_enabled && !m_skinning_batches.empty();
+	}
+
+	void SkinningPass::assignSkinnedVertexBuffers()
+	{
+		m_skinning_batches.clear();
+		uint32_t flight_count = VulkanRHI::get().getFlightCount();
+		uint32_t buffer_count = flight_count + 1;
+		uint64_t frame_index = VulkanRHI::get().getFrameIndex();
+		uint32_t buffer_index = static_cast<uint32_t>(frame_index % buffer_count);
+		uint32_t prev_buffer_index = static_cast<uint32_t>((frame_index + flight_count) % buffer_count);
+
+		if (m_is_enabled)
+		{
+			for (const auto& render_data : m_render_datas)
+			{
+				std::shared_ptr<SkeletalMeshRenderData> skeletal_mesh_render_data = std::static_pointer_cast<SkeletalMeshRenderData>(render_data);
+				uint32_t vertex_count = skeletal_mesh_render_data->vertex_count;
+				if (vertex_count == 0)
+				{
+					continue;
+				}
+
+				// the current buffer was last read by the frame before the oldest in flight frame, which has been waited for,
+				// grow it if the mesh has more vertices
+				SkinnedVertexBuffers& skinned_vertex_buffers = m_skinned_vertex_buffers[skeletal_mesh_render_data->entity_id];
+				skinned_vertex_buffers.vertex_buffers.resize(buffer_count);
+				skinned_vertex_buffers.vertex_counts.resize(buffer_count, 0);
+				skinned_vertex_buffers.frame_indices.resize(buffer_count, UINT64_MAX);
+				skinned_vertex_buffers.last_frame_index = frame_index;
+
+				VmaBuffer& vertex_buffer = skinned_vertex_buffers.vertex_buffers[buffer_index];
+				if (skinned_vertex_buffers.vertex_counts[buffer_index] < vertex_count)
+				{
+					vertex_buffer.destroy();
+					VulkanUtil::createBuffer(vertex_count * STATIC_VERTEX_WORD_NUM * sizeof(uint32_t),
+						VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+						VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE, vertex_buffer);
+					skinned_vertex_buffers.vertex_counts[buffer_index] = vertex_count;
+				}
+				skinned_vertex_buffers.frame_indices[buffer_index] = frame_index;
+
+				// meshes which weren't skinned last frame or have more vertices now have no motion from deformation
+				bool has_prev_vertices = skinned_vertex_buffers.frame_indices[prev_buffer_index] + 1 == frame_index &&
+					skinned_vertex_buffers.vertex_counts[prev_buffer_index] >= vertex_count;
+
+				SkinningBatch skinning_batch;
+				skinning_batch.bone_palette = skeletal_mesh_render_data->bone_palette;
+				skinning_batch.bone_palette_offset = skeletal_mesh_render_data->bone_palette_offset;
+				skinning_batch.bone_palette_size = skeletal_mesh_render_data->bone_palette_size;
+				skinning_batch.skeletal_vertex_buffer = skeletal_mesh_render_data->vertex_buffer;
+				skinning_batch.static_vertex_buffer = vertex_buffer;
+				skinning_batch.skinning_pco.vertex_count = vertex_count;
+				m_skinning_batches.push_back(skinning_batch);
+
+				skeletal_mesh_render_data->vertex_buffer = vertex_buffer;
+				skeletal_mesh_render_data->prev_vertex_buffer = has_prev_vertices ?
+					skinned_vertex_buffers.vertex_buffers[prev_buffer_index] : vertex_buffer;
+				skeletal_mesh_render_data->type = ERenderDataType::StaticMesh;
+			}
+		}
+
+		// release the buffers of entities which aren't skinned anymore, once no flight can still be reading them
+		for (auto iter = m_skinned_vertex_buffers.begin(); iter != m_skinned_vertex_buffers.end();)
+		{
+			if (frame_index - iter->second.last_frame_index > flight_count)
+			{
+				for (VmaBuffer& vertex_buffer : iter->second.vertex_buffers)
+				{
+					vertex_buffer.destroy();
+				}
+				iter = m_skinned_vertex_buffers.erase(iter);
+			}
+			else
+			{
+				++iter;
+			}
+		}
+	}
+
+	void SkinningPass::createRenderPass()
+	{
+		// compute pass, no render pass
+	}
+
+	void SkinningPass::createDescriptorSetLayouts()
+	{
+		std::vector<VkDescriptorSetLayoutBinding> desc_set_layout_bindings = {
+			{0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_COMPUTE_BIT, nullptr},
+			{1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_COMPUTE_BIT, nullptr},
+			{2, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_COMPUTE_BIT, nullptr}
+		};
+
+		VkDescriptorSetLayoutCreateInfo desc_set_layout_ci{};
+		desc_set_layout_ci.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+		desc_set_layout_ci.flags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_PUSH_DESCRIPTOR_BIT_KHR;
+		desc_set_layout_ci.bindingCount = static_cast<uint32_t>(desc_set_layout_bindings.size());
+		desc_set_layout_ci.pBindings = desc_set_layout_bindings.data();
+
+		m_desc_set_layouts.resize(1);
+		VkResult result = vkCreateDescriptorSetLayout(VulkanRHI::get().getDevice(), &desc_set_layout_ci, nullptr, &m_desc_set_layouts[0]);
+		CHECK_VULKAN_RESULT(result, "create descriptor set layout");
+	}
+
+	void SkinningPass::createPipelineLayouts()
+	{
+		m_push_constant_ranges =
+		{
+			{ VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(SkinningPCO) }
+		};
+
+		VkPipelineLayoutCreateInfo pipeline_layout_ci{};
+		pipeline_layout_ci.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+		pipeline_layout_ci.setLayoutCount = 1;
+		pipeline_layout_ci.pSetLayouts = &m_desc_set_layouts[0];
+		pipeline_layout_ci.pushConstantRangeCount = static_cast<uint32_t>(m_push_constant_ranges.size());
+		pipeline_layout_ci.pPushConstantRanges = m_push_constant_ranges.data();
+
+		m_pipeline_layouts.resize(1);
+		VkResult result = vkCreatePipelineLayout(VulkanRHI::get().getDevice(), &pipeline_layout_ci, nullptr, &m_pipeline_layouts[0]);
+		CHECK_VULKAN_RESULT(result, "create pipeline layout");
+	}
+
+	void SkinningPass::createPipelines()
+	{
+		VkComputePipelineCreateInfo compute_pipeline_ci{};
+		compute_pipeline_ci.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+		compute_pipeline_ci.stage = g_engine.shaderManager()->getShaderStageCI("skinning.comp", VK_SHADER_STAGE_COMPUTE_BIT);
+		compute_pipeline_ci.layout = m_pipeline_layouts[0];
+
+		m_pipelines.resize(1);
+		VkResult result = vkCreateComputePipelines(VulkanRHI::get().getDevice(), m_pipeline_cache, 1, &compute_pipeline_ci, nullptr, &m_pipelines[0]);
+		CHECK_VULKAN_RESULT(result, "create skinning compute pipeline");
+	}
+
+	void SkinningPass::createFramebuffer()
+	{
+		// compute pass, no framebuffer
+	}
+
+}
\ No newline at end of file
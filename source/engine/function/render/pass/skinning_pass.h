@@ -0,0 +1,55 @@
+#pragma once
+
+#include "render_pass.h"
+
+#include <map>
+
+namespace Bamboo
+{
+	// compute skinning: skeletal meshes are skinned once per frame by compute shaders on the async compute queue into vertex buffers
+	// of their entities, which have the static vertex layout, so every pass draws them with its static mesh pipeline
+	class SkinningPass : public RenderPass
+	{
+	public:
+		virtual void render() override;
+		virtual void destroy() override;
+		virtual bool isEnabled() override;
+
+		virtual void createRenderPass() override;
+		virtual void createDescriptorSetLayouts() override;
+		virtual void createPipelineLayouts() override;
+		virtual void createPipelines() override;
+		virtual void createFramebuffer() override;
+
+		void setEnabled(bool is_enabled) { m_is_enabled = is_enabled; }
+
+		// point the skeletal mesh render datas to their skinned vertex buffers of this and the previous frame and mark them as static meshes,
+		// must be called after the render datas are set
+		void assignSkinnedVertexBuffers();
+
+	private:
+		struct SkinningBatch
+		{
+			VmaBuffer bone_palette;
+			uint32_t bone_palette_offset;
+			uint32_t bone_palette_size;
+			VmaBuffer skeletal_vertex_buffer;
+			VmaBuffer static_vertex_buffer;
+			SkinningPCO skinning_pco;
+		};
+
+		struct SkinnedVertexBuffers
+		{
+			// one more than the flight count, so the previous frame's vertices are kept for motion vectors
+			// while the in flight frames write theirs, a buffer is only rewritten after the frames reading it are done
+			std::vector<VmaBuffer> vertex_buffers;
+			std::vector<uint32_t> vertex_counts;
+			std::vector<uint64_t> frame_indices;
+			uint64_t last_frame_index = 0;
+		};
+
+		bool m_is_enabled = false;
+		std::vector<SkinningBatch> m_skinning_batches;
+		std::map<uint32_t, SkinnedVertexBuffers> m_skinned_vertex_buffers;
+	};
+}
\ No newline at end of file
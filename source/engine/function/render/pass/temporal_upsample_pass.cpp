@@ -0,0 +1,183 @@
+#include "temporal_upsample_pass.h"
+#include "engine/core/vulkan/vulkan_rhi.h"
+#include "engine/resource/shader/shader_manager.h"
+
+namespace Bamboo
+{
+	// weight of the reprojected history, the rest is the current frame's color
+	const float k_history_weight = 0.9f;
+
+	TemporalUpsamplePass::TemporalUpsamplePass()
+	{
+		m_format = VK_FORMAT_R8G8B8A8_UNORM;
+	}
+
+	void TemporalUpsamplePass::render()
+	{
+		VkCommandBuffer command_buffer = VulkanRHI::get().getCommandBuffer();
+		VmaImageViewSampler& history_texture = m_history_texture_samplers[m_history_index];
+		const VmaImageViewSampler& last_history_texture = m_history_texture_samplers[m_history_index ^ 1];
+
+		// transition history texture to color attachment, previous contents are discarded
+		VkImageAspectFlags aspect_flags = VulkanUtil::calcImageAspectFlags(m_format);
+		VulkanUtil::cmdImageBarrier(command_buffer, history_texture.image(), aspect_flags, 1,
+			VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+			VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0,
+			VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT);
+
+		// render to history texture
+		VkClearValue clear_value;
+		clear_value.color = { { 0.0f, 0.0f, 0.0f, 1.0f } };
+		std::vector<VkRenderingAttachmentInfo> color_attachments = {
+			getRenderingAttachment(history_texture.view, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, clear_value)
+		};
+		beginRendering(command_buffer, m_width, m_height, 1, color_attachments);
+
+		vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pipelines[0]);
+
+		// push constants
+		m_temporal_upsample_pco.render_size = glm::vec4(m_render_extent.width, m_render_extent.height, 1.0f / m_width, 1.0f / m_height);
+		m_temporal_upsample_pco.history_weight = k_history_weight;
+		m_temporal_upsample_pco.reset_history = !m_is_history_valid;
+		updatePushConstants(command_buffer, m_pipeline_layouts[0], { &m_temporal_upsample_pco });
+
+		// texture image samplers, the last history isn't written after it's created, so the current color stands in for it
+		std::vector<VkWriteDescriptorSet> desc_writes;
+		std::array<VkDescriptorImageInfo, 3> desc_image_infos{};
+		addImageDescriptorSet(desc_writes, desc_image_infos[0], *m_p_color_texture, 0);
+		addImageDescriptorSet(desc_writes, desc_image_infos[1], *m_p_velocity_texture, 1);
+		addImageDescriptorSet(desc_writes, desc_image_infos[2], m_is_history_valid ? last_history_texture : *m_p_color_texture, 2);
+
+		VulkanRHI::get().getVkCmdPushDescriptorSetKHR()(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
+			m_pipeline_layouts[0], 0, static_cast<uint32_t>(desc_writes.size()), desc_writes.data());
+		vkCmdDraw(command_buffer, 3, 1, 0, 0);
+		vkCmdEndRendering(command_buffer);
+
+		// transition history texture for sampling in postprocess pass and next frame
+		VulkanUtil::cmdImageBarrier(command_buffer, history_texture.image(), aspect_flags, 1,
+			VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+			VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
+			VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT);
+
+		m_is_history_valid = true;
+	}
+
+	bool TemporalUpsamplePass::isEnabled()
+	{
+		return RenderPass::isEnabled() && m_is_enabled && m_p_color_texture && m_p_velocity_texture;
+	}
+
+	void TemporalUpsamplePass::setEnabled(bool is_enabled)
+	{
+		// the history stops being updated while the pass is disabled
+		if (!is_enabled)
+		{
+			m_is_history_valid = false;
+		}
+		m_is_enabled = is_enabled;
+	}
+
+	void TemporalUpsamplePass::setCamera(const glm::mat4& reprojection, const glm::vec2& jitter)
+	{
+		m_temporal_upsample_pco.reprojection = reprojection;
+
+		// jittered geometry moves by half the ndc offset in uv
+		m_temporal_upsample_pco.jitter = jitter * 0.5f;
+	}
+
+	void TemporalUpsamplePass::createRenderPass()
+	{
+		// rendered with dynamic rendering, no render pass object is needed
+	}
+
+	void TemporalUpsamplePass::createDescriptorSetLayouts()
+	{
+		VkDescriptorSetLayoutCreateInfo desc_set_layout_ci{};
+		desc_set_layout_ci.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+		desc_set_layout_ci.flags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_PUSH_DESCRIPTOR_BIT_KHR;
+
+		std::vector<VkDescriptorSetLayoutBinding> desc_set_layout_bindings = {
+			{0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_FRAGMENT_BIT, nullptr},
+			{1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_FRAGMENT_BIT, nullptr},
+			{2, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_FRAGMENT_BIT, nullptr},
+		};
+
+		m_desc_set_layouts.resize(1);
+		desc_set_layout_ci.bindingCount = static_cast<uint32_t>(desc_set_layout_bindings.size());
+		desc_set_layout_ci.pBindings = desc_set_layout_bindings.data();
+		VkResult result = vkCreateDescriptorSetLayout(VulkanRHI::get().getDevice(), &desc_set_layout_ci, nullptr, &m_desc_set_layouts[0]);
+		CHECK_VULKAN_RESULT(result, "create temporal upsample descriptor set layout");
+	}
+
+	void TemporalUpsamplePass::createPipelineLayouts()
+	{
+		m_push_constant_ranges =
+		{
+			{ VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(TemporalUpsamplePCO) }
+		};
+
+		VkPipelineLayoutCreateInfo pipeline_layout_ci{};
+		pipeline_layout_ci.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+		pipeline_layout_ci.setLayoutCount = 1;
+		pipeline_layout_ci.pSetLayouts = &m_desc_set_layouts[0];
+		pipeline_layout_ci.pushConstantRangeCount = static_cast<uint32_t>(m_push_constant_ranges.size());
+		pipeline_layout_ci.pPushConstantRanges = m_push_constant_ranges.data();
+
+		m_pipeline_layouts.resize(1);
+		VkResult result = vkCreatePipelineLayout(VulkanRHI::get().getDevice(), &pipeline_layout_ci, nullptr, &m_pipeline_layouts[0]);
+		CHECK_VULKAN_RESULT(result, "create temporal upsample pipeline layout");
+	}
+
+	void TemporalUpsamplePass::createPipelines()
+	{
+		// disable culling and depth testing
+		m_rasterize_state_ci.cullMode = VK_CULL_MODE_NONE;
+		m_depth_stencil_ci.depthTestEnable = VK_FALSE;
+		m_depth_stencil_ci.depthWriteEnable = VK_FALSE;
+		m_color_blend_attachments[0].blendEnable = VK_FALSE;
+
+		// vertex input state
+		VkPipelineVertexInputStateCreateInfo vertex_input_ci{};
+		vertex_input_ci.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+
+		// shader stages
+		const auto& shader_manager = g_engine.shaderManager();
+		std::vector<VkPipelineShaderStageCreateInfo> shader_stage_cis = {
+			shader_manager->getShaderStageCI("screen.vert", VK_SHADER_STAGE_VERTEX_BIT),
+			shader_manager->getShaderStageCI("temporal_upsample.frag", VK_SHADER_STAGE_FRAGMENT_BIT)
+		};
+
+		setRenderingFormats({ m_format });
+		m_pipeline_ci.pVertexInputState = &vertex_input_ci;
+		m_pipeline_ci.layout = m_pipeline_layouts[0];
+		m_pipeline_ci.stageCount = static_cast<uint32_t>(shader_stage_cis.size());
+		m_pipeline_ci.pStages = shader_stage_cis.data();
+
+		m_pipelines.resize(1);
+		VkResult result = vkCreateGraphicsPipelines(VulkanRHI::get().getDevice(), m_pipeline_cache, 1, &m_pipeline_ci, nullptr, &m_pipelines[0]);
+		CHECK_VULKAN_RESULT(result, "create temporal upsample graphics pipeline");
+	}
+
+	void TemporalUpsamplePass::createFramebuffer()
+	{
+		// create full resolution history images and views, rendered with dynamic rendering so no framebuffer is needed
+		for (VmaImageViewSampler& history_texture_sampler : m_history_texture_samplers)
+		{
+			VulkanUtil::createImageViewSampler(m_width, m_height, nullptr, 1, 1, m_format,
+				VK_FILTER_LINEAR, VK_FILTER_LINEAR, VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE, history_texture_sampler,
+				VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT);
+		}
+		m_is_history_valid = false;
+	}
+
+	void TemporalUpsamplePass::destroyResizableObjects()
+	{
+		for (VmaImageViewSampler& history_texture_sampler : m_history_texture_samplers)
+		{
+			history_texture_sampler.destroy();
+		}
+
+		RenderPass::destroyResizableObjects();
+	}
+
+}
\ No newline at end of file
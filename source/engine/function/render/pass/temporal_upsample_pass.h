@@ -0,0 +1,55 @@
+#pragma once
+
+#include "render_pass.h"
+
+#include <array>
+
+namespace Bamboo
+{
+	// temporal upsampling: the jittered main pass color of render resolution is accumulated into a full resolution history,
+	// the last history is reprojected with gbuffer motion vectors and clamped to the current color neighborhood to reject stale samples
+	class TemporalUpsamplePass : public RenderPass
+	{
+	public:
+		TemporalUpsamplePass();
+
+		virtual void render() override;
+		virtual bool isEnabled() override;
+
+		virtual void createRenderPass() override;
+		virtual void createDescriptorSetLayouts() override;
+		virtual void createPipelineLayouts() override;
+		virtual void createPipelines() override;
+		virtual void createFramebuffer() override;
+		virtual void destroyResizableObjects() override;
+
+		void setEnabled(bool is_enabled);
+		void setInputTextures(const VmaImageViewSampler* p_color_texture, const VmaImageViewSampler* p_velocity_texture) {
+			m_p_color_texture = p_color_texture;
+			m_p_velocity_texture = p_velocity_texture;
+		}
+
+		// rendered region at the top left of the input textures
+		void setRenderExtent(const VkExtent2D& render_extent) { m_render_extent = render_extent; }
+
+		// reprojection maps current clip space to the previous one, jitter is the projection offset in ndc
+		void setCamera(const glm::mat4& reprojection, const glm::vec2& jitter);
+
+		// swap the histories for a new frame, the color texture is the history written by this frame afterwards
+		void swapHistory() { m_history_index ^= 1; }
+		const VmaImageViewSampler* getColorTexture() { return &m_history_texture_samplers[m_history_index]; }
+
+	private:
+		bool m_is_enabled = false;
+		VkFormat m_format;
+		const VmaImageViewSampler* m_p_color_texture = nullptr;
+		const VmaImageViewSampler* m_p_velocity_texture = nullptr;
+		VkExtent2D m_render_extent = { 0, 0 };
+		TemporalUpsamplePCO m_temporal_upsample_pco;
+
+		// the last frame's history is read while the other one is written
+		std::array<VmaImageViewSampler, 2> m_history_texture_samplers;
+		uint32_t m_history_index = 0;
+		bool m_is_history_valid = false;
+	};
+}
\ No newline at end of file
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "engine/core/vulkan/vulkan_util.h"
+#include "engine/core/math/bounding_box.h"
 #include "host_device.h"
 
 namespace Bamboo
@@ -30,23 +31,49 @@ namespace Bamboo
 		glm::mat4 camera_view_proj;
 
 		std::vector<VmaBuffer> lighting_ubs;
+		std::vector<VmaBuffer> light_sbs;
+		std::vector<VmaBuffer> light_cluster_sbs;
 
 		VmaImageViewSampler irradiance_texture;
 		VmaImageViewSampler prefilter_texture;
 		VmaImageViewSampler brdf_lut_texture;
 
 		VmaImageViewSampler directional_light_shadow_texture;
-		std::vector<VmaImageViewSampler> point_light_shadow_textures;
-		std::vector<VmaImageViewSampler> spot_light_shadow_textures;
+		VmaImageViewSampler local_light_shadow_atlas;
 	};
 
 	struct MeshRenderData : public RenderData
 	{
 		VmaBuffer vertex_buffer;
 		VmaBuffer index_buffer;
+
+		// static vertices of the previous frame for motion vectors, the vertex buffer itself unless the mesh is compute skinned
+		VmaBuffer prev_vertex_buffer;
+
+		// per sub mesh, the index buffer is rebound when the index type changes
+		std::vector<VkIndexType> index_types;
+		std::vector<int32_t> vertex_offsets;
 		std::vector<uint32_t> index_counts;
 		std::vector<uint32_t> index_offsets;
+
+		// lod index ranges of shadow passes, selected with their own bias
+		std::vector<uint32_t> shadow_index_counts;
+		std::vector<uint32_t> shadow_index_offsets;
 		TransformPCO transform_pco;
+		BoundingBox bounding_box;
+
+		// meshlets of each full detail sub mesh in the mesh's meshlet buffer, zero counts for the others,
+		// sub meshes assigned indirect draws by meshlet cull pass are drawn with their gpu written draw counts
+		VmaBuffer meshlet_buffer;
+		std::vector<uint32_t> meshlet_offsets;
+		std::vector<uint32_t> meshlet_counts;
+		VmaBuffer meshlet_draw_command_buffer;
+		VmaBuffer meshlet_draw_count_buffer;
+		std::vector<uint32_t> meshlet_draw_offsets;
+		std::vector<uint32_t> meshlet_count_indices;
+
+		// static meshes don't move or deform, they are cached in shadow maps
+		bool is_static = false;
 	};
 
 	struct StaticMeshRenderData : public MeshRenderData
@@ -61,7 +88,14 @@ namespace Bamboo
 	{
 		SkeletalMeshRenderData() { type = ERenderDataType::SkeletalMesh; }
 
-		std::vector<VmaBuffer> bone_ubs;
+		// the animator's bone palette in the shared bone buffer
+		VmaBuffer bone_palette;
+		uint32_t bone_palette_offset = 0;
+		uint32_t bone_palette_size = 0;
+
+		// skinned by skinning pass into the vertex buffers of the entity, then drawn as a static mesh
+		uint32_t entity_id = 0;
+		uint32_t vertex_count = 0;
 	};
 
 	struct SkyboxRenderData : public RenderData
@@ -70,7 +104,10 @@ namespace Bamboo
 
 		VmaBuffer vertex_buffer;
 		VmaBuffer index_buffer;
+		VkIndexType index_type;
 		uint32_t index_count;
+		uint32_t first_index;
+		int32_t vertex_offset;
 		TransformPCO transform_pco;
 		VmaImageViewSampler env_texture;
 	};
@@ -104,17 +141,25 @@ namespace Bamboo
 
 	struct ShadowCubeCreateInfo
 	{
+		uint32_t light_id;
 		vec3 light_pos;
 		float light_near;
 		float light_far;
+
+		// projected size of the light on screen in [0, 1], decides its shadow atlas tile size
+		float importance;
 	};
 
 	struct ShadowFrustumCreateInfo
 	{
+		uint32_t light_id;
 		vec3 light_pos;
 		vec3 light_dir;
 		float light_angle;
 		float light_near;
 		float light_far;
+
+		// projected size of the light on screen in [0, 1], decides its shadow atlas tile size
+		float importance;
 	};
 }
\ No newline at end of file
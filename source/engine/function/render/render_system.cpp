@@ -3,17 +3,22 @@
 #include "engine/core/event/event_system.h"
 #include "engine/core/math/math_util.h"
 #include "engine/function/framework/world/world_manager.h"
+#include "engine/function/animation/animation_system.h"
 #include "engine/resource/asset/asset_manager.h"
 #include "engine/function/render/debug_draw_manager.h"
 #include "engine/platform/timer/timer.h"
+#include "engine/resource/asset/texture_2d.h"
 
 #include "engine/core/vulkan/vulkan_rhi.h"
 #include "engine/function/render/pass/directional_light_shadow_pass.h"
-#include "engine/function/render/pass/point_light_shadow_pass.h"
-#include "engine/function/render/pass/spot_light_shadow_pass.h"
+#include "engine/function/render/pass/local_light_shadow_pass.h"
 #include "engine/function/render/pass/pick_pass.h"
 #include "engine/function/render/pass/outline_pass.h"
+#include "engine/function/render/pass/skinning_pass.h"
+#include "engine/function/render/pass/meshlet_cull_pass.h"
 #include "engine/function/render/pass/main_pass.h"
+#include "engine/function/render/pass/hiz_pass.h"
+#include "engine/function/render/pass/temporal_upsample_pass.h"
 #include "engine/function/render/pass/postprocess_pass.h"
 #include "engine/function/render/pass/ui_pass.h"
 
@@ -26,8 +31,12 @@
 #include "engine/function/framework/component/directional_light_component.h"
 #include "engine/function/framework/component/point_light_component.h"
 #include "engine/function/framework/component/spot_light_component.h"
+#include "engine/function/framework/component/rigidbody_component.h"
 
 #include <random>
+#include <algorithm>
+#include <limits>
+#include <set>
 
 namespace Bamboo
 {
@@ -35,21 +44,29 @@ namespace Bamboo
 	void RenderSystem::init()
 	{
 		m_directional_light_shadow_pass = std::make_shared<DirectionalLightShadowPass>();
-		m_point_light_shadow_pass = std::make_shared<PointLightShadowPass>();
-		m_spot_light_shadow_pass = std::make_shared<SpotLightShadowPass>();
+		m_local_light_shadow_pass = std::make_shared<LocalLightShadowPass>();
 		m_pick_pass = std::make_shared<PickPass>();
 		m_outline_pass = std::make_shared<OutlinePass>();
+		m_skinning_pass = std::make_shared<SkinningPass>();
+		m_meshlet_cull_pass = std::make_shared<MeshletCullPass>();
 		m_main_pass = std::make_shared<MainPass>();
+		m_hiz_pass = std::make_shared<HiZPass>();
+		m_hiz_pass->setDepthTexture(m_main_pass->getDepthTexture());
+		m_temporal_upsample_pass = std::make_shared<TemporalUpsamplePass>();
+		m_temporal_upsample_pass->setInputTextures(m_main_pass->getColorTexture(), m_main_pass->getVelocityTexture());
 		m_postprocess_pass = std::make_shared<class PostprocessPass>();
 		m_ui_pass = std::make_shared<UIPass>();
 
 		m_render_passes = {
+			m_skinning_pass,
 			m_directional_light_shadow_pass, 
-			m_point_light_shadow_pass,
-			m_spot_light_shadow_pass,
+			m_local_light_shadow_pass,
 			m_pick_pass,
 			m_outline_pass,
+			m_meshlet_cull_pass,
 			m_main_pass,
+			m_hiz_pass,
+			m_temporal_upsample_pass,
 			m_postprocess_pass,
 			m_ui_pass
 		};
@@ -75,11 +92,26 @@ namespace Bamboo
 		m_default_texture_cube = as->loadAsset<TextureCube>(DEFAULT_TEXTURE_CUBE_URL);
 
 		// create lighting uniform buffers
-		m_lighting_ubs.resize(MAX_FRAMES_IN_FLIGHT);
+		m_lighting_ubs.resize(VulkanRHI::get().getFlightCount());
 		for (VmaBuffer& uniform_buffer : m_lighting_ubs)
 		{
 			VulkanUtil::createBuffer(sizeof(LightingUBO), VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, VMA_MEMORY_USAGE_AUTO_PREFER_HOST, uniform_buffer);
 		}
+
+		// create point/spot light and light cluster storage buffers
+		m_light_sbs.resize(VulkanRHI::get().getFlightCount());
+		m_light_cluster_sbs.resize(VulkanRHI::get().getFlightCount());
+		for (uint32_t i = 0; i < VulkanRHI::get().getFlightCount(); ++i)
+		{
+			VulkanUtil::createBuffer(sizeof(LightSSBO), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VMA_MEMORY_USAGE_AUTO_PREFER_HOST, m_light_sbs[i]);
+			VulkanUtil::createBuffer(sizeof(LightCluster) * LIGHT_CLUSTER_NUM + sizeof(uint32_t) * MAX_LIGHT_INDEX_NUM, 
+				VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VMA_MEMORY_USAGE_AUTO_PREFER_HOST, m_light_cluster_sbs[i]);
+		}
+		m_light_clusters.resize(LIGHT_CLUSTER_NUM);
+		m_light_indices.resize(MAX_LIGHT_INDEX_NUM);
+		m_light_cluster_ranges.resize(MAX_POINT_LIGHT_NUM + MAX_SPOT_LIGHT_NUM);
+		m_point_light_cluster_counts.resize(LIGHT_CLUSTER_NUM);
+		m_spot_light_cluster_counts.resize(LIGHT_CLUSTER_NUM);
 		m_lighting_icons = {
 			{ ELightType::DirectionalLight, VulkanUtil::loadImageViewSampler("asset/engine/texture/gizmo/directional_light.png") },
 			{ ELightType::SkyLight, VulkanUtil::loadImageViewSampler("asset/engine/texture/gizmo/sky_light.png") },
@@ -90,9 +122,18 @@ namespace Bamboo
 
 	void RenderSystem::tick(float delta_time)
 	{
+		// wait current flight's buffers free before updating them
+		VulkanRHI::get().waitFrame();
+
+		// upload the bone matrices animated in this frame's logic tick
+		g_engine.animationSystem()->updateBoneBuffer();
+
 		// collect render data from entities of current world
 		collectRenderDatas();
 
+		// release least recently rendered assets if gpu memory is over budget
+		evictAssets();
+
 		// vulkan rendering
 		VulkanRHI::get().render();
 	}
@@ -107,6 +148,14 @@ namespace Bamboo
 		{
 			uniform_buffer.destroy();
 		}
+		for (VmaBuffer& storage_buffer : m_light_sbs)
+		{
+			storage_buffer.destroy();
+		}
+		for (VmaBuffer& storage_buffer : m_light_cluster_sbs)
+		{
+			storage_buffer.destroy();
+		}
 
 		for (auto& iter : m_lighting_icons)
 		{
@@ -118,9 +167,13 @@ namespace Bamboo
 
 	void RenderSystem::resize(uint32_t width, uint32_t height)
 	{
+		m_viewport_height = std::max(height, 1u);
 		m_pick_pass->onResize(width, height);
 		m_outline_pass->onResize(width, height);
+		m_meshlet_cull_pass->onResize(width, height);
 		m_main_pass->onResize(width, height);
+		m_hiz_pass->onResize(width, height);
+		m_temporal_upsample_pass->onResize(width, height);
 		m_postprocess_pass->onResize(width, height);
 	}
 
@@ -188,6 +241,26 @@ namespace Bamboo
 		auto camera_transform_component = camera_entity.lock()->getComponent(TransformComponent);
 		auto camera_component = camera_entity.lock()->getComponent(CameraComponent);
 
+		// dynamic resolution, and sub-pixel halton(2, 3) jitter of render resolution for temporal upsampling
+		const uint32_t k_jitter_phase_count = 16;
+		updateRenderScale();
+		m_main_pass->setRenderScale(m_render_scale);
+		VkExtent2D render_extent = m_main_pass->getRenderExtent();
+		glm::vec2 jitter(0.0f);
+		if (m_temporal_upsampling)
+		{
+			uint32_t jitter_index = static_cast<uint32_t>(VulkanRHI::get().getFrameIndex() % k_jitter_phase_count) + 1;
+			jitter = glm::vec2(MathUtil::halton(jitter_index, 2) - 0.5f, MathUtil::halton(jitter_index, 3) - 0.5f) *
+				2.0f / glm::vec2(render_extent.width, render_extent.height);
+		}
+		camera_component->setJitter(jitter);
+
+		// motion vectors reproject with the previous frame's camera, there's no motion in the first frame
+		glm::mat4 camera_view_proj = camera_component->getViewProjectionMatrix();
+		glm::mat4 prev_camera_view_proj = m_is_prev_camera_valid ? m_prev_camera_view_proj : camera_view_proj;
+		m_prev_camera_view_proj = camera_view_proj;
+		m_is_prev_camera_valid = true;
+
 		// set render datas
 		const VmaImageViewSampler& default_texture_2d = g_engine.assetManager()->getDefaultTexture2D();
 		std::shared_ptr<LightingRenderData> lighting_render_data = std::make_shared<LightingRenderData>();
@@ -196,16 +269,7 @@ namespace Bamboo
 		lighting_render_data->irradiance_texture = m_default_texture_cube->m_image_view_sampler;
 		lighting_render_data->prefilter_texture = m_default_texture_cube->m_image_view_sampler;
 		lighting_render_data->directional_light_shadow_texture = m_directional_light_shadow_pass->getShadowImageViewSampler();
-		lighting_render_data->point_light_shadow_textures.resize(MAX_POINT_LIGHT_NUM);
-		lighting_render_data->spot_light_shadow_textures.resize(MAX_SPOT_LIGHT_NUM);
-		for (uint32_t i = 0; i < MAX_POINT_LIGHT_NUM; ++i)
-		{
-			lighting_render_data->point_light_shadow_textures[i] = m_default_texture_cube->m_image_view_sampler;
-		}
-		for (uint32_t i = 0; i < MAX_SPOT_LIGHT_NUM; ++i)
-		{
-			lighting_render_data->spot_light_shadow_textures[i] = default_texture_2d;
-		}
+		lighting_render_data->local_light_shadow_atlas = m_local_light_shadow_pass->getShadowAtlasImageViewSampler();
 		std::shared_ptr<SkyboxRenderData> skybox_render_data = nullptr;
 
 		// shadow create infos
@@ -217,13 +281,22 @@ namespace Bamboo
 		std::vector<ShadowCubeCreateInfo> shadow_cube_cis;
 		std::vector<ShadowFrustumCreateInfo> shadow_frustum_cis;
 
+		// projected size of a light's sphere relative to the screen height, lights around the camera cover it all
+		auto calcLightImportance = [&](const glm::vec3& light_pos, float light_radius)
+		{
+			float light_distance = glm::distance(camera_transform_component->m_position, light_pos);
+			float screen_height = light_distance * std::tan(glm::radians(camera_component->m_fovy) * 0.5f);
+			return light_distance > light_radius ? std::min(light_radius / screen_height, 1.0f) : 1.0f;
+		};
+
 		// set lighting uniform buffer object
 		LightingUBO lighting_ubo;
 		lighting_ubo.camera_pos = camera_transform_component->m_position;
 		lighting_ubo.camera_dir = camera_transform_component->getForwardVector();
 		lighting_ubo.exposure = camera_component->m_exposure;
 		lighting_ubo.camera_view = camera_component->getViewMatrix();
-		lighting_ubo.inv_camera_view_proj = glm::inverse(camera_component->getViewProjectionMatrix());
+		lighting_ubo.camera_view_proj = camera_component->getViewProjectionMatrix();
+		lighting_ubo.inv_camera_view_proj = glm::inverse(camera_component->getJitteredViewProjectionMatrix());
 		lighting_ubo.has_sky_light = lighting_ubo.has_directional_light = false;
 		lighting_ubo.point_light_num = lighting_ubo.spot_light_num = 0;
 		lighting_ubo.shader_debug_option = m_shader_debug_option;
@@ -232,6 +305,24 @@ namespace Bamboo
 		const auto& ddm = g_engine.debugDrawSystem();
 		ddm->clear();
 
+		// hi-z occlusion culling tests against the depth pyramid of a previous frame
+		m_hiz_pass->setEnabled(m_occlusion_culling);
+		m_hiz_pass->setCameraViewProj(camera_component->getJitteredViewProjectionMatrix());
+		m_hiz_pass->setDepthExtent(render_extent);
+		m_hiz_pass->fetchOcclusionDepths();
+		BoundingBox scene_bounding_box;
+		std::map<uint32_t, float> lod_screen_sizes;
+		std::map<uint32_t, glm::mat4> model_matrices;
+
+		// skeletal meshes with their animators and screen sizes, for animation lods
+		struct AnimatedMesh
+		{
+			std::shared_ptr<SkeletalMeshRenderData> render_data;
+			std::shared_ptr<AnimatorComponent> animator;
+			float screen_size;
+		};
+		std::vector<AnimatedMesh> animated_meshes;
+
 		// traverse all entities
 		const auto& entities = current_world->getEntities();
 		for (const auto& iter : entities)
@@ -259,8 +350,20 @@ namespace Bamboo
 
 				if (mesh)
 				{
+					touchMesh(mesh);
+
+					// skinned meshes are bounded by their current poses, so that limbs moving out of the bind pose aren't culled
+					BoundingBox bounding_box = mesh->m_bounding_box;
+					auto animator_component = entity->getComponent(AnimatorComponent);
+					if (skeletal_mesh_component && animator_component)
+					{
+						bounding_box = animator_component->calcSkinnedBoundingBox(*skeletal_mesh_component->getSkeletalMesh());
+					}
+
 					// draw mesh bounding boxes
-					BoundingBox bounding_box = mesh->m_bounding_box.transform(transform_component->getGlobalMatrix());
+					glm::mat4 model_matrix = transform_component->getGlobalMatrix();
+					bounding_box = bounding_box.transform(model_matrix);
+					scene_bounding_box.combine(bounding_box);
 					if ((m_show_debug_option & (1 << 1)) == (1 << 1))
 					{
 						ddm->drawBox(bounding_box.center(), bounding_box.extent(), k_zero_vector, Color3::Yellow);
@@ -282,28 +385,89 @@ namespace Bamboo
 					}
 
 					static_mesh_render_data->type = is_skeletal_mesh ? ERenderDataType::SkeletalMesh : ERenderDataType::StaticMesh;
+
+					// skeletal meshes and simulated rigidbodies are dynamic shadow casters, the others can be cached in shadow maps
+					auto rigidbody_component = entity->getComponent(RigidbodyComponent);
+					static_mesh_render_data->is_static = !is_skeletal_mesh &&
+						(!rigidbody_component || rigidbody_component->m_motion_type == EMotionType::Static);
 					static_mesh_render_data->vertex_buffer = mesh->m_vertex_buffer;
+					static_mesh_render_data->prev_vertex_buffer = mesh->m_vertex_buffer;
 					static_mesh_render_data->index_buffer = mesh->m_index_buffer;
+					static_mesh_render_data->meshlet_buffer = mesh->m_meshlet_buffer;
+					static_mesh_render_data->bounding_box = bounding_box;
 
 					// update uniform buffers
 					if (is_skeletal_mesh)
 					{
-						auto animator_component = entity->getComponent(AnimatorComponent);
-						skeletal_mesh_render_data->bone_ubs = animator_component->m_bone_ubs;
+						skeletal_mesh_render_data->bone_palette = g_engine.animationSystem()->getBoneBuffer();
+						skeletal_mesh_render_data->bone_palette_offset = animator_component->getBonePaletteOffset();
+						skeletal_mesh_render_data->bone_palette_size = animator_component->getBonePaletteSize();
+						skeletal_mesh_render_data->entity_id = entity->getID();
+						skeletal_mesh_render_data->vertex_count = static_cast<uint32_t>(skeletal_mesh_component->getSkeletalMesh()->m_vertices.size());
+					}
+
+					// update push constants, new entities have no motion
+					auto model_iter = m_prev_model_matrices.find(entity->getID());
+					const glm::mat4& prev_model_matrix = model_iter != m_prev_model_matrices.end() ? model_iter->second : model_matrix;
+					static_mesh_render_data->transform_pco.m = model_matrix;
+					static_mesh_render_data->transform_pco.mvp = camera_view_proj * model_matrix;
+					static_mesh_render_data->transform_pco.prev_mvp = prev_camera_view_proj * prev_model_matrix;
+					model_matrices[entity->getID()] = model_matrix;
+
+					// projected size of the bounding sphere relative to half screen height,
+					// only updated after it changes more than the hysteresis, so lods don't flicker at their thresholds
+					float radius = glm::length(bounding_box.extent());
+					float screen_size = std::numeric_limits<float>::max();
+					if (camera_component->m_projection_type == EProjectionType::Orthographic)
+					{
+						screen_size = radius * camera_component->m_aspect_ratio / camera_component->m_ortho_width;
+					}
+					else
+					{
+						float distance = glm::length(bounding_box.center() - camera_transform_component->m_position);
+						if (distance > radius)
+						{
+							screen_size = radius / (distance * std::tan(glm::radians(camera_component->m_fovy) * 0.5f));
+						}
+					}
+					auto lod_iter = m_lod_screen_sizes.find(entity->getID());
+					if (lod_iter != m_lod_screen_sizes.end() && std::abs(screen_size / lod_iter->second - 1.0f) <= m_lod_hysteresis)
+					{
+						screen_size = lod_iter->second;
+					}
+					lod_screen_sizes[entity->getID()] = screen_size;
+					if (is_skeletal_mesh)
+					{
+						animated_meshes.push_back({ skeletal_mesh_render_data, entity->getComponent(AnimatorComponent), screen_size });
 					}
 
-					// update push constants
-					static_mesh_render_data->transform_pco.m = transform_component->getGlobalMatrix();
-					static_mesh_render_data->transform_pco.nm = glm::transpose(glm::inverse(glm::mat3(static_mesh_render_data->transform_pco.m)));
-					static_mesh_render_data->transform_pco.mvp = camera_component->getViewProjectionMatrix() * static_mesh_render_data->transform_pco.m;
+					// lod errors are relative to the bounding radius, scale them to pixels
+					float pixel_scale = screen_size * m_viewport_height * 0.5f;
 
 					// traverse all sub meshes
+					uint32_t meshlet_offset = 0;
 					for (size_t i = 0; i < mesh->m_sub_meshes.size(); ++i)
 					{
 						const auto& sub_mesh = mesh->m_sub_meshes[i];
 
-						static_mesh_render_data->index_counts.push_back(sub_mesh.m_index_count);
-						static_mesh_render_data->index_offsets.push_back(sub_mesh.m_index_offset);
+						static_mesh_render_data->index_types.push_back(mesh->getIndexType(sub_mesh));
+						static_mesh_render_data->vertex_offsets.push_back(static_cast<int32_t>(sub_mesh.m_vertex_offset));
+
+						uint32_t lod = selectLOD(sub_mesh, pixel_scale, m_lod_bias);
+						static_mesh_render_data->index_counts.push_back(lod == 0 ? sub_mesh.m_index_count : sub_mesh.m_lods[lod - 1].m_index_count);
+						static_mesh_render_data->index_offsets.push_back(mesh->getFirstIndex(sub_mesh, 
+							lod == 0 ? sub_mesh.m_index_offset : sub_mesh.m_lods[lod - 1].m_index_offset));
+
+						uint32_t shadow_lod = selectLOD(sub_mesh, pixel_scale, m_shadow_lod_bias);
+						static_mesh_render_data->shadow_index_counts.push_back(shadow_lod == 0 ? sub_mesh.m_index_count : sub_mesh.m_lods[shadow_lod - 1].m_index_count);
+						static_mesh_render_data->shadow_index_offsets.push_back(mesh->getFirstIndex(sub_mesh, 
+							shadow_lod == 0 ? sub_mesh.m_index_offset : sub_mesh.m_lods[shadow_lod - 1].m_index_offset));
+
+						// meshlets only split the full detail lod, skinning would move skeletal meshes' triangles out of their bounds
+						uint32_t meshlet_count = static_cast<uint32_t>(sub_mesh.m_meshlets.size());
+						static_mesh_render_data->meshlet_offsets.push_back(meshlet_offset);
+						static_mesh_render_data->meshlet_counts.push_back(!is_skeletal_mesh && lod == 0 ? meshlet_count : 0);
+						meshlet_offset += meshlet_count;
 
 						MaterialPCO material_pco;
 						material_pco.base_color_factor = sub_mesh.m_material->m_base_color_factor;
@@ -317,6 +481,11 @@ namespace Bamboo
 						material_pco.has_normal_texture = sub_mesh.m_material->m_normal_texure != nullptr;
 						static_mesh_render_data->material_pcos.push_back(material_pco);
 
+						touchTexture(sub_mesh.m_material->m_base_color_texure);
+						touchTexture(sub_mesh.m_material->m_metallic_roughness_occlusion_texure);
+						touchTexture(sub_mesh.m_material->m_normal_texure);
+						touchTexture(sub_mesh.m_material->m_emissive_texure);
+
 						static_mesh_render_data->pbr_textures.push_back({
 							sub_mesh.m_material->m_base_color_texure ? sub_mesh.m_material->m_base_color_texure->m_image_view_sampler : default_texture_2d,
 							sub_mesh.m_material->m_metallic_roughness_occlusion_texure ? sub_mesh.m_material->m_metallic_roughness_occlusion_texure->m_image_view_sampler : default_texture_2d,
@@ -370,7 +539,11 @@ namespace Bamboo
 				std::shared_ptr<StaticMesh> skybox_cube_mesh = sky_light_component->m_cube_mesh;
 				skybox_render_data->vertex_buffer = skybox_cube_mesh->m_vertex_buffer;
 				skybox_render_data->index_buffer = skybox_cube_mesh->m_index_buffer;
-				skybox_render_data->index_count = skybox_cube_mesh->m_sub_meshes.front().m_index_count;
+				const SubMesh& skybox_sub_mesh = skybox_cube_mesh->m_sub_meshes.front();
+				skybox_render_data->index_type = skybox_cube_mesh->getIndexType(skybox_sub_mesh);
+				skybox_render_data->index_count = skybox_sub_mesh.m_index_count;
+				skybox_render_data->first_index = skybox_cube_mesh->getFirstIndex(skybox_sub_mesh, skybox_sub_mesh.m_index_offset);
+				skybox_render_data->vertex_offset = static_cast<int32_t>(skybox_sub_mesh.m_vertex_offset);
 				skybox_render_data->transform_pco.mvp = camera_component->getProjectionMatrix(EProjectionType::Perspective) * camera_component->getViewMatrixNoTranslation();
 				skybox_render_data->env_texture = sky_light_component->m_prefilter_texture_sampler;
 
@@ -389,20 +562,31 @@ namespace Bamboo
 			{
 				auto transform_component = entity->getComponent(TransformComponent);
 
-				// set lighting uniform buffer object
-				PointLight& point_light = lighting_ubo.point_lights[lighting_ubo.point_light_num++];
-				point_light.position = transform_component->m_position;
-				point_light.color = point_light_component->getColor();
-				point_light.radius = point_light_component->m_radius;
-				point_light.linear_attenuation = point_light_component->m_linear_attenuation;
-				point_light.quadratic_attenuation = point_light_component->m_quadratic_attenuation;
-				point_light.cast_shadow = point_light_component->m_cast_shadow;
-
-				ShadowCubeCreateInfo shadow_cube_ci;
-				shadow_cube_ci.light_pos = transform_component->m_position;
-				shadow_cube_ci.light_far =point_light_component->m_radius;
-				shadow_cube_ci.light_near = camera_component->m_near;
-				shadow_cube_cis.push_back(shadow_cube_ci);
+				// set point light storage buffer object, lights beyond the capacity are dropped
+				if (lighting_ubo.point_light_num < MAX_POINT_LIGHT_NUM)
+				{
+					PointLight& point_light = m_light_ssbo.point_lights[lighting_ubo.point_light_num++];
+					point_light.position = transform_component->m_position;
+					point_light.color = point_light_component->getColor();
+					point_light.radius = point_light_component->m_radius;
+					point_light.linear_attenuation = point_light_component->m_linear_attenuation;
+					point_light.quadratic_attenuation = point_light_component->m_quadratic_attenuation;
+
+					// only the first shadow casting lights get shadow maps, the others are shaded without shadow
+					point_light.shadow_index = -1;
+					if (point_light_component->m_cast_shadow && shadow_cube_cis.size() < MAX_SHADOW_POINT_LIGHT_NUM)
+					{
+						point_light.shadow_index = static_cast<int>(shadow_cube_cis.size());
+
+						ShadowCubeCreateInfo shadow_cube_ci;
+						shadow_cube_ci.light_id = entity->getID();
+						shadow_cube_ci.light_pos = transform_component->m_position;
+						shadow_cube_ci.light_far = point_light_component->m_radius;
+						shadow_cube_ci.light_near = camera_component->m_near;
+						shadow_cube_ci.importance = calcLightImportance(point_light.position, point_light.radius);
+						shadow_cube_cis.push_back(shadow_cube_ci);
+					}
+				}
 
 				addBillboardRenderData(transform_component, camera_component, billboard_render_datas,
 					selected_billboard_render_datas, billboard_entity_ids, ELightType::PointLight);
@@ -414,106 +598,195 @@ namespace Bamboo
 			{
 				auto transform_component = entity->getComponent(TransformComponent);
 
-				// set lighting uniform buffer object
-				SpotLight& spot_light = lighting_ubo.spot_lights[lighting_ubo.spot_light_num++];
-				PointLight& point_light = spot_light._pl;
-				point_light.position = transform_component->m_position;
-				point_light.color = spot_light_component->getColor();
-				point_light.radius = spot_light_component->m_radius;
-				point_light.linear_attenuation = spot_light_component->m_linear_attenuation;
-				point_light.quadratic_attenuation = spot_light_component->m_quadratic_attenuation;
-				point_light.cast_shadow = spot_light_component->m_cast_shadow;
-				point_light.padding0 = std::cos(glm::radians(spot_light_component->m_inner_cone_angle));
-				point_light.padding1 = std::cos(glm::radians(spot_light_component->m_outer_cone_angle));
-
-				spot_light.direction = transform_component->getForwardVector();
-
-				ShadowFrustumCreateInfo shadow_frustum_ci;
-				shadow_frustum_ci.light_pos = transform_component->m_position;
-				shadow_frustum_ci.light_dir = spot_light.direction;
-				shadow_frustum_ci.light_angle = spot_light_component->m_outer_cone_angle;
-				shadow_frustum_ci.light_far = spot_light_component->m_radius;
-				shadow_frustum_ci.light_near = camera_component->m_near;
-				shadow_frustum_cis.push_back(shadow_frustum_ci);
+				// set spot light storage buffer object, lights beyond the capacity are dropped
+				if (lighting_ubo.spot_light_num < MAX_SPOT_LIGHT_NUM)
+				{
+					SpotLight& spot_light = m_light_ssbo.spot_lights[lighting_ubo.spot_light_num++];
+					PointLight& point_light = spot_light._pl;
+					point_light.position = transform_component->m_position;
+					point_light.color = spot_light_component->getColor();
+					point_light.radius = spot_light_component->m_radius;
+					point_light.linear_attenuation = spot_light_component->m_linear_attenuation;
+					point_light.quadratic_attenuation = spot_light_component->m_quadratic_attenuation;
+					point_light.padding0 = std::cos(glm::radians(spot_light_component->m_inner_cone_angle));
+					point_light.padding1 = std::cos(glm::radians(spot_light_component->m_outer_cone_angle));
+
+					spot_light.direction = transform_component->getForwardVector();
+
+					point_light.shadow_index = -1;
+					if (spot_light_component->m_cast_shadow && shadow_frustum_cis.size() < MAX_SHADOW_SPOT_LIGHT_NUM)
+					{
+						point_light.shadow_index = static_cast<int>(shadow_frustum_cis.size());
+
+						ShadowFrustumCreateInfo shadow_frustum_ci;
+						shadow_frustum_ci.light_id = entity->getID();
+						shadow_frustum_ci.light_pos = transform_component->m_position;
+						shadow_frustum_ci.light_dir = spot_light.direction;
+						shadow_frustum_ci.light_angle = spot_light_component->m_outer_cone_angle;
+						shadow_frustum_ci.light_far = spot_light_component->m_radius;
+						shadow_frustum_ci.light_near = camera_component->m_near;
+						shadow_frustum_ci.importance = calcLightImportance(point_light.position, point_light.radius);
+						shadow_frustum_cis.push_back(shadow_frustum_ci);
+					}
+				}
 
 				addBillboardRenderData(transform_component, camera_component, billboard_render_datas, 
 					selected_billboard_render_datas, billboard_entity_ids, ELightType::SpotLight);
 			}
 		}
 
-		// directional light shadow pass: n mesh datas
-		if (lighting_ubo.has_directional_light)
+		m_lod_screen_sizes = std::move(lod_screen_sizes);
+		m_prev_model_matrices = std::move(model_matrices);
+
+		// the volume a mesh's directional shadow can fall on, i.e. its bounding box extruded along the light direction through the scene
+		float shadow_extrusion = glm::length(scene_bounding_box.extent()) * 2.0f;
+		auto extrudeShadowBoundingBox = [&](const BoundingBox& bounding_box)
 		{
-			m_directional_light_shadow_pass->updateCascades(shadow_cascade_ci);
+			BoundingBox shadow_bounding_box = bounding_box;
+			shadow_bounding_box.combine(bounding_box.m_min + shadow_cascade_ci.light_dir * shadow_extrusion);
+			shadow_bounding_box.combine(bounding_box.m_max + shadow_cascade_ci.light_dir * shadow_extrusion);
+			return shadow_bounding_box;
+		};
 
-			for (uint32_t i = 0; i < SHADOW_CASCADE_NUM; ++i)
+		// animation lod: characters are animated at rates by their screen sizes, and the ones whose meshes and shadows are all hidden
+		// are neither animated nor skinned, their bounding boxes are enlarged so that they resume a bit before coming into view
+		std::vector<std::shared_ptr<RenderData>> skeletal_mesh_render_datas;
+		std::set<const RenderData*> culled_render_datas;
+		const float k_animation_cull_margin = 0.25f;
+		bool has_directional_shadow = lighting_ubo.has_directional_light && lighting_ubo.directional_light.cast_shadow;
+		for (const AnimatedMesh& animated_mesh : animated_meshes)
+		{
+			BoundingBox bounding_box = animated_mesh.render_data->bounding_box;
+			glm::vec3 margin = bounding_box.extent() * k_animation_cull_margin;
+			bounding_box.m_min -= margin;
+			bounding_box.m_max += margin;
+			bool is_visible = !bounding_box.isOutsideFrustum(camera_view_proj) && !m_hiz_pass->isOccluded(bounding_box);
+
+			BoundingBox shadow_bounding_box = extrudeShadowBoundingBox(bounding_box);
+			bool is_shadow_visible = has_directional_shadow &&
+				!shadow_bounding_box.isOutsideFrustum(camera_view_proj) && !m_hiz_pass->isOccluded(shadow_bounding_box);
+
+			// point and spot light shadows are kept within the lights' ranges
+			auto isInLightRange = [&bounding_box](const glm::vec3& light_pos, float light_radius)
 			{
-				lighting_ubo.directional_light.cascade_splits[i] = m_directional_light_shadow_pass->m_cascade_splits[i];
-				lighting_ubo.directional_light.cascade_view_projs[i] = m_directional_light_shadow_pass->m_shadow_cascade_ubo.cascade_view_projs[i];
+				return glm::distance(glm::clamp(light_pos, bounding_box.m_min, bounding_box.m_max), light_pos) <= light_radius;
+			};
+			for (const auto& shadow_cube_ci : shadow_cube_cis)
+			{
+				is_shadow_visible = is_shadow_visible || isInLightRange(shadow_cube_ci.light_pos, shadow_cube_ci.light_far);
+			}
+			for (const auto& shadow_frustum_ci : shadow_frustum_cis)
+			{
+				is_shadow_visible = is_shadow_visible || isInLightRange(shadow_frustum_ci.light_pos, shadow_frustum_ci.light_far);
 			}
 
-			if (lighting_ubo.directional_light.cast_shadow)
+			bool is_culled = !is_visible && !is_shadow_visible;
+			animated_mesh.animator->setLODState(animated_mesh.screen_size, is_visible, is_culled);
+			if (is_culled)
 			{
-				m_directional_light_shadow_pass->setRenderDatas(mesh_render_datas);
+				culled_render_datas.insert(animated_mesh.render_data.get());
+			}
+			else
+			{
+				skeletal_mesh_render_datas.push_back(animated_mesh.render_data);
 			}
 		}
 
-		// point light shadow pass: n mesh datas
-		if (lighting_ubo.point_light_num > 0)
+		// skinning pass: skeletal meshes are skinned once on gpu, then all passes draw them as static meshes
+		m_skinning_pass->setEnabled(m_compute_skinning);
+		m_skinning_pass->setRenderDatas(skeletal_mesh_render_datas);
+		m_skinning_pass->assignSkinnedVertexBuffers();
+
+		// skip meshes hidden behind the depth pyramid, a shadow caster is skipped if the volume its shadow can fall on is hidden,
+		// culled characters are skipped by all but pick pass, which draws them with vertex skinning
+		std::vector<std::shared_ptr<RenderData>> visible_mesh_render_datas, visible_shadow_caster_render_datas, shadow_mesh_render_datas;
+		for (const auto& render_data : mesh_render_datas)
 		{
-			m_point_light_shadow_pass->updateCubes(shadow_cube_cis);
-			const auto& point_light_shadow_textures = m_point_light_shadow_pass->getShadowImageViewSamplers();
-			for (size_t i = 0; i < point_light_shadow_textures.size(); ++i)
+			if (culled_render_datas.find(render_data.get()) != culled_render_datas.end())
 			{
-				lighting_render_data->point_light_shadow_textures[i] = point_light_shadow_textures[i];
+				continue;
 			}
+			shadow_mesh_render_datas.push_back(render_data);
 
-			bool cast_shadow = false;
-			for (uint32_t i = 0; i < lighting_ubo.point_light_num; ++i)
+			const BoundingBox& bounding_box = std::static_pointer_cast<MeshRenderData>(render_data)->bounding_box;
+			if (!m_hiz_pass->isOccluded(bounding_box))
 			{
-				if (lighting_ubo.point_lights[i].cast_shadow)
-				{
-					cast_shadow = true;
-					break;
-				}
+				visible_mesh_render_datas.push_back(render_data);
 			}
 
-			if (cast_shadow)
+			if (!m_hiz_pass->isOccluded(extrudeShadowBoundingBox(bounding_box)))
 			{
-				m_point_light_shadow_pass->setRenderDatas(mesh_render_datas);
+				visible_shadow_caster_render_datas.push_back(render_data);
 			}
 		}
 
-		// spot light shadow pass: n mesh datas
-		if (lighting_ubo.spot_light_num > 0)
+		// directional light shadow pass: n mesh datas
+		if (lighting_ubo.has_directional_light)
 		{
-			m_spot_light_shadow_pass->updateFrustums(shadow_frustum_cis);
-			const auto& spot_light_shadow_textures = m_spot_light_shadow_pass->getShadowImageViewSamplers();
-			for (size_t i = 0; i < spot_light_shadow_textures.size(); ++i)
+			m_directional_light_shadow_pass->updateCascades(shadow_cascade_ci);
+
+			for (uint32_t i = 0; i < SHADOW_CASCADE_NUM; ++i)
 			{
-				lighting_render_data->spot_light_shadow_textures[i] = spot_light_shadow_textures[i];
+				lighting_ubo.directional_light.cascade_splits[i] = m_directional_light_shadow_pass->m_cascade_splits[i];
+				lighting_ubo.directional_light.cascade_view_projs[i] = m_directional_light_shadow_pass->m_shadow_cascade_ubo.cascade_view_projs[i];
 			}
 
-			bool cast_shadow = false;
-			for (uint32_t i = 0; i < lighting_ubo.spot_light_num; ++i)
+			if (lighting_ubo.directional_light.cast_shadow)
 			{
-				lighting_ubo.spot_lights[i].view_proj = m_spot_light_shadow_pass->m_light_view_projs[i];
-				if (lighting_ubo.spot_lights[i]._pl.cast_shadow)
+				m_directional_light_shadow_pass->setRenderDatas(visible_shadow_caster_render_datas);
+			}
+		}
+
+		// local light shadow pass: n mesh datas, lights keep their atlas tiles between frames and release them once they're gone
+		m_local_light_shadow_pass->updateLights(shadow_cube_cis, shadow_frustum_cis);
+		for (int i = 0; i < lighting_ubo.point_light_num; ++i)
+		{
+			PointLight& point_light = m_light_ssbo.point_lights[i];
+			if (point_light.shadow_index >= 0)
+			{
+				PointLightShadow& point_light_shadow = m_light_ssbo.point_light_shadows[point_light.shadow_index];
+				for (uint32_t f = 0; f < SHADOW_FACE_NUM; ++f)
+				{
+					point_light_shadow.face_view_projs[f] = m_local_light_shadow_pass->getPointLightViewProj(point_light.shadow_index, f);
+					point_light_shadow.face_atlas_rects[f] = m_local_light_shadow_pass->getPointLightAtlasRect(point_light.shadow_index, f);
+				}
+
+				// lights which didn't get atlas tiles are shaded without shadow
+				if (point_light_shadow.face_atlas_rects[0].z == 0.0f)
 				{
-					cast_shadow = true;
+					point_light.shadow_index = -1;
 				}
 			}
+		}
 
-			if (cast_shadow)
+		for (int i = 0; i < lighting_ubo.spot_light_num; ++i)
+		{
+			SpotLight& spot_light = m_light_ssbo.spot_lights[i];
+			if (spot_light._pl.shadow_index >= 0)
 			{
-				m_spot_light_shadow_pass->setRenderDatas(mesh_render_datas);
+				spot_light.view_proj = m_local_light_shadow_pass->getSpotLightViewProj(spot_light._pl.shadow_index);
+				spot_light.shadow_atlas_rect = m_local_light_shadow_pass->getSpotLightAtlasRect(spot_light._pl.shadow_index);
+				if (spot_light.shadow_atlas_rect.z == 0.0f)
+				{
+					spot_light._pl.shadow_index = -1;
+				}
 			}
 		}
 
+		if (!shadow_cube_cis.empty() || !shadow_frustum_cis.empty())
+		{
+			m_local_light_shadow_pass->setRenderDatas(shadow_mesh_render_datas);
+		}
+
+		// assign point/spot lights to clusters
+		assignLightClusters(camera_component, lighting_ubo);
+
 		// update lighting uniform buffers
 		VmaBuffer uniform_buffer = m_lighting_ubs[VulkanRHI::get().getFlightIndex()];
 		VulkanUtil::updateBuffer(uniform_buffer, (void*)&lighting_ubo, sizeof(LightingUBO));
 		lighting_render_data->lighting_ubs = m_lighting_ubs;
+		lighting_render_data->light_sbs = m_light_sbs;
+		lighting_render_data->light_cluster_sbs = m_light_cluster_sbs;
 
 		// pick pass
 		m_pick_pass->setRenderDatas(mesh_render_datas);
@@ -525,15 +798,29 @@ namespace Bamboo
 		m_outline_pass->setRenderDatas(!g_engine.isSimulating() ? selected_mesh_render_datas : std::vector<std::shared_ptr<RenderData>>{});
 		m_outline_pass->setBillboardRenderDatas(!g_engine.isSimulating() ? selected_billboard_render_datas : std::vector<std::shared_ptr<BillboardRenderData>>{});
 
+		// meshlet cull pass: meshlets of visible static meshes are culled on gpu and drawn indirectly by main pass
+		m_meshlet_cull_pass->setEnabled(m_meshlet_culling && VulkanRHI::get().isDrawIndirectCountSupported());
+		m_meshlet_cull_pass->setCamera(camera_component->getViewProjectionMatrix(), camera_component->getPosition());
+		m_meshlet_cull_pass->setRenderDatas(visible_mesh_render_datas);
+		m_meshlet_cull_pass->assignMeshletDraws();
+
 		// main pass
+		m_main_pass->setJitterMatrix(camera_component->getJitterMatrix());
 		m_main_pass->setLightingRenderData(lighting_render_data);
 		m_main_pass->setSkyboxRenderData(skybox_render_data);
 		m_main_pass->setBillboardRenderDatas(!g_engine.isSimulating() ? billboard_render_datas : std::vector<std::shared_ptr<BillboardRenderData>>{});
-		m_main_pass->setRenderDatas(mesh_render_datas);
+		m_main_pass->setRenderDatas(visible_mesh_render_datas);
+
+		// temporal upsample pass: pixels without motion vectors are reprojected with the unjittered cameras
+		m_temporal_upsample_pass->setEnabled(m_temporal_upsampling);
+		m_temporal_upsample_pass->setRenderExtent(render_extent);
+		m_temporal_upsample_pass->setCamera(prev_camera_view_proj * glm::inverse(camera_view_proj), jitter);
+		m_temporal_upsample_pass->swapHistory();
 
 		// postprocess pass
 		std::shared_ptr<PostProcessRenderData> postprocess_render_data = std::make_shared<PostProcessRenderData>();
-		postprocess_render_data->p_color_texture = m_main_pass->getColorTexture();
+		postprocess_render_data->p_color_texture = m_temporal_upsampling ?
+			m_temporal_upsample_pass->getColorTexture() : m_main_pass->getColorTexture();
 		postprocess_render_data->outline_texture = m_outline_pass->getColorTexture();
 		m_postprocess_pass->setRenderDatas({postprocess_render_data});
 	}
@@ -571,4 +858,321 @@ namespace Bamboo
 		billboard_entity_ids.push_back(entity_id);
 	}
 
+	void RenderSystem::assignLightClusters(std::shared_ptr<CameraComponent> camera_component, LightingUBO& lighting_ubo)
+	{
+		// clusters are 2d screen tiles with exponential depth slices, must match calc_light_cluster_index in pbr.h
+		const float k_min_depth = 0.001f;
+		float near = std::max(camera_component->m_near, k_min_depth);
+		float far = std::max(camera_component->m_far, near + k_min_depth);
+		float log_depth_range = std::log(far / near);
+		lighting_ubo.cluster_z_scale = LIGHT_CLUSTER_DIM_Z / log_depth_range;
+		lighting_ubo.cluster_z_bias = LIGHT_CLUSTER_DIM_Z * std::log(near) / log_depth_range;
+
+		glm::mat4 view = camera_component->getViewMatrix();
+		glm::mat4 proj = camera_component->getProjectionMatrix();
+
+		// conservative cluster range of a light's bounding sphere, false if it's outside of the camera frustum
+		auto calcClusterRange = [&](const glm::vec3& position, float radius, LightClusterRange& range)
+		{
+			glm::vec3 view_pos = view * glm::vec4(position, 1.0f);
+			float min_depth = -view_pos.z - radius;
+			float max_depth = -view_pos.z + radius;
+			if (max_depth < near || min_depth > far)
+			{
+				return false;
+			}
+
+			auto calcSlice = [&](float depth) {
+				int slice = static_cast<int>(std::floor(std::log(depth) * lighting_ubo.cluster_z_scale - lighting_ubo.cluster_z_bias));
+				return std::clamp(slice, 0, LIGHT_CLUSTER_DIM_Z - 1);
+			};
+			range.min.z = calcSlice(std::max(min_depth, near));
+			range.max.z = calcSlice(std::min(max_depth, far));
+
+			// project the view space bounding box of the sphere, it covers the whole screen if it crosses the near plane
+			glm::vec2 min_ndc(-1.0f);
+			glm::vec2 max_ndc(1.0f);
+			if (min_depth > near)
+			{
+				min_ndc = glm::vec2(std::numeric_limits<float>::max());
+				max_ndc = glm::vec2(std::numeric_limits<float>::lowest());
+				for (uint32_t i = 0; i < 8; ++i)
+				{
+					glm::vec3 offset((i & 1) ? radius : -radius, (i & 2) ? radius : -radius, (i & 4) ? radius : -radius);
+					glm::vec4 clip_pos = proj * glm::vec4(view_pos + offset, 1.0f);
+					glm::vec2 ndc = glm::vec2(clip_pos) / clip_pos.w;
+					min_ndc = glm::min(min_ndc, ndc);
+					max_ndc = glm::max(max_ndc, ndc);
+				}
+
+				if (max_ndc.x < -1.0f || max_ndc.y < -1.0f || min_ndc.x > 1.0f || min_ndc.y > 1.0f)
+				{
+					return false;
+				}
+			}
+
+			auto calcTile = [](float ndc, int dim) {
+				return std::clamp(static_cast<int>((ndc * 0.5f + 0.5f) * dim), 0, dim - 1);
+			};
+			range.min.x = calcTile(min_ndc.x, LIGHT_CLUSTER_DIM_X);
+			range.max.x = calcTile(max_ndc.x, LIGHT_CLUSTER_DIM_X);
+			range.min.y = calcTile(min_ndc.y, LIGHT_CLUSTER_DIM_Y);
+			range.max.y = calcTile(max_ndc.y, LIGHT_CLUSTER_DIM_Y);
+			return true;
+		};
+
+		auto forEachCluster = [](const LightClusterRange& range, const auto& func) {
+			for (int z = range.min.z; z <= range.max.z; ++z)
+			{
+				for (int y = range.min.y; y <= range.max.y; ++y)
+				{
+					for (int x = range.min.x; x <= range.max.x; ++x)
+					{
+						func(x + y * LIGHT_CLUSTER_DIM_X + z * LIGHT_CLUSTER_DIM_X * LIGHT_CLUSTER_DIM_Y);
+					}
+				}
+			}
+		};
+
+		// 1.calculate cluster ranges and count lights of each cluster
+		uint32_t light_num = lighting_ubo.point_light_num + lighting_ubo.spot_light_num;
+		std::vector<LightClusterRange>& ranges = m_light_cluster_ranges;
+		std::vector<uint32_t>& point_light_counts = m_point_light_cluster_counts;
+		std::vector<uint32_t>& spot_light_counts = m_spot_light_cluster_counts;
+		std::fill(point_light_counts.begin(), point_light_counts.end(), 0);
+		std::fill(spot_light_counts.begin(), spot_light_counts.end(), 0);
+		for (uint32_t i = 0; i < light_num; ++i)
+		{
+			bool is_point_light = i < (uint32_t)lighting_ubo.point_light_num;
+			const PointLight& point_light = is_point_light ? m_light_ssbo.point_lights[i] : 
+				m_light_ssbo.spot_lights[i - lighting_ubo.point_light_num]._pl;
+			ranges[i].is_visible = calcClusterRange(point_light.position, point_light.radius, ranges[i]);
+			if (ranges[i].is_visible)
+			{
+				std::vector<uint32_t>& light_counts = is_point_light ? point_light_counts : spot_light_counts;
+				forEachCluster(ranges[i], [&](uint32_t c) { light_counts[c]++; });
+			}
+		}
+
+		// 2.allocate light index ranges, clusters are truncated once the light index list is full
+		uint32_t light_index_num = 0;
+		uint32_t dropped_light_index_num = 0;
+		for (uint32_t c = 0; c < LIGHT_CLUSTER_NUM; ++c)
+		{
+			uint32_t capacity = MAX_LIGHT_INDEX_NUM - light_index_num;
+			uint32_t point_light_count = std::min(point_light_counts[c], capacity);
+			uint32_t spot_light_count = std::min(spot_light_counts[c], capacity - point_light_count);
+			dropped_light_index_num += point_light_counts[c] + spot_light_counts[c] - point_light_count - spot_light_count;
+
+			m_light_clusters[c].light_offset = light_index_num;
+			m_light_clusters[c].light_counts = point_light_count | (spot_light_count << 16);
+			light_index_num += point_light_count + spot_light_count;
+			point_light_counts[c] = spot_light_counts[c] = 0;
+		}
+
+		// warn once when lights start to be dropped, not every frame they stay dropped
+		if (dropped_light_index_num > 0 && !m_is_light_index_overflow)
+		{
+			LOG_WARNING("light index list overflows by {} indices, lights are dropped from clusters", dropped_light_index_num);
+		}
+		m_is_light_index_overflow = dropped_light_index_num > 0;
+
+		// 3.fill light indices, point lights come before spot lights in each cluster
+		for (uint32_t i = 0; i < light_num; ++i)
+		{
+			if (!ranges[i].is_visible)
+			{
+				continue;
+			}
+
+			bool is_point_light = i < (uint32_t)lighting_ubo.point_light_num;
+			uint32_t light_index = is_point_light ? i : i - lighting_ubo.point_light_num;
+			forEachCluster(ranges[i], [&](uint32_t c) {
+				const LightCluster& light_cluster = m_light_clusters[c];
+				uint32_t point_light_count = light_cluster.light_counts & 0xFFFF;
+				uint32_t spot_light_count = light_cluster.light_counts >> 16;
+				if (is_point_light && point_light_counts[c] < point_light_count)
+				{
+					m_light_indices[light_cluster.light_offset + point_light_counts[c]++] = light_index;
+				}
+				else if (!is_point_light && spot_light_counts[c] < spot_light_count)
+				{
+					m_light_indices[light_cluster.light_offset + point_light_count + spot_light_counts[c]++] = light_index;
+				}
+			});
+		}
+
+		// update light and light cluster storage buffers
+		uint32_t flight_index = VulkanRHI::get().getFlightIndex();
+		VulkanUtil::updateBuffer(m_light_sbs[flight_index], m_light_ssbo.point_lights, sizeof(PointLight) * lighting_ubo.point_light_num);
+		VulkanUtil::updateBuffer(m_light_sbs[flight_index], m_light_ssbo.spot_lights, sizeof(SpotLight) * lighting_ubo.spot_light_num, 
+			offsetof(LightSSBO, spot_lights));
+		VulkanUtil::updateBuffer(m_light_sbs[flight_index], m_light_ssbo.point_light_shadows, sizeof(m_light_ssbo.point_light_shadows),
+			offsetof(LightSSBO, point_light_shadows));
+
+		size_t light_clusters_size = sizeof(LightCluster) * LIGHT_CLUSTER_NUM;
+		VulkanUtil::updateBuffer(m_light_cluster_sbs[flight_index], m_light_clusters.data(), light_clusters_size);
+		VulkanUtil::updateBuffer(m_light_cluster_sbs[flight_index], m_light_indices.data(), sizeof(uint32_t) * light_index_num, light_clusters_size);
+	}
+
+	uint32_t RenderSystem::selectLOD(const SubMesh& sub_mesh, float pixel_scale, float bias)
+	{
+		const float k_lod_pixel_error = 1.0f;
+
+		uint32_t lod = 0;
+		while (lod < sub_mesh.m_lods.size() && sub_mesh.m_lods[lod].m_error * pixel_scale <= k_lod_pixel_error * bias)
+		{
+			lod++;
+		}
+		return lod;
+	}
+
+	void RenderSystem::updateRenderScale()
+	{
+		// the main pass can only be rendered smaller if temporal upsampling resolves it to full resolution
+		if (!m_temporal_upsampling || !m_dynamic_resolution)
+		{
+			m_render_scale = 1.0f;
+			return;
+		}
+
+		// gpu time roughly scales with pixel count, i.e. the square of render scale, but the measured time is a few frames old,
+		// so the scale only moves part of the way, and holds within a tolerance of the target to avoid oscillation
+		const float k_time_tolerance = 0.05f;
+		const float k_adapt_rate = 0.2f;
+		float gpu_time = VulkanRHI::get().getGPUFrameTime();
+		if (gpu_time <= 0.0f || std::abs(gpu_time / m_target_gpu_time - 1.0f) <= k_time_tolerance)
+		{
+			return;
+		}
+
+		float target_scale = m_render_scale * std::sqrt(m_target_gpu_time / gpu_time);
+		m_render_scale = std::clamp(m_render_scale + (target_scale - m_render_scale) * k_adapt_rate, m_min_render_scale, 1.0f);
+	}
+
+	// move an asset to the most recently rendered end of its residency list
+	template<typename T>
+	static void touchResident(ResidencyList<T>& residency_list, const std::shared_ptr<T>& asset)
+	{
+		auto iter = residency_list.iters.find(asset.get());
+		if (iter == residency_list.iters.end())
+		{
+			residency_list.iters[asset.get()] = residency_list.assets.insert(residency_list.assets.end(), { asset.get(), asset });
+		}
+		else
+		{
+			// an unloaded asset's address may have been reused by a new one
+			if (iter->second->second.expired())
+			{
+				iter->second->second = asset;
+			}
+			residency_list.assets.splice(residency_list.assets.end(), residency_list.assets, iter->second);
+		}
+	}
+
+	// the least recently rendered asset of a residency list which no frame in flight uses, unloaded assets are dropped on the way
+	template<typename T>
+	static std::shared_ptr<T> getEvictableResident(ResidencyList<T>& residency_list, uint64_t max_rendered_frame)
+	{
+		while (!residency_list.assets.empty())
+		{
+			std::shared_ptr<T> asset = residency_list.assets.front().second.lock();
+			if (asset)
+			{
+				return asset->m_last_rendered_frame <= max_rendered_frame ? asset : nullptr;
+			}
+
+			residency_list.iters.erase(residency_list.assets.front().first);
+			residency_list.assets.pop_front();
+		}
+		return nullptr;
+	}
+
+	template<typename T>
+	static void evictResident(ResidencyList<T>& residency_list, const std::shared_ptr<T>& asset)
+	{
+		asset->evict();
+		residency_list.assets.erase(residency_list.iters[asset.get()]);
+		residency_list.iters.erase(asset.get());
+	}
+
+	void RenderSystem::touchMesh(const std::shared_ptr<Mesh>& mesh)
+	{
+		// re-stream evicted mesh
+		if (!mesh->isResident())
+		{
+			std::dynamic_pointer_cast<Asset>(mesh)->inflate();
+		}
+		mesh->m_last_rendered_frame = VulkanRHI::get().getFrameIndex() + 1;
+		touchResident(m_resident_meshes, mesh);
+	}
+
+	void RenderSystem::touchTexture(const std::shared_ptr<Texture2D>& texture)
+	{
+		if (!texture)
+		{
+			return;
+		}
+
+		// re-stream evicted texture
+		if (!texture->isResident())
+		{
+			texture->inflate();
+		}
+		texture->m_last_rendered_frame = VulkanRHI::get().getFrameIndex() + 1;
+		touchResident(m_resident_textures, texture);
+	}
+
+	void RenderSystem::evictAssets()
+	{
+		if (!VulkanRHI::get().isOverMemoryBudget())
+		{
+			return;
+		}
+
+		// only assets which have been rendered before and aren't used by any frame in flight can be evicted,
+		// assets which are never touched by render system (e.g. brdf lut, skybox cube) stay resident
+		uint64_t current_frame = VulkanRHI::get().getFrameIndex() + 1;
+		uint64_t flight_count = VulkanRHI::get().getFlightCount();
+		if (current_frame <= flight_count + 1)
+		{
+			return;
+		}
+		uint64_t max_rendered_frame = current_frame - flight_count - 1;
+
+		// evict the least recently rendered of both lists first until back in budget
+		uint32_t evicted_count = 0;
+		while (VulkanRHI::get().isOverMemoryBudget())
+		{
+			std::shared_ptr<Mesh> mesh = getEvictableResident(m_resident_meshes, max_rendered_frame);
+			std::shared_ptr<Texture2D> texture = getEvictableResident(m_resident_textures, max_rendered_frame);
+			if (!mesh && !texture)
+			{
+				break;
+			}
+
+			if (texture && (!mesh || texture->m_last_rendered_frame <= mesh->m_last_rendered_frame))
+			{
+				evictResident(m_resident_textures, texture);
+			}
+			else
+			{
+				evictResident(m_resident_meshes, mesh);
+			}
+			evicted_count++;
+		}
+
+		if (evicted_count > 0)
+		{
+			const float k_mb = 1024.0f * 1024.0f;
+			LOG_INFO("evicted {} assets over gpu memory budget, texture: {:.1f}MB, mesh: {:.1f}MB, render target: {:.1f}MB, staging: {:.1f}MB, buffer: {:.1f}MB", 
+				evicted_count,
+				VulkanRHI::get().getMemoryUsage(EMemoryCategory::Texture) / k_mb,
+				VulkanRHI::get().getMemoryUsage(EMemoryCategory::Mesh) / k_mb,
+				VulkanRHI::get().getMemoryUsage(EMemoryCategory::RenderTarget) / k_mb,
+				VulkanRHI::get().getMemoryUsage(EMemoryCategory::Staging) / k_mb,
+				VulkanRHI::get().getMemoryUsage(EMemoryCategory::Buffer) / k_mb);
+		}
+	}
+
 }
\ No newline at end of file
@@ -3,11 +3,20 @@
 #include "engine/function/render/pass/render_pass.h"
 
 #include <map>
+#include <list>
 #include <memory>
 #include <functional>
 
 namespace Bamboo
 {
+	// assets in the order they were last rendered, with their list positions to move them in O(log n)
+	template<typename T>
+	struct ResidencyList
+	{
+		std::list<std::pair<const T*, std::weak_ptr<T>>> assets;
+		std::map<const T*, typename std::list<std::pair<const T*, std::weak_ptr<T>>>::iterator> iters;
+	};
+
 	enum class ELightType
 	{
 		DirectionalLight, SkyLight, PointLight, SpotLight
@@ -23,6 +32,23 @@ namespace Bamboo
 		void resize(uint32_t width, uint32_t height);
 		void setShaderDebugOption(int option) { m_shader_debug_option = option; }
 		void setShowDebugOption(int option) { m_show_debug_option = option; }
+		void setOcclusionCulling(bool enable) { m_occlusion_culling = enable; }
+		void setMeshletCulling(bool enable) { m_meshlet_culling = enable; }
+
+		// skeletal meshes are skinned once per frame by compute shaders, otherwise by the vertex shaders of every pass drawing them
+		void setComputeSkinning(bool enable) { m_compute_skinning = enable; }
+
+		// temporal upsampling resolves the jittered main pass color into a full resolution history,
+		// dynamic resolution scales the main pass down to hold the target gpu frame time(ms), it requires temporal upsampling
+		void setTemporalUpsampling(bool enable) { m_temporal_upsampling = enable; }
+		void setDynamicResolution(bool enable, float target_gpu_time, float min_render_scale) {
+			m_dynamic_resolution = enable; m_target_gpu_time = target_gpu_time; m_min_render_scale = min_render_scale;
+		}
+
+		// lods are selected by their error projected to screen, bias scales the tolerated pixel error,
+		// hysteresis is the relative screen size change needed before an instance's lods are reselected
+		void setLODBias(float main_bias, float shadow_bias) { m_lod_bias = main_bias; m_shadow_lod_bias = shadow_bias; }
+		void setLODHysteresis(float hysteresis) { m_lod_hysteresis = hysteresis; }
 
 		VkImageView getColorImageView();
 
@@ -42,25 +68,83 @@ namespace Bamboo
 			std::vector<uint32_t>& billboard_entity_ids,
 			ELightType light_type);
 
+		// clustered lighting: assign point/spot lights to the clusters of camera frustum on cpu
+		void assignLightClusters(std::shared_ptr<class CameraComponent> camera_component, LightingUBO& lighting_ubo);
+
+		// the coarsest lod of a sub mesh whose projected error is within the tolerated pixel error
+		uint32_t selectLOD(const class SubMesh& sub_mesh, float pixel_scale, float bias);
+
+		// move the main pass render scale towards the target gpu frame time
+		void updateRenderScale();
+
+		// gpu memory residency
+		void touchMesh(const std::shared_ptr<class Mesh>& mesh);
+		void touchTexture(const std::shared_ptr<class Texture2D>& texture);
+		void evictAssets();
+
 		// render passes
 		std::shared_ptr<class DirectionalLightShadowPass> m_directional_light_shadow_pass;
-		std::shared_ptr<class PointLightShadowPass> m_point_light_shadow_pass;
-		std::shared_ptr<class SpotLightShadowPass> m_spot_light_shadow_pass;
+		std::shared_ptr<class LocalLightShadowPass> m_local_light_shadow_pass;
 		std::shared_ptr<class PickPass> m_pick_pass;
 		std::shared_ptr<class OutlinePass> m_outline_pass;
+		std::shared_ptr<class SkinningPass> m_skinning_pass;
+		std::shared_ptr<class MeshletCullPass> m_meshlet_cull_pass;
 		std::shared_ptr<class MainPass> m_main_pass;
+		std::shared_ptr<class HiZPass> m_hiz_pass;
+		std::shared_ptr<class TemporalUpsamplePass> m_temporal_upsample_pass;
 		std::shared_ptr<class PostprocessPass> m_postprocess_pass;
 		std::shared_ptr<class UIPass> m_ui_pass;
 		std::vector<std::shared_ptr<RenderPass>> m_render_passes;
 
 		// render datas
 		std::vector<VmaBuffer> m_lighting_ubs;
+		std::vector<VmaBuffer> m_light_sbs;
+		std::vector<VmaBuffer> m_light_cluster_sbs;
+		LightSSBO m_light_ssbo;
+		std::vector<LightCluster> m_light_clusters;
+		std::vector<uint32_t> m_light_indices;
+
+		// light cluster assignment scratch, reused across frames
+		struct LightClusterRange
+		{
+			glm::ivec3 min;
+			glm::ivec3 max;
+			bool is_visible;
+		};
+		std::vector<LightClusterRange> m_light_cluster_ranges;
+		std::vector<uint32_t> m_point_light_cluster_counts;
+		std::vector<uint32_t> m_spot_light_cluster_counts;
+		bool m_is_light_index_overflow = false;
 		std::shared_ptr<class TextureCube> m_default_texture_cube;
 		std::map<ELightType, VmaImageViewSampler> m_lighting_icons;
 
+		// resident meshes/textures from the least to the most recently rendered, evicted from the front over budget
+		ResidencyList<class Mesh> m_resident_meshes;
+		ResidencyList<class Texture2D> m_resident_textures;
+
 		// render options
 		int m_shader_debug_option = 0;
 		int m_show_debug_option = 0;
+		bool m_occlusion_culling = false;
+		bool m_meshlet_culling = false;
+		bool m_compute_skinning = true;
+		float m_lod_bias = 1.0f;
+		float m_shadow_lod_bias = 2.0f;
+		float m_lod_hysteresis = 0.1f;
+		bool m_temporal_upsampling = false;
+		bool m_dynamic_resolution = false;
+		float m_target_gpu_time = 16.0f;
+		float m_min_render_scale = 0.5f;
+		float m_render_scale = 1.0f;
+
+		// screen sizes which mesh entities' lods were last selected with
+		std::map<uint32_t, float> m_lod_screen_sizes;
+		uint32_t m_viewport_height = 1;
+
+		// model matrices of mesh entities and camera view projection of the previous frame, for motion vectors
+		std::map<uint32_t, glm::mat4> m_prev_model_matrices;
+		glm::mat4 m_prev_camera_view_proj;
+		bool m_is_prev_camera_valid = false;
 
 		// selection
 		std::vector<uint32_t> m_selected_entity_ids;
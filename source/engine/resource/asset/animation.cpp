@@ -1,12 +1,76 @@
 #include "animation.h"
 #include <limits>
+#include <algorithm>
 
 CEREAL_REGISTER_TYPE(Bamboo::Animation)
 CEREAL_REGISTER_POLYMORPHIC_RELATION(Bamboo::Asset, Bamboo::Animation)
 
 namespace Bamboo
 {
-	void Animation::inflate()
+	glm::vec4 AnimationSampler::getValue(size_t key) const
+	{
+		if (m_value_format == EValueFormat::Float)
+		{
+			return m_values[key];
+		}
+
+		const uint16_t* quantized_value = &m_quantized_values[key * 3];
+		if (m_value_format == EValueFormat::QuantizedVector)
+		{
+			glm::vec3 normalized_value = glm::vec3(quantized_value[0], quantized_value[1], quantized_value[2]) / 65535.0f;
+			return glm::vec4(m_range_min + normalized_value * m_range_extent, 0.0f);
+		}
+
+		// the largest component's index is in the top bits of the first two values, the others have 15 bits in [-1/sqrt(2), 1/sqrt(2)]
+		const float k_max_component = 0.70710678f;
+		uint32_t largest_index = (quantized_value[0] >> 15) | ((quantized_value[1] >> 15) << 1);
+		glm::vec4 rotation;
+		float sum2 = 0.0f;
+		for (uint32_t i = 0, c = 0; c < 4; ++c)
+		{
+			if (c != largest_index)
+			{
+				float normalized_component = static_cast<float>(quantized_value[i++] & 0x7fff) / 32767.0f;
+				rotation[c] = (normalized_component * 2.0f - 1.0f) * k_max_component;
+				sum2 += rotation[c] * rotation[c];
+			}
+		}
+		rotation[largest_index] = std::sqrt(std::max(1.0f - sum2, 0.0f));
+		return rotation;
+	}
+
+	size_t AnimationSampler::findKey(float time, size_t& cursor) const
+	{
+		size_t key_count = m_times.size();
+		if (key_count < 2 || time <= m_times.front())
+		{
+			cursor = 0;
+			return cursor;
+		}
+		if (time >= m_times.back())
+		{
+			cursor = key_count - 2;
+			return cursor;
+		}
+
+		// time usually stays in the cached interval or moves on to the next one
+		if (cursor + 1 < key_count && m_times[cursor] <= time)
+		{
+			if (time <= m_times[cursor + 1])
+			{
+				return cursor;
+			}
+			if (cursor + 2 < key_count && time <= m_times[cursor + 2])
+			{
+				return ++cursor;
+			}
+		}
+
+		cursor = std::upper_bound(m_times.begin(), m_times.end(), time) - m_times.begin() - 1;
+		return cursor;
+	}
+
+	void Animation::calcTimeRange()
 	{
 		m_start_time = std::numeric_limits<float>::max();
 		m_end_time = std::numeric_limits<float>::min();
@@ -25,6 +89,10 @@ namespace Bamboo
 				}
 			}
 		}
+	}
+
+	void Animation::inflate()
+	{
 		m_duration = m_end_time - m_start_time;
 	}
 
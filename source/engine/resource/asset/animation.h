@@ -1,6 +1,7 @@
 #pragma once
 
 #include "engine/resource/asset/base/asset.h"
+#include "engine/core/base/macro.h"
 
 namespace Bamboo
 {
@@ -33,18 +34,44 @@ namespace Bamboo
 			Linear, Step, CubicSpline
 		};
 
+		// compressed samplers store 3 uint16 per key instead of m_values: translations and scales normalized
+		// to the range of the track, rotations as their smallest three components with the largest one's index
+		enum class EValueFormat
+		{
+			Float, QuantizedVector, QuantizedRotation
+		};
+
 		EInterpolationType m_interp_type;
 		std::vector<float> m_times;
 		std::vector<glm::vec4> m_values;
 
+		EValueFormat m_value_format = EValueFormat::Float;
+		std::vector<uint16_t> m_quantized_values;
+		glm::vec3 m_range_min = glm::vec3(0.0f);
+		glm::vec3 m_range_extent = glm::vec3(0.0f);
+
+		size_t getKeyCount() const { return m_times.size(); }
+
+		// decompressed value of a key, rotations are in x, y, z, w order
+		glm::vec4 getValue(size_t key) const;
+
+		// index of the key interval containing time, clamped to the first and last interval,
+		// cursor caches the last result so playing forward is amortized O(1), seeks and loops fall back to binary search
+		size_t findKey(float time, size_t& cursor) const;
+
 	private:
 		friend class cereal::access;
 		template<class Archive>
-		void serialize(Archive& ar)
+		void serialize(Archive& ar, const uint32_t version)
 		{
+			ASSERT(version == 1, "unsupported animation sampler version {}, reimport the animation", version);
 			ar(cereal::make_nvp("interp_type", m_interp_type));
 			ar(cereal::make_nvp("times", m_times)); 
 			ar(cereal::make_nvp("values", m_values));
+			ar(cereal::make_nvp("value_format", m_value_format));
+			ar(cereal::make_nvp("quantized_values", m_quantized_values));
+			ar(cereal::make_nvp("range_min", m_range_min));
+			ar(cereal::make_nvp("range_extent", m_range_extent));
 		}
 	};
 
@@ -54,20 +81,31 @@ namespace Bamboo
 		std::vector<AnimationSampler> m_samplers;
 		std::vector<AnimationChannel> m_channels;
 
+		// time range of the uncompressed keys, stored since compression collapses constant tracks to a single key
 		float m_start_time;
 		float m_end_time;
 		float m_duration;
 
+		void calcTimeRange();
 		virtual void inflate() override;
 
 	private:
 		friend class cereal::access;
 		template<class Archive>
-		void serialize(Archive& ar)
+		void serialize(Archive& ar, const uint32_t version)
 		{
+			ASSERT(version == 1, "unsupported animation version {}, reimport the animation", version);
 			ar(cereal::make_nvp("name", m_name));
 			ar(cereal::make_nvp("samplers", m_samplers)); 
 			ar(cereal::make_nvp("channels", m_channels));
+			ar(cereal::make_nvp("start_time", m_start_time));
+			ar(cereal::make_nvp("end_time", m_end_time));
 		}
 	};
-}
\ No newline at end of file
+}
+
+// animations serialized before the classes were versioned carry no version, so cereal reads unrelated data as one,
+// only the current version is accepted and loading anything else fails with a request to reimport,
+// fields added later bump the version and are read only if the archived version has them
+CEREAL_CLASS_VERSION(Bamboo::AnimationSampler, 1)
+CEREAL_CLASS_VERSION(Bamboo::Animation, 1)
\ No newline at end of file
@@ -42,6 +42,7 @@ namespace Bamboo
 		void serializeAsset(std::shared_ptr<Asset> asset, const URL& url = "");
 
 		const VmaImageViewSampler& getDefaultTexture2D() { return m_default_texture_2d; }
+		const std::map<URL, std::shared_ptr<Asset>>& getAssets() { return m_assets; }
 
 	private:
 		friend class GltfImporter;
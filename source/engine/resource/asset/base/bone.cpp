@@ -19,14 +19,4 @@ namespace Bamboo
 		m_local_bind_pose_transform.m_scale = scale;
 	}
 
-	void Bone::update(const glm::mat4& parent_global_bind_pose_matrix)
-	{
-		m_global_bind_pose_matrix = parent_global_bind_pose_matrix * m_local_bind_pose_transform.matrix();
-	}
-
-	glm::mat4 Bone::matrix() const
-	{
-		return m_global_bind_pose_matrix * m_global_inverse_bind_pose_matrix;
-	}
-
 }
\ No newline at end of file
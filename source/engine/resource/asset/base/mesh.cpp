@@ -1,4 +1,5 @@
 #include "mesh.h"
+#include <glm/gtc/packing.hpp>
 
 namespace Bamboo
 {
@@ -7,6 +8,132 @@ namespace Bamboo
 	{
 		m_vertex_buffer.destroy();
 		m_index_buffer.destroy();
+		m_meshlet_buffer.destroy();
+	}
+
+	void Mesh::evict()
+	{
+		m_vertex_buffer.destroy();
+		m_index_buffer.destroy();
+		m_meshlet_buffer.destroy();
+		m_vertex_buffer = {};
+		m_index_buffer = {};
+		m_meshlet_buffer = {};
+	}
+
+	uint32_t Mesh::getFirstIndex(const SubMesh& sub_mesh, uint32_t index_offset) const
+	{
+		return sub_mesh.m_is_index16 ? static_cast<uint32_t>(m_indices.size()) * 2 + index_offset : index_offset;
+	}
+
+	void Mesh::getVertexInputDescriptions(bool is_skeletal,
+		std::vector<VkVertexInputBindingDescription>& binding_descriptions,
+		std::vector<VkVertexInputAttributeDescription>& attribute_descriptions, bool has_prev_position)
+	{
+		binding_descriptions.resize(1, VkVertexInputBindingDescription{});
+		binding_descriptions[0].binding = 0;
+		binding_descriptions[0].inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+
+		attribute_descriptions.assign(is_skeletal ? 5 : 3, VkVertexInputAttributeDescription{});
+		for (size_t i = 0; i < attribute_descriptions.size(); ++i)
+		{
+			attribute_descriptions[i].binding = 0;
+			attribute_descriptions[i].location = static_cast<uint32_t>(i);
+		}
+
+#if QUANTIZED_VERTEX
+		binding_descriptions[0].stride = is_skeletal ? sizeof(QuantizedSkeletalVertex) : sizeof(QuantizedStaticVertex);
+
+		attribute_descriptions[0].format = VK_FORMAT_R32G32B32_SFLOAT;
+		attribute_descriptions[0].offset = offsetof(QuantizedStaticVertex, m_position);
+		attribute_descriptions[1].format = VK_FORMAT_R16G16_SFLOAT;
+		attribute_descriptions[1].offset = offsetof(QuantizedStaticVertex, m_tex_coord);
+		attribute_descriptions[2].format = VK_FORMAT_R16G16_SNORM;
+		attribute_descriptions[2].offset = offsetof(QuantizedStaticVertex, m_normal);
+
+		if (is_skeletal)
+		{
+			attribute_descriptions[3].format = VK_FORMAT_R16G16B16A16_UINT;
+			attribute_descriptions[3].offset = offsetof(QuantizedSkeletalVertex, m_bones);
+			attribute_descriptions[4].format = VK_FORMAT_R32G32B32A32_SFLOAT;
+			attribute_descriptions[4].offset = offsetof(QuantizedSkeletalVertex, m_weights);
+		}
+#else
+		binding_descriptions[0].stride = is_skeletal ? sizeof(SkeletalVertex) : sizeof(StaticVertex);
+
+		attribute_descriptions[0].format = VK_FORMAT_R32G32B32_SFLOAT;
+		attribute_descriptions[0].offset = offsetof(StaticVertex, m_position);
+		attribute_descriptions[1].format = VK_FORMAT_R32G32_SFLOAT;
+		attribute_descriptions[1].offset = offsetof(StaticVertex, m_tex_coord);
+		attribute_descriptions[2].format = VK_FORMAT_R32G32B32_SFLOAT;
+		attribute_descriptions[2].offset = offsetof(StaticVertex, m_normal);
+
+		if (is_skeletal)
+		{
+			attribute_descriptions[3].format = VK_FORMAT_R16G16B16A16_UINT;
+			attribute_descriptions[3].offset = offsetof(SkeletalVertex, m_bones);
+			attribute_descriptions[4].format = VK_FORMAT_R32G32B32A32_SFLOAT;
+			attribute_descriptions[4].offset = offsetof(SkeletalVertex, m_weights);
+		}
+#endif
+
+		if (has_prev_position)
+		{
+			ASSERT(!is_skeletal, "previous positions are only supported by static vertices");
+			binding_descriptions.push_back(binding_descriptions[0]);
+			binding_descriptions[1].binding = 1;
+
+			VkVertexInputAttributeDescription prev_position_attribute = attribute_descriptions[0];
+			prev_position_attribute.binding = 1;
+			prev_position_attribute.location = 3;
+			attribute_descriptions.push_back(prev_position_attribute);
+		}
+	}
+
+	void Mesh::createIndexBuffer()
+	{
+		VulkanUtil::createIndexBuffer(m_indices, m_index_buffer, m_indices16);
+	}
+
+	void Mesh::createMeshletBuffer()
+	{
+		std::vector<MeshletData> meshlet_datas;
+		for (const SubMesh& sub_mesh : m_sub_meshes)
+		{
+			for (const Meshlet& meshlet : sub_mesh.m_meshlets)
+			{
+				MeshletData meshlet_data{};
+				meshlet_data.sphere = meshlet.m_sphere;
+				meshlet_data.cone_apex = glm::vec4(meshlet.m_cone_apex, 1.0f);
+				meshlet_data.cone_axis_cutoff = glm::vec4(meshlet.m_cone_axis, meshlet.m_cone_cutoff);
+				meshlet_data.first_index = getFirstIndex(sub_mesh, sub_mesh.m_index_offset + meshlet.m_index_offset);
+				meshlet_data.index_count = meshlet.m_index_count;
+				meshlet_data.vertex_offset = static_cast<int32_t>(sub_mesh.m_vertex_offset);
+				meshlet_datas.push_back(meshlet_data);
+			}
+		}
+
+		if (!meshlet_datas.empty())
+		{
+			VulkanUtil::createStorageBuffer(static_cast<uint32_t>(meshlet_datas.size() * sizeof(MeshletData)), meshlet_datas.data(), m_meshlet_buffer);
+		}
+	}
+
+	void Mesh::quantizeVertex(const StaticVertex& vertex, QuantizedStaticVertex& quantized_vertex)
+	{
+		quantized_vertex.m_position = vertex.m_position;
+		quantized_vertex.m_tex_coord = glm::packHalf2x16(vertex.m_tex_coord);
+
+		// project the normal onto an octahedron, and unfold its lower half onto the corners
+		float l1_norm = std::abs(vertex.m_normal.x) + std::abs(vertex.m_normal.y) + std::abs(vertex.m_normal.z);
+		glm::vec3 n = l1_norm > 0.0f ? vertex.m_normal / l1_norm : glm::vec3(0.0f, 0.0f, 1.0f);
+		glm::vec2 oct = glm::vec2(n);
+		if (n.z < 0.0f)
+		{
+			oct.x = (1.0f - std::abs(n.y)) * (n.x >= 0.0f ? 1.0f : -1.0f);
+			oct.y = (1.0f - std::abs(n.x)) * (n.y >= 0.0f ? 1.0f : -1.0f);
+		}
+		quantized_vertex.m_normal = glm::packSnorm2x16(oct);
 	}
 
 }
\ No newline at end of file
@@ -20,9 +20,10 @@ private:
 	}
 };
 
+// 16 bit bone indices, so that skeletons may have more than 255 bones
 struct SkeletalVertex : public StaticVertex
 {
-	glm::ivec4 m_bones;
+	glm::u16vec4 m_bones;
 	glm::vec4 m_weights;
 
 private:
@@ -36,6 +37,20 @@ private:
 	}
 };
 
+// gpu layout of vertices with half float uvs and octahedral normals, see QUANTIZED_VERTEX
+struct QuantizedStaticVertex
+{
+	glm::vec3 m_position;
+	uint32_t m_tex_coord;
+	uint32_t m_normal;
+};
+
+struct QuantizedSkeletalVertex : public QuantizedStaticVertex
+{
+	glm::u16vec4 m_bones;
+	glm::vec4 m_weights;
+};
+
 namespace Bamboo
 {
 	class Mesh
@@ -45,15 +60,38 @@ namespace Bamboo
 
 		std::vector<SubMesh> m_sub_meshes;
 		std::vector<uint32_t> m_indices;
+		std::vector<uint16_t> m_indices16;
 
 		VmaBuffer m_vertex_buffer;
 		VmaBuffer m_index_buffer;
+
+		// meshlets of all sub meshes in order, null if no sub mesh has meshlets
+		VmaBuffer m_meshlet_buffer;
 		
 		BoundingBox m_bounding_box;
 
+		// evicted meshes release their gpu memory, and are re-streamed from vertices/indices when rendered again
+		uint64_t m_last_rendered_frame = 0;
+		bool isResident() { return m_vertex_buffer.buffer != VK_NULL_HANDLE; }
+		void evict();
+
+		// 16 bit indices follow the 32 bit ones in the index buffer, which is bound as either type at offset 0
+		VkIndexType getIndexType(const SubMesh& sub_mesh) const { return sub_mesh.m_is_index16 ? VK_INDEX_TYPE_UINT16 : VK_INDEX_TYPE_UINT32; }
+		uint32_t getFirstIndex(const SubMesh& sub_mesh, uint32_t index_offset) const;
+
+		// vertex buffer layout shared by all mesh pipelines,
+		// static mesh pipelines writing motion vectors also read positions of the previous frame from a second binding
+		static void getVertexInputDescriptions(bool is_skeletal,
+			std::vector<VkVertexInputBindingDescription>& binding_descriptions,
+			std::vector<VkVertexInputAttributeDescription>& attribute_descriptions, bool has_prev_position = false);
+
 	protected:
 		virtual void calcBoundingBox() = 0;
 
+		void createIndexBuffer();
+		void createMeshletBuffer();
+		static void quantizeVertex(const StaticVertex& vertex, QuantizedStaticVertex& quantized_vertex);
+
 	private:
 		friend class cereal::access;
 		template<class Archive>
@@ -61,6 +99,7 @@ namespace Bamboo
 		{
 			ar(cereal::make_nvp("sub_meshes", m_sub_meshes));
 			ar(cereal::make_nvp("indices", m_indices));
+			ar(cereal::make_nvp("indices16", m_indices16));
 		}
 	};
 }
\ No newline at end of file
@@ -2,29 +2,93 @@
 
 #include "engine/resource/asset/material.h"
 #include "engine/core/math/bounding_box.h"
+#include "engine/core/base/macro.h"
 
 namespace Bamboo
 {
+	// simplified index range of a sub mesh in the same index array, the error is in units of the mesh's bounding radius
+	struct SubMeshLOD
+	{
+		uint32_t m_index_offset;
+		uint32_t m_index_count;
+		float m_error;
+
+	private:
+		friend class cereal::access;
+		template<class Archive>
+		void serialize(Archive& ar)
+		{
+			ar(cereal::make_nvp("index_offset", m_index_offset));
+			ar(cereal::make_nvp("index_count", m_index_count));
+			ar(cereal::make_nvp("error", m_error));
+		}
+	};
+
+	// contiguous index range of a sub mesh's full detail triangles, with object space bounds for gpu culling,
+	// the cluster is backfacing if the direction from the camera to the cone apex is within cutoff of the cone axis
+	struct Meshlet
+	{
+		uint32_t m_index_offset;
+		uint32_t m_index_count;
+		glm::vec4 m_sphere;
+		glm::vec3 m_cone_apex;
+		glm::vec3 m_cone_axis;
+		float m_cone_cutoff;
+
+	private:
+		friend class cereal::access;
+		template<class Archive>
+		void serialize(Archive& ar)
+		{
+			ar(cereal::make_nvp("index_offset", m_index_offset));
+			ar(cereal::make_nvp("index_count", m_index_count));
+			ar(cereal::make_nvp("sphere", m_sphere));
+			ar(cereal::make_nvp("cone_apex", m_cone_apex));
+			ar(cereal::make_nvp("cone_axis", m_cone_axis));
+			ar(cereal::make_nvp("cone_cutoff", m_cone_cutoff));
+		}
+	};
+
 	class SubMesh : public IAssetRef
 	{
 	public:
 		uint32_t m_index_offset;
 		uint32_t m_index_count;
 		uint32_t m_vertex_count;
+
+		// indices are relative to the sub mesh's first vertex, and stored in 16 bits if its vertex count allows
+		uint32_t m_vertex_offset = 0;
+		bool m_is_index16 = false;
+
+		// coarser lods following the full detail index range, with increasing errors
+		std::vector<SubMeshLOD> m_lods;
+
+		// clusters of the full detail index range, relative to m_index_offset, empty if they weren't built
+		std::vector<Meshlet> m_meshlets;
 		
 		std::shared_ptr<Material> m_material;
 
 	private:
 		friend class cereal::access;
 		template<class Archive>
-		void serialize(Archive& ar)
+		void serialize(Archive& ar, const uint32_t version)
 		{
+			ASSERT(version == 1, "unsupported sub mesh version {}, reimport the mesh", version);
 			ar(cereal::make_nvp("asset_ref", cereal::base_class<IAssetRef>(this)));
 			ar(cereal::make_nvp("index_offset", m_index_offset));
 			ar(cereal::make_nvp("index_count", m_index_count));
 			ar(cereal::make_nvp("vertex_count", m_vertex_count));
+			ar(cereal::make_nvp("vertex_offset", m_vertex_offset));
+			ar(cereal::make_nvp("is_index16", m_is_index16));
+			ar(cereal::make_nvp("lods", m_lods));
+			ar(cereal::make_nvp("meshlets", m_meshlets));
 		}
 
 		virtual void bindRefs() override;
 	};
-}
\ No newline at end of file
+}
+
+// sub meshes serialized before the class was versioned carry no version, so cereal reads unrelated data as one,
+// only the current version is accepted and loading anything else fails with a request to reimport,
+// fields added later bump the version and are read only if the archived version has them
+CEREAL_CLASS_VERSION(Bamboo::SubMesh, 1)
\ No newline at end of file
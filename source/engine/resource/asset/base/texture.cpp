@@ -24,6 +24,12 @@ namespace Bamboo
 		m_address_mode_u = m_address_mode_v = m_address_mode_w = address_mode;
 	}
 
+	void Texture::evict()
+	{
+		m_image_view_sampler.destroy();
+		m_image_view_sampler = {};
+	}
+
 	bool Texture::isSRGB()
 	{
 		return m_texture_type == ETextureType::BaseColor || m_texture_type == ETextureType::Emissive;
@@ -35,6 +35,11 @@ namespace Bamboo
 
 		void setAddressMode(VkSamplerAddressMode address_mode);
 
+		// evicted textures release their gpu memory, and are re-streamed from image data when rendered again
+		uint64_t m_last_rendered_frame = 0;
+		bool isResident() { return m_image_view_sampler.view != VK_NULL_HANDLE; }
+		void evict();
+
 	protected:
 		bool isSRGB();
 		bool isMipmap();
@@ -0,0 +1,159 @@
+#include "animation_compressor.h"
+
+#include <algorithm>
+
+namespace Bamboo
+{
+
+	void AnimationCompressor::reduceKeys(AnimationSampler& sampler, bool is_rotation, float tolerance)
+	{
+		size_t key_count = sampler.m_times.size();
+		if (sampler.m_interp_type == AnimationSampler::EInterpolationType::CubicSpline || key_count < 2)
+		{
+			return;
+		}
+
+		// a single key holds its value over the whole clip
+		bool is_constant = true;
+		for (size_t k = 1; k < key_count && is_constant; ++k)
+		{
+			is_constant = calcError(sampler.m_values[0], sampler.m_values[k], is_rotation) <= tolerance;
+		}
+		if (is_constant)
+		{
+			sampler.m_times.resize(1);
+			sampler.m_values.resize(1);
+			return;
+		}
+
+		// greedily extend the span from the last kept key, a key is kept once interpolating over the span misses any key in it
+		std::vector<size_t> kept_keys = { 0 };
+		size_t anchor = 0;
+		for (size_t i = 1; i + 1 < key_count; ++i)
+		{
+			bool is_redundant = true;
+			for (size_t k = anchor + 1; k <= i && is_redundant; ++k)
+			{
+				glm::vec4 value = sampler.m_values[anchor];
+				if (sampler.m_interp_type == AnimationSampler::EInterpolationType::Linear)
+				{
+					float t = (sampler.m_times[k] - sampler.m_times[anchor]) / (sampler.m_times[i + 1] - sampler.m_times[anchor]);
+					value = interpolate(sampler.m_values[anchor], sampler.m_values[i + 1], t, is_rotation);
+				}
+				is_redundant = calcError(value, sampler.m_values[k], is_rotation) <= tolerance;
+			}
+
+			if (!is_redundant)
+			{
+				kept_keys.push_back(i);
+				anchor = i;
+			}
+		}
+
+		// the last key is always kept, so the track still ends on its final value
+		kept_keys.push_back(key_count - 1);
+
+		std::vector<float> times(kept_keys.size());
+		std::vector<glm::vec4> values(kept_keys.size());
+		for (size_t i = 0; i < kept_keys.size(); ++i)
+		{
+			times[i] = sampler.m_times[kept_keys[i]];
+			values[i] = sampler.m_values[kept_keys[i]];
+		}
+		sampler.m_times = std::move(times);
+		sampler.m_values = std::move(values);
+	}
+
+	void AnimationCompressor::quantize(AnimationSampler& sampler, bool is_rotation)
+	{
+		if (sampler.m_interp_type == AnimationSampler::EInterpolationType::CubicSpline || sampler.m_value_format != AnimationSampler::EValueFormat::Float)
+		{
+			return;
+		}
+
+		size_t key_count = sampler.m_values.size();
+		sampler.m_quantized_values.resize(key_count * 3);
+		if (is_rotation)
+		{
+			// q and -q are the same rotation, so the largest component is made positive and recovered from the others
+			const float k_max_component = 0.70710678f;
+			for (size_t k = 0; k < key_count; ++k)
+			{
+				glm::vec4 rotation = glm::normalize(sampler.m_values[k]);
+				uint32_t largest_index = 0;
+				for (uint32_t c = 1; c < 4; ++c)
+				{
+					if (std::abs(rotation[c]) > std::abs(rotation[largest_index]))
+					{
+						largest_index = c;
+					}
+				}
+				if (rotation[largest_index] < 0.0f)
+				{
+					rotation = -rotation;
+				}
+
+				uint16_t* quantized_value = &sampler.m_quantized_values[k * 3];
+				for (uint32_t i = 0, c = 0; c < 4; ++c)
+				{
+					if (c != largest_index)
+					{
+						float normalized_component = std::clamp(rotation[c] / k_max_component * 0.5f + 0.5f, 0.0f, 1.0f);
+						quantized_value[i++] = static_cast<uint16_t>(normalized_component * 32767.0f + 0.5f);
+					}
+				}
+				quantized_value[0] |= static_cast<uint16_t>((largest_index & 1) << 15);
+				quantized_value[1] |= static_cast<uint16_t>((largest_index >> 1) << 15);
+			}
+			sampler.m_value_format = AnimationSampler::EValueFormat::QuantizedRotation;
+		}
+		else
+		{
+			// range reduction, every component spans the full 16 bits over its range in the track
+			glm::vec3 range_max = sampler.m_values[0];
+			sampler.m_range_min = sampler.m_values[0];
+			for (const glm::vec4& value : sampler.m_values)
+			{
+				sampler.m_range_min = glm::min(sampler.m_range_min, glm::vec3(value));
+				range_max = glm::max(range_max, glm::vec3(value));
+			}
+			sampler.m_range_extent = range_max - sampler.m_range_min;
+
+			for (size_t k = 0; k < key_count; ++k)
+			{
+				for (int c = 0; c < 3; ++c)
+				{
+					float extent = sampler.m_range_extent[c];
+					float normalized_component = extent > 0.0f ? (sampler.m_values[k][c] - sampler.m_range_min[c]) / extent : 0.0f;
+					sampler.m_quantized_values[k * 3 + c] = static_cast<uint16_t>(std::clamp(normalized_component, 0.0f, 1.0f) * 65535.0f + 0.5f);
+				}
+			}
+			sampler.m_value_format = AnimationSampler::EValueFormat::QuantizedVector;
+		}
+
+		sampler.m_values.clear();
+		sampler.m_values.shrink_to_fit();
+	}
+
+	glm::vec4 AnimationCompressor::interpolate(const glm::vec4& a, const glm::vec4& b, float t, bool is_rotation)
+	{
+		if (!is_rotation)
+		{
+			return glm::mix(a, b, t);
+		}
+
+		// normalized lerp along the shortest arc, as sampled at runtime
+		return glm::normalize(glm::mix(a, glm::dot(a, b) < 0.0f ? -b : b, t));
+	}
+
+	float AnimationCompressor::calcError(const glm::vec4& a, const glm::vec4& b, bool is_rotation)
+	{
+		glm::vec4 delta = a - (is_rotation && glm::dot(a, b) < 0.0f ? -b : b);
+		if (!is_rotation)
+		{
+			delta.w = 0.0f;
+		}
+		return std::max(std::max(std::abs(delta.x), std::abs(delta.y)), std::max(std::abs(delta.z), std::abs(delta.w)));
+	}
+
+}
\ No newline at end of file
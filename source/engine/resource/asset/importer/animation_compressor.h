@@ -0,0 +1,21 @@
+#pragma once
+
+#include "engine/resource/asset/animation.h"
+
+namespace Bamboo
+{
+	class AnimationCompressor
+	{
+	public:
+		// drop the keys that interpolating between their kept neighbors reproduces within tolerance,
+		// constant tracks are reduced to a single key, cubic spline samplers are left untouched
+		static void reduceKeys(AnimationSampler& sampler, bool is_rotation, float tolerance);
+
+		// quantize the float values of a sampler into 3 uint16 per key, see AnimationSampler::EValueFormat
+		static void quantize(AnimationSampler& sampler, bool is_rotation);
+
+	private:
+		static glm::vec4 interpolate(const glm::vec4& a, const glm::vec4& b, float t, bool is_rotation);
+		static float calcError(const glm::vec4& a, const glm::vec4& b, bool is_rotation);
+	};
+}
\ No newline at end of file
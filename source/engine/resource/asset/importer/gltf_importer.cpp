@@ -1,11 +1,14 @@
 #define TINYGLTF_IMPLEMENTATION
 #define TINYGLTF_NO_STB_IMAGE_WRITE
 #include "gltf_importer.h"
+#include "mesh_optimizer.h"
+#include "animation_compressor.h"
 
 #include "engine/core/base/macro.h"
 #include "engine/resource/asset/asset_manager.h"
 
 #include <queue>
+#include <numeric>
 
 namespace Bamboo
 {
@@ -132,7 +135,7 @@ namespace Bamboo
 		return -1;
 	}
 
-	uint8_t GltfImporter::topologizeGltfBones(std::vector<Bone>& bones, const std::vector<std::pair<tinygltf::Node, int>>& joint_nodes)
+	uint16_t GltfImporter::topologizeGltfBones(std::vector<Bone>& bones, const std::vector<std::pair<tinygltf::Node, int>>& joint_nodes)
 	{
 		std::vector<size_t> bone_indices;
 		for (size_t i = 0; i < joint_nodes.size(); ++i)
@@ -149,15 +152,15 @@ namespace Bamboo
 			for (int child_joint_node_index : joint_node.children)
 			{
 				size_t child_bone_index = findGltfJointNodeBoneIndex(joint_nodes, child_joint_node_index);
-				bones[i].m_children.push_back(static_cast<uint8_t>(child_bone_index));
-				bones[child_bone_index].m_parent = static_cast<uint8_t>(i);
+				bones[i].m_children.push_back(static_cast<uint16_t>(child_bone_index));
+				bones[child_bone_index].m_parent = static_cast<uint16_t>(i);
 
 				bone_indices.erase(std::remove(bone_indices.begin(), bone_indices.end(), child_bone_index), bone_indices.end());
 			}
 		}
 
 		ASSERT(bone_indices.size() == 1, "failed to find the root bone");
-		return static_cast<uint8_t>(bone_indices.front());
+		return static_cast<uint16_t>(bone_indices.front());
 	}
 
 	void GltfImporter::importGltfTexture(const tinygltf::Model& gltf_model,
@@ -222,7 +225,8 @@ namespace Bamboo
 		const std::vector<std::pair<tinygltf::Primitive, glm::mat4>>& primitives,
 		const std::vector<std::shared_ptr<Material>>& materials,
 		std::shared_ptr<StaticMesh>& static_mesh,
-		std::shared_ptr<SkeletalMesh>& skeletal_mesh)
+		std::shared_ptr<SkeletalMesh>& skeletal_mesh,
+		const GltfImportOption& option)
 	{
 		size_t vertex_count = 0, index_count = 0;
 		size_t primitive_count = primitives.size();
@@ -339,13 +343,13 @@ namespace Bamboo
 					case TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT:
 					{
 						const uint16_t* joint_buffer = static_cast<const uint16_t*>(joint_void_buffer);
-						skeletal_vertex->m_bones = glm::vec4(glm::make_vec4(&joint_buffer[v * joint_byte_stride]));
+						skeletal_vertex->m_bones = glm::u16vec4(glm::make_vec4(&joint_buffer[v * joint_byte_stride]));
 						break;
 					}
 					case TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE:
 					{
 						const uint8_t* joint_buffer = static_cast<const uint8_t*>(joint_void_buffer);
-						skeletal_vertex->m_bones = glm::vec4(glm::make_vec4(&joint_buffer[v * joint_byte_stride]));
+						skeletal_vertex->m_bones = glm::u16vec4(glm::make_vec4(&joint_buffer[v * joint_byte_stride]));
 						break;
 					}
 					default:
@@ -422,6 +426,179 @@ namespace Bamboo
 			vertex_start += primitive_vertex_count;
 			index_start += primitive_index_count;
 		}
+
+		std::vector<glm::vec3> positions(vertex_count);
+		for (size_t v = 0; v < vertex_count; ++v)
+		{
+			positions[v] = static_mesh ? static_mesh->m_vertices[v].m_position : skeletal_mesh->m_vertices[v].m_position;
+		}
+
+		if (option.generate_lods)
+		{
+			generateMeshLODs(mesh, positions);
+		}
+
+		std::vector<uint32_t> vertex_remap = packMeshIndices(mesh, positions, option);
+		if (static_mesh)
+		{
+			remapVertices(static_mesh->m_vertices, vertex_remap);
+		}
+		else
+		{
+			remapVertices(skeletal_mesh->m_vertices, vertex_remap);
+		}
+	}
+
+	void GltfImporter::generateMeshLODs(const std::shared_ptr<Mesh>& mesh, const std::vector<glm::vec3>& positions)
+	{
+		const uint32_t k_max_lod_count = 4;
+		const uint32_t k_min_index_count = 64 * 3;
+		const float k_lod_index_ratio = 0.5f;
+		const float k_min_index_reduction = 0.9f;
+		const float k_max_lod_error = 0.1f;
+
+		// errors are stored relative to the bounding radius, so they can be projected with the instance's scale at runtime
+		BoundingBox bounding_box;
+		for (const glm::vec3& position : positions)
+		{
+			bounding_box.combine(position);
+		}
+		float radius = std::max(glm::length(bounding_box.extent()), k_epsilon);
+
+		// simplify every lod from the previous one, and append lod indices after all full detail indices
+		for (SubMesh& sub_mesh : mesh->m_sub_meshes)
+		{
+			sub_mesh.m_lods.clear();
+			std::vector<uint32_t> lod_indices(mesh->m_indices.begin() + sub_mesh.m_index_offset,
+				mesh->m_indices.begin() + sub_mesh.m_index_offset + sub_mesh.m_index_count);
+			for (uint32_t l = 0; l < k_max_lod_count && lod_indices.size() > k_min_index_count; ++l)
+			{
+				size_t target_index_count = static_cast<size_t>(lod_indices.size() * k_lod_index_ratio) / 3 * 3;
+				float error = 0.0f;
+				std::vector<uint32_t> simplified_indices = MeshOptimizer::simplify(positions, lod_indices, 
+					target_index_count, k_max_lod_error * radius, error);
+				if (simplified_indices.size() > lod_indices.size() * k_min_index_reduction)
+				{
+					break;
+				}
+
+				SubMeshLOD lod;
+				lod.m_index_offset = static_cast<uint32_t>(mesh->m_indices.size());
+				lod.m_index_count = static_cast<uint32_t>(simplified_indices.size());
+				lod.m_error = std::max(error / radius, sub_mesh.m_lods.empty() ? 0.0f : sub_mesh.m_lods.back().m_error);
+				sub_mesh.m_lods.push_back(lod);
+
+				mesh->m_indices.insert(mesh->m_indices.end(), simplified_indices.begin(), simplified_indices.end());
+				lod_indices = std::move(simplified_indices);
+			}
+		}
+	}
+
+	std::vector<uint32_t> GltfImporter::packMeshIndices(const std::shared_ptr<Mesh>& mesh, const std::vector<glm::vec3>& positions, const GltfImportOption& option)
+	{
+		const float k_overdraw_threshold = 1.05f;
+		const uint32_t k_max_index16_vertex_count = 1 << 16;
+		const uint32_t k_max_meshlet_vertex_count = MESHLET_MAX_VERTEX_NUM;
+		const uint32_t k_max_meshlet_triangle_count = MESHLET_MAX_TRIANGLE_NUM;
+
+		std::vector<uint32_t> vertex_remap(positions.size());
+		std::iota(vertex_remap.begin(), vertex_remap.end(), 0);
+
+		std::vector<uint32_t> indices;
+		std::vector<uint16_t> indices16;
+		uint32_t vertex_start = 0;
+		for (SubMesh& sub_mesh : mesh->m_sub_meshes)
+		{
+			// the full detail range and the lod ranges, relative to the sub mesh's first vertex
+			std::vector<std::vector<uint32_t>> ranges;
+			ranges.emplace_back(mesh->m_indices.begin() + sub_mesh.m_index_offset,
+				mesh->m_indices.begin() + sub_mesh.m_index_offset + sub_mesh.m_index_count);
+			for (const SubMeshLOD& lod : sub_mesh.m_lods)
+			{
+				ranges.emplace_back(mesh->m_indices.begin() + lod.m_index_offset,
+					mesh->m_indices.begin() + lod.m_index_offset + lod.m_index_count);
+			}
+			for (std::vector<uint32_t>& range : ranges)
+			{
+				for (uint32_t& index : range)
+				{
+					index -= vertex_start;
+				}
+			}
+
+			std::vector<glm::vec3> sub_mesh_positions(positions.begin() + vertex_start, positions.begin() + vertex_start + sub_mesh.m_vertex_count);
+			if (option.optimize_meshes)
+			{
+				for (std::vector<uint32_t>& range : ranges)
+				{
+					MeshOptimizer::optimizeVertexCache(range, sub_mesh.m_vertex_count);
+				}
+
+				// lods are drawn at a distance, where overdraw matters less than their cache efficiency
+				MeshOptimizer::optimizeOverdraw(ranges[0], sub_mesh_positions, k_overdraw_threshold);
+			}
+
+			// meshlets are consecutive triangles of the final order, vertex renumbering doesn't change them
+			sub_mesh.m_meshlets.clear();
+			if (option.build_meshlets)
+			{
+				sub_mesh.m_meshlets = MeshOptimizer::buildMeshlets(ranges[0], sub_mesh_positions, k_max_meshlet_vertex_count, k_max_meshlet_triangle_count);
+			}
+
+			if (option.optimize_meshes)
+			{
+				// renumber vertices by their first use, the full detail range first
+				std::vector<uint32_t> fetch_indices;
+				for (const std::vector<uint32_t>& range : ranges)
+				{
+					fetch_indices.insert(fetch_indices.end(), range.begin(), range.end());
+				}
+				std::vector<uint32_t> fetch_remap = MeshOptimizer::optimizeVertexFetch(fetch_indices, sub_mesh.m_vertex_count);
+				for (size_t r = 0, i = 0; r < ranges.size(); ++r)
+				{
+					std::copy(fetch_indices.begin() + i, fetch_indices.begin() + i + ranges[r].size(), ranges[r].begin());
+					i += ranges[r].size();
+				}
+				for (uint32_t v = 0; v < sub_mesh.m_vertex_count; ++v)
+				{
+					vertex_remap[vertex_start + v] = vertex_start + fetch_remap[v];
+				}
+			}
+
+			// sub meshes with at most 65536 vertices are indexed in 16 bits
+			sub_mesh.m_vertex_offset = vertex_start;
+			sub_mesh.m_is_index16 = sub_mesh.m_vertex_count <= k_max_index16_vertex_count;
+			for (size_t r = 0; r < ranges.size(); ++r)
+			{
+				uint32_t index_offset = static_cast<uint32_t>(sub_mesh.m_is_index16 ? indices16.size() : indices.size());
+				if (r == 0)
+				{
+					sub_mesh.m_index_offset = index_offset;
+				}
+				else
+				{
+					sub_mesh.m_lods[r - 1].m_index_offset = index_offset;
+				}
+
+				for (uint32_t index : ranges[r])
+				{
+					if (sub_mesh.m_is_index16)
+					{
+						indices16.push_back(static_cast<uint16_t>(index));
+					}
+					else
+					{
+						indices.push_back(index);
+					}
+				}
+			}
+
+			vertex_start += sub_mesh.m_vertex_count;
+		}
+
+		mesh->m_indices = std::move(indices);
+		mesh->m_indices16 = std::move(indices16);
+		return vertex_remap;
 	}
 
 	bool GltfImporter::importGltf(const std::string& filename, const URL& folder, const GltfImportOption& option)
@@ -606,7 +783,7 @@ namespace Bamboo
 				}
 			}
 
-			importGltfPrimitives(gltf_model, primitives, materials, static_mesh, skeletal_mesh);
+			importGltfPrimitives(gltf_model, primitives, materials, static_mesh, skeletal_mesh, option);
 
 			if (is_skeletal_mesh)
 			{
@@ -647,7 +824,7 @@ namespace Bamboo
 				{
 					primitives.push_back(std::make_pair(primitive, node_pair.first));
 				}
-				importGltfPrimitives(gltf_model, primitives, materials, static_mesh, skeletal_mesh);
+				importGltfPrimitives(gltf_model, primitives, materials, static_mesh, skeletal_mesh, option);
 
 				if (is_skeletal_mesh)
 				{
@@ -787,10 +964,34 @@ namespace Bamboo
 				channel.m_sampler_index = gltf_channel.sampler;
 			}
 
+			// compress the sampler of each channel by its path type
+			animation->calcTimeRange();
+			if (option.compress_animations)
+			{
+				// translation errors are in scene units and scale errors are relative, rotation errors are in quaternion components,
+				// roughly half the angle in radians, which are amplified by every child bone's length so they get a tighter tolerance
+				const float k_translation_scale_key_tolerance = 0.0001f;
+				const float k_rotation_key_tolerance = 0.00002f;
+				std::vector<bool> compressed_samplers(animation->m_samplers.size(), false);
+				for (const AnimationChannel& channel : animation->m_channels)
+				{
+					if (channel.m_sampler_index >= animation->m_samplers.size() || compressed_samplers[channel.m_sampler_index])
+					{
+						continue;
+					}
+
+					AnimationSampler& sampler = animation->m_samplers[channel.m_sampler_index];
+					bool is_rotation = channel.m_path_type == AnimationChannel::EPathType::Rotation;
+					AnimationCompressor::reduceKeys(sampler, is_rotation, is_rotation ? k_rotation_key_tolerance : k_translation_scale_key_tolerance);
+					AnimationCompressor::quantize(sampler, is_rotation);
+					compressed_samplers[channel.m_sampler_index] = true;
+				}
+			}
+
 			animation->inflate();
 			as->serializeAsset(animation);
 		}
 
 		return true;
 	}
-}
+}
\ No newline at end of file
@@ -21,7 +21,7 @@ namespace Bamboo
 		static bool validateGltfMeshNode(const tinygltf::Node* node, const tinygltf::Model& gltf_model);
 		static bool isGltfSkeletalMesh(const tinygltf::Mesh& gltf_mesh);
 		static size_t findGltfJointNodeBoneIndex(const std::vector<std::pair<tinygltf::Node, int>>& joint_nodes, int node_index);
-		static uint8_t topologizeGltfBones(std::vector<Bone>& bones, const std::vector<std::pair<tinygltf::Node, int>>& joint_nodes);
+		static uint16_t topologizeGltfBones(std::vector<Bone>& bones, const std::vector<std::pair<tinygltf::Node, int>>& joint_nodes);
 
 		static void importGltfTexture(const tinygltf::Model& gltf_model,
 			const tinygltf::Image& gltf_image,
@@ -32,7 +32,21 @@ namespace Bamboo
 			const std::vector<std::pair<tinygltf::Primitive, glm::mat4>>& primitives,
 			const std::vector<std::shared_ptr<Material>>& materials,
 			std::shared_ptr<StaticMesh>& static_mesh,
-			std::shared_ptr<SkeletalMesh>& skeletal_mesh);
+			std::shared_ptr<SkeletalMesh>& skeletal_mesh,
+			const GltfImportOption& option);
+		static void generateMeshLODs(const std::shared_ptr<Mesh>& mesh, const std::vector<glm::vec3>& positions);
+		static std::vector<uint32_t> packMeshIndices(const std::shared_ptr<Mesh>& mesh, const std::vector<glm::vec3>& positions, const GltfImportOption& option);
+
+		template<typename VertexType>
+		static void remapVertices(std::vector<VertexType>& vertices, const std::vector<uint32_t>& vertex_remap)
+		{
+			std::vector<VertexType> remapped_vertices(vertices.size());
+			for (size_t v = 0; v < vertices.size(); ++v)
+			{
+				remapped_vertices[v] = vertices[vertex_remap[v]];
+			}
+			vertices = std::move(remapped_vertices);
+		}
 
 		static bool importGltf(const std::string& filename, const URL& folder, const GltfImportOption& option);
 	};
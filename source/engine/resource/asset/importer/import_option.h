@@ -5,6 +5,12 @@ struct GltfImportOption
 	// mesh
 	bool combine_meshes;
 	bool force_static_mesh;
+	bool generate_lods;
+	bool optimize_meshes;
+	bool build_meshlets;
+
+	// animation
+	bool compress_animations;
 
 	// material
 	bool contains_occlusion_channel;
@@ -0,0 +1,708 @@
+#include "mesh_optimizer.h"
+
+#include <unordered_map>
+#include <algorithm>
+#include <cstring>
+#include <cmath>
+#include <limits>
+
+namespace Bamboo
+{
+	// symmetric 4x4 plane quadric, with the accumulated area weight to average the error
+	struct Quadric
+	{
+		double a00 = 0.0, a01 = 0.0, a02 = 0.0, a03 = 0.0;
+		double a11 = 0.0, a12 = 0.0, a13 = 0.0;
+		double a22 = 0.0, a23 = 0.0;
+		double a33 = 0.0;
+		double weight = 0.0;
+
+		void addPlane(const glm::dvec3& n, double d, double w)
+		{
+			a00 += w * n.x * n.x; a01 += w * n.x * n.y; a02 += w * n.x * n.z; a03 += w * n.x * d;
+			a11 += w * n.y * n.y; a12 += w * n.y * n.z; a13 += w * n.y * d;
+			a22 += w * n.z * n.z; a23 += w * n.z * d;
+			a33 += w * d * d;
+			weight += w;
+		}
+
+		void add(const Quadric& q)
+		{
+			a00 += q.a00; a01 += q.a01; a02 += q.a02; a03 += q.a03;
+			a11 += q.a11; a12 += q.a12; a13 += q.a13;
+			a22 += q.a22; a23 += q.a23;
+			a33 += q.a33;
+			weight += q.weight;
+		}
+
+		// average squared distance from p to the accumulated planes
+		double eval(const glm::dvec3& p) const
+		{
+			double e = a00 * p.x * p.x + 2.0 * a01 * p.x * p.y + 2.0 * a02 * p.x * p.z + 2.0 * a03 * p.x +
+				a11 * p.y * p.y + 2.0 * a12 * p.y * p.z + 2.0 * a13 * p.y +
+				a22 * p.z * p.z + 2.0 * a23 * p.z +
+				a33;
+			return weight > 0.0 ? std::abs(e) / weight : 0.0;
+		}
+	};
+
+	struct Collapse
+	{
+		uint32_t from;
+		uint32_t to;
+		double cost;
+	};
+
+	struct PositionHash
+	{
+		size_t operator()(const glm::vec3& p) const
+		{
+			uint32_t bits[3];
+			memcpy(bits, &p, sizeof(bits));
+			return ((size_t)bits[0] * 73856093u) ^ ((size_t)bits[1] * 19349663u) ^ ((size_t)bits[2] * 83492791u);
+		}
+	};
+
+	std::vector<uint32_t> MeshOptimizer::simplify(const std::vector<glm::vec3>& positions, const std::vector<uint32_t>& indices,
+		size_t target_index_count, float max_error, float& result_error)
+	{
+		result_error = 0.0f;
+
+		// compact referenced vertices to local ids, and weld local vertices with the same position
+		std::unordered_map<uint32_t, uint32_t> local_ids;
+		std::unordered_map<glm::vec3, uint32_t, PositionHash> welded_ids;
+		std::vector<uint32_t> local_originals;
+		std::vector<uint32_t> remap;
+		std::vector<glm::dvec3> welded_positions;
+		std::vector<uint32_t> welded_local_counts;
+		std::vector<uint32_t> tris(indices.size());
+		for (size_t i = 0; i < indices.size(); ++i)
+		{
+			auto iter = local_ids.find(indices[i]);
+			if (iter == local_ids.end())
+			{
+				uint32_t local_id = static_cast<uint32_t>(local_originals.size());
+				iter = local_ids.insert({ indices[i], local_id }).first;
+				local_originals.push_back(indices[i]);
+
+				const glm::vec3& position = positions[indices[i]];
+				auto welded_iter = welded_ids.find(position);
+				if (welded_iter == welded_ids.end())
+				{
+					welded_iter = welded_ids.insert({ position, static_cast<uint32_t>(welded_positions.size()) }).first;
+					welded_positions.push_back(glm::dvec3(position));
+					welded_local_counts.push_back(0);
+				}
+				remap.push_back(welded_iter->second);
+				welded_local_counts[welded_iter->second]++;
+			}
+			tris[i] = iter->second;
+		}
+
+		// vertex quadrics from their triangle planes
+		size_t welded_count = welded_positions.size();
+		std::vector<Quadric> quadrics(welded_count);
+		for (size_t i = 0; i < tris.size(); i += 3)
+		{
+			const glm::dvec3& p0 = welded_positions[remap[tris[i]]];
+			const glm::dvec3& p1 = welded_positions[remap[tris[i + 1]]];
+			const glm::dvec3& p2 = welded_positions[remap[tris[i + 2]]];
+			glm::dvec3 n = glm::cross(p1 - p0, p2 - p0);
+			double area = glm::length(n);
+			if (area <= 0.0)
+			{
+				continue;
+			}
+			n /= area;
+			double d = -glm::dot(n, p0);
+			for (uint32_t c = 0; c < 3; ++c)
+			{
+				quadrics[remap[tris[i + c]]].addPlane(n, d, area * 0.5);
+			}
+		}
+
+		// lock border vertices, whose edges have only one triangle, and seam vertices, which are split into several vertices
+		std::vector<bool> locked(welded_count, false);
+		std::unordered_map<uint64_t, uint32_t> edge_counts;
+		for (size_t i = 0; i < tris.size(); i += 3)
+		{
+			for (uint32_t c = 0; c < 3; ++c)
+			{
+				uint32_t a = remap[tris[i + c]];
+				uint32_t b = remap[tris[i + (c + 1) % 3]];
+				uint64_t key = ((uint64_t)std::min(a, b) << 32) | std::max(a, b);
+				edge_counts[key]++;
+			}
+		}
+		for (const auto& iter : edge_counts)
+		{
+			if (iter.second == 1)
+			{
+				locked[iter.first >> 32] = true;
+				locked[iter.first & 0xffffffff] = true;
+			}
+		}
+		for (size_t v = 0; v < welded_count; ++v)
+		{
+			locked[v] = locked[v] || welded_local_counts[v] > 1;
+		}
+
+		double max_cost = (double)max_error * max_error;
+		double result_cost = 0.0;
+		size_t triangle_count = tris.size() / 3;
+		size_t target_triangle_count = target_index_count / 3;
+		std::vector<uint32_t> adjacency_offsets(welded_count + 1);
+		std::vector<uint32_t> adjacency;
+		std::vector<Collapse> collapses;
+		std::vector<bool> touched(welded_count);
+
+		const uint32_t k_max_pass_count = 64;
+		for (uint32_t pass = 0; pass < k_max_pass_count && triangle_count > target_triangle_count; ++pass)
+		{
+			// triangles around each welded vertex
+			std::fill(adjacency_offsets.begin(), adjacency_offsets.end(), 0);
+			for (uint32_t index : tris)
+			{
+				adjacency_offsets[remap[index] + 1]++;
+			}
+			for (size_t v = 0; v < welded_count; ++v)
+			{
+				adjacency_offsets[v + 1] += adjacency_offsets[v];
+			}
+			adjacency.resize(tris.size());
+			std::vector<uint32_t> fill_offsets(adjacency_offsets.begin(), adjacency_offsets.end() - 1);
+			for (size_t i = 0; i < tris.size(); ++i)
+			{
+				adjacency[fill_offsets[remap[tris[i]]]++] = static_cast<uint32_t>(i / 3);
+			}
+
+			// the cheaper direction of every edge, collapsing onto the other vertex's position
+			collapses.clear();
+			for (size_t i = 0; i < tris.size(); i += 3)
+			{
+				for (uint32_t c = 0; c < 3; ++c)
+				{
+					uint32_t a = remap[tris[i + c]];
+					uint32_t b = remap[tris[i + (c + 1) % 3]];
+					if (a > b)
+					{
+						continue;
+					}
+
+					Quadric q = quadrics[a];
+					q.add(quadrics[b]);
+					double cost_ab = locked[a] ? std::numeric_limits<double>::max() : q.eval(welded_positions[b]);
+					double cost_ba = locked[b] ? std::numeric_limits<double>::max() : q.eval(welded_positions[a]);
+					if (locked[a] && locked[b])
+					{
+						continue;
+					}
+					collapses.push_back(cost_ab <= cost_ba ? Collapse{ a, b, cost_ab } : Collapse{ b, a, cost_ba });
+				}
+			}
+			std::sort(collapses.begin(), collapses.end(), [](const Collapse& lhs, const Collapse& rhs) { return lhs.cost < rhs.cost; });
+
+			// apply the cheapest collapses, every vertex collapses at most once per pass
+			std::fill(touched.begin(), touched.end(), false);
+			size_t collapse_count = 0;
+			for (const Collapse& collapse : collapses)
+			{
+				if (triangle_count <= target_triangle_count || collapse.cost > max_cost)
+				{
+					break;
+				}
+				if (touched[collapse.from] || touched[collapse.to])
+				{
+					continue;
+				}
+
+				// reject collapses which flip a remaining triangle, and find the vertex used on the collapsed edge
+				uint32_t to_local = UINT32_MAX;
+				bool is_flipped = false;
+				for (uint32_t a = adjacency_offsets[collapse.from]; a < adjacency_offsets[collapse.from + 1] && !is_flipped; ++a)
+				{
+					const uint32_t* tri = &tris[adjacency[a] * 3];
+					uint32_t w0 = remap[tri[0]], w1 = remap[tri[1]], w2 = remap[tri[2]];
+					if (w0 == w1 || w1 == w2 || w0 == w2)
+					{
+						continue;
+					}
+					if (w0 == collapse.to || w1 == collapse.to || w2 == collapse.to)
+					{
+						to_local = w0 == collapse.to ? tri[0] : (w1 == collapse.to ? tri[1] : tri[2]);
+						continue;
+					}
+
+					glm::dvec3 p[3] = { welded_positions[w0], welded_positions[w1], welded_positions[w2] };
+					glm::dvec3 n0 = glm::cross(p[1] - p[0], p[2] - p[0]);
+					for (uint32_t c = 0; c < 3; ++c)
+					{
+						if (remap[tri[c]] == collapse.from)
+						{
+							p[c] = welded_positions[collapse.to];
+						}
+					}
+					glm::dvec3 n1 = glm::cross(p[1] - p[0], p[2] - p[0]);
+					is_flipped = glm::dot(n0, n1) <= 0.0;
+				}
+				if (is_flipped || to_local == UINT32_MAX)
+				{
+					continue;
+				}
+
+				// move all corners of the collapsed vertex, the triangles on the edge become degenerate
+				for (uint32_t a = adjacency_offsets[collapse.from]; a < adjacency_offsets[collapse.from + 1]; ++a)
+				{
+					uint32_t* tri = &tris[adjacency[a] * 3];
+					uint32_t w0 = remap[tri[0]], w1 = remap[tri[1]], w2 = remap[tri[2]];
+					if (w0 == w1 || w1 == w2 || w0 == w2)
+					{
+						continue;
+					}
+					if (w0 == collapse.to || w1 == collapse.to || w2 == collapse.to)
+					{
+						triangle_count--;
+					}
+					for (uint32_t c = 0; c < 3; ++c)
+					{
+						if (remap[tri[c]] == collapse.from)
+						{
+							tri[c] = to_local;
+						}
+					}
+				}
+
+				quadrics[collapse.to].add(quadrics[collapse.from]);
+				touched[collapse.from] = touched[collapse.to] = true;
+				result_cost = std::max(result_cost, collapse.cost);
+				collapse_count++;
+			}
+
+			// remove degenerate triangles
+			size_t write = 0;
+			for (size_t i = 0; i < tris.size(); i += 3)
+			{
+				uint32_t w0 = remap[tris[i]], w1 = remap[tris[i + 1]], w2 = remap[tris[i + 2]];
+				if (w0 != w1 && w1 != w2 && w0 != w2)
+				{
+					tris[write++] = tris[i];
+					tris[write++] = tris[i + 1];
+					tris[write++] = tris[i + 2];
+				}
+			}
+			tris.resize(write);
+			triangle_count = write / 3;
+
+			if (collapse_count == 0)
+			{
+				break;
+			}
+		}
+
+		std::vector<uint32_t> result(tris.size());
+		for (size_t i = 0; i < tris.size(); ++i)
+		{
+			result[i] = local_originals[tris[i]];
+		}
+		result_error = static_cast<float>(std::sqrt(result_cost));
+		return result;
+	}
+
+	// forsyth's score of a vertex from its position in the lru cache and its triangles not drawn yet
+	static float calcVertexScore(int cache_position, uint32_t cache_size, uint32_t live_triangle_count)
+	{
+		if (live_triangle_count == 0)
+		{
+			return -1.0f;
+		}
+
+		// vertices of the last triangle get a fixed score, so the next triangle doesn't strictly reuse its edge
+		float score = 0.0f;
+		if (cache_position >= 0)
+		{
+			score = cache_position < 3 ? 0.75f : std::pow(1.0f - (float)(cache_position - 3) / (cache_size - 3), 1.5f);
+		}
+
+		// boost vertices with few triangles left, to finish them before they become isolated
+		score += 2.0f * std::pow((float)live_triangle_count, -0.5f);
+		return score;
+	}
+
+	void MeshOptimizer::optimizeVertexCache(std::vector<uint32_t>& indices, size_t vertex_count)
+	{
+		const uint32_t k_cache_size = 32;
+
+		size_t triangle_count = indices.size() / 3;
+		if (triangle_count == 0)
+		{
+			return;
+		}
+
+		// triangles around each vertex
+		std::vector<uint32_t> adjacency_offsets(vertex_count + 1, 0);
+		for (uint32_t index : indices)
+		{
+			adjacency_offsets[index + 1]++;
+		}
+		for (size_t v = 0; v < vertex_count; ++v)
+		{
+			adjacency_offsets[v + 1] += adjacency_offsets[v];
+		}
+		std::vector<uint32_t> adjacency(indices.size());
+		std::vector<uint32_t> fill_offsets(adjacency_offsets.begin(), adjacency_offsets.end() - 1);
+		for (size_t i = 0; i < indices.size(); ++i)
+		{
+			adjacency[fill_offsets[indices[i]]++] = static_cast<uint32_t>(i / 3);
+		}
+
+		std::vector<uint32_t> live_counts(vertex_count);
+		std::vector<int> cache_positions(vertex_count, -1);
+		std::vector<float> vertex_scores(vertex_count);
+		for (size_t v = 0; v < vertex_count; ++v)
+		{
+			live_counts[v] = adjacency_offsets[v + 1] - adjacency_offsets[v];
+			vertex_scores[v] = calcVertexScore(-1, k_cache_size, live_counts[v]);
+		}
+
+		std::vector<bool> emitted(triangle_count, false);
+		std::vector<uint32_t> cache, new_cache;
+		std::vector<uint32_t> result;
+		result.reserve(indices.size());
+		size_t scan_cursor = 0;
+		uint32_t best_triangle = UINT32_MAX;
+		while (result.size() < indices.size())
+		{
+			// no candidate around the cached vertices, continue with the next triangle in input order
+			if (best_triangle == UINT32_MAX)
+			{
+				while (emitted[scan_cursor])
+				{
+					scan_cursor++;
+				}
+				best_triangle = static_cast<uint32_t>(scan_cursor);
+			}
+
+			const uint32_t* tri = &indices[best_triangle * 3];
+			emitted[best_triangle] = true;
+			result.insert(result.end(), tri, tri + 3);
+
+			// the drawn triangle's vertices move to the front of the cache
+			new_cache.clear();
+			for (uint32_t c = 0; c < 3; ++c)
+			{
+				live_counts[tri[c]]--;
+				if (std::find(new_cache.begin(), new_cache.end(), tri[c]) == new_cache.end())
+				{
+					new_cache.push_back(tri[c]);
+				}
+			}
+			for (uint32_t v : cache)
+			{
+				if (v != tri[0] && v != tri[1] && v != tri[2])
+				{
+					new_cache.push_back(v);
+				}
+			}
+
+			// vertices pushed out of the cache
+			for (size_t i = k_cache_size; i < new_cache.size(); ++i)
+			{
+				cache_positions[new_cache[i]] = -1;
+				vertex_scores[new_cache[i]] = calcVertexScore(-1, k_cache_size, live_counts[new_cache[i]]);
+			}
+			new_cache.resize(std::min<size_t>(new_cache.size(), k_cache_size));
+			std::swap(cache, new_cache);
+
+			for (size_t i = 0; i < cache.size(); ++i)
+			{
+				cache_positions[cache[i]] = static_cast<int>(i);
+				vertex_scores[cache[i]] = calcVertexScore(static_cast<int>(i), k_cache_size, live_counts[cache[i]]);
+			}
+
+			// the best remaining triangle around the cached vertices is drawn next
+			float best_score = -1.0f;
+			best_triangle = UINT32_MAX;
+			for (uint32_t v : cache)
+			{
+				for (uint32_t a = adjacency_offsets[v]; a < adjacency_offsets[v + 1]; ++a)
+				{
+					uint32_t t = adjacency[a];
+					if (emitted[t])
+					{
+						continue;
+					}
+
+					const uint32_t* candidate = &indices[t * 3];
+					float score = vertex_scores[candidate[0]] + vertex_scores[candidate[1]] + vertex_scores[candidate[2]];
+					if (score > best_score)
+					{
+						best_score = score;
+						best_triangle = t;
+					}
+				}
+			}
+		}
+
+		indices = std::move(result);
+	}
+
+	void MeshOptimizer::optimizeOverdraw(std::vector<uint32_t>& indices, const std::vector<glm::vec3>& positions, float threshold)
+	{
+		const uint32_t k_cache_size = 16;
+
+		size_t triangle_count = indices.size() / 3;
+		if (triangle_count < 2)
+		{
+			return;
+		}
+
+		// split clusters where a triangle misses all its vertices in the cache, the cache order restarts there,
+		// so the clusters can be reordered without losing much cache efficiency
+		std::vector<uint32_t> cluster_offsets;
+		std::vector<uint32_t> timestamps(positions.size(), 0);
+		uint32_t time = k_cache_size + 1;
+		for (size_t t = 0; t < triangle_count; ++t)
+		{
+			uint32_t miss_count = 0;
+			for (uint32_t c = 0; c < 3; ++c)
+			{
+				uint32_t index = indices[t * 3 + c];
+				if (time - timestamps[index] > k_cache_size)
+				{
+					timestamps[index] = time++;
+					miss_count++;
+				}
+			}
+			if (t == 0 || miss_count == 3)
+			{
+				cluster_offsets.push_back(static_cast<uint32_t>(t));
+			}
+		}
+		cluster_offsets.push_back(static_cast<uint32_t>(triangle_count));
+
+		size_t cluster_count = cluster_offsets.size() - 1;
+		if (cluster_count < 2)
+		{
+			return;
+		}
+
+		glm::dvec3 mesh_centroid(0.0);
+		for (uint32_t index : indices)
+		{
+			mesh_centroid += glm::dvec3(positions[index]);
+		}
+		mesh_centroid /= (double)indices.size();
+
+		// clusters facing outwards from the mesh center are more likely to occlude the others
+		std::vector<double> cluster_sort_keys(cluster_count);
+		for (size_t c = 0; c < cluster_count; ++c)
+		{
+			glm::dvec3 centroid(0.0);
+			glm::dvec3 normal(0.0);
+			double area = 0.0;
+			for (uint32_t t = cluster_offsets[c]; t < cluster_offsets[c + 1]; ++t)
+			{
+				glm::dvec3 p0 = positions[indices[t * 3]];
+				glm::dvec3 p1 = positions[indices[t * 3 + 1]];
+				glm::dvec3 p2 = positions[indices[t * 3 + 2]];
+				glm::dvec3 n = glm::cross(p1 - p0, p2 - p0);
+				double triangle_area = glm::length(n);
+				centroid += (p0 + p1 + p2) * (triangle_area / 3.0);
+				normal += n;
+				area += triangle_area;
+			}
+
+			double normal_length = glm::length(normal);
+			cluster_sort_keys[c] = area > 0.0 && normal_length > 0.0 ?
+				glm::dot(centroid / area - mesh_centroid, normal / normal_length) : 0.0;
+		}
+
+		std::vector<uint32_t> cluster_order(cluster_count);
+		for (size_t c = 0; c < cluster_count; ++c)
+		{
+			cluster_order[c] = static_cast<uint32_t>(c);
+		}
+		std::stable_sort(cluster_order.begin(), cluster_order.end(), [&](uint32_t lhs, uint32_t rhs) {
+			return cluster_sort_keys[lhs] > cluster_sort_keys[rhs];
+		});
+
+		std::vector<uint32_t> result;
+		result.reserve(indices.size());
+		for (uint32_t c : cluster_order)
+		{
+			result.insert(result.end(), indices.begin() + cluster_offsets[c] * 3, indices.begin() + cluster_offsets[c + 1] * 3);
+		}
+
+		// the cache misses at the cluster boundaries may cost more than the saved overdraw
+		if (calcACMR(result, positions.size(), k_cache_size) <= calcACMR(indices, positions.size(), k_cache_size) * threshold)
+		{
+			indices = std::move(result);
+		}
+	}
+
+	std::vector<uint32_t> MeshOptimizer::optimizeVertexFetch(std::vector<uint32_t>& indices, size_t vertex_count)
+	{
+		std::vector<uint32_t> new_vertices(vertex_count, UINT32_MAX);
+		std::vector<uint32_t> old_vertices;
+		old_vertices.reserve(vertex_count);
+		for (uint32_t& index : indices)
+		{
+			if (new_vertices[index] == UINT32_MAX)
+			{
+				new_vertices[index] = static_cast<uint32_t>(old_vertices.size());
+				old_vertices.push_back(index);
+			}
+			index = new_vertices[index];
+		}
+
+		for (size_t v = 0; v < vertex_count; ++v)
+		{
+			if (new_vertices[v] == UINT32_MAX)
+			{
+				old_vertices.push_back(static_cast<uint32_t>(v));
+			}
+		}
+		return old_vertices;
+	}
+
+	float MeshOptimizer::calcACMR(const std::vector<uint32_t>& indices, size_t vertex_count, uint32_t cache_size)
+	{
+		if (indices.empty())
+		{
+			return 0.0f;
+		}
+
+		// a vertex is in the fifo cache if less than cache_size misses happened since it was loaded
+		std::vector<uint32_t> timestamps(vertex_count, 0);
+		uint32_t time = cache_size + 1;
+		uint32_t miss_count = 0;
+		for (uint32_t index : indices)
+		{
+			if (time - timestamps[index] > cache_size)
+			{
+				timestamps[index] = time++;
+				miss_count++;
+			}
+		}
+		return (float)miss_count / (indices.size() / 3);
+	}
+
+	std::vector<Meshlet> MeshOptimizer::buildMeshlets(const std::vector<uint32_t>& indices, const std::vector<glm::vec3>& positions,
+		uint32_t max_vertex_count, uint32_t max_triangle_count)
+	{
+		// cones whose triangle normals spread wider than this are never culled
+		const float k_min_cone_dot = 0.1f;
+
+		// a vertex belongs to the current meshlet if it was stamped with its index
+		std::vector<uint32_t> stamps(positions.size(), UINT32_MAX);
+		std::vector<Meshlet> meshlets;
+		std::vector<uint32_t> vertices;
+		uint32_t triangle_start = 0;
+
+		auto finishMeshlet = [&](uint32_t triangle_end) {
+			Meshlet meshlet;
+			meshlet.m_index_offset = triangle_start * 3;
+			meshlet.m_index_count = (triangle_end - triangle_start) * 3;
+
+			// bounding sphere around the center of the vertices' bounding box
+			glm::vec3 min(std::numeric_limits<float>::max());
+			glm::vec3 max(std::numeric_limits<float>::lowest());
+			for (uint32_t v : vertices)
+			{
+				min = glm::min(min, positions[v]);
+				max = glm::max(max, positions[v]);
+			}
+			glm::vec3 center = (min + max) * 0.5f;
+			float radius = 0.0f;
+			for (uint32_t v : vertices)
+			{
+				radius = std::max(radius, glm::distance(center, positions[v]));
+			}
+			meshlet.m_sphere = glm::vec4(center, radius);
+
+			// the cone axis is the average triangle normal, its cutoff covers the normal furthest from it
+			std::vector<glm::vec3> normals;
+			std::vector<glm::vec3> centroids;
+			glm::vec3 axis(0.0f);
+			for (uint32_t t = triangle_start; t < triangle_end; ++t)
+			{
+				const glm::vec3& p0 = positions[indices[t * 3]];
+				const glm::vec3& p1 = positions[indices[t * 3 + 1]];
+				const glm::vec3& p2 = positions[indices[t * 3 + 2]];
+				glm::vec3 normal = glm::cross(p1 - p0, p2 - p0);
+				float area = glm::length(normal);
+				if (area > 0.0f)
+				{
+					normals.push_back(normal / area);
+					centroids.push_back((p0 + p1 + p2) / 3.0f);
+					axis += normals.back();
+				}
+			}
+
+			float axis_length = glm::length(axis);
+			float min_dot = 1.0f;
+			if (axis_length > 0.0f)
+			{
+				axis /= axis_length;
+				for (const glm::vec3& normal : normals)
+				{
+					min_dot = std::min(min_dot, glm::dot(axis, normal));
+				}
+			}
+
+			meshlet.m_cone_apex = center;
+			meshlet.m_cone_axis = axis;
+			meshlet.m_cone_cutoff = 1.0f;
+			if (axis_length > 0.0f && min_dot > k_min_cone_dot)
+			{
+				// move the apex back along the axis until it's behind every triangle's plane
+				float max_t = 0.0f;
+				for (size_t i = 0; i < normals.size(); ++i)
+				{
+					float t = glm::dot(centroids[i] - center, normals[i]) / glm::dot(axis, normals[i]);
+					max_t = std::max(max_t, t);
+				}
+				meshlet.m_cone_apex = center - axis * max_t;
+				meshlet.m_cone_cutoff = std::sqrt(1.0f - min_dot * min_dot);
+			}
+			meshlets.push_back(meshlet);
+
+			vertices.clear();
+			triangle_start = triangle_end;
+		};
+
+		uint32_t triangle_count = static_cast<uint32_t>(indices.size() / 3);
+		for (uint32_t t = 0; t < triangle_count; ++t)
+		{
+			uint32_t meshlet_index = static_cast<uint32_t>(meshlets.size());
+			uint32_t new_vertex_count = 0;
+			for (uint32_t i = 0; i < 3; ++i)
+			{
+				new_vertex_count += stamps[indices[t * 3 + i]] != meshlet_index ? 1 : 0;
+			}
+
+			if (vertices.size() + new_vertex_count > max_vertex_count || t - triangle_start >= max_triangle_count)
+			{
+				finishMeshlet(t);
+				meshlet_index++;
+			}
+
+			for (uint32_t i = 0; i < 3; ++i)
+			{
+				uint32_t index = indices[t * 3 + i];
+				if (stamps[index] != meshlet_index)
+				{
+					stamps[index] = meshlet_index;
+					vertices.push_back(index);
+				}
+			}
+		}
+
+		if (triangle_start < triangle_count)
+		{
+			finishMeshlet(triangle_count);
+		}
+		return meshlets;
+	}
+
+}
\ No newline at end of file
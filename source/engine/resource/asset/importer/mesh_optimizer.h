@@ -0,0 +1,37 @@
+#pragma once
+
+#include "engine/resource/asset/base/sub_mesh.h"
+#include <glm/glm.hpp>
+#include <vector>
+
+namespace Bamboo
+{
+	class MeshOptimizer
+	{
+	public:
+		// quadric error edge collapse simplification of a triangle list, vertices are only collapsed onto their neighbors,
+		// so the result references the same vertices, border and uv/normal seam vertices are kept to avoid cracks,
+		// result_error is the largest collapse error in mesh space distance
+		static std::vector<uint32_t> simplify(const std::vector<glm::vec3>& positions, const std::vector<uint32_t>& indices,
+			size_t target_index_count, float max_error, float& result_error);
+
+		// reorder triangles for the post transform vertex cache, with forsyth's vertex scores
+		static void optimizeVertexCache(std::vector<uint32_t>& indices, size_t vertex_count);
+
+		// reorder clusters of a cache optimized triangle list to draw outward facing ones first, so they occlude the others,
+		// keeps the order if the clusters cost more than threshold times the vertex cache misses
+		static void optimizeOverdraw(std::vector<uint32_t>& indices, const std::vector<glm::vec3>& positions, float threshold);
+
+		// renumber vertices by their first use in indices, which is rewritten, returns the old vertex of every new one,
+		// unreferenced vertices are moved to the end
+		static std::vector<uint32_t> optimizeVertexFetch(std::vector<uint32_t>& indices, size_t vertex_count);
+
+		// split a triangle list into meshlets of consecutive triangles with limited vertex and triangle counts,
+		// so they can be culled on gpu and drawn as index ranges without reordering the list
+		static std::vector<Meshlet> buildMeshlets(const std::vector<uint32_t>& indices, const std::vector<glm::vec3>& positions,
+			uint32_t max_vertex_count, uint32_t max_triangle_count);
+
+		// average cache misses per triangle of a fifo vertex cache
+		static float calcACMR(const std::vector<uint32_t>& indices, size_t vertex_count, uint32_t cache_size);
+	};
+}
\ No newline at end of file
@@ -10,15 +10,40 @@ namespace Bamboo
 	{
 		calcBoundingBox();
 
-		VulkanUtil::createVertexBuffer(m_vertices.size() * sizeof(m_vertices[0]), m_vertices.data(), m_vertex_buffer);
-		VulkanUtil::createIndexBuffer(m_indices, m_index_buffer);
+		// vertex buffers are also read as storage buffers by compute skinning
+#if QUANTIZED_VERTEX
+		std::vector<QuantizedSkeletalVertex> quantized_vertices(m_vertices.size());
+		for (size_t i = 0; i < m_vertices.size(); ++i)
+		{
+			quantizeVertex(m_vertices[i], quantized_vertices[i]);
+			quantized_vertices[i].m_bones = m_vertices[i].m_bones;
+			quantized_vertices[i].m_weights = m_vertices[i].m_weights;
+		}
+		VulkanUtil::createVertexBuffer(quantized_vertices.size() * sizeof(quantized_vertices[0]), quantized_vertices.data(), m_vertex_buffer, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT);
+#else
+		VulkanUtil::createVertexBuffer(m_vertices.size() * sizeof(m_vertices[0]), m_vertices.data(), m_vertex_buffer, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT);
+#endif
+		createIndexBuffer();
 	}
 
 	void SkeletalMesh::calcBoundingBox()
 	{
+		m_bone_bounding_boxes.clear();
 		for (const auto& vertex : m_vertices)
 		{
 			m_bounding_box.combine(vertex.m_position);
+
+			for (int i = 0; i < 4; ++i)
+			{
+				if (vertex.m_weights[i] > 0.0f)
+				{
+					if (vertex.m_bones[i] >= m_bone_bounding_boxes.size())
+					{
+						m_bone_bounding_boxes.resize(vertex.m_bones[i] + 1);
+					}
+					m_bone_bounding_boxes[vertex.m_bones[i]].combine(vertex.m_position);
+				}
+			}
 		}
 	}
 
@@ -12,6 +12,9 @@ namespace Bamboo
 
 		std::vector<SkeletalVertex> m_vertices;
 
+		// bind space bounding boxes of the vertices each bone influences, empty for bones without vertices
+		std::vector<BoundingBox> m_bone_bounding_boxes;
+
 	protected:
 		virtual void calcBoundingBox() override;
 
@@ -1,5 +1,4 @@
 #include "skeleton.h"
-#include <queue>
 
 CEREAL_REGISTER_TYPE(Bamboo::Skeleton)
 CEREAL_REGISTER_POLYMORPHIC_RELATION(Bamboo::Asset, Bamboo::Skeleton)
@@ -11,8 +10,9 @@ namespace Bamboo
 	{
 		for (size_t i = 0; i < m_bones.size(); ++i)
 		{
-			m_name_index[m_bones[i].m_name] = static_cast<uint8_t>(i);
+			m_name_index[m_bones[i].m_name] = static_cast<uint16_t>(i);
 		}
+		sortBones();
 	}
 
 	bool Skeleton::hasBone(const std::string& name)
@@ -22,30 +22,52 @@ namespace Bamboo
 
 	Bone* Skeleton::getBone(const std::string& name)
 	{
-		if (hasBone(name))
-		{
-			return &m_bones[m_name_index[name]];
-		}
-		return nullptr;
+		uint16_t bone_index = getBoneIndex(name);
+		return bone_index != INVALID_BONE_INDEX ? &m_bones[bone_index] : nullptr;
 	}
 
-	void Skeleton::update()
+	uint16_t Skeleton::getBoneIndex(const std::string& name) const
 	{
-		std::queue<std::pair<uint8_t, glm::mat4>> queue;
-		queue.push(std::make_pair(m_root_bone_index, glm::mat4(1.0)));
+		auto iter = m_name_index.find(name);
+		return iter != m_name_index.end() ? iter->second : INVALID_BONE_INDEX;
+	}
 
-		while (!queue.empty())
-		{
-			std::pair<uint8_t, glm::mat4> pair = queue.front();
-			queue.pop();
+	void Skeleton::calcBoneTransforms(const Pose& pose, BoneTransform* bone_transforms) const
+	{
+		// global matrices are scratch shared by the animators updated on the same thread, instead of state of every animator
+		static thread_local std::vector<glm::mat4> global_matrices;
+		global_matrices.resize(m_bones.size());
 
-			Bone& bone = m_bones[pair.first];
-			bone.update(pair.second);
+		// every parent's global matrix is final before its children read it
+		for (size_t i = 0; i < m_sorted_bone_indices.size(); ++i)
+		{
+			uint16_t bone_index = m_sorted_bone_indices[i];
+			const Bone& bone = m_bones[bone_index];
+			glm::mat4 local_matrix = pose.getTransform(bone_index).matrix();
+			global_matrices[bone_index] = i == 0 ? local_matrix : global_matrices[bone.m_parent] * local_matrix;
+			glm::mat4 bone_matrix = global_matrices[bone_index] * bone.m_global_inverse_bind_pose_matrix;
+#if DUAL_QUATERNION_SKINNING
+			// dual quaternions only represent rigid transforms, bone scales are dropped
+			glm::quat real = glm::quat_cast(glm::mat3(glm::normalize(glm::vec3(bone_matrix[0])),
+				glm::normalize(glm::vec3(bone_matrix[1])), glm::normalize(glm::vec3(bone_matrix[2]))));
+			glm::quat dual = glm::quat(0.0f, glm::vec3(bone_matrix[3])) * real * 0.5f;
+			bone_transforms[bone_index].real = glm::vec4(real.x, real.y, real.z, real.w);
+			bone_transforms[bone_index].dual = glm::vec4(dual.x, dual.y, dual.z, dual.w);
+#else
+			bone_transforms[bone_index].matrix = bone_matrix;
+#endif
+		}
+	}
 
-			for (uint8_t child_bone_index : bone.m_children)
-			{
-				queue.push(std::make_pair(child_bone_index, bone.m_global_bind_pose_matrix));
-			}
+	void Skeleton::sortBones()
+	{
+		m_sorted_bone_indices.clear();
+		m_sorted_bone_indices.reserve(m_bones.size());
+		m_sorted_bone_indices.push_back(m_root_bone_index);
+		for (size_t i = 0; i < m_sorted_bone_indices.size(); ++i)
+		{
+			const Bone& bone = m_bones[m_sorted_bone_indices[i]];
+			m_sorted_bone_indices.insert(m_sorted_bone_indices.end(), bone.m_children.begin(), bone.m_children.end());
 		}
 	}
 
@@ -1,22 +1,38 @@
 #pragma once
 
 #include "engine/resource/asset/base/bone.h"
+#include "engine/core/math/pose.h"
+#include "host_device.h"
 
 namespace Bamboo
 {
+	// the immutable definition of a skeleton shared by all its animators: hierarchy, bind poses and names,
+	// animators only keep poses of their own
 	class Skeleton : public Asset
 	{
 	public:
 		std::vector<Bone> m_bones;
-		uint8_t m_root_bone_index;
+		uint16_t m_root_bone_index;
 
-		std::map<std::string, uint8_t> m_name_index;
+		std::map<std::string, uint16_t> m_name_index;
 
 		virtual void inflate() override;
 
 		bool hasBone(const std::string& name);
 		Bone* getBone(const std::string& name);
-		void update();
+
+		// INVALID_BONE_INDEX if the skeleton has no such bone, bone indices are 16 bit
+		uint16_t getBoneIndex(const std::string& name) const;
+
+		// evaluate the skinning transforms of a pose of the skeleton in topological order, parents before their children,
+		// bone_transforms must hold a transform per bone
+		void calcBoneTransforms(const Pose& pose, BoneTransform* bone_transforms) const;
+
+	private:
+		void sortBones();
+
+		// bones reachable from the root in breadth first order
+		std::vector<uint16_t> m_sorted_bone_indices;
 
 	private:
 		friend class cereal::access;
@@ -10,8 +10,18 @@ namespace Bamboo
 	{
 		calcBoundingBox();
 
+#if QUANTIZED_VERTEX
+		std::vector<QuantizedStaticVertex> quantized_vertices(m_vertices.size());
+		for (size_t i = 0; i < m_vertices.size(); ++i)
+		{
+			quantizeVertex(m_vertices[i], quantized_vertices[i]);
+		}
+		VulkanUtil::createVertexBuffer(quantized_vertices.size() * sizeof(quantized_vertices[0]), quantized_vertices.data(), m_vertex_buffer);
+#else
 		VulkanUtil::createVertexBuffer(m_vertices.size() * sizeof(m_vertices[0]), m_vertices.data(), m_vertex_buffer);
-		VulkanUtil::createIndexBuffer(m_indices, m_index_buffer);
+#endif
+		createIndexBuffer();
+		createMeshletBuffer();
 	}
 
 	void StaticMesh::calcBoundingBox()
@@ -3,6 +3,7 @@
 #include <cereal/access.hpp>
 #include <glm/glm.hpp>
 #include <glm/gtc/type_ptr.hpp>
+#include <glm/gtc/type_precision.hpp>
 
 #include <rttr/registration>
 #include <rttr/registration_friend.h>
@@ -20,6 +21,7 @@ namespace cereal
 	template<class Archive> void serialize(Archive& ar, glm::uvec2& v) { ar(cereal::make_nvp("x", v.x), cereal::make_nvp("y", v.y)); }
 	template<class Archive> void serialize(Archive& ar, glm::uvec3& v) { ar(cereal::make_nvp("x", v.x), cereal::make_nvp("y", v.y), cereal::make_nvp("z", v.z)); }
 	template<class Archive> void serialize(Archive& ar, glm::uvec4& v) { ar(cereal::make_nvp("x", v.x), cereal::make_nvp("y", v.y), cereal::make_nvp("z", v.z), cereal::make_nvp("w", v.w)); }
+	template<class Archive> void serialize(Archive& ar, glm::u16vec4& v) { ar(cereal::make_nvp("x", v.x), cereal::make_nvp("y", v.y), cereal::make_nvp("z", v.z), cereal::make_nvp("w", v.w)); }
 	template<class Archive> void serialize(Archive& ar, glm::dvec2& v) { ar(cereal::make_nvp("x", v.x), cereal::make_nvp("y", v.y)); }
 	template<class Archive> void serialize(Archive& ar, glm::dvec3& v) { ar(cereal::make_nvp("x", v.x), cereal::make_nvp("y", v.y), cereal::make_nvp("z", v.z)); }
 	template<class Archive> void serialize(Archive& ar, glm::dvec4& v) { ar(cereal::make_nvp("x", v.x), cereal::make_nvp("y", v.y), cereal::make_nvp("z", v.z), cereal::make_nvp("w", v.w)); }
@@ -1,5 +1,6 @@
 #include "shader_manager.h"
 #include "engine/core/vulkan/vulkan_rhi.h"
+#include "host_device.h"
 #include <array>
 
 namespace Bamboo
@@ -36,10 +37,14 @@ namespace Bamboo
 			return;
 		}
 
-		// get shader include directory
+		// build options shared with c++ are passed as shader definitions, see the engine's CMakeLists.txt
+		std::string shader_defines = StringUtil::format("-DDUAL_QUATERNION_SKINNING=%d -DQUANTIZED_VERTEX=%d",
+			DUAL_QUATERNION_SKINNING, QUANTIZED_VERTEX);
+
+		// get shader include directory, all shaders are recompiled if it or the definitions change
 		bool need_compile_all = false;
 		std::string global_shader_include_dir = fs->global(fs->combine(fs->getShaderDir(), std::string("include")));
-		std::string shader_include_dir_modified_time = fs->modifiedTime(global_shader_include_dir);
+		std::string shader_include_dir_modified_time = fs->modifiedTime(global_shader_include_dir) + " " + shader_defines;
 		std::string spv_include_filename = fs->combine(spv_dir, std::string("include.txt"));
 		if (!fs->exists(spv_include_filename))
 		{
@@ -81,8 +86,8 @@ namespace Bamboo
 				std::string global_glsl_filename = fs->global(glsl_filename);
 				std::string spv_filename = StringUtil::format("%s/%s-%s.spv", spv_dir.c_str(), glsl_basename.c_str(), modified_time.c_str());
 				std::string global_spv_filename = fs->global(spv_filename);
-				std::string shader_compile_cmd = StringUtil::format("%s --target-env vulkan1.3 -I%s -g -o \"%s\" \"%s\"", 
-					VULKAN_SHADER_COMPILER, global_shader_include_dir.c_str(), global_spv_filename.c_str(), global_glsl_filename.c_str());
+				std::string shader_compile_cmd = StringUtil::format("%s --target-env vulkan1.3 -I%s %s -g -o \"%s\" \"%s\"", 
+					VULKAN_SHADER_COMPILER, global_shader_include_dir.c_str(), shader_defines.c_str(), global_spv_filename.c_str(), global_glsl_filename.c_str());
 				std::string result = execute(shader_compile_cmd.c_str());
 				StringUtil::trim(result);
 				if (!result.empty())